@@ -0,0 +1,198 @@
+#include "../headers/AdmissionController.h"
+
+#include <algorithm>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+std::string overloadStateToString(OverloadState state) {
+    switch (state) {
+        case OverloadState::NORMAL: return "NORMAL";
+        case OverloadState::ELEVATED: return "ELEVATED";
+        case OverloadState::OVERLOADED: return "OVERLOADED";
+    }
+    return "UNKNOWN";
+}
+
+std::string admissionVerdictToString(AdmissionVerdict verdict) {
+    switch (verdict) {
+        case AdmissionVerdict::ADMITTED: return "ADMITTED";
+        case AdmissionVerdict::GLOBAL_LIMIT: return "GLOBAL_LIMIT";
+        case AdmissionVerdict::PER_IP_LIMIT: return "PER_IP_LIMIT";
+        case AdmissionVerdict::RATE_LIMITED: return "RATE_LIMITED";
+        case AdmissionVerdict::OVERLOADED: return "OVERLOADED";
+    }
+    return "UNKNOWN";
+}
+
+AdmissionController::AdmissionController(const AdmissionConfig& cfg)
+    : config(cfg),
+      bucketCapacity(cfg.acceptBurst > 0 ? cfg.acceptBurst : std::max(1.0, cfg.acceptRatePerSec)),
+      tokens(bucketCapacity),
+      lastRefill(std::chrono::steady_clock::now())
+{
+}
+
+bool AdmissionController::isEnabled() const {
+    return config.maxConnections > 0 || config.maxConnectionsPerIp > 0 || config.acceptRatePerSec > 0.0 || config.maxPendingConnections > 0;
+}
+
+// --- Décision d'admission (thread d'acceptation) ---
+// L'ordre des contrôles va du plus grave au plus local : un serveur saturé refuse tout le monde,
+// le seau à jetons n'est débité que pour une connexion qui passerait toutes les autres limites.
+AdmissionVerdict AdmissionController::admit(int fd, uint32_t ip) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    AdmissionVerdict verdict = AdmissionVerdict::ADMITTED;
+    if (config.maxPendingConnections > 0 && pendingCount >= static_cast<size_t>(config.maxPendingConnections)) {
+        verdict = AdmissionVerdict::OVERLOADED;
+    } else if (config.maxConnections > 0 && connections.size() >= static_cast<size_t>(config.maxConnections)) {
+        verdict = AdmissionVerdict::GLOBAL_LIMIT;
+    } else if (config.maxConnectionsPerIp > 0) {
+        auto it = perIpCount.find(ip);
+        if (it != perIpCount.end() && it->second >= config.maxConnectionsPerIp) {
+            verdict = AdmissionVerdict::PER_IP_LIMIT;
+        }
+    }
+    if (verdict == AdmissionVerdict::ADMITTED && config.acceptRatePerSec > 0.0 && !takeToken(std::chrono::steady_clock::now())) {
+        verdict = AdmissionVerdict::RATE_LIMITED;
+    }
+
+    if (verdict != AdmissionVerdict::ADMITTED) {
+        recordShed(verdict);
+        return verdict;
+    }
+
+    auto [it, inserted] = connections.emplace(fd, Tracked{ip, false});
+    if (!inserted) {
+        // Ne devrait pas arriver : un release() manquant avant close(). On remplace l'entrée périmée.
+        LOG("AdmissionController::admit ERROR : Socket FD " + std::to_string(fd) + " déjà suivi (release manquant). Entrée remplacée.", "ERROR");
+        if (--perIpCount[it->second.ip] <= 0) {
+            perIpCount.erase(it->second.ip);
+        }
+        if (!it->second.established) {
+            pendingCount--;
+        }
+        it->second = Tracked{ip, false};
+    }
+    perIpCount[ip]++;
+    pendingCount++;
+    stats.admitted++;
+    stats.peakOpenConnections = std::max(stats.peakOpenConnections, connections.size());
+
+    if (consecutiveSheds > 0) {
+        LOG("AdmissionController::admit INFO : Reprise des admissions après " + std::to_string(consecutiveSheds) + " connexion(s) refusée(s).", "INFO");
+        consecutiveSheds = 0;
+    }
+    updateState();
+    return AdmissionVerdict::ADMITTED;
+}
+
+void AdmissionController::markEstablished(int fd) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = connections.find(fd);
+    if (it == connections.end() || it->second.established) {
+        return;
+    }
+    it->second.established = true;
+    pendingCount--;
+    updateState();
+}
+
+void AdmissionController::release(int fd) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = connections.find(fd);
+    if (it == connections.end()) {
+        return;
+    }
+    auto ip_it = perIpCount.find(it->second.ip);
+    if (ip_it != perIpCount.end() && --ip_it->second <= 0) {
+        perIpCount.erase(ip_it);
+    }
+    if (!it->second.established) {
+        pendingCount--;
+    }
+    connections.erase(it);
+    updateState();
+}
+
+void AdmissionController::refuse(int fd) {
+    linger lg{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+    close(fd);
+}
+
+// --- Seau à jetons ---
+bool AdmissionController::takeToken(std::chrono::steady_clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+    lastRefill = now;
+    tokens = std::min(bucketCapacity, tokens + elapsed * config.acceptRatePerSec);
+    if (tokens < 1.0) {
+        return false;
+    }
+    tokens -= 1.0;
+    return true;
+}
+
+// --- État de charge ---
+// Seules les limites globales comptent (connexions ouvertes, en cours d'établissement) : une IP qui
+// atteint sa propre limite ne rend pas le serveur "chargé" pour les autres clients.
+OverloadState AdmissionController::computeState() const {
+    if ((config.maxPendingConnections > 0 && pendingCount >= static_cast<size_t>(config.maxPendingConnections))
+        || (config.maxConnections > 0 && connections.size() >= static_cast<size_t>(config.maxConnections))) {
+        return OverloadState::OVERLOADED;
+    }
+    if ((config.maxPendingConnections > 0 && pendingCount * 4 >= static_cast<size_t>(config.maxPendingConnections) * 3)
+        || (config.maxConnections > 0 && connections.size() * 4 >= static_cast<size_t>(config.maxConnections) * 3)) {
+        return OverloadState::ELEVATED;
+    }
+    return OverloadState::NORMAL;
+}
+
+void AdmissionController::updateState() {
+    OverloadState next = computeState();
+    if (next == state) {
+        return;
+    }
+    std::string level = next == OverloadState::OVERLOADED ? "WARNING" : "INFO";
+    LOG("AdmissionController " + level + " : État de charge " + overloadStateToString(state) + " -> " + overloadStateToString(next)
+        + " (connexions ouvertes: " + std::to_string(connections.size()) + ", en cours d'établissement: " + std::to_string(pendingCount) + ").", level);
+    state = next;
+}
+
+void AdmissionController::recordShed(AdmissionVerdict verdict) {
+    switch (verdict) {
+        case AdmissionVerdict::GLOBAL_LIMIT: stats.shedGlobalLimit++; break;
+        case AdmissionVerdict::PER_IP_LIMIT: stats.shedPerIpLimit++; break;
+        case AdmissionVerdict::RATE_LIMITED: stats.shedRateLimited++; break;
+        case AdmissionVerdict::OVERLOADED: stats.shedOverloaded++; break;
+        case AdmissionVerdict::ADMITTED: break;
+    }
+    // Un refus journalisé par épisode (et non par connexion) : sous attaque, le log ne doit pas devenir le goulot.
+    if (consecutiveSheds++ == 0) {
+        LOG("AdmissionController WARNING : Connexions refusées avant TLS (" + admissionVerdictToString(verdict) + "). Connexions ouvertes: "
+            + std::to_string(connections.size()) + ", en cours d'établissement: " + std::to_string(pendingCount) + ".", "WARNING");
+    }
+}
+
+OverloadState AdmissionController::getState() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return state;
+}
+
+AdmissionStats AdmissionController::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    AdmissionStats current = stats;
+    current.openConnections = connections.size();
+    current.pendingConnections = pendingCount;
+    current.state = state;
+    return current;
+}
+
+void AdmissionController::logStats() const {
+    AdmissionStats st = getStats();
+    LOG("AdmissionController::logStats INFO : État " + overloadStateToString(st.state) + ". Admises: " + std::to_string(st.admitted)
+        + ", refusées (globale: " + std::to_string(st.shedGlobalLimit) + ", par IP: " + std::to_string(st.shedPerIpLimit)
+        + ", débit: " + std::to_string(st.shedRateLimited) + ", surcharge: " + std::to_string(st.shedOverloaded)
+        + "). Ouvertes: " + std::to_string(st.openConnections) + " (pic: " + std::to_string(st.peakOpenConnections) + ").", "INFO");
+}
@@ -10,6 +10,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <string> 
+#include <algorithm>
 #include <fcntl.h>  // Pour fcntl
 #include <signal.h> // Pour ignorer SIGPIPE signal
 
@@ -18,6 +19,7 @@
 #include <openssl/evp.h> 
 #include <openssl/crypto.h> 
 #include "../headers/ClientInitiator.h"
+#include "../headers/ClientSessionPool.h"
 #include "../headers/Logger.h"  
 #include "../headers/OpenSSLDeleters.h"
 #include <fstream> 
@@ -475,7 +477,194 @@ void test_max_connections(){
     std::this_thread::sleep_for(std::chrono::seconds(10));
 }
 
-int main() {
+// Résultats cumulés du benchmark de reprise (protégés par resumption_mutex).
+std::mutex resumption_mutex;
+double full_handshake_ms_total = 0.0;
+double resumed_handshake_ms_total = 0.0;
+int full_handshake_count = 0;
+int resumed_handshake_count = 0;
+int resumption_refused_count = 0; // Session proposée mais handshake complet côté serveur
+
+/* Une connexion du benchmark de reprise : TCP + handshake TLS (en proposant 'offered' si non null), authentification,
+lecture d'une réponse (en TLS 1.3 les tickets arrivent après le handshake), puis fermeture.
+Retourne la session à proposer à la connexion suivante (à libérer par l'appelant), ou nullptr en cas d'échec. */
+SSL_SESSION* resumption_round(SSL_CTX* ctx, SSL_SESSION* offered, int id) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) {
+        failed_connections++;
+        return nullptr;
+    }
+    sockaddr_in server_addr{};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(SERVER_PORT);
+    inet_pton(AF_INET, SERVER_IP, &server_addr.sin_addr);
+
+    auto handshake_start = std::chrono::high_resolution_clock::now();
+    if (!connect_with_timeout(sock, &server_addr, CONNECTION_TIMEOUT_MS)) {
+        close(sock);
+        failed_connections++;
+        return nullptr;
+    }
+    SSL* ssl = SSL_new(ctx);
+    if (!ssl || !SSL_set_fd(ssl, sock) || (offered && !SSL_set_session(ssl, offered)) || SSL_connect(ssl) <= 0) {
+        std::lock_guard<std::mutex> lock(cout_mutex);
+        std::cerr << "\033[1;31mClient #" << id << ": Échec connexion SSL\033[0m\n";
+        if (ssl) SSL_free(ssl);
+        close(sock);
+        failed_connections++;
+        return nullptr;
+    }
+    std::chrono::duration<double, std::milli> handshake_ms = std::chrono::high_resolution_clock::now() - handshake_start;
+    bool reused = SSL_session_reused(ssl);
+
+    // Authentification puis lecture de la réponse : permet de recevoir le NewSessionTicket TLS 1.3.
+    std::string auth_message = "ID:benchmark" + std::to_string(id) + ",TOKEN:abc123\n";
+    SSL_write(ssl, auth_message.c_str(), auth_message.length());
+    timeval read_timeout{READ_TIMEOUT_MS / 1000, (READ_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &read_timeout, sizeof(read_timeout));
+    char buffer[4096];
+    SSL_read(ssl, buffer, sizeof(buffer));
+
+    SSL_SESSION* next = SSL_get1_session(ssl);
+    const char* quit_message = "QUIT\n";
+    SSL_write(ssl, quit_message, strlen(quit_message));
+    SSL_shutdown(ssl);
+    SSL_free(ssl);
+    close(sock);
+
+    successful_connections++;
+    {
+        std::lock_guard<std::mutex> lock(resumption_mutex);
+        if (reused) {
+            resumed_handshake_ms_total += handshake_ms.count();
+            resumed_handshake_count++;
+        } else {
+            full_handshake_ms_total += handshake_ms.count();
+            full_handshake_count++;
+            if (offered) resumption_refused_count++;
+        }
+    }
+    return next;
+}
+
+void save_resumption_results_to_csv(const std::string& filename, int num_clients, int reconnects, double full_avg_ms, double resumed_avg_ms, double full_hps, double resumed_hps, int refused) {
+    std::ofstream file;
+    file.open(filename, std::ios::app); // Ouvrir en mode ajout
+    if (!file.is_open()) {
+        LOG("Erreur : Impossible d'ouvrir le fichier " + filename, "ERROR");
+        return;
+    }
+    file << num_clients << "," << reconnects << "," << full_avg_ms << "," << resumed_avg_ms << "," << full_hps << "," << resumed_hps << "," << refused << "\n";
+    file.close();
+}
+
+/* Benchmark 4 : reprise de session TLS. Chaque client fait un premier handshake complet puis se reconnecte 'reconnects' fois
+en proposant la session (ticket) obtenue à la connexion précédente. On compare la latence moyenne et le débit (handshakes par
+seconde et par thread client) des handshakes complets et repris ; un refus de reprise par le serveur est compté à part. */
+void test_resumption(int num_clients, int reconnects) {
+    successful_connections = 0;
+    failed_connections = 0;
+    full_handshake_ms_total = resumed_handshake_ms_total = 0.0;
+    full_handshake_count = resumed_handshake_count = resumption_refused_count = 0;
+
+    // Contexte partagé par tous les clients : le cache de sessions client n'est pas utilisé, la session est passée explicitement.
+    SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+    if (!ctx) {
+        LOG("test_resumption: Erreur création SSL_CTX", "ERROR");
+        return;
+    }
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_clients; ++i) {
+        threads.emplace_back([ctx, reconnects, i]() {
+            SSL_SESSION* session = nullptr;
+            for (int round = 0; round <= reconnects; ++round) {
+                SSL_SESSION* next = resumption_round(ctx, session, i);
+                if (next) {
+                    if (session) SSL_SESSION_free(session);
+                    session = next;
+                }
+            }
+            if (session) SSL_SESSION_free(session);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    SSL_CTX_free(ctx);
+
+    double full_avg = full_handshake_count > 0 ? full_handshake_ms_total / full_handshake_count : 0.0;
+    double resumed_avg = resumed_handshake_count > 0 ? resumed_handshake_ms_total / resumed_handshake_count : 0.0;
+    double full_hps = full_avg > 0 ? 1000.0 / full_avg : 0.0;
+    double resumed_hps = resumed_avg > 0 ? 1000.0 / resumed_avg : 0.0;
+
+    std::cout << "\n=== Résultat du benchmark de reprise pour " << num_clients << " clients x " << (reconnects + 1) << " connexions ===\n";
+    std::cout << "Connexions réussies : " << successful_connections.load() << ", échouées : " << failed_connections.load() << "\n";
+    std::cout << "Handshakes complets : " << full_handshake_count << " | latence moyenne : " << full_avg << " ms | " << full_hps << " handshakes/s/client\n";
+    std::cout << "Handshakes repris   : " << resumed_handshake_count << " | latence moyenne : " << resumed_avg << " ms | " << resumed_hps << " handshakes/s/client\n";
+    std::cout << "Reprises refusées par le serveur : " << resumption_refused_count << "\n";
+    if (resumed_avg > 0) {
+        std::cout << "Gain de la reprise : x" << (full_avg / resumed_avg) << "\n\n";
+    }
+
+    save_resumption_results_to_csv("resumption_results.csv", num_clients, reconnects, full_avg, resumed_avg, full_hps, resumed_hps, resumption_refused_count);
+}
+
+/* Benchmark des canaux multiplexés : 'num_accounts' comptes ("poolbench<i>", mot de passe "pw<ID>") ouverts sur
+'num_connections' connexions TLS d'un ClientSessionPool (un seul SSL_CTX, un handshake par connexion et non par compte).
+Mesure le temps d'ouverture des canaux puis l'aller-retour d'un GET_PRICE par compte, envoyés tous ensemble. */
+void test_pool(int num_accounts, int num_connections) {
+    ClientPoolConfig config;
+    config.connections = static_cast<size_t>(std::max(1, num_connections));
+    config.maxChannelsPerConnection = static_cast<size_t>((num_accounts + num_connections - 1) / std::max(1, num_connections));
+    config.connectionId = "poolbench-conn";
+    config.connectionPassword = "pwpoolbench";
+
+    auto start = std::chrono::high_resolution_clock::now();
+    ClientSessionPool pool;
+    if (!pool.start(config)) {
+        LOG("test_pool: Aucune connexion du pool n'a pu être établie.", "ERROR");
+        return;
+    }
+    auto connected = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::shared_ptr<PooledSession>> sessions;
+    for (int i = 0; i < num_accounts; ++i) {
+        std::string id = "poolbench" + std::to_string(i);
+        auto session = pool.openSession(id, "pw" + id);
+        if (session) {
+            sessions.push_back(session);
+        }
+    }
+    auto opened = std::chrono::high_resolution_clock::now();
+
+    for (auto& session : sessions) {
+        session->send("GET_PRICE SRD-BTC");
+    }
+    size_t answered = 0;
+    std::string line;
+    for (auto& session : sessions) {
+        if (session->receiveLine(line, 5000)) {
+            answered++;
+        }
+    }
+    auto done = std::chrono::high_resolution_clock::now();
+    size_t connection_count = pool.getConnectionCount();
+    pool.stop();
+
+    double connect_ms = std::chrono::duration<double, std::milli>(connected - start).count();
+    double open_ms = std::chrono::duration<double, std::milli>(opened - connected).count();
+    double rtt_ms = std::chrono::duration<double, std::milli>(done - opened).count();
+    std::cout << "\n=== Résultat du benchmark pool : " << num_accounts << " comptes sur " << connection_count << " connexions ===\n";
+    std::cout << "Connexions TLS : " << connect_ms << " ms\n";
+    std::cout << "Canaux ouverts : " << sessions.size() << " / " << num_accounts << " en " << open_ms << " ms ("
+              << (sessions.empty() ? 0.0 : open_ms / sessions.size()) << " ms/compte)\n";
+    std::cout << "GET_PRICE : " << answered << " réponses en " << rtt_ms << " ms\n\n";
+}
+
+int main(int argc, char* argv[]) {
     //------------------------CPS------------------------------
     //ignorer les erreurs dues au connexions/deconnexion trop rapides
     signal(SIGPIPE, SIG_IGN);
@@ -484,7 +673,27 @@ int main() {
     OpenSSL_add_all_algorithms();
     SSL_load_error_strings();
     LOG("Démarrage des tests de benchmark", "INFO");
-    
+
+    //------------------------Reprise TLS------------------------------
+    // ./Benchmark resumption [clients] [reconnexions] : compare handshakes complets et repris, puis quitte.
+    if (argc > 1 && std::string(argv[1]) == "resumption") {
+        int num_clients = argc > 2 ? std::stoi(argv[2]) : 50;
+        int reconnects = argc > 3 ? std::stoi(argv[3]) : 10;
+        LOG("Démarrage du benchmark de reprise TLS avec " + std::to_string(num_clients) + " clients", "INFO");
+        test_resumption(num_clients, reconnects);
+        return 0;
+    }
+
+    //------------------------Pool de connexions------------------------------
+    // ./Benchmark pool [comptes] [connexions] : comptes multiplexés sur quelques connexions TLS, puis quitte.
+    if (argc > 1 && std::string(argv[1]) == "pool") {
+        int num_accounts = argc > 2 ? std::stoi(argv[2]) : 200;
+        int num_connections = argc > 3 ? std::stoi(argv[3]) : 4;
+        LOG("Démarrage du benchmark pool avec " + std::to_string(num_accounts) + " comptes", "INFO");
+        test_pool(num_accounts, num_connections);
+        return 0;
+    }
+
 
     // Exécuter les tests avec différentes charges
     std::vector<int> client_counts = {100, 500, 1000, 1500, 2000, 2500, 3000, 3500, 4000, 4500, 5000, 5500, 6000, 6500, 7500, 8000, 10000, 12000, 15000, 20000, 25000, 30000, 40000, 50000, 60000};
@@ -0,0 +1,293 @@
+#include "../headers/BinaryProtocol.h"
+#include "../headers/Global.h" // Pour TransactionStatus et transactionStatusToString (describe)
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace BinaryProtocol {
+
+// --- Écriture/lecture en ordre réseau (big-endian), indépendamment de l'architecture ---
+static void putU8(std::string& out, uint8_t value) {
+    out.push_back(static_cast<char>(value));
+}
+
+static void putU16(std::string& out, uint16_t value) {
+    putU8(out, static_cast<uint8_t>(value >> 8));
+    putU8(out, static_cast<uint8_t>(value));
+}
+
+static void putU32(std::string& out, uint32_t value) {
+    putU16(out, static_cast<uint16_t>(value >> 16));
+    putU16(out, static_cast<uint16_t>(value));
+}
+
+static void putU64(std::string& out, uint64_t value) {
+    putU32(out, static_cast<uint32_t>(value >> 32));
+    putU32(out, static_cast<uint32_t>(value));
+}
+
+static void putDouble(std::string& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putU64(out, bits);
+}
+
+// Champ de taille fixe complété par des '\0' (tronqué si trop long).
+static void putField(std::string& out, std::string_view text, size_t size) {
+    size_t copied = std::min(text.size(), size);
+    out.append(text.data(), copied);
+    out.append(size - copied, '\0');
+}
+
+static uint16_t getU16(const char* data) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    return static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+}
+
+static uint32_t getU32(const char* data) {
+    return (static_cast<uint32_t>(getU16(data)) << 16) | getU16(data + 2);
+}
+
+static uint64_t getU64(const char* data) {
+    return (static_cast<uint64_t>(getU32(data)) << 32) | getU32(data + 4);
+}
+
+static double getDouble(const char* data) {
+    uint64_t bits = getU64(data);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// En-tête d'une trame dont le corps fait 'bodySize' octets.
+static void putHeader(std::string& out, MessageType type, uint64_t requestId, size_t bodySize) {
+    out.reserve(out.size() + HEADER_SIZE + bodySize);
+    putU32(out, static_cast<uint32_t>(HEADER_SIZE + bodySize));
+    putU8(out, static_cast<uint8_t>(type));
+    putU8(out, VERSION);
+    putU16(out, 0);
+    putU64(out, requestId);
+}
+
+
+// --- Extraction d'une trame ---
+DecodeStatus nextFrame(LineFramer& framer, FrameHeader& header, std::string_view& body) {
+    char raw[HEADER_SIZE];
+    if (!framer.peek(raw, HEADER_SIZE)) {
+        return DecodeStatus::NEED_MORE;
+    }
+    header.length = getU32(raw);
+    header.type = static_cast<MessageType>(static_cast<uint8_t>(raw[4]));
+    header.version = static_cast<uint8_t>(raw[5]);
+    header.reserved = getU16(raw + 6);
+    header.requestId = getU64(raw + 8);
+
+    if (header.version != VERSION || header.length < HEADER_SIZE || header.length > MAX_FRAME_SIZE) {
+        return DecodeStatus::INVALID;
+    }
+
+    std::string_view frame;
+    if (!framer.nextBlock(header.length, frame)) {
+        return DecodeStatus::NEED_MORE;
+    }
+    body = frame.substr(HEADER_SIZE);
+    return DecodeStatus::FRAME;
+}
+
+
+// --- Décodage des corps ---
+bool decodeOrder(std::string_view body, OrderBody& order) {
+    if (body.size() != ORDER_BODY_SIZE) {
+        return false;
+    }
+    std::memcpy(order.symbol, body.data(), SYMBOL_SIZE);
+    order.percentage = getDouble(body.data() + SYMBOL_SIZE);
+    return true;
+}
+
+bool decodeSymbol(std::string_view body, SymbolBody& symbol) {
+    if (body.size() != SYMBOL_BODY_SIZE) {
+        return false;
+    }
+    std::memcpy(symbol.symbol, body.data(), SYMBOL_SIZE);
+    return true;
+}
+
+bool decodeShow(std::string_view body, ShowBody& show) {
+    if (body.size() != SHOW_BODY_SIZE) {
+        return false;
+    }
+    show.target = static_cast<ShowTarget>(static_cast<uint8_t>(body[0]));
+    return true;
+}
+
+bool decodePrice(std::string_view body, PriceBody& price) {
+    if (body.size() != PRICE_BODY_SIZE) {
+        return false;
+    }
+    std::memcpy(price.symbol, body.data(), SYMBOL_SIZE);
+    price.price = getDouble(body.data() + SYMBOL_SIZE);
+    return true;
+}
+
+bool decodeWallet(std::string_view body, WalletBody& wallet) {
+    if (body.size() != WALLET_BODY_SIZE) {
+        return false;
+    }
+    wallet.usd = getDouble(body.data());
+    wallet.srdBtc = getDouble(body.data() + 8);
+    return true;
+}
+
+bool decodeTransactionResult(std::string_view body, TransactionResultBody& result, std::string_view& reason) {
+    if (body.size() < TRANSACTION_RESULT_BODY_SIZE) {
+        return false;
+    }
+    std::memcpy(result.transactionId, body.data(), TRANSACTION_ID_SIZE);
+    result.status = static_cast<uint8_t>(body[TRANSACTION_ID_SIZE]);
+    reason = body.substr(TRANSACTION_RESULT_BODY_SIZE);
+    return true;
+}
+
+std::string_view fieldView(const char* field, size_t size) {
+    const void* end = std::memchr(field, '\0', size);
+    return std::string_view(field, end ? static_cast<size_t>(static_cast<const char*>(end) - field) : size);
+}
+
+
+// --- Encodage des requêtes ---
+void encodeOrder(std::string& out, MessageType side, uint64_t requestId, std::string_view symbol, double percentage) {
+    putHeader(out, side, requestId, ORDER_BODY_SIZE);
+    putField(out, symbol, SYMBOL_SIZE);
+    putDouble(out, percentage);
+}
+
+void encodeGetPrice(std::string& out, uint64_t requestId, std::string_view symbol) {
+    putHeader(out, MessageType::GET_PRICE, requestId, SYMBOL_BODY_SIZE);
+    putField(out, symbol, SYMBOL_SIZE);
+}
+
+void encodeShow(std::string& out, uint64_t requestId, ShowTarget target) {
+    putHeader(out, MessageType::SHOW, requestId, SHOW_BODY_SIZE);
+    putU8(out, static_cast<uint8_t>(target));
+    out.append(SHOW_BODY_SIZE - 1, '\0');
+}
+
+void encodeQuit(std::string& out, uint64_t requestId) {
+    putHeader(out, MessageType::QUIT, requestId, 0);
+}
+
+void encodeHeartbeat(std::string& out, MessageType type, uint64_t requestId) {
+    putHeader(out, type, requestId, 0);
+}
+
+
+// --- Encodage des réponses ---
+void encodeAck(std::string& out, uint64_t requestId) {
+    putHeader(out, MessageType::ACK, requestId, 0);
+}
+
+void encodeText(std::string& out, MessageType type, uint64_t requestId, std::string_view text) {
+    text = text.substr(0, std::min(text.size(), MAX_FRAME_SIZE - HEADER_SIZE));
+    putHeader(out, type, requestId, text.size());
+    out.append(text.data(), text.size());
+}
+
+void encodePrice(std::string& out, uint64_t requestId, std::string_view symbol, double price) {
+    putHeader(out, MessageType::PRICE, requestId, PRICE_BODY_SIZE);
+    putField(out, symbol, SYMBOL_SIZE);
+    putDouble(out, price);
+}
+
+void encodeWallet(std::string& out, uint64_t requestId, double usd, double srdBtc) {
+    putHeader(out, MessageType::WALLET, requestId, WALLET_BODY_SIZE);
+    putDouble(out, usd);
+    putDouble(out, srdBtc);
+}
+
+void encodeTransactionResult(std::string& out, uint64_t requestId, std::string_view transactionId, uint8_t status, std::string_view reason) {
+    reason = reason.substr(0, std::min(reason.size(), MAX_FRAME_SIZE - HEADER_SIZE - TRANSACTION_RESULT_BODY_SIZE));
+    putHeader(out, MessageType::TRANSACTION_RESULT, requestId, TRANSACTION_RESULT_BODY_SIZE + reason.size());
+    putField(out, transactionId, TRANSACTION_ID_SIZE);
+    putU8(out, status);
+    out.append(7, '\0');
+    out.append(reason.data(), reason.size());
+}
+
+
+// --- Affichage ---
+std::string describe(const FrameHeader& header, std::string_view body) {
+    std::ostringstream text;
+    if (header.requestId != 0) {
+        text << "#" << header.requestId << " ";
+    }
+
+    switch (header.type) {
+        case MessageType::ACK:
+            text << "OK";
+            break;
+        case MessageType::ERROR_TEXT:
+        case MessageType::TEXT:
+            text << body;
+            break;
+        case MessageType::PRICE: {
+            PriceBody price;
+            if (!decodePrice(body, price)) break;
+            text << "PRICE " << fieldView(price.symbol, SYMBOL_SIZE) << " " << std::fixed << std::setprecision(8) << price.price;
+            break;
+        }
+        case MessageType::WALLET: {
+            WalletBody wallet;
+            if (!decodeWallet(body, wallet)) break;
+            text << std::fixed << std::setprecision(10) << "BALANCE USD: " << wallet.usd << ", SRD-BTC: " << wallet.srdBtc;
+            break;
+        }
+        case MessageType::TRANSACTION_RESULT: {
+            TransactionResultBody result;
+            std::string_view reason;
+            if (!decodeTransactionResult(body, result, reason)) break;
+            text << "TRANSACTION_RESULT ID=" << fieldView(result.transactionId, TRANSACTION_ID_SIZE)
+                 << " STATUS=" << transactionStatusToString(static_cast<TransactionStatus>(result.status));
+            if (!reason.empty()) {
+                text << " REASON=\"" << reason << "\"";
+            }
+            break;
+        }
+        case MessageType::BUY:
+        case MessageType::SELL: {
+            OrderBody order;
+            if (!decodeOrder(body, order)) break;
+            text << (header.type == MessageType::BUY ? "BUY " : "SELL ") << fieldView(order.symbol, SYMBOL_SIZE) << " " << order.percentage;
+            break;
+        }
+        case MessageType::GET_PRICE: {
+            SymbolBody symbol;
+            if (!decodeSymbol(body, symbol)) break;
+            text << "GET_PRICE " << fieldView(symbol.symbol, SYMBOL_SIZE);
+            break;
+        }
+        case MessageType::SHOW: {
+            ShowBody show;
+            if (!decodeShow(body, show)) break;
+            text << (show.target == ShowTarget::TRANSACTIONS ? "SHOW TRANSACTIONS" : "SHOW WALLET");
+            break;
+        }
+        case MessageType::QUIT:
+            text << "QUIT";
+            break;
+        case MessageType::PING:
+            text << "PING";
+            break;
+        case MessageType::PONG:
+            text << "PONG";
+            break;
+        default:
+            text << "UNKNOWN_FRAME type=" << static_cast<int>(header.type) << " length=" << header.length;
+            break;
+    }
+    return text.str();
+}
+
+} // namespace BinaryProtocol
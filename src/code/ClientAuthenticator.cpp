@@ -96,7 +96,8 @@ AuthOutcome ClientAuthenticator::AuthenticateClient(ServerConnection& client_con
     // La logique de vérification/enregistrement est dans Server::processAuthRequest.
     // AuthenticatedUserId est un paramètre OUT que le Server remplit si succès.
     // On ne passe PAS reasonForFailure ici, car HandleClient gère les messages d'échec génériques.
-    AuthOutcome authResultFromServer = server_instance.processAuthRequest(receivedId, receivedPassword, authenticatedUserId);
+    // Pair local vérifié par le noyau (socket Unix) : le mot de passe n'est pas exigé pour le compte lié à son UID.
+    AuthOutcome authResultFromServer = server_instance.processAuthRequest(receivedId, receivedPassword, authenticatedUserId, server_instance.PeerAccount(client_conn));
 
 
     // --- 4. Retourner le résultat au Server::HandleClient ---
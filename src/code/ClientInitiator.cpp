@@ -15,7 +15,8 @@
 #include <openssl/ssl.h> 
 #include <openssl/err.h>
 #include <cstring>      
-#include <cerrno>        
+#include <cerrno>
+#include <sys/un.h>        
 
 
 // --- Implémentation du Constructeur ClientInitiator ---
@@ -79,6 +80,7 @@ std::shared_ptr<ServerConnection> ClientInitiator::ConnectToServer(const std::st
         return nullptr;
     }
     LOG("ClientInitiator::ConnectToServer INFO : Connexion TCP établie au serveur " + host + ":" + std::to_string(port) + ". Socket FD: " + std::to_string(clientSocket), "INFO");
+    LowLatency::configureSocket(clientSocket, this->tcpNoDelay, this->busyPollMicros);
 
     // 4. Initiation de la session SSL.
     UniqueSSL ssl_ptr(SSL_new(ctx_raw)); // Utilise le contexte client passé en argument
@@ -133,3 +135,64 @@ std::shared_ptr<ServerConnection> ClientInitiator::ConnectToServer(const std::st
 
     return connection; // Retourne le pointeur partagé vers l'objet de connexion.
 }
+
+// --- Implémentation de la méthode ClientInitiator::ConnectToUnixSocket ---
+std::shared_ptr<ServerConnection> ClientInitiator::ConnectToUnixSocket(const std::string& path) {
+    LOG("ClientInitiator::ConnectToUnixSocket INFO : Tentative de connexion locale à '" + path + "'", "INFO");
+
+    sockaddr_un serverAddr{};
+    if (path.empty() || path.size() >= sizeof(serverAddr.sun_path)) {
+        LOG("ClientInitiator::ConnectToUnixSocket ERROR : Chemin du socket Unix invalide: '" + path + "'.", "ERROR");
+        return nullptr;
+    }
+    serverAddr.sun_family = AF_UNIX;
+    std::memcpy(serverAddr.sun_path, path.c_str(), path.size() + 1);
+
+    int clientSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (clientSocket < 0) {
+        LOG("ClientInitiator::ConnectToUnixSocket ERROR : Échec de la création de la socket client. Erreur: " + std::string(strerror(errno)), "ERROR");
+        return nullptr;
+    }
+    if (connect(clientSocket, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) < 0) {
+        LOG("ClientInitiator::ConnectToUnixSocket ERROR : Échec de la connexion à '" + path + "'. Erreur: " + std::string(strerror(errno)), "ERROR");
+        close(clientSocket);
+        return nullptr;
+    }
+
+    // L'objet ServerConnection prend la propriété de la socket.
+    std::shared_ptr<ServerConnection> connection = std::make_shared<ServerConnection>(clientSocket, std::make_unique<PlainTransport>(clientSocket));
+    if (!connection->isConnected()) {
+        LOG("ClientInitiator::ConnectToUnixSocket ERROR : Échec de la création de l'objet ServerConnection.", "ERROR");
+        return nullptr;
+    }
+    LOG("ClientInitiator::ConnectToUnixSocket INFO : Connexion locale établie. Socket FD: " + std::to_string(clientSocket), "INFO");
+    return connection;
+}
+
+
+// --- Implémentation de la méthode ClientInitiator::EnableBinaryProtocol ---
+bool ClientInitiator::EnableBinaryProtocol(ServerConnection& connection) {
+    try {
+        if (connection.send("BINARY ON\n") <= 0) {
+            LOG("ClientInitiator::EnableBinaryProtocol ERROR : Échec de l'envoi de la demande de protocole binaire.", "ERROR");
+            return false;
+        }
+        // La réponse est encore une ligne texte ; les échanges suivants sont des trames binaires.
+        std::string response = connection.receiveLine();
+        if (response.rfind("OK", 0) != 0) {
+            LOG("ClientInitiator::EnableBinaryProtocol WARNING : Protocole binaire refusé par le serveur : '" + response + "'", "WARNING");
+            return false;
+        }
+    } catch (const std::exception& e) {
+        LOG("ClientInitiator::EnableBinaryProtocol ERROR : Exception pendant la négociation du protocole binaire : " + std::string(e.what()), "ERROR");
+        return false;
+    }
+    LOG("ClientInitiator::EnableBinaryProtocol INFO : Protocole binaire activé. Socket FD: " + std::to_string(connection.getSocketFD()), "INFO");
+    return true;
+}
+
+// --- Réglages des sockets TCP sortants ---
+void ClientInitiator::SetSocketTuning(bool noDelay, int busyPoll) {
+    this->tcpNoDelay = noDelay;
+    this->busyPollMicros = busyPoll;
+}
@@ -9,6 +9,8 @@
 #include "../headers/Logger.h" // Pour LOG macro
 #include "../headers/Transaction.h" // Pour enums et struct TransactionRequest, et helpers stringTo/ToString
 #include "../headers/TransactionQueue.h"
+#include "../headers/BinaryProtocol.h" // Trames du protocole binaire (après "BINARY ON")
+#include "../headers/CommandTable.h" // Verbes (hachage parfait) et découpage des commandes texte
 
 #include <iostream>
 #include <sstream> // Pour le parsing des commandes et le formatage
@@ -21,14 +23,18 @@
 #include <cctype> // Pour ::tolower
 #include <string> // Inclure explicitement pour std::to_string si nécessaire selon le compilateur/standard
 #include <cmath> // Pour std::isfinite
+#include <cstring> // Pour std::memcpy
+#include <charconv> // Pour std::from_chars (identifiants de requête, canaux)
+#include <poll.h> // Pour POLLIN/POLLOUT (mode thread)
+#include <filesystem> // Pour le répertoire temporaire (EXPORT TRANSACTIONS)
+#include <unistd.h> // Pour write/unlink
+#include <stdlib.h> // Pour mkstemp
 
 
 // Assurez-vous que l'instance globale de la file est déclarée dans UN SEUL fichier .cpp (souvent Server.cpp)
 
-// Constante pour la fréquence d'appel du bot (légèrement > fréquence de prix)
-const std::chrono::seconds BOT_CALL_INTERVAL(16);
-// Taille du buffer de réception
-const int RECEIVE_BUFFER_SIZE = 1024; // Taille typique pour lire des commandes texte
+// Mode thread : attente maximale sur le socket avant de revider la file d'envoi alimentée par la TQ.
+const int THREAD_MODE_POLL_MS = 10;
 
 
 // Déclaration des méthodes privées pour que le compilateur les connaisse
@@ -36,6 +42,62 @@ const int RECEIVE_BUFFER_SIZE = 1024; // Taille typique pour lire des commandes
 bool submitBotOrder(TradingAction action); // Cette déclaration libre semble incorrecte pour une méthode membre ClientSession
 
 
+// Mots-clés (SHOW WALLET, PIPELINE ON...) : même comparaison que les verbes de la table.
+using CommandTable::equalsIgnoreCase;
+
+// Extrait le préfixe "#<id> " d'une commande en mode pipeline (ou "@<canal> " avec marker '@') et le retire
+// de la vue. Retourne false si le préfixe est absent, non numérique, nul ou non suivi d'un espace.
+static bool extractRequestId(std::string_view& command, uint64_t& requestId, char marker = '#') {
+    size_t start = command.find_first_not_of(" \t");
+    if (start == std::string_view::npos || command[start] != marker) {
+        return false;
+    }
+    const char* first = command.data() + start + 1;
+    const char* last = command.data() + command.size();
+    auto [end, ec] = std::from_chars(first, last, requestId);
+    if (ec != std::errc() || end == first || requestId == 0 || (end != last && *end != ' ' && *end != '\t')) {
+        return false;
+    }
+    command.remove_prefix(static_cast<size_t>(end - command.data()));
+    return true;
+}
+
+// Préfixe chaque ligne d'un message par 'prefix' (réponses multi-lignes comprises).
+static std::string prefixLines(const std::string& message, const std::string& prefix) {
+    std::string tagged;
+    tagged.reserve(message.size() + prefix.size());
+    size_t line_start = 0;
+    while (line_start < message.size()) {
+        size_t line_end = message.find('\n', line_start);
+        size_t next = (line_end == std::string::npos) ? message.size() : line_end + 1;
+        tagged += prefix;
+        tagged.append(message, line_start, next - line_start);
+        line_start = next;
+    }
+    return tagged;
+}
+
+// Préfixe chaque ligne d'une réponse par "#<id> ".
+static std::string withRequestId(const std::string& message, uint64_t requestId) {
+    return prefixLines(message, "#" + std::to_string(requestId) + " ");
+}
+
+// Numéro de canal écrit en tête de commande ("@<n>") ou en argument de CHANNEL : entier de 1 à 2^32-1.
+static bool parseChannelNumber(std::string_view word, uint32_t& channel) {
+    const char* first = word.data();
+    const char* last = word.data() + word.size();
+    auto [end, ec] = std::from_chars(first, last, channel);
+    return ec == std::errc() && end == last && channel != 0;
+}
+
+// Copie en majuscules (pour les symboles/devises transmis aux API qui attendent une std::string).
+static std::string toUpperCopy(std::string_view word) {
+    std::string upper(word);
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+    return upper;
+}
+
+
 // --- Constructeur ---
 ClientSession::ClientSession(const std::string& id, std::shared_ptr<ServerConnection> clientConn, std::shared_ptr<Wallet> wallet)
     // Initialise les membres dans l'ordre de déclaration
@@ -43,7 +105,16 @@ ClientSession::ClientSession(const std::string& id, std::shared_ptr<ServerConnec
       client(clientConn),
       clientWallet(wallet),
       bot(nullptr), // Initialisation du shared_ptr bot à nullptr
-      running(false) // Initialisation du flag running à false
+      running(false), // Initialisation du flag running à false
+      stopped(false),
+      pipelineMode(false),
+      currentRequestId(0),
+      binaryMode(false),
+      lastBotCallTime(std::chrono::system_clock::now()),
+      idleTimeout(0),
+      heartbeatInterval(0),
+      lastActivity(std::chrono::steady_clock::now()),
+      lastPingSent(lastActivity)
 {
     LOG("ClientSession INFO : Initialisation pour client " + clientId, "INFO");
     // L'héritage de enable_shared_from_this est initialisé automatiquement.
@@ -57,11 +128,20 @@ ClientSession::~ClientSession() {
     // Demander l'arrêt et joindre le thread si nécessaire
     stop(); // Appelle la méthode stop(), qui loggue sa propre tentative d'arrêt/join.
 
-    // Sauvegarder le portefeuille à la déconnexion (après que le thread de session ne l'utilise plus)
+    // Sauvegarder le portefeuille à la déconnexion (après que le thread de session ne l'utilise plus).
+    // Le group commit et les règlements d'ordres au repos (settleMakers) peuvent encore l'utiliser : même
+    // verrou et même écriture atomique (fichier temporaire renommé) que le group commit.
     if (clientWallet) {
-        // La méthode saveToFile loggue déjà succès/échec.
-        clientWallet->saveToFile();
-        LOG("ClientSession INFO : Portefeuille sauvegardé pour " + clientId + " avant destruction.", "INFO");
+        bool saved;
+        {
+            std::lock_guard<std::mutex> walletLock(clientWallet->getMutex());
+            saved = clientWallet->saveToFileAtomic(); // Loggue lui-même la cause d'un échec
+        }
+        if (saved) {
+            LOG("ClientSession INFO : Portefeuille sauvegardé pour " + clientId + " avant destruction.", "INFO");
+        } else {
+            LOG("ClientSession ERROR : Échec de la sauvegarde du portefeuille de " + clientId + " avant destruction.", "ERROR");
+        }
     } else {
         LOG("ClientSession WARNING : Wallet null lors de la destruction de la session pour " + clientId + ". Sauvegarde impossible.", "WARNING");
     }
@@ -95,340 +175,1119 @@ void ClientSession::start() {
 }
 
 // --- Demande l'arrêt du thread de session ---
+// Idempotente : le premier appel fait le travail (même si 'running' a déjà été remis à false par QUIT
+// ou par une déconnexion), les suivants sont ignorés.
 void ClientSession::stop() {
-    if (running.load()) {
-        LOG("ClientSession INFO : Attente de la fin du thread de session pour " + clientId, "INFO");
-        running = false; // Signale au thread de s'arrêter
+    if (stopped.exchange(true)) {
+        LOG("ClientSession WARNING : La session " + clientId + " était déjà arrêtée lors de la demande d'arrêt.", "WARNING");
+        return;
+    }
 
-        // Joindre le thread pour attendre sa fin propre
-        if (sessionThread.joinable()) {
-            LOG("ClientSession INFO : Fermeture proactive de la connexion client pour débloquer le thread de session pour " + clientId, "INFO");
+    LOG("ClientSession INFO : Arrêt de la session pour " + clientId, "INFO");
+    running = false; // Signale au thread de s'arrêter
+
+    // Joindre le thread pour attendre sa fin propre (mode thread uniquement : en mode réacteur il n'y a pas de thread dédié)
+    if (sessionThread.joinable()) {
+        if (sessionThread.get_id() == std::this_thread::get_id()) {
+            // stop() appelé depuis le thread de session lui-même : impossible de se joindre soi-même.
+            sessionThread.detach();
+        } else {
+            LOG("ClientSession INFO : Attente de la fin du thread de session pour " + clientId, "INFO");
             sessionThread.join();
             LOG("ClientSession INFO : Thread de session terminé pour " + clientId, "INFO");
         }
+    }
 
-        // Fermer explicitement la connexion réseau APRES que le thread de session ne l'utilise plus
-        if (client && client->isConnected()) { // Vérifier si le client est toujours valide et connecté
-            LOG("ClientSession WARNING : Thread de session non joignable pour " + clientId + " lors de l'arrêt.", "WARNING");
-            client->closeConnection(); // Appeler la méthode de Client.h
-        }
+    // Fermer explicitement la connexion réseau APRES que le thread de session ne l'utilise plus.
+    // Une session de canal ne possède pas la connexion : elle reste ouverte pour les autres comptes.
+    if (channelId == 0 && client && client->isConnected()) { // Vérifier si le client est toujours valide et connecté
+        client->closeConnection(); // Appeler la méthode de Client.h
+    }
+    closeAllChannels();
 
-        // Désenregistrer la session de la TQ APRES que le thread est joint et la connexion fermée
-        // pour éviter que la TQ essaie de notifier une session en cours d'arrêt ou déconnectée.
-        txQueue.unregisterSession(clientId);
-        LOG("ClientSession INFO : Session " + clientId + " désenregistrée de la TQ suite à l'arrêt.", "INFO");
+    // Plus aucun prix proposé à la connexion (déjà fermée pour une session principale).
+    if (priceFeed && !priceSubscriptions.empty()) {
+        priceFeed->unsubscribeAll(client.get());
+        priceSubscriptions.clear();
+    }
 
-    } else {
-        LOG("ClientSession WARNING : La session " + clientId + " n'était pas en cours d'exécution lors de la demande d'arrêt.", "WARNING");
+    // Le canal en mémoire partagée vit avec la session : plus aucun ordre n'est lu après l'arrêt.
+    if (shmGateway && shmChannel) {
+        shmGateway->detach(shmChannel);
+        shmChannel.reset();
     }
 
+    // Désenregistrer la session de la TQ APRES que le thread est joint et la connexion fermée
+    // pour éviter que la TQ essaie de notifier une session en cours d'arrêt ou déconnectée.
+    txQueue.unregisterSession(clientId);
+    LOG("ClientSession INFO : Session " + clientId + " désenregistrée de la TQ suite à l'arrêt.", "INFO");
 }
 
 // --- Boucle principale du thread de session ---
-// Cette méthode est exécutée par le thread 'sessionThread'.
+// Cette méthode est exécutée par le thread 'sessionThread' (mode sans réacteur).
+// Le thread de session est l'unique lecteur ET l'unique écrivain de la connexion : les autres threads
+// (worker de la TQ) déposent leurs messages dans la file d'envoi, vidée à chaque tour de boucle.
 void ClientSession::run() {
     LOG("ClientSession INFO : Thread de session démarré pour client " + clientId, "INFO");
 
-    char read_buffer[RECEIVE_BUFFER_SIZE]; // Buffer pour les données brutes reçues de la connexion.
-    std::string command_buffer; // Buffer pour accumuler les données réseau et extraire les commandes complètes (terminées par '\n').
-    std::chrono::system_clock::time_point last_bot_call_time = std::chrono::system_clock::now(); // Pour le bot (si implémenté).
+    if (client) {
+        client->attachWriter(nullptr); // Pas de réveil nécessaire : la boucle repasse toutes les THREAD_MODE_POLL_MS.
+        // Socket non bloquant : une lecture ne doit pas empêcher l'envoi des messages déposés par la TQ.
+        if (!client->setNonBlocking(true)) {
+            LOG("ClientSession ERROR : Impossible de passer le socket en non bloquant pour client " + clientId + ". Arrêt de la session.", "ERROR");
+            running.store(false);
+        }
+    }
+
+    // Prochaine vérification d'inactivité (immédiate au premier tour, pour calculer l'échéance).
+    std::chrono::steady_clock::time_point next_idle_check = std::chrono::steady_clock::now();
 
     // La boucle principale du thread continue tant que le flag 'running' est true
     // ET que l'objet client (ServerConnection) est valide ET connecté.
     while (running.load() && client && client->isConnected()) {
 
-        // --- 1. Gérer la réception et le buffering des données ---
-        int bytes_received = 0;
+        // --- 1. Réception et traitement des commandes complètes (draine jusqu'à WANT_READ) ---
+        // Inclut les octets déjà lus par receiveLine() pendant l'authentification.
+        bool keep = true;
         try {
-             // Tente de lire des données depuis la connexion.
-             // Cette fonction est bloquante si aucune donnée n'est disponible,
-             // mais elle devrait se débloquer si la connexion est fermée proprement (retourne 0)
-             // ou si une erreur survient (retourne < 0).
-             bytes_received = client->receive(read_buffer, sizeof(read_buffer));
+            keep = onReadable();
         } catch (const std::exception& e) {
-             // Attrape les exceptions lancées par la méthode receive (ex: erreurs SSL).
-             LOG("ClientSession ERROR : Erreur de réception pour client " + clientId + ": " + e.what(), "ERROR");
-             running.store(false); // Signale l'arrêt de la boucle.
-             break; // Sort de la boucle while.
+            LOG("ClientSession ERROR : Erreur de réception pour client " + clientId + ": " + e.what(), "ERROR");
+            keep = false;
         }
 
-        if (bytes_received > 0) {
-            // Des données ont été reçues. Ajouter au buffer d'accumulation.
-            command_buffer.append(read_buffer, bytes_received);
-            // Log le nombre d'octets reçus et la taille actuelle du buffer d'accumulation (DEBUG supprimé).
-
-            // --- Extraire les commandes complètes du buffer (terminées par '\n') ---
-            size_t newline_pos;
-            // Boucle tant qu'un caractère de fin de ligne ('\n') est trouvé dans le buffer.
-            while ((newline_pos = command_buffer.find('\n')) != std::string::npos) {
-                // Extrait la commande complète jusqu'au '\n'.
-                std::string complete_command = command_buffer.substr(0, newline_pos);
-                // Retire la commande extraite et le '\n' du buffer d'accumulation.
-                command_buffer.erase(0, newline_pos + 1);
-
-                processClientCommand(complete_command); // Appelle la logique de traitement de commande
-
-                // Après traitement d'une commande, vérifier si le flag 'running' a été mis à false
-                // (ex: par une commande "QUIT" ou "stop session" gérée dans processClientCommand).
-                if (!running.load()) break; // Si arrêt demandé, sortir de la boucle d'extraction de commandes.
-            }
-             // Les données partielles qui ne forment pas encore une ligne complète restent dans command_buffer.
-
-        } else if (bytes_received == 0) {
-            // receive retourne 0 lorsque le pair (le client) ferme la connexion proprement.
-            LOG("ClientSession INFO : Déconnexion propre détectée pour client " + clientId + ". Socket FD: " + std::to_string(client ? client->getSocketFD() : -1), "INFO");
-            running.store(false); // Signale l'arrêt de la boucle.
-            // La boucle se terminera à la prochaine vérification de la condition while.
-        } else { // bytes_received < 0
-            // receive retourne une valeur négative pour des erreurs SSL (SSL_ERROR_WANT_READ/WRITE, etc.).
-            // ServerConnection::receive loggue déjà le type d'erreur SSL si possible.
-            LOG("ClientSession ERROR : Erreur détectée lors de la réception pour client " + clientId + ". Arrêt de la session. Code retour receive: " + std::to_string(bytes_received), "ERROR");
-            running.store(false); // Signale l'arrêt de la boucle.
-            // La boucle se terminera à la prochaine vérification de la condition while.
-        }
-
-         // Vérifier les conditions d'arrêt après chaque cycle de réception/traitement pour une sortie rapide.
-         if (!running.load() || !client || !client->isConnected()) {
-             break; // Sort de la boucle while principale.
-         }
-
+        // --- 2. Envoi des réponses et des notifications en file (regroupées) ---
+        // Même si la session se termine (ex: QUIT), les réponses déjà produites doivent partir.
+        ServerConnection::FlushResult flushed = client->flushOutbound();
+        if (!keep || flushed == ServerConnection::FlushResult::FAILED) {
+            running.store(false);
+            break;
+        }
 
-        // --- 2. Gérer l'appel périodique au bot et la soumission de ses ordres ---
-        // Cette section ne sera exécutée que si le bot est associé à cette session (non null).
-        if (bot) {
-            auto now = std::chrono::system_clock::now();
-            // Vérifier si l'intervalle d'appel du bot est écoulé.
-            if (now - last_bot_call_time >= BOT_CALL_INTERVAL) {
-                // LOG("ClientSession DEBUG : Appel de la logique du bot pour " + clientId, "DEBUG"); // Supprimé (DEBUG)
-                // Appeler la méthode du bot pour qu'il prenne une décision.
-                TradingAction bot_action = bot->processLatestPrice();
-
-                // --- Traduire la décision du bot en ordre et soumettre à la TQ ---
-                if (bot_action != TradingAction::HOLD && bot_action != TradingAction::UNKNOWN) {
-                    LOG("ClientSession INFO : Bot " + clientId + " a décidé l'action: " + (bot_action == TradingAction::BUY ? "BUY" : (bot_action == TradingAction::CLOSE_LONG ? "CLOSE_LONG" : "AUTRE")), "INFO");
-                    // submitBotOrder gère le calcul de quantité, la création de requête et la soumission TQ
-                    submitBotOrder(bot_action);
-                } else {
-                    // Log si le bot a décidé de ne rien faire (commenté par défaut pour éviter spam log).
-                }
+        // --- 3. Gérer l'appel périodique au bot et la soumission de ses ordres ---
+        if (!onTick()) {
+            break;
+        }
 
-                last_bot_call_time = now; // Mettre à jour le temps du dernier appel au bot.
+        // --- 3b. Inactivité du client (fermeture) et heartbeats ---
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next_idle_check) {
+            IdleCheck idle = checkIdle(now);
+            if (idle.expired) {
+                running.store(false);
+                break;
             }
+            next_idle_check = idle.nextCheck.count() > 0 ? now + idle.nextCheck : std::chrono::steady_clock::time_point::max();
         }
 
-        // --- 3. Gestion de la pause ---
-        // Un petit sleep pour éviter une boucle très active (utilisant 100% CPU) si receive n'est pas bloquant
-        // ou s'il n'y a rien à recevoir ou à traiter (bot inactif, pas de commandes).
-        // Essentiel si receive est non bloquant ou a un timeout très court.
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        // --- 4. Attente : données à lire, place pour écrire (si le pair est lent), ou délai écoulé ---
+        client->waitForSocket(flushed == ServerConnection::FlushResult::WOULD_BLOCK ? (POLLIN | POLLOUT) : POLLIN, THREAD_MODE_POLL_MS);
     } // Fin de la boucle while (condition running || client valide/connecté devient fausse)
 
     // Ce log est exécuté juste après la sortie de la boucle while.
     LOG("ClientSession INFO : Sortie de la boucle de session pour client " + clientId + ". Raison: running=" + std::to_string(running.load()) + ", client_connected=" + std::to_string(client ? client->isConnected() : false), "INFO");
+    // Fermer la connexion dès la fin de la boucle (QUIT, inactivité) : le pair voit la fermeture
+    // immédiatement et la session n'est plus considérée comme connectée (reconnexion possible).
+    if (client && client->isConnected()) {
+        client->closeConnection();
+    }
     // La destruction de l'objet ClientSession (quand le shared_ptr n'est plus référencé) appellera ~ClientSession()
     // qui appellera stop() pour la fin propre.
 }
 
 
-// --- Traite une commande reçue du client (string complète) ---
-// Appelée par ClientSession::run() quand une commande complète (terminée par '\n') est extraite du buffer.
-void ClientSession::processClientCommand(const std::string& command) {
-    LOG("ClientSession INFO : Début traitement commande pour client " + clientId + " : '" + command + "'", "INFO");
-
-    std::stringstream ss(command);
-    std::string base_command;
-    ss >> base_command;
-
-    std::transform(base_command.begin(), base_command.end(), base_command.begin(), ::toupper);
-
-    std::string response_message = "";
-
-    // --- Parsing et Dispatch ---
-    if (base_command == "QUIT") {
-        LOG("ClientSession INFO : Commande QUIT reçue pour client " + clientId + ". Signalement de l'arrêt de la session.", "INFO");
-        running.store(false);
-        response_message = "OK: Disconnecting.\n";
-
-    } else if (base_command == "SHOW") {
-        std::string target;
-        ss >> target;
-        std::transform(target.begin(), target.end(), target.begin(), ::toupper);
-
-        if (target == "WALLET") {
-             LOG("ClientSession INFO : Commande SHOW WALLET reçue pour client " + clientId, "INFO");
-             std::shared_ptr<Wallet> wallet = getClientWallet();
-
-             if (wallet) {
-                 double usd_balance = wallet->getBalance(Currency::USD);
-                 double srd_btc_balance = wallet->getBalance(Currency::SRD_BTC);
-
-                 std::stringstream response_ss;
-                 response_ss << std::fixed << std::setprecision(10)
-                             << "BALANCE USD: " << usd_balance
-                             << ", SRD-BTC: " << srd_btc_balance
-                             << "\n";
-                 response_message = response_ss.str();
-
-             } else {
-                 LOG("ClientSession ERROR : Portefeuille (Wallet) non disponible pour client " + clientId + " lors de la commande SHOW WALLET.", "ERROR");
-                 response_message = "ERROR: Internal server error (Wallet not available).\n";
-             }
+// --- Extraction des commandes complètes du buffer de réception ---
+// Les lignes sont des vues sur le buffer circulaire de la connexion : aucune copie ni allocation par commande.
+bool ClientSession::drainCommands() {
+    LineFramer& framer = client->getInputFramer();
+    std::string_view line;
+    // Après chaque commande, vérifier si le flag 'running' a été mis à false (ex: "QUIT").
+    while (running.load()) {
+        // Protocole binaire : trames de taille annoncée dans l'en-tête, lues dans le même buffer circulaire.
+        if (binaryMode.load()) {
+            BinaryProtocol::FrameHeader header;
+            std::string_view body;
+            BinaryProtocol::DecodeStatus frame_status = BinaryProtocol::nextFrame(framer, header, body);
+            if (frame_status == BinaryProtocol::DecodeStatus::NEED_MORE) {
+                break;
+            }
+            if (frame_status == BinaryProtocol::DecodeStatus::INVALID) {
+                LOG("ClientSession WARNING : En-tête de trame binaire invalide (version " + std::to_string(header.version) + ", taille " + std::to_string(header.length) + ") reçu de client " + clientId + ". Fermeture de la session.", "WARNING");
+                return false;
+            }
+            processBinaryFrame(header, body);
+            continue;
+        }
+
+        LineFramer::Status status = framer.nextLine(line);
+        if (status == LineFramer::Status::NEED_MORE) {
+            break; // Les données partielles restent dans le buffer circulaire.
+        }
+        if (status == LineFramer::Status::LINE_TOO_LONG) {
+            LOG("ClientSession WARNING : Ligne de commande trop longue (> " + std::to_string(framer.maxLineLength()) + " octets) reçue de client " + clientId + ". Fermeture de la session.", "WARNING");
+            client->send("ERROR: Command line too long. Connection closing.\n");
+            return false;
+        }
+        processClientCommand(line); // Appelle la logique de traitement de commande
+    }
+    return true;
+}
+
+// --- Envoi d'une réponse à la commande en cours ---
+// En mode pipeline, chaque ligne est préfixée par l'identifiant de la commande en cours de traitement.
+void ClientSession::reply(const std::string& message) {
+    if (!client || !client->isConnected()) {
+        return;
+    }
+    if (binaryMode.load()) {
+        // Protocole binaire : le texte part dans une trame ERROR_TEXT ou TEXT portant l'identifiant de la requête.
+        std::string_view text(message);
+        if (!text.empty() && text.back() == '\n') {
+            text.remove_suffix(1);
+        }
+        std::string frame;
+        bool is_error = text.compare(0, 5, "ERROR") == 0;
+        BinaryProtocol::encodeText(frame, is_error ? BinaryProtocol::MessageType::ERROR_TEXT : BinaryProtocol::MessageType::TEXT, currentRequestId, text);
+        client->send(frame);
+        return;
+    }
+    client->send(onChannel(currentRequestId ? withRequestId(message, currentRequestId) : message));
+}
 
-        } else if (target == "TRANSACTIONS") {
-             LOG("ClientSession INFO : Commande SHOW TRANSACTIONS reçue pour client " + clientId, "INFO");
+// --- Canaux multiplexés ---
+std::string ClientSession::onChannel(std::string message) const {
+    return channelPrefix.empty() ? message : prefixLines(message, channelPrefix);
+}
 
-             std::shared_ptr<Wallet> wallet = getClientWallet();
+void ClientSession::setChannelHost(Server* server, size_t maxChannelCount) {
+    channelHost = server;
+    maxChannels = maxChannelCount;
+}
 
-             if (wallet) {
-                  std::vector<Transaction> history = wallet->getTransactionHistory();
-                  int display_count = 10;
-                  int start_index = std::max(0, (int)history.size() - display_count);
+void ClientSession::startAsChannel(uint32_t channel) {
+    channelId = channel;
+    channelPrefix = "@" + std::to_string(channel) + " ";
+    running.store(true);
+    LOG("ClientSession INFO : Session pour client " + clientId + " démarrée comme canal " + std::to_string(channel) + " (connexion partagée, socket FD: " + std::to_string(client ? client->getSocketFD() : -1) + ").", "INFO");
+}
 
-                  std::stringstream resp_ss;
-                  resp_ss << "TRANSACTION_HISTORY (Total: " << history.size() << ", Showing last " << (history.size() - start_index) << "):\n";
-                  for (size_t i = start_index; i < history.size(); ++i) {
-                      // Assurez-vous que Transaction::getDescription() existe
-                      resp_ss << "- " << history[i].getDescription() << "\n";
-                  }
-                  response_message = resp_ss.str();
+uint32_t ClientSession::getChannelId() const { return channelId; }
 
-             } else {
-                  LOG("ClientSession ERROR : Portefeuille (Wallet) non disponible pour client " + clientId + " lors de la commande SHOW TRANSACTIONS.", "ERROR");
-                  response_message = "ERROR: Internal server error (Wallet not available).\n";
-             }
+void ClientSession::dispatchToChannel(uint32_t channel, std::string_view command) {
+    auto it = channels.find(channel);
+    if (it == channels.end()) {
+        client->send("@" + std::to_string(channel) + " ERROR: Unknown channel. Use CHANNEL OPEN <n> <ID> <password> first.\n");
+        return;
+    }
+    std::shared_ptr<ClientSession> session = it->second;
+    session->processClientCommand(command);
+    if (!session->running.load()) {
+        // QUIT sur le canal : seule sa session se termine.
+        channels.erase(channel);
+        channelHost->CloseChannelSession(session);
+    }
+}
 
+void ClientSession::handleChannelCommand(std::string_view action, std::string_view number, std::string_view userId, std::string_view password) {
+    uint32_t channel = 0;
+    if (!parseChannelNumber(number, channel)) {
+        reply("ERROR: Invalid channel number. Usage: CHANNEL OPEN <n> <ID> <password> | CHANNEL CLOSE <n> (n > 0).\n");
+        return;
+    }
+    const std::string prefix = "@" + std::to_string(channel) + " ";
+
+    if (equalsIgnoreCase(action, "OPEN")) {
+        if (channels.count(channel)) {
+            client->send(prefix + "ERROR: Channel already open.\n");
+        } else if (channels.size() >= maxChannels) {
+            client->send(prefix + "ERROR: Too many channels on this connection (max " + std::to_string(maxChannels) + ").\n");
+        } else if (userId.empty()) {
+            client->send(prefix + "ERROR: Missing ID. Usage: CHANNEL OPEN <n> <ID> <password>.\n");
         } else {
-             LOG("ClientSession WARNING : Cible inconnue pour SHOW reçue pour client " + clientId + " : '" + command + "'", "WARNING");
-             response_message = "ERROR: Unknown SHOW target. Use SHOW WALLET or SHOW TRANSACTIONS.\n";
+            AuthOutcome outcome = AuthOutcome::FAIL;
+            std::string error;
+            std::shared_ptr<ClientSession> session = channelHost->OpenChannelSession(client, channel, std::string(userId), std::string(password), outcome, error);
+            if (session) {
+                channels[channel] = session;
+                client->send(prefix + (outcome == AuthOutcome::NEW ? "AUTH NEW\n" : "AUTH SUCCESS\n"));
+            } else {
+                client->send(prefix + error + "\n");
+            }
         }
+    } else if (equalsIgnoreCase(action, "CLOSE")) {
+        auto it = channels.find(channel);
+        if (it == channels.end()) {
+            client->send(prefix + "ERROR: Unknown channel.\n");
+        } else {
+            std::shared_ptr<ClientSession> session = std::move(it->second);
+            channels.erase(it);
+            channelHost->CloseChannelSession(session);
+            client->send(prefix + "OK: Channel closed.\n");
+        }
+    } else {
+        reply("ERROR: Invalid CHANNEL command. Usage: CHANNEL OPEN <n> <ID> <password> | CHANNEL CLOSE <n>.\n");
+    }
+}
 
-    } else if (base_command == "GET_PRICE") {
-         std::string symbol;
-         ss >> symbol;
-         std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::toupper);
-
-         if (!symbol.empty()) {
-              double price = Global::getPrice(symbol);
-              if (price > 0 && std::isfinite(price)) {
-                   std::stringstream resp_ss;
-                   resp_ss << "PRICE " << symbol << " " << std::fixed << std::setprecision(8) << price << "\n";
-                   response_message = resp_ss.str();
-              } else {
-                    LOG("ClientSession ERROR : Prix invalide (" + std::to_string(price) + ") obtenu de Global pour symbole " + symbol + " pour client " + clientId, "ERROR");
-                    response_message = "ERROR: Could not retrieve valid price for " + symbol + ".\n";
-              }
-         } else {
-              LOG("ClientSession WARNING : Symbole manquant pour commande GET_PRICE pour client " + clientId, "WARNING");
-              response_message = "ERROR: Missing symbol for GET_PRICE. Use GET_PRICE <symbol>.\n";
-         }
+void ClientSession::closeAllChannels() {
+    if (channels.empty()) {
+        return;
+    }
+    LOG("ClientSession INFO : Fermeture de " + std::to_string(channels.size()) + " canal(aux) de la connexion de client " + clientId + ".", "INFO");
+    auto open_channels = std::move(channels);
+    channels.clear();
+    for (auto& [channel, session] : open_channels) {
+        if (channelHost) {
+            channelHost->CloseChannelSession(session);
+        } else {
+            session->stop();
+        }
+    }
+}
 
-    // ========================================================================
-    // === Bloc de commandes BUY/SELL/START BOT/STOP BOT ===
-    // ========================================================================
-    } else if (base_command == "BUY" || base_command == "SELL") {
-         if (bot) {
-             LOG("ClientSession WARNING : Refus commande manuelle " + base_command + " de client " + clientId + " : Bot actif.", "WARNING");
-             response_message = "ERROR: Manual trading (" + base_command + ") is disabled while the bot is active. Please stop the bot first.\n";
-         } else {
-             std::string currency_str;
-             double percentage = 0.0;
-             ss >> currency_str >> percentage;
-             std::transform(currency_str.begin(), currency_str.end(), currency_str.begin(), ::toupper);
+// --- Historique des transactions (SHOW TRANSACTIONS, texte et binaire) ---
+constexpr size_t DEFAULT_HISTORY_LIMIT = 10;       // SHOW TRANSACTIONS sans limite
+constexpr size_t MAX_HISTORY_LIMIT = 1000;         // Borne d'une page (taille de la réponse, durée du verrou)
+constexpr size_t HISTORY_CHUNK_BYTES = 16 * 1024;  // Taille visée des blocs envoyés
+
+// Formate une page d'historique, une ligne "- <description>" par transaction, directement depuis le
+// portefeuille (sans copier l'historique) en blocs d'environ HISTORY_CHUNK_BYTES ; l'en-tête est placé en
+// tête du premier bloc. Sans pagination ('paged' faux), l'en-tête reste celui d'origine ("Showing last N").
+// Retourne false si le curseur 'beforeId' est inconnu.
+static bool formatTransactionPage(const Wallet& wallet, size_t limit, const std::string& beforeId, bool paged,
+                                  std::vector<std::string>& chunks) {
+    chunks.assign(1, std::string());
+    Wallet::TransactionPage page = wallet.visitTransactionPage(limit, beforeId, [&](const Transaction& tx) {
+        if (chunks.back().size() >= HISTORY_CHUNK_BYTES) {
+            chunks.emplace_back();
+        }
+        chunks.back() += "- ";
+        chunks.back() += tx.getDescription();
+        chunks.back() += '\n';
+    });
+    if (!page.cursorFound) {
+        return false;
+    }
 
-             Currency trade_currency = stringToCurrency(currency_str);
+    std::string header = "TRANSACTION_HISTORY (Total: " + std::to_string(page.total);
+    if (paged) {
+        header += ", Showing " + std::to_string(page.count) + ", Next: " + (page.nextCursor.empty() ? std::string("none") : "before=" + page.nextCursor) + "):\n";
+    } else {
+        header += ", Showing last " + std::to_string(page.count) + "):\n";
+    }
+    chunks.front().insert(0, header);
+    return true;
+}
 
-             if (trade_currency != Currency::UNKNOWN && percentage > 0.0 && percentage <= 100.0 && ss && !ss.fail()) {
-                  RequestType req_type = (base_command == "BUY") ? RequestType::BUY : RequestType::SELL;
+// --- Export de l'historique complet (EXPORT TRANSACTIONS) ---
+// Écrit l'historique au format CSV dans un fichier temporaire anonyme (supprimé du répertoire dès sa
+// création) et retourne son descripteur, ou -1. Le contenu reste dans le cache de pages : la connexion
+// l'envoie par SSL_sendfile (kTLS) ou par blocs, sans le garder en file d'envoi.
+static int writeTransactionExport(const std::vector<Transaction>& history, size_t& size, size_t& lines) {
+    std::string path = (std::filesystem::temp_directory_path() / "ppn_export_XXXXXX").string();
+    int fd = mkstemp(&path[0]);
+    if (fd < 0) {
+        LOG("ClientSession ERROR : Impossible de créer le fichier temporaire d'export : " + std::string(strerror(errno)), "ERROR");
+        return -1;
+    }
+    unlink(path.c_str());
 
-                  handleClientTradeRequest(req_type, currency_str, percentage);
+    std::string content = Transaction::csvHeader();
+    for (const Transaction& tx : history) {
+        content += tx.toCSVLine();
+    }
+    size_t written = 0;
+    while (written < content.size()) {
+        ssize_t n = write(fd, content.data() + written, content.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            LOG("ClientSession ERROR : Écriture du fichier d'export impossible : " + std::string(strerror(errno)), "ERROR");
+            close(fd);
+            return -1;
+        }
+        written += static_cast<size_t>(n);
+    }
+    size = content.size();
+    lines = history.size() + 1;
+    return fd;
+}
 
-                  LOG("ClientSession INFO : Requête de trading manuelle (" + base_command + " " + currencyToString(trade_currency) + " " + std::to_string(percentage) + "%) reçue pour client " + clientId + ". Soumission à la TQ via handleClientTradeRequest.", "INFO");
-                  response_message = "OK: Your " + base_command + " request has been submitted for processing.\n";
+// --- Traite une trame du protocole binaire ---
+// Équivalent binaire de processClientCommand : les champs sont lus à position fixe dans le corps de la
+// trame (pas de découpage en mots ni de conversion texte -> nombre). Chaque requête reçoit exactement une
+// réponse portant son identifiant ; un BUY/SELL accepté reçoit en plus un TRANSACTION_RESULT.
+void ClientSession::processBinaryFrame(const BinaryProtocol::FrameHeader& header, std::string_view body) {
+    using namespace BinaryProtocol;
+    currentRequestId = header.requestId;
+    std::string frame; // Réponse à taille fixe (les réponses texte passent par reply())
+
+    switch (header.type) {
+        case MessageType::BUY:
+        case MessageType::SELL: {
+            const std::string verb = (header.type == MessageType::BUY) ? "BUY" : "SELL";
+            OrderBody order;
+            if (!decodeOrder(body, order)) {
+                reply("ERROR: Malformed " + verb + " frame.\n");
+                break;
+            }
+            if (bot) {
+                reply("ERROR: Manual trading (" + verb + ") is disabled while the bot is active. Please stop the bot first.\n");
+                break;
+            }
+            std::string currency_str = toUpperCopy(fieldView(order.symbol, SYMBOL_SIZE));
+            if (stringToCurrency(currency_str) == Currency::UNKNOWN || !(order.percentage > 0.0 && order.percentage <= 100.0)) {
+                reply("ERROR: Invalid syntax or value for " + verb + ". Use " + verb + " <Currency> <Percentage (1-100)>.\n");
+                break;
+            }
+            RequestType req_type = (header.type == MessageType::BUY) ? RequestType::BUY : RequestType::SELL;
+            // En cas d'échec, handleClientTradeRequest a déjà répondu (trame ERROR_TEXT).
+            if (handleClientTradeRequest(req_type, currency_str, order.percentage)) {
+                encodeAck(frame, currentRequestId);
+            }
+            break;
+        }
 
-             } else {
-                 LOG("ClientSession WARNING : Syntaxe/valeurs invalides pour commande " + base_command + " de client " + clientId + ": '" + command + "'. Arguments: Devise='" + currency_str + "', Pourcentage=" + std::to_string(percentage) + ".", "WARNING");
-                 response_message = "ERROR: Invalid syntax or value for " + base_command + ". Use " + base_command + " <Currency> <Percentage (1-100)>.\n";
-             }
-         }
+        case MessageType::GET_PRICE: {
+            SymbolBody symbol_body;
+            if (!decodeSymbol(body, symbol_body)) {
+                reply("ERROR: Malformed GET_PRICE frame.\n");
+                break;
+            }
+            std::string symbol = toUpperCopy(fieldView(symbol_body.symbol, SYMBOL_SIZE));
+            double price = Global::getPrice(symbol);
+            if (price > 0 && std::isfinite(price)) {
+                encodePrice(frame, currentRequestId, symbol, price);
+            } else {
+                reply("ERROR: Could not retrieve valid price for " + symbol + ".\n");
+            }
+            break;
+        }
 
-        } else if (base_command == "START") {
-            std::string bot_keyword;
-            ss >> bot_keyword;
-            if (bot_keyword == "BOT") { // C'est bien "START BOT"
-                double bollingerK;
-                // Tenter de lire le paramètre BollingerK (un double)
-                if (ss >> bollingerK) {
-                    // --- Vérifier s'il y a des paramètres non attendus après K ---
-                    std::string remaining;
-                    ss >> remaining; // Tente de lire quelque chose d'autre après le double
-                    if (!remaining.empty()) { // S'il reste du texte après le nombre (ex: START BOT 2.0 texte)
-                        response_message = "ERROR: Invalid command format for START BOT. Usage: START BOT <BollingerK>.\n";
-                        LOG("Server WARNING : Commande START BOT avec texte en trop après K de client " + clientId + ". Commande: '" + command + "'", "WARNING");
-                    }
-                    else {
-                        // --- Paramètre K lu avec succès et pas de texte en trop ! ---
-                        // Appeler la méthode startBot avec le paramètre K.
-                        // La période Bollinger (20) est gérée à l'intérieur de ClientSession::startBot.
-                        startBot(bollingerK); // Appel de startBot
-                        LOG("Server INFO : Commande START BOT reçue et parsée avec K=" + std::to_string(bollingerK) + " pour client " + clientId, "INFO");
-                        // La méthode startBot envoie elle-même le message de confirmation ("BOT STARTED...").
-                        // response_message est vide ici si startBot réussit (startBot envoie la réponse OK).
-                    }
-                } else {
-                    // Le paramètre K n'est pas un nombre valide ou est manquant
-                    response_message = "ERROR: Invalid or missing BollingerK value. Usage: START BOT <BollingerK> (e.g., 2.0).\n";
-                    LOG("Server WARNING : Commande START BOT avec paramètre K invalide (pas un nombre ou manquant) de client " + clientId + ". Commande: '" + command + "'", "WARNING");
+        case MessageType::SHOW: {
+            ShowBody show;
+            std::shared_ptr<Wallet> wallet = getClientWallet();
+            if (!decodeShow(body, show)) {
+                reply("ERROR: Malformed SHOW frame.\n");
+            } else if (!wallet) {
+                LOG("ClientSession ERROR : Portefeuille (Wallet) non disponible pour client " + clientId + " lors d'une requête SHOW binaire.", "ERROR");
+                reply("ERROR: Internal server error (Wallet not available).\n");
+            } else if (show.target == ShowTarget::WALLET) {
+                encodeWallet(frame, currentRequestId, wallet->getBalance(Currency::USD), wallet->getBalance(Currency::SRD_BTC));
+            } else if (show.target == ShowTarget::TRANSACTIONS) {
+                std::vector<std::string> chunks;
+                formatTransactionPage(*wallet, DEFAULT_HISTORY_LIMIT, std::string(), false, chunks);
+                std::string text;
+                for (const std::string& chunk : chunks) {
+                    text += chunk; // Une seule trame TEXT par requête
                 }
+                reply(text);
             } else {
-                // Juste "START" sans "BOT" ou avec un autre mot
-                response_message = "ERROR: Unknown START command target '" + bot_keyword + "'. Available: START BOT <BollingerK>.\n";
-                 LOG("Server WARNING : Commande START inconnue de client " + clientId + ". Commande: '" + command + "'", "WARNING");
+                reply("ERROR: Unknown SHOW target.\n");
             }
-        } else if (base_command == "STOP") {
-             std::string bot_keyword;
-             ss >> bot_keyword;
-             std::transform(bot_keyword.begin(), bot_keyword.end(), bot_keyword.begin(), ::toupper);
-
-             if (bot_keyword == "BOT") { // C'est bien "STOP BOT"
-                 // Vérifier s'il y a des paramètres inattendus
-                 std::string remaining;
-                 ss >> remaining;
-                 if (!remaining.empty()) {
-                      response_message = "ERROR: Invalid command format for STOP BOT. Usage: STOP BOT.\n";
-                      LOG("Server WARNING : Commande STOP BOT avec texte en trop de client " + clientId + ". Commande: '" + command + "'", "WARNING");
-                 } else {
-                     // Commande valide "STOP BOT"
-                     stopBot(); // Appel de stopBot
-                     LOG("Server INFO : Commande STOP BOT reçue et parsée pour client " + clientId, "INFO");
-                     // La méthode stopBot envoie elle-même le message de confirmation ("BOT STOPPED.").
-                     // response_message est vide ici si stopBot réussit (stopBot envoie la réponse OK).
-                 }
-             } else {
-                  // Juste "STOP" sans "BOT" ou avec un autre mot
-                  response_message = "ERROR: Unknown STOP command target '" + bot_keyword + "'. Available: STOP BOT.\n";
-                  LOG("Server WARNING : Commande STOP inconnue de client " + clientId + ". Commande: '" + command + "'", "WARNING");
-             }
+            break;
+        }
+
+        case MessageType::QUIT:
+            LOG("ClientSession INFO : Requête QUIT (binaire) reçue pour client " + clientId + ". Signalement de l'arrêt de la session.", "INFO");
+            running.store(false);
+            encodeAck(frame, currentRequestId);
+            break;
+
+        case MessageType::PING:
+            encodeHeartbeat(frame, MessageType::PONG, currentRequestId);
+            break;
 
-    // ========================================================================
-    // === Fin du bloc de commandes BUY/SELL/START BOT/STOP BOT ===
-    // ========================================================================
+        case MessageType::PONG:
+            break; // Réponse à notre PING : la réception a déjà compté comme activité.
 
-    } else { // Gérer les commandes inconnues
-        LOG("ClientSession WARNING : Commande inconnue reçue pour client " + clientId + " : '" + command + "'", "WARNING");
-        response_message = "ERROR: Unknown command '" + command + "'. Use SHOW WALLET, SHOW TRANSACTIONS, GET_PRICE <symbol>, BUY/SELL <Currency> <Percentage>, START BOT <BollingerK>, STOP BOT, or QUIT.\n";
+        default:
+            LOG("ClientSession WARNING : Type de trame binaire inconnu (" + std::to_string(static_cast<int>(header.type)) + ") reçu de client " + clientId + ".", "WARNING");
+            reply("ERROR: Unknown binary message type.\n");
+            break;
     }
 
+    if (!frame.empty() && client && client->isConnected()) {
+        client->send(frame);
+    }
+}
+
+// --- Appel périodique au bot (mode thread) ---
+bool ClientSession::onTick() {
+    // Vérifier si l'intervalle d'appel du bot est écoulé (le sien ou celui d'un canal).
+    if ((bot || !channels.empty()) && std::chrono::system_clock::now() - lastBotCallTime >= BOT_CALL_INTERVAL) {
+        return onBotTimer();
+    }
+    return running.load() && client && client->isConnected();
+}
+
+// --- Appel du bot (échéance de son intervalle) ---
+bool ClientSession::onBotTimer() {
+    // Cette section ne sera exécutée que si le bot est associé à cette session (non null).
+    if (bot) {
+        // Appeler la méthode du bot pour qu'il prenne une décision.
+        TradingAction bot_action = bot->processLatestPrice();
+
+        // --- Traduire la décision du bot en ordre et soumettre à la TQ ---
+        if (bot_action != TradingAction::HOLD && bot_action != TradingAction::UNKNOWN) {
+            LOG("ClientSession INFO : Bot " + clientId + " a décidé l'action: " + (bot_action == TradingAction::BUY ? "BUY" : (bot_action == TradingAction::CLOSE_LONG ? "CLOSE_LONG" : "AUTRE")), "INFO");
+            // submitBotOrder gère le calcul de quantité, la création de requête et la soumission TQ
+            submitBotOrder(bot_action);
+        }
+
+        lastBotCallTime = std::chrono::system_clock::now(); // Mettre à jour le temps du dernier appel au bot.
+    }
+    // Les canaux n'ont pas de timer propre : leurs bots suivent celui de la session principale.
+    for (auto& [channel, session] : channels) {
+        session->onBotTimer();
+    }
+    if (!channels.empty()) {
+        lastBotCallTime = std::chrono::system_clock::now();
+    }
+    return running.load() && client && client->isConnected();
+}
+
+// --- Politique d'inactivité ---
+void ClientSession::setIdlePolicy(std::chrono::milliseconds idle, std::chrono::milliseconds heartbeat) {
+    idleTimeout = std::max(idle, std::chrono::milliseconds(0));
+    heartbeatInterval = std::max(heartbeat, std::chrono::milliseconds(0));
+}
+
+// --- Passerelle en mémoire partagée ---
+void ClientSession::setShmGateway(ShmGateway* gateway) {
+    shmGateway = gateway;
+}
+
+void ClientSession::setPriceFeed(PriceFeed* feed) {
+    priceFeed = feed;
+}
+
+// --- Vérification d'inactivité ---
+// Une seule échéance par session couvre les deux délais : la prochaine vérification est la plus proche
+// entre l'expiration d'inactivité et le prochain PING.
+ClientSession::IdleCheck ClientSession::checkIdle(std::chrono::steady_clock::time_point now) {
+    using std::chrono::milliseconds;
+    IdleCheck check;
+    if (!running.load() || !client || !client->isConnected()) {
+        check.expired = true;
+        return check;
+    }
+
+    milliseconds idle = std::chrono::duration_cast<milliseconds>(now - lastActivity);
+    if (idleTimeout.count() > 0 && idle >= idleTimeout) {
+        LOG("ClientSession WARNING : Aucune activité du client " + clientId + " depuis " + std::to_string(idle.count() / 1000) + " s. Fermeture de la session.", "WARNING");
+        check.expired = true;
+        return check;
+    }
+
+    milliseconds next = milliseconds::max();
+    if (idleTimeout.count() > 0) {
+        next = idleTimeout - idle;
+    }
+    if (heartbeatInterval.count() > 0) {
+        // Dernier échange : activité du client, ou PING déjà envoyé depuis (un PING par intervalle).
+        auto reference = std::max(lastActivity, lastPingSent);
+        if (now - reference >= heartbeatInterval) {
+            sendHeartbeat();
+            lastPingSent = now;
+            reference = now;
+        }
+        next = std::min(next, heartbeatInterval - std::chrono::duration_cast<milliseconds>(now - reference));
+    }
+    if (next != milliseconds::max()) {
+        check.nextCheck = std::max(next, milliseconds(1));
+    }
+    return check;
+}
+
+void ClientSession::sendHeartbeat() {
+    if (!client || !client->isConnected()) {
+        return;
+    }
+    if (binaryMode.load()) {
+        std::string frame;
+        BinaryProtocol::encodeHeartbeat(frame, BinaryProtocol::MessageType::PING, 0);
+        client->send(frame);
+    } else {
+        client->send("PING\n");
+    }
+}
+
+// --- Mode réacteur : préparation de la session ---
+bool ClientSession::startInReactor() {
+    if (running.load() || !client || !client->isConnected()) {
+        LOG("ClientSession WARNING : Impossible de démarrer la session (mode réacteur) pour client " + clientId + " (déjà en cours ou client déconnecté)", "WARNING");
+        return false;
+    }
+    if (!client->setNonBlocking(true)) {
+        LOG("ClientSession ERROR : Impossible de passer le socket en non bloquant pour client " + clientId, "ERROR");
+        return false;
+    }
+    // Dès maintenant, plus aucun thread n'écrit directement sur la connexion : les messages attendent
+    // dans la file que le thread d'E/S (qui attachera son propre réveil) les envoie.
+    client->attachWriter(nullptr);
+    running.store(true);
+    LOG("ClientSession INFO : Session pour client " + clientId + " confiée au réacteur (pas de thread dédié).", "INFO");
+    return true;
+}
+
+// --- Socket lisible (mode réacteur, et à chaque tour de run() en mode thread) ---
+// Exécutée uniquement par le thread propriétaire de la session : les lectures sont donc sérialisées.
+bool ClientSession::onReadable() {
+    if (!running.load() || !client || !client->isConnected()) {
+        return false;
+    }
+
+    // Commandes déjà présentes dans le buffer (ex: reçues avec la ligne d'authentification).
+    if (!drainCommands()) {
+        return false;
+    }
+
+    // Drainer la connexion jusqu'à WANT_READ : en non bloquant, receive() retourne 0
+    // sans marquer la connexion fermée quand il n'y a plus rien à lire pour l'instant.
+    while (running.load() && client->isConnected()) {
+        int bytes_received = client->receiveIntoFramer();
+        if (bytes_received > 0) {
+            lastActivity = std::chrono::steady_clock::now();
+            if (!drainCommands()) {
+                return false;
+            }
+        } else {
+            break; // WANT_READ (connexion toujours active) ou fermeture/erreur (connexion marquée fermée).
+        }
+    }
+
+    if (client->isConnected() && running.load()) {
+        return true;
+    }
+    LOG("ClientSession INFO : Fin de session détectée pour client " + clientId + ". Raison: running=" + std::to_string(running.load()) + ", client_connected=" + std::to_string(client->isConnected()), "INFO");
+    return false;
+}
+
+
+// --- Traite une commande reçue du client (string complète) ---
+// Appelée par ClientSession::run() quand une commande complète (terminée par '\n') est extraite du buffer.
+// --- Commande texte en cours de traitement ---
+// Mots restants et effets à appliquer après la réponse, partagés entre processClientCommand et le traitement du verbe.
+struct ClientSession::CommandContext {
+    std::string_view command;    // Commande complète (sans identifiant de pipeline), pour les logs et messages d'erreur
+    std::string_view verb;       // Premier mot tel que reçu
+    CommandTokens tokens;        // Positionné après le verbe
+    std::string response;        // Réponse envoyée par processClientCommand (vide : rien à envoyer)
+    bool switchToBinary = false; // "BINARY ON" : bascule APRÈS l'envoi de l'accusé texte
+    int exportFd = -1;           // EXPORT TRANSACTIONS : fichier envoyé juste après l'en-tête
+    size_t exportSize = 0;
+    std::vector<int> shmFds;     // SHM ATTACH : descripteurs joints à la réponse
+
+    CommandContext(std::string_view cmd, std::string_view first, CommandTokens rest)
+        : command(cmd), verb(first), tokens(rest) {}
+};
+
+// Traitement de chaque verbe, indexé par CommandVerb (même ordre que l'énumération, UNKNOWN en dernier).
+const ClientSession::CommandHandler ClientSession::commandHandlers[] = {
+    &ClientSession::handleQuit,      // QUIT
+    &ClientSession::handleShow,      // SHOW
+    &ClientSession::handleExport,    // EXPORT
+    &ClientSession::handleShm,       // SHM
+    &ClientSession::handleGetPrice,  // GET_PRICE
+    &ClientSession::handleTrade,     // BUY
+    &ClientSession::handleTrade,     // SELL
+    &ClientSession::handleStart,     // START
+    &ClientSession::handleStop,      // STOP
+    &ClientSession::handlePipeline,  // PIPELINE
+    &ClientSession::handleChannel,   // CHANNEL
+    &ClientSession::handleBinary,    // BINARY
+    &ClientSession::handlePing,      // PING
+    &ClientSession::handlePong,      // PONG
+    &ClientSession::handleSubscribe,   // SUBSCRIBE
+    &ClientSession::handleUnsubscribe, // UNSUBSCRIBE
+    &ClientSession::handleLimitOrder,  // LIMIT
+    &ClientSession::handleLimitOrder,  // IOC
+    &ClientSession::handleLimitOrder,  // FOK
+    &ClientSession::handleCancel,      // CANCEL
+    &ClientSession::handleUnknown,   // UNKNOWN
+};
+
+void ClientSession::processClientCommand(std::string_view command) {
+    // --- Mode pipeline : chaque commande porte un identifiant choisi par le client ("#<id> <commande>") ---
+    // L'identifiant est repris en tête de chaque ligne de réponse (y compris le TRANSACTION_RESULT
+    // asynchrone), ce qui permet au client de garder plusieurs commandes en vol sans attendre les réponses.
+    currentRequestId = 0;
+
+    // Canal multiplexé : "@<n> <commande>" est traité par la session du canal n.
+    uint64_t tagged_channel = 0;
+    if (channelId == 0 && extractRequestId(command, tagged_channel, '@')) {
+        if (tagged_channel > UINT32_MAX) {
+            reply("ERROR: Invalid channel number.\n");
+        } else {
+            dispatchToChannel(static_cast<uint32_t>(tagged_channel), command);
+        }
+        return;
+    }
+
+    // Heartbeats (avec ou sans mode pipeline, jamais d'identifiant) : la réception a déjà compté comme activité.
+    CommandTokens heartbeat_tokens(command);
+    CommandVerb first_verb = CommandTable::lookup(heartbeat_tokens.next());
+    if ((first_verb == CommandVerb::PING || first_verb == CommandVerb::PONG) && heartbeat_tokens.next().empty()) {
+        if (first_verb == CommandVerb::PING) {
+            reply("PONG\n");
+        }
+        return;
+    }
+
+    if (pipelineMode && !extractRequestId(command, currentRequestId)) {
+        LOG("ClientSession WARNING : Commande sans identifiant valide en mode pipeline pour client " + clientId + " : '" + std::string(command) + "'", "WARNING");
+        reply("ERROR: Missing or invalid request id. Use #<id> <command> (id > 0) in PIPELINE mode.\n");
+        return;
+    }
+
+    // Découpage en mots sans copie ; le verbe est résolu par la table à hachage parfait (casse ignorée).
+    CommandTokens tokens(command);
+    std::string_view base_command = tokens.next();
+    CommandVerb verb = CommandTable::lookup(base_command);
+
+    // CHANNEL OPEN porte un mot de passe : jamais journalisé.
+    const std::string logged_command = verb == CommandVerb::CHANNEL ? "CHANNEL ..." : std::string(command);
+    LOG("ClientSession INFO : Début traitement commande pour client " + clientId + (channelId ? " (canal " + std::to_string(channelId) + ")" : "") + " : '" + logged_command + "'", "INFO");
+
+    // --- Dispatch ---
+    static_assert(sizeof(commandHandlers) / sizeof(commandHandlers[0]) == COMMAND_VERB_COUNT,
+                  "ClientSession::commandHandlers doit avoir une entrée par CommandVerb");
+    CommandContext ctx(command, base_command, tokens);
+    (this->*commandHandlers[static_cast<size_t>(verb)])(ctx);
+
     // --- Envoyer le message de réponse au client ---
-    if (!response_message.empty() && client && client->isConnected()) {
+    if (!ctx.shmFds.empty()) {
+        // La connexion transmet puis ferme ses copies des descripteurs.
+        if (!client->enqueueWithDescriptors(currentRequestId ? withRequestId(ctx.response, currentRequestId) : ctx.response, std::move(ctx.shmFds))) {
+            LOG("ClientSession ERROR : Impossible de transmettre le canal en mémoire partagée à client " + clientId + ".", "ERROR");
+            shmGateway->detach(shmChannel);
+            shmChannel.reset();
+        }
+    } else if (!ctx.response.empty() && client && client->isConnected()) {
          try {
-            client->send(response_message);
+            reply(ctx.response);
             // LOG("ClientSession DEBUG : Réponse envoyée à " + clientId + ": '" + response_message.substr(0, std::min(response_message.size(), (size_t)200)) + ((response_message.size() > 200) ? "..." : "") + "'", "DEBUG"); // Supprimé (DEBUG)
         } catch (const std::exception& e) {
              LOG("ClientSession ERROR : Erreur lors de l'envoi de la réponse à " + clientId + ": " + e.what(), "ERROR");
         }
     }
+    if (ctx.exportFd != -1) {
+        // Le fichier suit l'en-tête dans la file d'envoi ; la connexion ferme le descripteur.
+        if (!client || !client->enqueueFile(ctx.exportFd, 0, ctx.exportSize)) {
+            LOG("ClientSession ERROR : Impossible de mettre l'export en file d'envoi pour client " + clientId + ".", "ERROR");
+            if (!client) close(ctx.exportFd);
+        }
+    }
+
+    if (ctx.switchToBinary) {
+        binaryMode.store(true);
+        LOG("ClientSession INFO : Protocole binaire activé pour client " + clientId + ".", "INFO");
+    }
+
+    LOG("ClientSession INFO : Fin traitement commande pour client " + clientId + " : '" + logged_command + "'", "INFO");
+}
+
+// --- Traitement des verbes (appelés par processClientCommand via commandHandlers) ---
+// Chacun lit ses arguments dans ctx.tokens et remplit ctx.response ; une réponse vide signifie que la
+// réponse a déjà été envoyée (startBot, stopBot, CHANNEL) ou qu'il n'y en a pas (PONG).
+
+void ClientSession::handleQuit(CommandContext& ctx) {
+    LOG("ClientSession INFO : Commande QUIT reçue pour client " + clientId + ". Signalement de l'arrêt de la session.", "INFO");
+    running.store(false);
+    ctx.response = "OK: Disconnecting.\n";
+}
+
+void ClientSession::handleShow(CommandContext& ctx) {
+    std::string_view target = ctx.tokens.next();
+
+    if (equalsIgnoreCase(target, "WALLET")) {
+         LOG("ClientSession INFO : Commande SHOW WALLET reçue pour client " + clientId, "INFO");
+         std::shared_ptr<Wallet> wallet = getClientWallet();
+
+         if (wallet) {
+             double usd_balance = wallet->getBalance(Currency::USD);
+             double srd_btc_balance = wallet->getBalance(Currency::SRD_BTC);
+             double usd_reserved = wallet->getReserved(Currency::USD);
+             double srd_btc_reserved = wallet->getReserved(Currency::SRD_BTC);
+
+             std::stringstream response_ss;
+             response_ss << std::fixed << std::setprecision(10)
+                         << "BALANCE USD: " << usd_balance
+                         << ", SRD-BTC: " << srd_btc_balance;
+             // Fonds réservés par les ordres au repos (hors solde disponible), seulement s'il y en a.
+             if (usd_reserved > 0.0 || srd_btc_reserved > 0.0) {
+                 response_ss << " | RESERVED USD: " << usd_reserved << ", SRD-BTC: " << srd_btc_reserved;
+             }
+             response_ss << "\n";
+             ctx.response = response_ss.str();
+
+         } else {
+             LOG("ClientSession ERROR : Portefeuille (Wallet) non disponible pour client " + clientId + " lors de la commande SHOW WALLET.", "ERROR");
+             ctx.response = "ERROR: Internal server error (Wallet not available).\n";
+         }
+
+    } else if (equalsIgnoreCase(target, "TRANSACTIONS")) {
+         LOG("ClientSession INFO : Commande SHOW TRANSACTIONS reçue pour client " + clientId, "INFO");
+
+         // Arguments optionnels, dans n'importe quel ordre : une limite et/ou un curseur "before=<id>"
+         // (l'ID de la plus ancienne transaction de la page précédente, donné par "Next:").
+         size_t limit = DEFAULT_HISTORY_LIMIT;
+         std::string beforeId;
+         bool paged = false;
+         for (std::string_view arg = ctx.tokens.next(); !arg.empty(); arg = ctx.tokens.next()) {
+              paged = true;
+              if (arg.size() > 7 && equalsIgnoreCase(arg.substr(0, 7), "BEFORE=")) {
+                   beforeId.assign(arg.substr(7));
+                   continue;
+              }
+              auto [end, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), limit);
+              if (ec != std::errc() || end != arg.data() + arg.size() || limit == 0 || limit > MAX_HISTORY_LIMIT) {
+                   ctx.response = "ERROR: Invalid SHOW TRANSACTIONS arguments. Usage: SHOW TRANSACTIONS [limit 1-" + std::to_string(MAX_HISTORY_LIMIT) + "] [before=<id>].\n";
+                   return;
+              }
+         }
+
+         std::shared_ptr<Wallet> wallet = getClientWallet();
+
+         if (wallet) {
+              // Blocs formatés sous le verrou du portefeuille, envoyés après l'avoir relâché.
+              std::vector<std::string> chunks;
+              if (!formatTransactionPage(*wallet, limit, beforeId, paged, chunks)) {
+                   ctx.response = "ERROR: Unknown transaction id '" + beforeId + "'.\n";
+              } else {
+                   for (std::string& chunk : chunks) {
+                        reply(chunk);
+                   }
+              }
+
+         } else {
+              LOG("ClientSession ERROR : Portefeuille (Wallet) non disponible pour client " + clientId + " lors de la commande SHOW TRANSACTIONS.", "ERROR");
+              ctx.response = "ERROR: Internal server error (Wallet not available).\n";
+         }
+
+    } else {
+         LOG("ClientSession WARNING : Cible inconnue pour SHOW reçue pour client " + clientId + " : '" + std::string(ctx.command) + "'", "WARNING");
+         ctx.response = "ERROR: Unknown SHOW target. Use SHOW WALLET or SHOW TRANSACTIONS.\n";
+    }
+}
+
+void ClientSession::handleExport(CommandContext& ctx) {
+    // Historique complet en CSV : une ligne d'en-tête "EXPORT TRANSACTIONS <octets> <lignes>" (seule
+    // ligne préfixée en mode pipeline), suivie des <octets> du CSV tels quels.
+    if (channelId != 0) {
+        // Octets bruts sans préfixe : le client ne pourrait plus démultiplexer la connexion.
+        ctx.response = "ERROR: EXPORT TRANSACTIONS is not available on a multiplexed channel.\n";
+    } else if (!equalsIgnoreCase(ctx.tokens.next(), "TRANSACTIONS")) {
+        ctx.response = "ERROR: Unknown EXPORT target. Use EXPORT TRANSACTIONS.\n";
+    } else if (std::shared_ptr<Wallet> wallet = getClientWallet()) {
+        size_t lines = 0;
+        ctx.exportFd = writeTransactionExport(wallet->getTransactionHistory(), ctx.exportSize, lines);
+        if (ctx.exportFd < 0) {
+            ctx.exportFd = -1;
+            ctx.response = "ERROR: Internal server error (export failed).\n";
+        } else {
+            LOG("ClientSession INFO : Export de " + std::to_string(lines - 1) + " transactions (" + std::to_string(ctx.exportSize) + " octets) pour client " + clientId + (client->canSendFile() ? " via sendfile (transport " + client->getTransportName() + ")." : " par blocs (transport " + client->getTransportName() + ")."), "INFO");
+            ctx.response = "EXPORT TRANSACTIONS " + std::to_string(ctx.exportSize) + " " + std::to_string(lines) + "\n";
+        }
+    } else {
+        LOG("ClientSession ERROR : Portefeuille (Wallet) non disponible pour client " + clientId + " lors de la commande EXPORT TRANSACTIONS.", "ERROR");
+        ctx.response = "ERROR: Internal server error (Wallet not available).\n";
+    }
+}
+
+void ClientSession::handleShm(CommandContext& ctx) {
+    // Canal en mémoire partagée : la réponse "SHM ATTACHED <ordres> <rapports> <octets>" porte (SCM_RIGHTS)
+    // le memfd du segment, l'eventfd de réveil du serveur et celui du client (voir ShmGateway.h).
+    if (!equalsIgnoreCase(ctx.tokens.next(), "ATTACH")) {
+        ctx.response = "ERROR: Invalid SHM command. Usage: SHM ATTACH.\n";
+    } else if (!shmGateway || channelId != 0) {
+        ctx.response = "ERROR: Shared-memory gateway is disabled on this server.\n";
+    } else if (!client->canPassDescriptors()) {
+        ctx.response = "ERROR: SHM ATTACH requires the local unix socket.\n";
+    } else if (shmChannel) {
+        ctx.response = "ERROR: Shared-memory channel already attached.\n";
+    } else if ((shmChannel = shmGateway->attach(clientId, ctx.shmFds))) {
+        ctx.response = "SHM ATTACHED " + std::to_string(shmChannel->getOrderCapacity()) + " " + std::to_string(shmChannel->getReportCapacity())
+                     + " " + std::to_string(shmChannel->getMappingSize()) + "\n";
+    } else {
+        ctx.response = "ERROR: Internal server error (shared-memory channel).\n";
+    }
+}
+
+void ClientSession::handleGetPrice(CommandContext& ctx) {
+     std::string symbol = toUpperCopy(ctx.tokens.next());
+
+     if (!symbol.empty()) {
+          double price = Global::getPrice(symbol);
+          if (price > 0 && std::isfinite(price)) {
+               std::stringstream resp_ss;
+               resp_ss << "PRICE " << symbol << " " << std::fixed << std::setprecision(8) << price << "\n";
+               ctx.response = resp_ss.str();
+          } else {
+                LOG("ClientSession ERROR : Prix invalide (" + std::to_string(price) + ") obtenu de Global pour symbole " + symbol + " pour client " + clientId, "ERROR");
+                ctx.response = "ERROR: Could not retrieve valid price for " + symbol + ".\n";
+          }
+     } else {
+          LOG("ClientSession WARNING : Symbole manquant pour commande GET_PRICE pour client " + clientId, "WARNING");
+          ctx.response = "ERROR: Missing symbol for GET_PRICE. Use GET_PRICE <symbol>.\n";
+     }
+}
+
+// BUY et SELL : "<verbe> <devise> <pourcentage (1-100)>".
+void ClientSession::handleTrade(CommandContext& ctx) {
+     const std::string verb = toUpperCopy(ctx.verb);
+     if (bot) {
+         LOG("ClientSession WARNING : Refus commande manuelle " + verb + " de client " + clientId + " : Bot actif.", "WARNING");
+         ctx.response = "ERROR: Manual trading (" + verb + ") is disabled while the bot is active. Please stop the bot first.\n";
+         return;
+     }
+     std::string currency_str = toUpperCopy(ctx.tokens.next());
+     double percentage = 0.0;
+     bool percentage_ok = ctx.tokens.nextDouble(percentage);
+
+     Currency trade_currency = stringToCurrency(currency_str);
+
+     if (trade_currency != Currency::UNKNOWN && percentage_ok && percentage > 0.0 && percentage <= 100.0) {
+          RequestType req_type = (verb == "BUY") ? RequestType::BUY : RequestType::SELL;
+
+          // En cas d'échec, handleClientTradeRequest a déjà envoyé l'erreur : une seule réponse par commande.
+          if (handleClientTradeRequest(req_type, currency_str, percentage)) {
+              LOG("ClientSession INFO : Requête de trading manuelle (" + verb + " " + currencyToString(trade_currency) + " " + std::to_string(percentage) + "%) reçue pour client " + clientId + ". Soumission à la TQ via handleClientTradeRequest.", "INFO");
+              ctx.response = "OK: Your " + verb + " request has been submitted for processing.\n";
+          }
+
+     } else {
+         LOG("ClientSession WARNING : Syntaxe/valeurs invalides pour commande " + verb + " de client " + clientId + ": '" + std::string(ctx.command) + "'. Arguments: Devise='" + currency_str + "', Pourcentage=" + std::to_string(percentage) + ".", "WARNING");
+         ctx.response = "ERROR: Invalid syntax or value for " + verb + ". Use " + verb + " <Currency> <Percentage (1-100)>.\n";
+     }
+}
+
+void ClientSession::handleStart(CommandContext& ctx) {
+    std::string_view bot_keyword = ctx.tokens.next();
+    if (bot_keyword == "BOT") { // C'est bien "START BOT"
+        double bollingerK;
+        // Tenter de lire le paramètre BollingerK (un double)
+        if (ctx.tokens.nextDouble(bollingerK)) {
+            // --- Vérifier s'il y a des paramètres non attendus après K ---
+            std::string_view remaining = ctx.tokens.next(); // Tente de lire quelque chose d'autre après le double
+            if (!remaining.empty()) { // S'il reste du texte après le nombre (ex: START BOT 2.0 texte)
+                ctx.response = "ERROR: Invalid command format for START BOT. Usage: START BOT <BollingerK>.\n";
+                LOG("Server WARNING : Commande START BOT avec texte en trop après K de client " + clientId + ". Commande: '" + std::string(ctx.command) + "'", "WARNING");
+            }
+            else {
+                // --- Paramètre K lu avec succès et pas de texte en trop ! ---
+                // Appeler la méthode startBot avec le paramètre K.
+                // La période Bollinger (20) est gérée à l'intérieur de ClientSession::startBot.
+                startBot(bollingerK); // Appel de startBot
+                LOG("Server INFO : Commande START BOT reçue et parsée avec K=" + std::to_string(bollingerK) + " pour client " + clientId, "INFO");
+                // La méthode startBot envoie elle-même le message de confirmation ("BOT STARTED...").
+                // ctx.response est vide ici si startBot réussit (startBot envoie la réponse OK).
+            }
+        } else {
+            // Le paramètre K n'est pas un nombre valide ou est manquant
+            ctx.response = "ERROR: Invalid or missing BollingerK value. Usage: START BOT <BollingerK> (e.g., 2.0).\n";
+            LOG("Server WARNING : Commande START BOT avec paramètre K invalide (pas un nombre ou manquant) de client " + clientId + ". Commande: '" + std::string(ctx.command) + "'", "WARNING");
+        }
+    } else {
+        // Juste "START" sans "BOT" ou avec un autre mot
+        ctx.response = "ERROR: Unknown START command target '" + std::string(bot_keyword) + "'. Available: START BOT <BollingerK>.\n";
+         LOG("Server WARNING : Commande START inconnue de client " + clientId + ". Commande: '" + std::string(ctx.command) + "'", "WARNING");
+    }
+}
+
+void ClientSession::handleStop(CommandContext& ctx) {
+     std::string_view bot_keyword = ctx.tokens.next();
+
+     if (equalsIgnoreCase(bot_keyword, "BOT")) { // C'est bien "STOP BOT"
+         // Vérifier s'il y a des paramètres inattendus
+         std::string_view remaining = ctx.tokens.next();
+         if (!remaining.empty()) {
+              ctx.response = "ERROR: Invalid command format for STOP BOT. Usage: STOP BOT.\n";
+              LOG("Server WARNING : Commande STOP BOT avec texte en trop de client " + clientId + ". Commande: '" + std::string(ctx.command) + "'", "WARNING");
+         } else {
+             // Commande valide "STOP BOT"
+             stopBot(); // Appel de stopBot
+             LOG("Server INFO : Commande STOP BOT reçue et parsée pour client " + clientId, "INFO");
+             // La méthode stopBot envoie elle-même le message de confirmation ("BOT STOPPED.").
+             // ctx.response est vide ici si stopBot réussit (stopBot envoie la réponse OK).
+         }
+     } else {
+          // Juste "STOP" sans "BOT" ou avec un autre mot
+          ctx.response = "ERROR: Unknown STOP command target '" + std::string(bot_keyword) + "'. Available: STOP BOT.\n";
+          LOG("Server WARNING : Commande STOP inconnue de client " + clientId + ". Commande: '" + std::string(ctx.command) + "'", "WARNING");
+     }
+}
+
+void ClientSession::handlePipeline(CommandContext& ctx) {
+    std::string_view mode = ctx.tokens.next();
+    if (equalsIgnoreCase(mode, "ON")) {
+        LOG("ClientSession INFO : Mode pipeline activé pour client " + clientId, "INFO");
+        pipelineMode = true;
+        ctx.response = "OK: Pipeline mode enabled. Prefix each command with #<id>.\n";
+    } else if (equalsIgnoreCase(mode, "OFF")) {
+        LOG("ClientSession INFO : Mode pipeline désactivé pour client " + clientId, "INFO");
+        pipelineMode = false;
+        // La confirmation porte encore l'identifiant de la commande qui a désactivé le mode.
+        ctx.response = "OK: Pipeline mode disabled.\n";
+    } else {
+        ctx.response = "ERROR: Invalid PIPELINE mode. Usage: PIPELINE ON|OFF.\n";
+    }
+}
 
-    LOG("ClientSession INFO : Fin traitement commande pour client " + clientId + " : '" + command + "'", "INFO");
+void ClientSession::handleChannel(CommandContext& ctx) {
+    // "CHANNEL OPEN <n> <ID> <mot de passe>" / "CHANNEL CLOSE <n>" : réponse préfixée par "@<n> " (AUTH
+    // SUCCESS, AUTH NEW, OK ou ERROR), envoyée par handleChannelCommand.
+    if (channelId != 0 || !channelHost || maxChannels == 0) {
+        ctx.response = "ERROR: Channels are not available on this connection.\n";
+        return;
+    }
+    std::string_view action = ctx.tokens.next();
+    std::string_view number = ctx.tokens.next();
+    std::string_view user_id = ctx.tokens.next();
+    std::string_view password = ctx.tokens.next();
+    handleChannelCommand(action, number, user_id, password);
+}
+
+void ClientSession::handleBinary(CommandContext& ctx) {
+    if (channelId != 0 || !channels.empty()) {
+        // Les canaux sont des lignes texte préfixées : la connexion reste en protocole texte.
+        ctx.response = "ERROR: BINARY ON is not available with multiplexed channels.\n";
+    } else if (!priceSubscriptions.empty()) {
+        // Les PRICE_UPDATE sont des lignes texte : elles casseraient le découpage en trames.
+        ctx.response = "ERROR: BINARY ON is not available with price subscriptions. Use UNSUBSCRIBE first.\n";
+    } else if (equalsIgnoreCase(ctx.tokens.next(), "ON")) {
+        ctx.response = "OK: Binary protocol enabled. Send length-prefixed frames from now on.\n";
+        ctx.switchToBinary = true;
+    } else {
+        ctx.response = "ERROR: Invalid BINARY mode. Usage: BINARY ON.\n";
+    }
+}
+
+// PING/PONG avec un identifiant de pipeline (les heartbeats nus sont traités avant le dispatch).
+void ClientSession::handlePing(CommandContext& ctx) {
+    ctx.response = "PONG\n";
+}
+
+void ClientSession::handlePong(CommandContext&) {
+}
+
+// "SUBSCRIBE PRICE <symbole>" : la confirmation part avant le premier PRICE_UPDATE (dernier prix connu),
+// puis une ligne "PRICE_UPDATE <symbole> <prix> <séquence>" à chaque nouveau prix, sans identifiant de
+// pipeline. Un saut de séquence signale des prix remplacés avant envoi (client lent).
+void ClientSession::handleSubscribe(CommandContext& ctx) {
+    std::string_view topic = ctx.tokens.next();
+    std::string symbol = toUpperCopy(ctx.tokens.next());
+    if (!equalsIgnoreCase(topic, "PRICE") || symbol.empty() || !ctx.tokens.next().empty()) {
+        ctx.response = "ERROR: Invalid SUBSCRIBE command. Usage: SUBSCRIBE PRICE <symbol>.\n";
+    } else if (channelId != 0) {
+        // Les mises à jour sont partagées telles quelles : pas de préfixe "@<n> " possible.
+        ctx.response = "ERROR: SUBSCRIBE is not available on a multiplexed channel. Subscribe on the primary session.\n";
+    } else if (!priceFeed || binaryMode.load()) {
+        ctx.response = "ERROR: Price subscriptions are disabled on this server.\n";
+    } else if (!priceFeed->hasSymbol(symbol)) {
+        ctx.response = "ERROR: Unknown symbol " + symbol + " for SUBSCRIBE PRICE.\n";
+    } else if (std::find(priceSubscriptions.begin(), priceSubscriptions.end(), symbol) != priceSubscriptions.end()) {
+        ctx.response = "OK: Already subscribed to " + symbol + " price updates.\n";
+    } else {
+        // Confirmation mise en file AVANT l'abonnement : le premier PRICE_UPDATE ne peut pas la précéder.
+        reply("OK: Subscribed to " + symbol + " price updates.\n");
+        if (priceFeed->subscribe(symbol, client)) {
+            priceSubscriptions.push_back(symbol);
+            LOG("ClientSession INFO : Client " + clientId + " abonné aux prix " + symbol + ".", "INFO");
+        }
+    }
+}
+
+// "UNSUBSCRIBE PRICE <symbole>", ou "UNSUBSCRIBE" / "UNSUBSCRIBE PRICE" pour tous les symboles.
+// Un PRICE_UPDATE déjà en file peut encore suivre la confirmation.
+void ClientSession::handleUnsubscribe(CommandContext& ctx) {
+    std::string_view topic = ctx.tokens.next();
+    std::string symbol = toUpperCopy(ctx.tokens.next());
+    if ((!topic.empty() && !equalsIgnoreCase(topic, "PRICE")) || !ctx.tokens.next().empty()) {
+        ctx.response = "ERROR: Invalid UNSUBSCRIBE command. Usage: UNSUBSCRIBE [PRICE [<symbol>]].\n";
+        return;
+    }
+    size_t removed = 0;
+    for (auto it = priceSubscriptions.begin(); it != priceSubscriptions.end();) {
+        if (symbol.empty() || *it == symbol) {
+            if (priceFeed) priceFeed->unsubscribe(*it, client.get());
+            it = priceSubscriptions.erase(it);
+            removed++;
+        } else {
+            ++it;
+        }
+    }
+    if (removed == 0) {
+        ctx.response = symbol.empty() ? "OK: No active subscription.\n" : "ERROR: Not subscribed to " + symbol + " price updates.\n";
+    } else {
+        ctx.response = symbol.empty() ? "OK: Unsubscribed from " + std::to_string(removed) + " price stream(s).\n"
+                                      : "OK: Unsubscribed from " + symbol + " price updates.\n";
+    }
+}
+
+// LIMIT, IOC et FOK : "<verbe> <BUY|SELL> <symbole> <quantité> <prix limite>".
+// Le résultat arrive ensuite dans une ligne ORDER_STATUS (identifiant de l'ordre s'il reste au repos).
+// Pas d'auto-exécution : un ordre qui atteint un ordre au repos du même client s'arrête là, son reste est
+// annulé (STATE=CANCELLED, ou KILLED pour un FOK) et l'ordre au repos est gardé.
+void ClientSession::handleLimitOrder(CommandContext& ctx) {
+     const std::string verb = toUpperCopy(ctx.verb);
+     if (bot) {
+         LOG("ClientSession WARNING : Refus commande manuelle " + verb + " de client " + clientId + " : Bot actif.", "WARNING");
+         ctx.response = "ERROR: Manual trading (" + verb + ") is disabled while the bot is active. Please stop the bot first.\n";
+         return;
+     }
+     std::string side_str = toUpperCopy(ctx.tokens.next());
+     std::string symbol_str = toUpperCopy(ctx.tokens.next());
+     double quantity = 0.0;
+     double limit_price = 0.0;
+     bool values_ok = ctx.tokens.nextDouble(quantity) && ctx.tokens.nextDouble(limit_price);
+
+     if ((side_str != "BUY" && side_str != "SELL") || !values_ok || !(quantity > 0.0) || !(limit_price > 0.0)
+         || !std::isfinite(quantity) || !std::isfinite(limit_price)) {
+         LOG("ClientSession WARNING : Syntaxe/valeurs invalides pour commande " + verb + " de client " + clientId + ": '" + std::string(ctx.command) + "'.", "WARNING");
+         ctx.response = "ERROR: Invalid syntax or value for " + verb + ". Use " + verb + " <BUY|SELL> <Symbol> <Quantity> <LimitPrice>.\n";
+         return;
+     }
+     if (stringToCurrency(symbol_str) != Currency::SRD_BTC) {
+         ctx.response = "ERROR: Only SRD-BTC has an order book.\n";
+         return;
+     }
+
+     TransactionRequest request(clientId, side_str == "BUY" ? RequestType::BUY : RequestType::SELL, symbol_str, quantity);
+     request.orderType = equalsIgnoreCase(ctx.verb, "LIMIT") ? OrderType::LIMIT : equalsIgnoreCase(ctx.verb, "IOC") ? OrderType::IOC : OrderType::FOK;
+     request.limitPrice = limit_price;
+     request.correlationId = currentRequestId;
+
+     extern TransactionQueue txQueue;
+     txQueue.addRequest(std::move(request));
+     LOG("ClientSession INFO : Ordre " + verb + " " + side_str + " " + std::to_string(quantity) + " " + symbol_str + " @ " + std::to_string(limit_price) + " soumis à la TQ pour client " + clientId + ".", "INFO");
+     ctx.response = "OK: Your " + verb + " order has been submitted for processing.\n";
+}
+
+// CANCEL <identifiant> : identifiant donné par ORDER_STATUS ORDER=<id>.
+void ClientSession::handleCancel(CommandContext& ctx) {
+     std::string_view id_str = ctx.tokens.next();
+     uint64_t order_id = 0;
+     auto [end, ec] = std::from_chars(id_str.data(), id_str.data() + id_str.size(), order_id);
+     if (id_str.empty() || ec != std::errc() || end != id_str.data() + id_str.size() || order_id == 0) {
+         ctx.response = "ERROR: Invalid syntax for CANCEL. Use CANCEL <OrderId>.\n";
+         return;
+     }
+
+     TransactionRequest request(clientId, RequestType::CANCEL, "", 0.0);
+     request.orderId = order_id;
+     request.correlationId = currentRequestId;
+
+     extern TransactionQueue txQueue;
+     txQueue.addRequest(std::move(request));
+     ctx.response = "OK: Your CANCEL request has been submitted for processing.\n";
+}
+
+void ClientSession::handleUnknown(CommandContext& ctx) {
+    LOG("ClientSession WARNING : Commande inconnue reçue pour client " + clientId + " : '" + std::string(ctx.command) + "'", "WARNING");
+    ctx.response = "ERROR: Unknown command '" + std::string(ctx.command) + "'. Use SHOW WALLET, SHOW TRANSACTIONS, EXPORT TRANSACTIONS, GET_PRICE <symbol>, BUY/SELL <Currency> <Percentage>, LIMIT|IOC|FOK <BUY|SELL> <symbol> <qty> <price>, CANCEL <orderId>, START BOT <BollingerK>, STOP BOT, PIPELINE ON|OFF, BINARY ON, SHM ATTACH, CHANNEL OPEN|CLOSE, SUBSCRIBE|UNSUBSCRIBE PRICE <symbol>, or QUIT.\n";
 }
 
 // --- Implémentation de handleClientTradeRequest (pour les trades BASÉS SUR POURCENTAGE) ---
@@ -443,7 +1302,7 @@ bool ClientSession::handleClientTradeRequest(RequestType req_type, const std::st
 
     if (!clientWallet) {
         LOG("ClientSession ERROR : Portefeuille non disponible pour client " + clientId + " pour requête " + requestTypeToString(req_type) + " " + cryptoName + " " + std::to_string(percentage) + "%.", "ERROR");
-        if (client && client->isConnected()) client->send("ERROR: Wallet not available for this operation.\n");
+        reply("ERROR: Wallet not available for this operation.\n");
         return false;
     }
 
@@ -451,14 +1310,14 @@ bool ClientSession::handleClientTradeRequest(RequestType req_type, const std::st
     Currency trade_currency_enum = stringToCurrency(cryptoName);
     if (trade_currency_enum == Currency::UNKNOWN) {
          LOG("ClientSession WARNING : Devise inconnue spécifiée dans la requête de trading pour client " + clientId + ": '" + cryptoName + "'.", "WARNING");
-         if (client && client->isConnected()) client->send("ERROR: Unknown currency specified: " + cryptoName + ".\n");
+         reply("ERROR: Unknown currency specified: " + cryptoName + ".\n");
          return false;
     }
 
      // S'assurer que la requête est pour la paire/type supporté (ex: BUY/SELL SRD-BTC).
      if (trade_currency_enum != Currency::SRD_BTC || (req_type != RequestType::BUY && req_type != RequestType::SELL)) {
         LOG("ClientSession WARNING : Type de requête (" + requestTypeToString(req_type) + ") ou devise (" + cryptoName + ") non supporté par handleClientTradeRequest (pourcentage) pour client " + clientId + ".", "WARNING");
-        if (client && client->isConnected()) client->send("ERROR: Only BUY/SELL of SRD-BTC is supported via client command (percentage).\n");
+        reply("ERROR: Only BUY/SELL of SRD-BTC is supported via client command (percentage).\n");
         return false;
     }
 
@@ -475,7 +1334,7 @@ bool ClientSession::handleClientTradeRequest(RequestType req_type, const std::st
     // Vérifier le pourcentage ou montant calculé - doit être positif.
      if (percentage <= 0 || amount_based_on_percentage <= 0) {
         LOG("ClientSession WARNING : " + clientId + " - " + requestTypeToString(req_type) + " " + std::to_string(percentage) + "% " + cryptoName + " : Pourcentage (" + std::to_string(percentage) + ") ou montant calculé (" + std::to_string(amount_based_on_percentage) + ") nul ou négatif. Solde " + currencyToString(balance_currency_for_percentage) + ": " + std::to_string(current_balance_for_calc), "WARNING");
-        if (client && client->isConnected()) client->send("ERROR: Percentage or calculated amount is zero or negative. Check balance and percentage.\n");
+        reply("ERROR: Percentage or calculated amount is zero or negative. Check balance and percentage.\n");
         return false;
     }
 
@@ -490,7 +1349,7 @@ bool ClientSession::handleClientTradeRequest(RequestType req_type, const std::st
         double current_price_srd_btc = Global::getPrice(currencyToString(Currency::SRD_BTC)); // Obtenir prix (thread-safe)
         if (current_price_srd_btc <= 0 || !std::isfinite(current_price_srd_btc)) {
             LOG("ClientSession ERROR : Prix SRD-BTC non disponible ou invalide (" + std::to_string(current_price_srd_btc) + ") pour requête BUY (pourcentage) de client " + clientId, "ERROR");
-            if (client && client->isConnected()) client->send("ERROR: Current price not available for BUY.\n");
+            reply("ERROR: Current price not available for BUY.\n");
             return false;
         }
         crypto_quantity_requested = amount_based_on_percentage / current_price_srd_btc;
@@ -508,7 +1367,7 @@ bool ClientSession::handleClientTradeRequest(RequestType req_type, const std::st
    // --- Vérifier la quantité crypto visée finale ---
    if (crypto_quantity_requested <= 0) {
         LOG("ClientSession WARNING : " + clientId + " - " + requestTypeToString(req_type) + " " + std::to_string(percentage) + "% " + cryptoName + " : Quantité crypto calculée nulle ou négative (" + std::to_string(crypto_quantity_requested) + ").", "WARNING");
-        if (client && client->isConnected()) client->send("ERROR: Calculated crypto quantity is zero or negative.\n");
+        reply("ERROR: Calculated crypto quantity is zero or negative.\n");
         return false;
    }
 
@@ -520,10 +1379,12 @@ bool ClientSession::handleClientTradeRequest(RequestType req_type, const std::st
         cryptoName, // Utilise le nom de la crypto (string) directement ici
         crypto_quantity_requested // La quantité (en crypto) calculée à trader
     );
+    // Identifiant de la commande (mode pipeline) : repris dans le TRANSACTION_RESULT correspondant.
+    request.correlationId = currentRequestId;
 
     // Soumettre la requête à la file d'attente globale (TransactionQueue)
     extern TransactionQueue txQueue; // Accès à la TQ globale
-    txQueue.addRequest(request); // txQueue.addRequest doit être thread-safe.
+    txQueue.addRequest(std::move(request)); // Déplacée dans la file (thread-safe, sans verrou).
 
     // Log final de soumission.
     LOG("ClientSession INFO : Requête de transaction soumise à la TQ par client " + clientId + " (manuel, pourcentage) : Client=" + clientId + ", Type=" + requestTypeToString(req_type) + ", Qty Visée=" + std::to_string(crypto_quantity_requested) + " " + cryptoName + " (basé sur " + std::to_string(percentage) + "% de solde " + currencyToString(balance_currency_for_percentage) + ")", "INFO");
@@ -617,8 +1478,8 @@ void ClientSession::submitBotOrder(TradingAction action) {
     // external TransactionQueue instance (déclarée extern dans ClientSession.h si elle n'est pas gérée autrement)
     extern TransactionQueue txQueue; // Accès à la TQ globale
 
-    // txQueue.addRequest est thread-safe (la TQ gère sa propre file d'attente avec un mutex).
-    txQueue.addRequest(request);
+    // txQueue.addRequest est thread-safe (anneau sans verrou du shard du client).
+    txQueue.addRequest(std::move(request));
 
     LOG("ClientSession INFO : Requête de transaction soumise à la TQ par bot " + clientId + " (auto): Client=" + clientId + ", Type=" + requestTypeToString(req_type) + ", Qty Visée=" + std::to_string(crypto_quantity_requested) + " " + currencyToString(trade_currency), "INFO");
 
@@ -630,7 +1491,7 @@ void ClientSession::submitBotOrder(TradingAction action) {
 // Cette méthode est appelée par la TransactionQueue lorsqu'une transaction est appliquée pour ce client.
 // Elle notifie le bot si présent, et envoie le résultat au client via la connexion réseau.
 // Cette méthode est appelée depuis un thread de la TQ, elle DOIT être thread-safe (pas de modification des membres de ClientSession sans verrou si nécessaire).
-void ClientSession::applyTransactionRequest(const Transaction& tx) {
+void ClientSession::applyTransactionRequest(const Transaction& tx, uint64_t requestId) {
     // Cette méthode est appelée par la TQ avec le résultat FINAL d'une transaction.
 
     // Log de la notification reçue.
@@ -664,13 +1525,24 @@ void ClientSession::applyTransactionRequest(const Transaction& tx) {
          // LOG("ClientSession DEBUG : Message TRANSACTION_RESULT formaté pour " + clientId + " Tx " + tx.getId() + ": '" + result_msg_ss.str() + "'", "DEBUG"); // Supprimé (DEBUG)
 
 
-        // Envoyer la réponse au client via le shared_ptr client (ServerConnection).
-        // Vérifier si la connexion est toujours active.
+        // Déposer la réponse dans la file d'envoi de la connexion : le thread de la TQ n'écrit jamais
+        // sur le socket (un client lent ne doit pas bloquer le traitement des transactions).
         if (client && client->isConnected()) {
             try {
-                // LOG("ClientSession DEBUG : applyTransactionRequest: Tentative d'envoi de la réponse TRANSACTION_RESULT au client " + clientId + "...", "DEBUG"); // Supprimé (DEBUG)
-                // La méthode send() de ServerConnection doit être thread-safe.
-                client->send(result_msg_ss.str() + "\n"); // N'oubliez pas le terminateur de ligne '\n' !
+                // Mode pipeline : le résultat reprend l'identifiant de la commande BUY/SELL d'origine.
+                std::string result_msg = result_msg_ss.str() + "\n"; // N'oubliez pas le terminateur de ligne '\n' !
+                if (binaryMode.load()) {
+                    // Protocole binaire : trame TRANSACTION_RESULT (identifiant, statut, raison éventuelle).
+                    result_msg.clear();
+                    BinaryProtocol::encodeTransactionResult(result_msg, requestId, tx.getId(), static_cast<uint8_t>(tx.getStatus()),
+                                                            tx.getStatus() == TransactionStatus::FAILED ? tx.getFailureReason() : std::string());
+                } else if (requestId) {
+                    result_msg = withRequestId(result_msg, requestId);
+                }
+                result_msg = onChannel(std::move(result_msg));
+                if (!client->enqueueSend(std::move(result_msg))) {
+                    LOG("ClientSession WARNING : applyTransactionRequest: Résultat TRANSACTION_RESULT non déposé pour client " + clientId + " (connexion fermée ou file d'envoi pleine) pour Tx " + tx.getId() + ".", "WARNING");
+                }
                 // LOG("ClientSession DEBUG : applyTransactionRequest: Réponse TRANSACTION_RESULT envoyée (ou appel send terminé sans exception) à " + clientId + ".", "DEBUG"); // Supprimé (DEBUG)
             } catch (const std::exception& e) {
                  // Gérer les erreurs d'envoi (connexion fermée, etc.).
@@ -695,6 +1567,27 @@ void ClientSession::applyTransactionRequest(const Transaction& tx) {
  }
 
 
+// --- applyOrderStatus : ORDER_STATUS / ORDER_FILL d'un ordre à cours limité ---
+// Comme applyTransactionRequest : déposé dans la file d'envoi, le thread de la TQ n'écrit jamais sur le socket.
+void ClientSession::applyOrderStatus(const std::string& line, uint64_t requestId) {
+    if (!client || !client->isConnected()) {
+        return;
+    }
+    std::string message;
+    if (binaryMode.load()) {
+        BinaryProtocol::encodeText(message, BinaryProtocol::MessageType::TEXT, requestId, line);
+    } else {
+        message = line + "\n";
+        if (requestId) {
+            message = withRequestId(message, requestId);
+        }
+    }
+    if (!client->enqueueSend(onChannel(std::move(message)))) {
+        LOG("ClientSession WARNING : applyOrderStatus: Ligne non déposée pour client " + clientId + " (connexion fermée ou file d'envoi pleine) : " + line, "WARNING");
+    }
+}
+
+
 // --- startBot(double bollingerK) : Démarre la logique du bot ---
 // Appelée par processClientCommand suite à la commande "START BOT <K>".
 // Crée un nouvel objet Bot et démarre son thread interne.
@@ -703,7 +1596,7 @@ void ClientSession::startBot(double bollingerK) {
     if (bot) {
         LOG("ClientSession WARNING : Bot déjà actif pour client " + clientId + ", ignorer START BOT.", "WARNING");
         // Envoyer une erreur au client si la connexion est toujours active.
-        if (client && client->isConnected()) client->send("ERROR: Bot is already running.\n");
+        reply("ERROR: Bot is already running.\n");
         return; // Ne pas démarrer un nouveau bot si un existe déjà.
     }
 
@@ -717,7 +1610,7 @@ void ClientSession::startBot(double bollingerK) {
           std::stringstream ss_log_err;
           ss_log_err << "ClientSession ERROR : Valeur de BollingerK invalide (" << std::fixed << std::setprecision(2) << bollingerK << ") pour client " << clientId << ". Échec démarrage bot.";
           LOG(ss_log_err.str(), "ERROR");
-          if (client && client->isConnected()) client->send("ERROR: Invalid BollingerK value provided. Must be a positive number (e.g., 2.0).\n");
+          reply("ERROR: Invalid BollingerK value provided. Must be a positive number (e.g., 2.0).\n");
           return; // Ne pas créer le Bot avec un paramètre invalide.
      }
 
@@ -734,13 +1627,13 @@ void ClientSession::startBot(double bollingerK) {
     } catch (const std::bad_weak_ptr& e) {
          // Cette exception peut arriver si shared_from_this() est appelé trop tôt.
          LOG("ClientSession CRITICAL : Échec d'obtention de shared_from_this pour créer le Bot (cas START BOT). La ClientSession doit être gérée par un shared_ptr avant d'appeler startBot. Erreur: " + std::string(e.what()), "CRITICAL");
-         if (client && client->isConnected()) client->send("ERROR: Internal server error starting bot.\n");
+         reply("ERROR: Internal server error starting bot.\n");
          bot = nullptr; // S'assurer que le pointeur bot est null en cas d'échec.
          return;
     } catch (const std::exception& e) {
           // Attraper d'autres exceptions lors de la création du Bot (ex: allocation mémoire).
           LOG("ClientSession ERROR : Exception lors de la création de l'objet Bot pour client " + clientId + ": " + e.what(), "ERROR");
-          if (client && client->isConnected()) client->send("ERROR: Failed to start bot due to creation error.\n");
+          reply("ERROR: Failed to start bot due to creation error.\n");
           bot = nullptr; // S'assurer que le pointeur bot est null en cas d'échec.
           return;
     }
@@ -753,11 +1646,11 @@ void ClientSession::startBot(double bollingerK) {
 
          LOG("ClientSession INFO : Bot créé et démarré pour client " + clientId + " avec P=" + std::to_string(bollingerPeriod) + ", K=" + std::to_string(bollingerK), "INFO");
          // Confirmer au client que le bot a démarré.
-         if (client && client->isConnected()) client->send("BOT STARTED with P=" + std::to_string(bollingerPeriod) + ", K=" + std::to_string(bollingerK) + ".\n");
+         reply("BOT STARTED with P=" + std::to_string(bollingerPeriod) + ", K=" + std::to_string(bollingerK) + ".\n");
     } else {
         // Si std::make_shared a retourné nullptr (très rare, sauf en cas d'exception gérée par le catch).
         LOG("ClientSession ERROR : Échec de création (pointeur null) de l'objet Bot pour client " + clientId, "ERROR");
-        if (client && client->isConnected()) client->send("ERROR: Failed to start bot (creation returned null).\n");
+        reply("ERROR: Failed to start bot (creation returned null).\n");
     }
  }
 
@@ -767,7 +1660,7 @@ void ClientSession::stopBot() {
     // Vérifier si un bot est actif.
     if (!bot) {
         LOG("ClientSession WARNING : Aucun bot actif pour client " + clientId + ", ignorer STOP BOT.", "WARNING");
-        if (client && client->isConnected()) client->send("ERROR: No bot is running.\n");
+        reply("ERROR: No bot is running.\n");
         return; // Rien à arrêter si le bot n'existe pas.
     }
 
@@ -780,7 +1673,7 @@ void ClientSession::stopBot() {
     bot = nullptr;
     LOG("ClientSession INFO : Bot arrêté pour client " + clientId, "INFO");
     // Confirmer au client que le bot est arrêté.
-    if (client && client->isConnected()) client->send("BOT STOPPED.\n");
+    reply("BOT STOPPED.\n");
  }
 
 // --- Getters simples ---
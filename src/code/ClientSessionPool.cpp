@@ -0,0 +1,358 @@
+#include "../headers/ClientSessionPool.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+// Attente maximale du thread d'E/S sans événement (filet de sécurité : les envois le réveillent).
+static constexpr int POOL_POLL_TIMEOUT_MS = 1000;
+
+// --- PooledSession ---
+PooledSession::PooledSession(ClientSessionPool* owner, std::shared_ptr<ServerConnection> conn, uint32_t channel, const std::string& id)
+    : pool(owner), connection(std::move(conn)), channelId(channel), clientId(id)
+{
+}
+
+bool PooledSession::send(const std::string& command) {
+    if (!isOpen()) {
+        return false;
+    }
+    return connection->enqueueSend("@" + std::to_string(channelId) + " " + command + "\n");
+}
+
+bool PooledSession::receiveLine(std::string& line, int timeoutMs) {
+    std::unique_lock<std::mutex> lock(inboxMutex);
+    auto ready = [this] { return !inbox.empty() || closed; };
+    if (timeoutMs < 0) {
+        inboxCv.wait(lock, ready);
+    } else if (!inboxCv.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready)) {
+        return false;
+    }
+    if (inbox.empty()) {
+        return false; // Canal fermé, tout a été lu.
+    }
+    line = std::move(inbox.front());
+    inbox.pop_front();
+    return true;
+}
+
+void PooledSession::close() {
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex);
+        if (closed) {
+            return;
+        }
+        closed = true;
+    }
+    inboxCv.notify_all();
+    // La réponse "@<n> OK: Channel closed." arrivera sur un canal déjà oublié : ignorée.
+    connection->enqueueSend("CHANNEL CLOSE " + std::to_string(channelId) + "\n");
+    pool->forgetSession(*this);
+}
+
+bool PooledSession::isOpen() const {
+    std::lock_guard<std::mutex> lock(inboxMutex);
+    return !closed;
+}
+
+const std::string& PooledSession::getClientId() const { return clientId; }
+uint32_t PooledSession::getChannelId() const { return channelId; }
+
+void PooledSession::deliver(std::string line) {
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex);
+        inbox.push_back(std::move(line));
+    }
+    inboxCv.notify_one();
+}
+
+void PooledSession::markClosed() {
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex);
+        closed = true;
+    }
+    inboxCv.notify_all();
+}
+
+
+// --- ClientSessionPool ---
+ClientSessionPool::~ClientSessionPool() {
+    stop();
+}
+
+bool ClientSessionPool::start(const ClientPoolConfig& cfg) {
+    if (running.load()) {
+        LOG("ClientSessionPool::start WARNING : Pool déjà démarré.", "WARNING");
+        return true;
+    }
+    config = cfg;
+    config.connections = std::max<size_t>(1, config.connections);
+
+    // Un seul contexte pour toutes les connexions (configuration TLS chargée une fois).
+    ctx = initiator.InitClientCTX();
+    if (!ctx) {
+        LOG("ClientSessionPool::start ERROR : Impossible de créer le contexte SSL client.", "ERROR");
+        return false;
+    }
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) {
+        LOG("ClientSessionPool::start ERROR : eventfd a échoué. Erreur: " + std::string(strerror(errno)), "ERROR");
+        return false;
+    }
+
+    for (size_t i = 0; i < config.connections; ++i) {
+        std::shared_ptr<ServerConnection> conn = connectOne(i);
+        if (!conn) {
+            continue;
+        }
+        // Dès maintenant, seul le thread d'E/S écrit sur la connexion (les envois passent par la file).
+        conn->setNonBlocking(true);
+        conn->attachWriter([this] { wake(); });
+        auto pc = std::make_unique<PoolConnection>();
+        pc->connection = std::move(conn);
+        connections.push_back(std::move(pc));
+    }
+    if (connections.empty()) {
+        LOG("ClientSessionPool::start ERROR : Aucune connexion établie vers " + config.host + ":" + std::to_string(config.port) + ".", "ERROR");
+        ::close(wakeFd);
+        wakeFd = -1;
+        return false;
+    }
+
+    running.store(true);
+    ioThread = std::thread(&ClientSessionPool::ioLoop, this);
+    LOG("ClientSessionPool::start INFO : " + std::to_string(connections.size()) + " connexion(s) ouverte(s), jusqu'à " + std::to_string(config.maxChannelsPerConnection) + " canaux chacune.", "INFO");
+    return true;
+}
+
+std::shared_ptr<ServerConnection> ClientSessionPool::connectOne(size_t index) {
+    const std::string id = config.connectionId + "-" + std::to_string(index);
+    std::shared_ptr<ServerConnection> conn = initiator.ConnectToServer(config.host, config.port, ctx.get());
+    if (!conn || !conn->isConnected()) {
+        return nullptr;
+    }
+    try {
+        conn->send("ID:" + id + ",TOKEN:" + config.connectionPassword + "\n");
+        std::string response = conn->receiveLine();
+        if (response != "AUTH SUCCESS" && response != "AUTH NEW") {
+            LOG("ClientSessionPool::connectOne ERROR : Authentification de la connexion " + id + " refusée : '" + response + "'.", "ERROR");
+            conn->closeConnection();
+            return nullptr;
+        }
+    } catch (const std::exception& e) {
+        LOG("ClientSessionPool::connectOne ERROR : Authentification de la connexion " + id + " impossible : " + e.what(), "ERROR");
+        conn->closeConnection();
+        return nullptr;
+    }
+    return conn;
+}
+
+void ClientSessionPool::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    wake();
+    if (ioThread.joinable()) {
+        ioThread.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& pc : connections) {
+        // Les canaux se terminent avec la connexion (la session principale ferme ses canaux côté serveur).
+        for (auto& [channel, session] : pc->sessions) {
+            session->markClosed();
+        }
+        pc->sessions.clear();
+        if (pc->connection->isConnected()) {
+            pc->connection->closeConnection();
+        }
+    }
+    connections.clear();
+    ::close(wakeFd);
+    wakeFd = -1;
+    LOG("ClientSessionPool::stop INFO : Pool arrêté.", "INFO");
+}
+
+std::shared_ptr<PooledSession> ClientSessionPool::openSession(const std::string& clientId, const std::string& password) {
+    if (!running.load()) {
+        return nullptr;
+    }
+    std::shared_ptr<PooledSession> session;
+    {
+        // Connexion vivante la moins chargée.
+        std::lock_guard<std::mutex> lock(mutex);
+        PoolConnection* target = nullptr;
+        for (auto& pc : connections) {
+            if (pc->alive && pc->sessions.size() < config.maxChannelsPerConnection
+                && (!target || pc->sessions.size() < target->sessions.size())) {
+                target = pc.get();
+            }
+        }
+        if (!target) {
+            LOG("ClientSessionPool::openSession WARNING : Aucune connexion disponible pour client " + clientId + " (toutes pleines ou perdues).", "WARNING");
+            return nullptr;
+        }
+        session = std::make_shared<PooledSession>(this, target->connection, target->nextChannel++, clientId);
+        // Enregistré avant l'envoi : la réponse peut arriver avant le retour de enqueueSend.
+        target->sessions[session->getChannelId()] = session;
+    }
+
+    std::string response;
+    bool sent = session->connection->enqueueSend("CHANNEL OPEN " + std::to_string(session->getChannelId()) + " " + clientId + " " + password + "\n");
+    if (sent && session->receiveLine(response, config.openTimeoutMs) && (response == "AUTH SUCCESS" || response == "AUTH NEW")) {
+        return session;
+    }
+    LOG("ClientSessionPool::openSession WARNING : Canal refusé pour client " + clientId + " : '" + (sent ? response : std::string("connexion fermée")) + "'.", "WARNING");
+    session->markClosed();
+    forgetSession(*session);
+    return nullptr;
+}
+
+void ClientSessionPool::forgetSession(const PooledSession& session) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& pc : connections) {
+        if (pc->connection == session.connection) {
+            pc->sessions.erase(session.channelId);
+            return;
+        }
+    }
+}
+
+size_t ClientSessionPool::getConnectionCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<size_t>(std::count_if(connections.begin(), connections.end(), [](const auto& pc) { return pc->alive; }));
+}
+
+size_t ClientSessionPool::getSessionCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const auto& pc : connections) {
+        count += pc->sessions.size();
+    }
+    return count;
+}
+
+void ClientSessionPool::wake() {
+    if (wakeFd >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+// --- Thread d'E/S ---
+// La liste des connexions est fixée par start() : seul leur état (alive, canaux) change ensuite.
+void ClientSessionPool::ioLoop() {
+    LOG("ClientSessionPool::ioLoop INFO : Thread d'E/S du pool démarré.", "INFO");
+    std::vector<pollfd> fds;
+    std::vector<PoolConnection*> polled;
+
+    while (running.load()) {
+        fds.clear();
+        polled.clear();
+        fds.push_back({wakeFd, POLLIN, 0});
+        for (auto& pc : connections) {
+            if (pc->connection->isConnected()) {
+                fds.push_back({pc->connection->getSocketFD(), static_cast<short>(POLLIN | (pc->waitingWritable ? POLLOUT : 0)), 0});
+                polled.push_back(pc.get());
+            }
+        }
+
+        int ready = ::poll(fds.data(), fds.size(), POOL_POLL_TIMEOUT_MS);
+        if (ready < 0 && errno != EINTR) {
+            LOG("ClientSessionPool::ioLoop ERROR : poll a échoué. Erreur: " + std::string(strerror(errno)), "ERROR");
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            uint64_t value;
+            while (::read(wakeFd, &value, sizeof(value)) > 0) {}
+        }
+
+        for (size_t i = 0; i < polled.size(); ++i) {
+            PoolConnection& pc = *polled[i];
+            bool ok = true;
+            // Lignes déjà présentes dans le buffer (reçues avec la réponse d'authentification) comprises.
+            if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR) || pc.connection->getInputFramer().buffered() > 0) {
+                ok = readConnection(pc);
+            }
+            if (ok) {
+                ServerConnection::FlushResult flushed = pc.connection->flushOutbound();
+                ok = flushed != ServerConnection::FlushResult::FAILED;
+                pc.waitingWritable = flushed == ServerConnection::FlushResult::WOULD_BLOCK;
+            }
+            if (!ok) {
+                connectionLost(pc);
+            }
+        }
+    }
+    LOG("ClientSessionPool::ioLoop INFO : Thread d'E/S du pool terminé.", "INFO");
+}
+
+bool ClientSessionPool::readConnection(PoolConnection& pc) {
+    LineFramer& framer = pc.connection->getInputFramer();
+    while (true) {
+        std::string_view line;
+        LineFramer::Status status;
+        while ((status = framer.nextLine(line)) == LineFramer::Status::LINE) {
+            dispatchLine(pc, line);
+        }
+        if (status == LineFramer::Status::LINE_TOO_LONG) {
+            LOG("ClientSessionPool::readConnection ERROR : Ligne trop longue reçue du serveur. Fermeture de la connexion.", "ERROR");
+            return false;
+        }
+        int received = pc.connection->receiveIntoFramer();
+        if (received <= 0) {
+            // 0 en non bloquant : plus rien à lire pour l'instant (sauf si la connexion a été fermée).
+            return received == 0 && pc.connection->isConnected();
+        }
+    }
+}
+
+void ClientSessionPool::dispatchLine(PoolConnection& pc, std::string_view line) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    if (line.size() > 1 && line[0] == '@') {
+        uint32_t channel = 0;
+        auto [end, ec] = std::from_chars(line.data() + 1, line.data() + line.size(), channel);
+        if (ec == std::errc() && end < line.data() + line.size() && *end == ' ') {
+            std::shared_ptr<PooledSession> session;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = pc.sessions.find(channel);
+                if (it != pc.sessions.end()) {
+                    session = it->second;
+                }
+            }
+            if (session) {
+                session->deliver(std::string(end + 1, line.data() + line.size()));
+            }
+            return; // Canal déjà fermé : réponse tardive ignorée.
+        }
+    }
+    if (line == "PING") {
+        pc.connection->enqueueSend("PONG\n");
+        return;
+    }
+    LOG("ClientSessionPool::dispatchLine WARNING : Ligne hors canal ignorée : '" + std::string(line) + "'.", "WARNING");
+}
+
+void ClientSessionPool::connectionLost(PoolConnection& pc) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!pc.alive) {
+        return;
+    }
+    pc.alive = false;
+    LOG("ClientSessionPool::connectionLost WARNING : Connexion du pool perdue (" + std::to_string(pc.sessions.size()) + " canal(aux) fermé(s)).", "WARNING");
+    for (auto& [channel, session] : pc.sessions) {
+        session->markClosed();
+    }
+    pc.sessions.clear();
+    if (pc.connection->isConnected()) {
+        pc.connection->closeConnection();
+    }
+}
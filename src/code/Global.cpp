@@ -1,5 +1,6 @@
 #include "../headers/Global.h"
 #include "../headers/Logger.h"
+#include "../headers/LowLatency.h"
 
 #include <curl/curl.h>        
 #include <nlohmann/json.hpp>  
@@ -41,6 +42,11 @@ std::atomic<bool> Global::stopRequested = false;
 
 // Thread dédié à la génération/mise à jour des prix
 std::thread Global::priceGenerationWorker;
+int Global::priceThreadCpu = -1;
+
+// Destinataire des nouveaux prix (abonnements, voir PriceFeed)
+std::mutex Global::listenerMutex;
+std::function<void(const std::string&, double)> Global::priceListener;
 
 
 // --- Callback de libcurl ---
@@ -141,6 +147,7 @@ std::string tradingActionToString(TradingAction ta) {
 // S'exécute dans priceGenerationWorker.
 void Global::generate_SRD_BTC_loop_impl() {
     LOG("Global Thread de génération de prix démarré.", "INFO");
+    LowLatency::pinCurrentThread(priceThreadCpu, "génération des prix");
 
     // Initialisation des ressources du thread.
     CURL* curl = nullptr;
@@ -227,6 +234,14 @@ void Global::generate_SRD_BTC_loop_impl() {
                  activeIndex.store((index + 1) % MAX_VALUES_PER_DAY); // Peut utiliser memory_order_seq_cst (par défaut)
             } // Les verrous sont libérés
 
+            // --- Diffusion aux abonnés (avant les écritures disque et le log) ---
+            {
+                std::lock_guard<std::mutex> lock_listener(listenerMutex);
+                if (priceListener) {
+                    priceListener("SRD-BTC", srd_btc);
+                }
+            }
+
             // --- Logging de la nouvelle valeur ---
             auto now = std::chrono::system_clock::now();
             auto time_t = std::chrono::system_clock::to_time_t(now);
@@ -287,6 +302,15 @@ void Global::startPriceGenerationThread() {
     }
 }
 
+void Global::setPriceThreadCpu(int cpu) {
+    priceThreadCpu = cpu;
+}
+
+void Global::setPriceListener(std::function<void(const std::string& symbol, double price)> listener) {
+    std::lock_guard<std::mutex> lock(listenerMutex);
+    priceListener = std::move(listener);
+}
+
 // Signale l'arrêt et attend la fin du thread.
 void Global::stopPriceGenerationThread() {
     LOG("Global Demande d'arrêt du thread de génération de prix.", "INFO");
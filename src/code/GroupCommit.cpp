@@ -0,0 +1,297 @@
+#include "../headers/GroupCommit.h"
+#include "../headers/Wallet.h"
+#include "../headers/Logger.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+GroupCommit::~GroupCommit() {
+    stop();
+    if (journalFd >= 0) {
+        close(journalFd);
+    }
+}
+
+void GroupCommit::configure(const GroupCommitConfig& newConfig, const std::string& path) {
+    config = newConfig;
+    config.intervalMicros = std::max(0, config.intervalMicros);
+    config.maxBatch = std::max(1, config.maxBatch);
+    journalPath = path;
+}
+
+bool GroupCommit::start() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (running || writer.joinable()) {
+        LOG("GroupCommit::start WARNING : Thread d'écriture déjà démarré.", "WARNING");
+        return false;
+    }
+    // Journal ouvert d'avance : le premier lot n'a pas à le faire, et syncfs a un descripteur dès le départ.
+    if (journalFd < 0) {
+        openJournal(); // Échec loggué ; nouvel essai à la première ligne à écrire.
+    }
+    running = true;
+    writer = std::thread(&GroupCommit::run, this);
+    LOG("GroupCommit::start INFO : Écriture groupée démarrée (intervalle " + std::to_string(config.intervalMicros) + " us, lots de "
+        + std::to_string(config.maxBatch) + ", " + (config.sync ? "syncfs" : "sans mise sur disque") + ", journal " + journalPath + ").", "INFO");
+    return true;
+}
+
+void GroupCommit::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        running = false;
+    }
+    pendingCv.notify_all();
+    spaceCv.notify_all();
+    if (writer.joinable()) {
+        writer.join();
+        GroupCommitStats s = getStats();
+        LOG("GroupCommit::stop INFO : Thread d'écriture arrêté. " + std::to_string(s.entries) + " requêtes en " + std::to_string(s.batches)
+            + " lots (plus grand : " + std::to_string(s.largestBatch) + "), " + std::to_string(s.walletWrites) + " écritures de portefeuille ("
+            + std::to_string(s.walletWriteFailures) + " en échec), " + std::to_string(s.syncs) + " mises sur disque, "
+            + std::to_string(s.journalWriteFailures) + " échecs d'écriture du journal.", "INFO");
+    }
+}
+
+void GroupCommit::submit(CommitEntry entry) {
+    std::unique_lock<std::mutex> lock(mtx);
+    size_t maxPending = static_cast<size_t>(config.maxBatch) * 4;
+    spaceCv.wait(lock, [&] { return pending.size() < maxPending || !running; });
+    if (!running) {
+        // Pas de thread d'écriture (arrêté ou jamais démarré) : lot d'une entrée écrit par l'appelant.
+        lock.unlock();
+        std::vector<CommitEntry> single;
+        single.push_back(std::move(entry));
+        commit(single);
+        return;
+    }
+    bool wake = pending.empty() || pending.size() + 1 >= static_cast<size_t>(config.maxBatch);
+    pending.push_back(std::move(entry));
+    lock.unlock();
+    if (wake) {
+        pendingCv.notify_one();
+    }
+}
+
+GroupCommitStats GroupCommit::getStats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return stats;
+}
+
+// --- Thread d'écriture ---
+void GroupCommit::run() {
+    std::vector<CommitEntry> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            auto ready = [&] { return !pending.empty() || !running; };
+            if (retryPending.load(std::memory_order_acquire)) {
+                // Écritures en échec : nouvel essai après RETRY_INTERVAL, même sans nouvelle entrée.
+                pendingCv.wait_for(lock, RETRY_INTERVAL, ready);
+            } else {
+                pendingCv.wait(lock, ready);
+            }
+            if (pending.empty() && !running) {
+                break; // Arrêt demandé et tout a été soumis.
+            }
+            // Laisser le lot se remplir : jusqu'à l'intervalle après sa première requête, ou sa taille maximale.
+            if (!pending.empty() && config.intervalMicros > 0 && running) {
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(config.intervalMicros);
+                pendingCv.wait_until(lock, deadline, [&] {
+                    return pending.size() >= static_cast<size_t>(config.maxBatch) || !running;
+                });
+            }
+            batch.swap(pending);
+        }
+        spaceCv.notify_all();
+        commit(batch);
+        batch.clear();
+    }
+    // Dernier essai pour les écritures en échec ; ce qui échoue encore n'est pas acquitté.
+    if (retryPending.load(std::memory_order_acquire)) {
+        commit(batch);
+        std::lock_guard<std::mutex> commitLock(commitMutex);
+        if (!deferred.empty() || !journalBacklog.empty()) {
+            LOG("GroupCommit::run ERROR : Arrêt avec des écritures en échec : " + std::to_string(deferred.size()) + " acquittement(s) jamais envoyé(s), "
+                + std::to_string(journalBacklog.size()) + " octets du journal non écrits.", "ERROR");
+        }
+    }
+}
+
+bool GroupCommit::openJournal() {
+    journalFd = open(journalPath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (journalFd < 0) {
+        LOG("GroupCommit::openJournal ERROR : Impossible d'ouvrir le journal " + journalPath + " : " + std::string(strerror(errno)), "ERROR");
+        return false;
+    }
+    struct stat st {};
+    if (fstat(journalFd, &st) == 0 && st.st_size == 0) {
+        const char* header = Transaction::csvHeader();
+        if (write(journalFd, header, strlen(header)) < 0) {
+            LOG("GroupCommit::openJournal ERROR : Écriture de l'en-tête de " + journalPath + " : " + std::string(strerror(errno)), "ERROR");
+        }
+    }
+    return true;
+}
+
+// --- Écriture d'un lot ---
+void GroupCommit::commit(std::vector<CommitEntry>& batch) {
+    std::lock_guard<std::mutex> commitLock(commitMutex);
+    bool retry = retryPending.load(std::memory_order_relaxed);
+    if (batch.empty() && !retry) {
+        return;
+    }
+
+    // 1. Journal global : lignes restées en échec puis celles du lot, en un seul write (O_APPEND).
+    std::string lines;
+    lines.swap(journalBacklog);
+    for (const CommitEntry& entry : batch) {
+        if (entry.transaction) {
+            lines += entry.transaction->toCSVLine();
+        }
+    }
+    size_t journalBytes = 0;
+    bool journalFailed = false;
+    if (!lines.empty()) {
+        journalFailed = journalFd < 0 && !openJournal();
+        while (!journalFailed && journalBytes < lines.size()) {
+            ssize_t n = write(journalFd, lines.data() + journalBytes, lines.size() - journalBytes);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                LOG("GroupCommit::commit ERROR : Écriture du journal " + journalPath + " : " + std::string(strerror(errno)), "ERROR");
+                journalFailed = true;
+                break;
+            }
+            journalBytes += static_cast<size_t>(n);
+        }
+        if (journalFailed) {
+            journalBacklog = lines.substr(journalBytes); // Reprise au lot suivant, à partir du premier octet manquant
+        }
+    }
+
+    // 2. Portefeuilles modifiés (et ceux restés en échec) : un fichier temporaire par portefeuille pour tout le lot.
+    std::unordered_set<const Wallet*> attempted;
+    std::unordered_set<const Wallet*> failed;
+    std::vector<std::shared_ptr<Wallet>> written;
+    std::vector<std::shared_ptr<Wallet>> toRetry;
+    toRetry.swap(failedWallets);
+    auto fail = [&](const std::shared_ptr<Wallet>& wallet) {
+        failed.insert(wallet.get());
+        failedWallets.push_back(wallet);
+    };
+    auto write = [&](const std::shared_ptr<Wallet>& wallet) {
+        if (!wallet || !attempted.insert(wallet.get()).second) {
+            return;
+        }
+        std::lock_guard<std::mutex> walletLock(wallet->getMutex());
+        if (wallet->writeTemporaryFile()) { // Loggue lui-même la cause d'un échec
+            written.push_back(wallet);
+        } else {
+            fail(wallet);
+        }
+    };
+    for (const std::shared_ptr<Wallet>& wallet : toRetry) {
+        write(wallet);
+    }
+    for (const CommitEntry& entry : batch) {
+        write(entry.wallet);
+    }
+
+    // 3. Une seule mise sur disque pour le journal et les fichiers temporaires, si le lot a écrit quelque chose.
+    bool synced = false;
+    if (config.sync && (journalBytes > 0 || !written.empty())) {
+        int rc = journalFd >= 0 ? syncfs(journalFd) : -1;
+        if (rc != 0) {
+            sync();
+        }
+        synced = true;
+    }
+
+    // 4. Renommages (contenu déjà sur disque), puis mise sur disque de leurs répertoires.
+    size_t walletWrites = 0;
+    std::vector<std::pair<std::string, std::vector<std::shared_ptr<Wallet>>>> directories;
+    for (const std::shared_ptr<Wallet>& wallet : written) {
+        bool published;
+        std::string directory;
+        {
+            std::lock_guard<std::mutex> walletLock(wallet->getMutex());
+            published = wallet->publishTemporaryFile();
+            directory = wallet->getDirectoryPath();
+        }
+        if (!published) {
+            fail(wallet);
+            continue;
+        }
+        auto it = std::find_if(directories.begin(), directories.end(), [&](const auto& d) { return d.first == directory; });
+        if (it == directories.end()) {
+            directories.emplace_back(directory, std::vector<std::shared_ptr<Wallet>>());
+            it = directories.end() - 1;
+        }
+        it->second.push_back(wallet);
+    }
+    for (const auto& directory : directories) {
+        if (config.sync && !Wallet::syncPath(directory.first, true)) {
+            for (const std::shared_ptr<Wallet>& wallet : directory.second) {
+                fail(wallet); // Renommage peut-être pas durable : portefeuille réécrit au lot suivant
+            }
+            continue;
+        }
+        walletWrites += directory.second.size();
+    }
+
+    // 5. Acquittements, dans l'ordre de soumission (retenus d'abord). Un client dont un portefeuille n'a pas pu
+    // être écrit est retenu en entier (ordre de ses résultats conservé) jusqu'à un lot où il l'est ; les
+    // autres clients ne l'attendent pas.
+    std::unordered_set<std::string> blockedClients;
+    for (const std::shared_ptr<Wallet>& wallet : failedWallets) {
+        blockedClients.insert(wallet->getClientId());
+    }
+    std::vector<CommitEntry> held;
+    auto acknowledge = [&](CommitEntry& entry) {
+        const std::string& client = !entry.clientId.empty() || !entry.wallet ? entry.clientId : entry.wallet->getClientId();
+        if (!client.empty() && blockedClients.count(client) != 0) {
+            held.push_back(std::move(entry));
+            return;
+        }
+        if (!entry.acknowledge) {
+            return;
+        }
+        try {
+            entry.acknowledge();
+        } catch (const std::exception& e) {
+            LOG("GroupCommit::commit ERROR : Exception lors d'un acquittement : " + std::string(e.what()), "ERROR");
+        } catch (...) {
+            LOG("GroupCommit::commit ERROR : Exception inconnue lors d'un acquittement.", "ERROR");
+        }
+    };
+    for (CommitEntry& entry : deferred) {
+        acknowledge(entry);
+    }
+    for (CommitEntry& entry : batch) {
+        acknowledge(entry);
+    }
+    deferred.swap(held);
+    retryPending.store(!deferred.empty() || !failedWallets.empty() || !journalBacklog.empty(), std::memory_order_release);
+    if (!failed.empty()) {
+        LOG("GroupCommit::commit ERROR : " + std::to_string(failed.size()) + " portefeuille(s) non écrit(s) : " + std::to_string(deferred.size())
+            + " acquittement(s) de " + std::to_string(blockedClients.size()) + " client(s) retenu(s) jusqu'à leur réécriture.", "ERROR");
+    } else if (retry && !retryPending.load(std::memory_order_relaxed)) {
+        LOG("GroupCommit::commit INFO : Écritures en échec reprises avec succès, acquittements retenus envoyés.", "INFO");
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    stats.batches++;
+    stats.entries += batch.size();
+    stats.walletWrites += walletWrites;
+    stats.walletWriteFailures += failed.size();
+    stats.journalWriteFailures += journalFailed ? 1 : 0;
+    stats.syncs += synced ? 1 : 0;
+    stats.largestBatch = std::max(stats.largestBatch, batch.size());
+}
@@ -0,0 +1,411 @@
+#include "../headers/HotUpgrade.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sstream>
+
+
+// Nombre maximal de descripteurs transmis (un par shard d'écoute).
+static constexpr size_t MAX_HANDOFF_FDS = 64;
+// Longueur maximale d'une ligne échangée (identifiant de client compris).
+static constexpr size_t MAX_LINE = 4096;
+
+// Remplit une adresse de socket Unix. Retourne false si le chemin est trop long.
+static bool makeUnixAddress(const std::string& path, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+
+// --- Constructeur / Destructeur ---
+HotUpgrade::HotUpgrade(const std::string& socketPath)
+    : path(socketPath),
+      listenFd(-1),
+      wakeFd(-1),
+      takeoverConn(-1),
+      running(false),
+      handedOff(false),
+      releaseConn(-1)
+{
+}
+
+HotUpgrade::~HotUpgrade() {
+    stop();
+    if (takeoverConn != -1) {
+        ::close(takeoverConn);
+        takeoverConn = -1;
+    }
+}
+
+
+// ============================================================================
+// === Ancien processus : service des demandes de reprise ===
+// ============================================================================
+
+bool HotUpgrade::startListening(Callbacks handoffCallbacks) {
+    if (running.load()) {
+        return true;
+    }
+    callbacks = std::move(handoffCallbacks);
+
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd == -1 || !openListener()) {
+        LOG("HotUpgrade::startListening ERROR : Impossible de créer le socket de mise à jour '" + path + "'. Erreur: " + std::string(strerror(errno)), "ERROR");
+        closeListener();
+        if (wakeFd != -1) { ::close(wakeFd); wakeFd = -1; }
+        return false;
+    }
+
+    running.store(true);
+    thread = std::thread(&HotUpgrade::listenLoop, this);
+    LOG("HotUpgrade::startListening INFO : En attente de demandes de mise à jour à chaud sur '" + path + "'.", "INFO");
+    return true;
+}
+
+void HotUpgrade::stop() {
+    if (running.exchange(false) && wakeFd != -1) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+    // Nouveau processus : débloquer la lecture des RELEASE.
+    if (releaseThread.joinable()) {
+        ::shutdown(takeoverConn, SHUT_RDWR);
+        releaseThread.join();
+    }
+    closeListener();
+    if (wakeFd != -1) {
+        ::close(wakeFd);
+        wakeFd = -1;
+    }
+}
+
+bool HotUpgrade::hasHandedOff() const {
+    return handedOff.load();
+}
+
+bool HotUpgrade::openListener() {
+    sockaddr_un addr;
+    if (!makeUnixAddress(path, addr)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd == -1) {
+        return false;
+    }
+    ::unlink(path.c_str()); // Fichier laissé par un processus précédent (le chemin est libéré avant toute reprise).
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 || chmod(path.c_str(), 0600) == -1 || listen(listenFd, 4) == -1) {
+        int saved = errno;
+        ::close(listenFd);
+        listenFd = -1;
+        errno = saved;
+        return false;
+    }
+    return true;
+}
+
+// Ferme le socket Unix et libère son chemin (seulement s'il nous appartient encore).
+void HotUpgrade::closeListener() {
+    if (listenFd != -1) {
+        ::close(listenFd);
+        listenFd = -1;
+        ::unlink(path.c_str());
+    }
+}
+
+void HotUpgrade::listenLoop() {
+    while (running.load()) {
+        if (listenFd == -1 && !openListener()) {
+            LOG("HotUpgrade::listenLoop ERROR : Impossible de recréer le socket de mise à jour '" + path + "'. Mise à jour à chaud indisponible. Erreur: " + std::string(strerror(errno)), "ERROR");
+            break;
+        }
+
+        pollfd fds[2] = {{listenFd, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            LOG("HotUpgrade::listenLoop ERROR : poll a échoué. Erreur: " + std::string(strerror(errno)), "ERROR");
+            break;
+        }
+        if (fds[1].revents != 0) {
+            break; // stop()
+        }
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        int conn = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (conn == -1) {
+            continue;
+        }
+        bool confirmed = serveTakeover(conn);
+        if (confirmed) {
+            // 'conn' reste ouverte (releaseConn) pour les RELEASE.
+            handedOff.store(true);
+            LOG("HotUpgrade::listenLoop INFO : Reprise confirmée par le nouveau processus. Arrêt de l'acceptation et vidange des sessions.", "INFO");
+            if (callbacks.handoff) {
+                callbacks.handoff();
+            }
+            break;
+        }
+        ::close(conn);
+        // Échec : le chemin a pu être libéré pendant l'échange ; il est recréé au tour suivant.
+    }
+}
+
+bool HotUpgrade::serveTakeover(int conn) {
+    // Seul un processus du même utilisateur peut prendre les sockets d'écoute.
+    ucred peer{};
+    socklen_t peer_len = sizeof(peer);
+    if (getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &peer, &peer_len) == -1 || peer.uid != getuid()) {
+        LOG("HotUpgrade::serveTakeover WARNING : Demande de reprise refusée (uid du pair différent ou inconnu).", "WARNING");
+        return false;
+    }
+    setTimeout(conn, TAKEOVER_TIMEOUT_MS);
+
+    std::string buffer;
+    std::string request;
+    if (!receiveLine(conn, buffer, request, nullptr) || request != "TAKEOVER 2") {
+        LOG("HotUpgrade::serveTakeover WARNING : Demande de reprise invalide : '" + request + "'.", "WARNING");
+        return false;
+    }
+    LOG("HotUpgrade::serveTakeover INFO : Demande de reprise reçue (pid " + std::to_string(peer.pid) + ").", "INFO");
+
+    // À partir d'ici, toute sortie sans READY rend la main à l'ancien processus (abort).
+    auto fail = [&]() {
+        {
+            std::lock_guard<std::mutex> lock(releaseMutex);
+            releaseConn = -1;
+        }
+        if (callbacks.abort) {
+            callbacks.abort();
+        }
+        return false;
+    };
+    Handoff handoff = callbacks.prepare ? callbacks.prepare() : Handoff();
+    if (handoff.listenSockets.empty() || handoff.listenSockets.size() > MAX_HANDOFF_FDS) {
+        sendLine(conn, "ERROR no listen sockets\n");
+        return fail();
+    }
+
+    // Libérer le chemin AVANT l'envoi : le nouveau processus y créera son propre socket après READY.
+    closeListener();
+    bool sent;
+    {
+        // Sous releaseMutex : un Wallet détruit pendant l'envoi attend, son RELEASE suit donc son LEASE.
+        std::lock_guard<std::mutex> lock(releaseMutex);
+        releaseConn = conn;
+        std::vector<std::string> leases = callbacks.leasedAccounts ? callbacks.leasedAccounts() : std::vector<std::string>();
+        sent = sendLine(conn, "LISTEN " + std::to_string(handoff.listenSockets.size()) + " " + std::to_string(leases.size()) + " "
+                        + std::to_string(handoff.transactionCounter) + "\n", handoff.listenSockets);
+        for (size_t i = 0; sent && i < leases.size(); ++i) {
+            sent = sendLine(conn, "LEASE " + leases[i] + "\n");
+        }
+        LOG("HotUpgrade::serveTakeover INFO : " + std::to_string(leases.size()) + " compte(s) encore tenu(s) par ce processus transmis au nouveau.", "INFO");
+    }
+    if (!sent) {
+        LOG("HotUpgrade::serveTakeover ERROR : Échec de l'envoi des sockets d'écoute. Erreur: " + std::string(strerror(errno)), "ERROR");
+        return fail();
+    }
+
+    std::string ready;
+    if (!receiveLine(conn, buffer, ready, nullptr) || ready != "READY") {
+        LOG("HotUpgrade::serveTakeover WARNING : Le nouveau processus n'a pas confirmé la reprise. Poursuite normale.", "WARNING");
+        return fail();
+    }
+    return true;
+}
+
+void HotUpgrade::releaseAccount(const std::string& clientId) {
+    std::lock_guard<std::mutex> lock(releaseMutex);
+    if (releaseConn == -1) {
+        return;
+    }
+    if (!sendLine(releaseConn, "RELEASE " + clientId + "\n")) {
+        LOG("HotUpgrade::releaseAccount WARNING : RELEASE non transmis pour '" + clientId + "' (rendu à la fin de ce processus). Erreur: " + std::string(strerror(errno)), "WARNING");
+    }
+}
+
+
+// ============================================================================
+// === Nouveau processus : reprise des sockets d'écoute ===
+// ============================================================================
+
+bool HotUpgrade::requestHandoff(Handoff& handoff, int timeoutMs) {
+    handoff = Handoff();
+    sockaddr_un addr;
+    if (!makeUnixAddress(path, addr)) {
+        return false;
+    }
+    int conn = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (conn == -1) {
+        return false;
+    }
+    if (connect(conn, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+        LOG("HotUpgrade::requestListenSockets WARNING : Aucun serveur en écoute sur '" + path + "'. Erreur: " + std::string(strerror(errno)), "WARNING");
+        ::close(conn);
+        return false;
+    }
+    setTimeout(conn, timeoutMs);
+
+    std::string response;
+    std::vector<int> fds;
+    takeoverBuffer.clear();
+    bool ok = sendLine(conn, "TAKEOVER 2\n") && receiveLine(conn, takeoverBuffer, response, &fds);
+    size_t announced = 0;
+    size_t leases = 0;
+    if (ok && response.rfind("LISTEN ", 0) == 0) {
+        std::istringstream fields(response.substr(7));
+        ok = static_cast<bool>(fields >> announced >> leases >> handoff.transactionCounter);
+    }
+    for (size_t i = 0; ok && i < leases; ++i) {
+        std::string lease;
+        ok = receiveLine(conn, takeoverBuffer, lease, &fds) && lease.rfind("LEASE ", 0) == 0;
+        if (ok) {
+            handoff.leasedAccounts.push_back(lease.substr(6));
+        }
+    }
+    if (!ok || announced == 0 || announced != fds.size()) {
+        LOG("HotUpgrade::requestListenSockets ERROR : Reprise refusée ou incomplète (réponse '" + response + "', " + std::to_string(fds.size()) + " descripteurs).", "ERROR");
+        for (int fd : fds) ::close(fd);
+        ::close(conn);
+        return false;
+    }
+
+    takeoverConn = conn; // Gardée ouverte : READY, puis les RELEASE.
+    handoff.listenSockets = std::move(fds);
+    LOG("HotUpgrade::requestHandoff INFO : " + std::to_string(handoff.listenSockets.size()) + " sockets d'écoute reçus de l'ancien processus, "
+        + std::to_string(handoff.leasedAccounts.size()) + " compte(s) encore tenu(s), compteur " + std::to_string(handoff.transactionCounter) + ".", "INFO");
+    return true;
+}
+
+bool HotUpgrade::confirmTakeover(ReleaseHandler onRelease) {
+    if (takeoverConn == -1) {
+        return false;
+    }
+    if (!sendLine(takeoverConn, "READY\n")) {
+        ::close(takeoverConn);
+        takeoverConn = -1;
+        return false;
+    }
+    setTimeout(takeoverConn, 0); // Les RELEASE arrivent pendant toute la vidange de l'ancien processus
+    releaseThread = std::thread(&HotUpgrade::releaseLoop, this, std::move(onRelease));
+    return true;
+}
+
+void HotUpgrade::releaseLoop(ReleaseHandler onRelease) {
+    std::string line;
+    while (receiveLine(takeoverConn, takeoverBuffer, line, nullptr)) {
+        if (line.rfind("RELEASE ", 0) == 0 && onRelease) {
+            onRelease(line.substr(8));
+        }
+    }
+    // Fermeture : l'ancien processus est terminé (ou ce processus s'arrête), plus aucun compte n'est tenu.
+    LOG("HotUpgrade::releaseLoop INFO : Connexion avec l'ancien processus fermée. Tous les comptes sont rendus.", "INFO");
+    if (onRelease) {
+        onRelease(std::string());
+    }
+}
+
+
+// ============================================================================
+// === Échange de lignes (et de descripteurs) sur le socket Unix ===
+// ============================================================================
+
+bool HotUpgrade::sendLine(int fd, const std::string& line, const std::vector<int>& fds) {
+    iovec iov{const_cast<char*>(line.data()), line.size()};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_HANDOFF_FDS)];
+    if (!fds.empty()) {
+        size_t fds_size = sizeof(int) * fds.size();
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(fds_size);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(fds_size);
+        std::memcpy(CMSG_DATA(cmsg), fds.data(), fds_size);
+    }
+
+    ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+    return sent == static_cast<ssize_t>(line.size());
+}
+
+bool HotUpgrade::receiveLine(int fd, std::string& pending, std::string& line, std::vector<int>* fds) {
+    line.clear();
+    char buffer[512];
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_HANDOFF_FDS)];
+
+    while (true) {
+        size_t newline = pending.find('\n');
+        if (newline != std::string::npos) {
+            line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            return true;
+        }
+        if (pending.size() >= MAX_LINE) {
+            return false; // Ligne trop longue.
+        }
+        iovec iov{buffer, sizeof(buffer)};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        ssize_t received = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return false;
+        }
+
+        // Descripteurs joints : conservés si l'appelant les attend, fermés sinon.
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+                continue;
+            }
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (size_t i = 0; i < count; ++i) {
+                int received_fd;
+                std::memcpy(&received_fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+                if (fds) {
+                    fds->push_back(received_fd);
+                } else {
+                    ::close(received_fd);
+                }
+            }
+        }
+
+        pending.append(buffer, static_cast<size_t>(received));
+    }
+}
+
+void HotUpgrade::setTimeout(int fd, int timeoutMs) {
+    timeval tv{};
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
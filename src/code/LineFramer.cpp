@@ -0,0 +1,152 @@
+#include "../headers/LineFramer.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+// Plus petite puissance de 2 supérieure ou égale à 'value'.
+static size_t roundUpPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+
+// --- Constructeur ---
+LineFramer::LineFramer(size_t capacity, size_t maxLineLength)
+    : ring(roundUpPowerOfTwo(std::max(capacity, maxLineLength + 1))),
+      mask(ring.size() - 1),
+      maxLine(maxLineLength),
+      scratch(maxLineLength)
+{
+}
+
+// --- Libération de la dernière ligne retournée ---
+void LineFramer::releaseConsumed() {
+    if (consumedUpTo > head) {
+        head = consumedUpTo;
+    }
+    if (head == tail) {
+        // Buffer vide : repartir du début maximise la zone contiguë disponible pour la prochaine lecture.
+        head = tail = scanned = consumedUpTo = 0;
+    }
+}
+
+// --- Zone d'écriture contiguë ---
+char* LineFramer::writePtr() {
+    releaseConsumed();
+    return ring.data() + (tail & mask);
+}
+
+size_t LineFramer::writableSize() {
+    releaseConsumed();
+    size_t used = static_cast<size_t>(tail - head);
+    size_t free_space = ring.size() - used;
+    size_t until_end = ring.size() - static_cast<size_t>(tail & mask);
+    return std::min(free_space, until_end);
+}
+
+void LineFramer::commitWrite(size_t count) {
+    tail += count;
+}
+
+// --- Copie d'octets (ex: reliquat lu pendant l'authentification) ---
+bool LineFramer::append(const char* data, size_t size) {
+    releaseConsumed();
+    if (size > ring.size() - static_cast<size_t>(tail - head)) {
+        return false;
+    }
+    while (size > 0) {
+        size_t chunk = std::min(size, ring.size() - static_cast<size_t>(tail & mask));
+        std::memcpy(ring.data() + (tail & mask), data, chunk);
+        tail += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+// --- Extraction de la prochaine ligne ---
+LineFramer::Status LineFramer::nextLine(std::string_view& line) {
+    releaseConsumed();
+
+    // Recherche de '\n' à partir du dernier octet examiné, segment contigu par segment contigu.
+    while (scanned < tail) {
+        size_t offset = static_cast<size_t>(scanned & mask);
+        size_t chunk = std::min(static_cast<size_t>(tail - scanned), ring.size() - offset);
+        const char* start = ring.data() + offset;
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', chunk));
+        if (!newline) {
+            scanned += chunk;
+            continue;
+        }
+
+        uint64_t newline_pos = scanned + static_cast<uint64_t>(newline - start);
+        size_t length = static_cast<size_t>(newline_pos - head);
+        if (length > maxLine) {
+            return Status::LINE_TOO_LONG;
+        }
+
+        size_t line_offset = static_cast<size_t>(head & mask);
+        if (line_offset + length <= ring.size()) {
+            line = std::string_view(ring.data() + line_offset, length);
+        } else {
+            // La ligne chevauche la fin du buffer : la reconstituer dans le tampon de travail.
+            size_t first = ring.size() - line_offset;
+            std::memcpy(scratch.data(), ring.data() + line_offset, first);
+            std::memcpy(scratch.data() + first, ring.data(), length - first);
+            line = std::string_view(scratch.data(), length);
+        }
+        scanned = newline_pos + 1;
+        consumedUpTo = newline_pos + 1;
+        return Status::LINE;
+    }
+
+    if (tail - head > maxLine) {
+        return Status::LINE_TOO_LONG;
+    }
+    return Status::NEED_MORE;
+}
+
+// --- Blocs de taille fixe ---
+bool LineFramer::peek(char* destination, size_t size) {
+    releaseConsumed();
+    if (tail - head < size) {
+        return false;
+    }
+    size_t offset = static_cast<size_t>(head & mask);
+    size_t first = std::min(size, ring.size() - offset);
+    std::memcpy(destination, ring.data() + offset, first);
+    std::memcpy(destination + first, ring.data(), size - first);
+    return true;
+}
+
+bool LineFramer::nextBlock(size_t size, std::string_view& block) {
+    releaseConsumed();
+    if (size > maxLine || tail - head < size) {
+        return false;
+    }
+    size_t offset = static_cast<size_t>(head & mask);
+    if (offset + size <= ring.size()) {
+        block = std::string_view(ring.data() + offset, size);
+    } else {
+        // Le bloc chevauche la fin du buffer : le reconstituer dans le tampon de travail.
+        size_t first = ring.size() - offset;
+        std::memcpy(scratch.data(), ring.data() + offset, first);
+        std::memcpy(scratch.data() + first, ring.data(), size - first);
+        block = std::string_view(scratch.data(), size);
+    }
+    consumedUpTo = head + size;
+    // Les octets du bloc ne doivent pas être réexaminés par nextLine().
+    if (scanned < consumedUpTo) {
+        scanned = consumedUpTo;
+    }
+    return true;
+}
+
+size_t LineFramer::buffered() const {
+    uint64_t start = std::max(head, consumedUpTo);
+    return static_cast<size_t>(tail - start);
+}
@@ -0,0 +1,57 @@
+#include "../headers/LowLatency.h"
+#include "../headers/Logger.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+namespace LowLatency {
+
+void configureSocket(int fd, bool tcpNoDelay, int busyPollMicros) {
+    if (tcpNoDelay) {
+        int one = 1;
+        if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) < 0) {
+            LOG("LowLatency::configureSocket WARNING : setsockopt(TCP_NODELAY) a échoué pour socket FD " + std::to_string(fd) + ". Erreur: " + std::string(strerror(errno)), "WARNING");
+        }
+    }
+#ifdef SO_BUSY_POLL
+    if (busyPollMicros > 0 && setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busyPollMicros, sizeof(busyPollMicros)) < 0) {
+        // Même cause pour toutes les connexions (droits, noyau) : un seul message.
+        static std::atomic<bool> warned{false};
+        if (!warned.exchange(true)) {
+            LOG("LowLatency::configureSocket WARNING : setsockopt(SO_BUSY_POLL, " + std::to_string(busyPollMicros) + " us) refusé. Erreur: " + std::string(strerror(errno)) + ". Busy polling désactivé (CAP_NET_ADMIN ou sysctl net.core.busy_read requis).", "WARNING");
+        }
+    }
+#else
+    (void)busyPollMicros;
+#endif
+}
+
+bool pinCurrentThread(int cpu, const std::string& threadName) {
+    if (cpu < 0) {
+        return true;
+    }
+    long cpu_count = sysconf(_SC_NPROCESSORS_CONF);
+    if (cpu >= CPU_SETSIZE || (cpu_count > 0 && cpu >= cpu_count)) {
+        LOG("LowLatency::pinCurrentThread WARNING : Coeur " + std::to_string(cpu) + " inexistant (" + std::to_string(cpu_count) + " coeurs). Thread " + threadName + " non épinglé.", "WARNING");
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        LOG("LowLatency::pinCurrentThread WARNING : Épinglage du thread " + threadName + " sur le coeur " + std::to_string(cpu) + " impossible. Erreur: " + std::string(strerror(rc)), "WARNING");
+        return false;
+    }
+    LOG("LowLatency::pinCurrentThread INFO : Thread " + threadName + " épinglé sur le coeur " + std::to_string(cpu) + ".", "INFO");
+    return true;
+}
+
+} // namespace LowLatency
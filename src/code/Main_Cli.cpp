@@ -8,6 +8,8 @@
 #include <cstring>      
 #include <algorithm>   
 #include <cerrno>       
+#include <sstream>
+#include <fstream>
 
 #include <openssl/ssl.h>   
 #include <openssl/err.h>   
@@ -19,6 +21,7 @@
 #include "../headers/Utils.h"            
 #include "../headers/Transaction.h"      
 #include "../headers/OpenSSLDeleters.h" 
+#include "../headers/BinaryProtocol.h"
 
 
 // Constantes et macros
@@ -65,7 +68,9 @@ void start_command_loop(std::shared_ptr<ServerConnection> connection) {
             continue;
         }
 
-        bool is_trading_command = (command.rfind("BUY", 0) == 0 || command.rfind("SELL", 0) == 0); // Vérifie si c'est une commande de trading
+        // Ordres à cours limité et annulations : "OK:", un éventuel TRANSACTION_RESULT, puis ORDER_STATUS.
+        bool is_order_command = (command.rfind("LIMIT", 0) == 0 || command.rfind("IOC", 0) == 0 || command.rfind("FOK", 0) == 0 || command.rfind("CANCEL", 0) == 0);
+        bool is_trading_command = (command.rfind("BUY", 0) == 0 || command.rfind("SELL", 0) == 0 || is_order_command); // Vérifie si c'est une commande de trading
         bool is_quit_command = (command == "QUIT");
 
         // Envoyer la commande au serveur.
@@ -98,9 +103,38 @@ void start_command_loop(std::shared_ptr<ServerConnection> connection) {
                  goto exit_reception_loop; // Utilisation d'un goto pour sortir proprement des boucles imbriquées
             }
 
+            // Heartbeat du serveur : répondre sans l'afficher ni le traiter comme une réponse.
+            if (serverResponse == "PING") {
+                connection->send("PONG\n");
+                continue;
+            }
+            // Prix poussé par un abonnement (SUBSCRIBE PRICE) : affiché, mais ce n'est pas la réponse attendue.
+            // Exécution d'un ordre au repos (ORDER_FILL) : peut arriver à tout moment, même chose.
+            if (serverResponse.rfind("PRICE_UPDATE ", 0) == 0 || serverResponse.rfind("ORDER_FILL ", 0) == 0) {
+                std::cout << "~ " << serverResponse << "\n";
+                continue;
+            }
+
             // Afficher la réponse reçue
             std::cout << "< " << serverResponse << "\n";
 
+            // Export : l'en-tête annonce le nombre de lignes CSV qui suivent, enregistrées dans un fichier.
+            if (serverResponse.rfind("EXPORT TRANSACTIONS ", 0) == 0) {
+                std::istringstream header(serverResponse.substr(20));
+                size_t export_bytes = 0, export_lines = 0;
+                header >> export_bytes >> export_lines;
+                std::ofstream export_file("transactions_export.csv", std::ios::trunc);
+                try {
+                    for (size_t i = 0; i < export_lines; ++i) {
+                        export_file << connection->receiveLine() << "\n";
+                    }
+                } catch (const std::exception& e) {
+                    LOG("Main_Cli ERROR : Export interrompu. Exception: " + std::string(e.what()), "ERROR");
+                    goto exit_reception_loop;
+                }
+                std::cout << "< (" << export_lines << " lignes, " << export_bytes << " octets enregistrés dans transactions_export.csv)\n";
+            }
+
             // --- Logique pour arrêter la réception ---
 
             // Cas 1 : La commande n'était pas de trading. On attend une seule réponse.
@@ -119,9 +153,17 @@ void start_command_loop(std::shared_ptr<ServerConnection> connection) {
             }
             // Vérifier si cette réponse est le résultat final "TRANSACTION_RESULT..."
             else if (serverResponse.rfind("TRANSACTION_RESULT", 0) == 0) {
-                // C'est le message final attendu pour une commande de trading.
+                // C'est le message final attendu pour une commande de trading (un ordre LIMIT/IOC/FOK
+                // exécuté attend encore son ORDER_STATUS).
+                if (is_order_command) {
+                    continue;
+                }
                 break; // Sort de la boucle de réception après le message final
             }
+            // Statut d'un ordre à cours limité ou d'une annulation : message final.
+            else if (serverResponse.rfind("ORDER_STATUS", 0) == 0) {
+                break;
+            }
             // Si ce n'est NI "OK:..." NI "TRANSACTION_RESULT...",
             // c'est probablement un message d'erreur (comme "ERROR: Manual trading...")
             // ou un message inattendu. Dans ce cas, cette réponse est la réponse finale.
@@ -156,6 +198,100 @@ void start_command_loop(std::shared_ptr<ServerConnection> connection) {
     // La connexion sera fermée après la sortie de cette fonction, dans le main().
 }
 
+// --- Boucle de Commandes Interactive (protocole binaire) ---
+// Même syntaxe de commandes que la boucle texte, mais chaque commande est encodée en trame binaire
+// (BinaryProtocol) et les trames reçues sont affichées sous forme lisible.
+// Commandes supportées : BUY|SELL <Currency> <Percentage>, GET_PRICE <symbol>, SHOW WALLET|TRANSACTIONS, QUIT.
+void start_binary_command_loop(std::shared_ptr<ServerConnection> connection) {
+    std::cout << "Connecté (protocole binaire). Entrez vos commandes (tapez 'QUIT' pour déconnecter) :\n";
+    std::string command;
+    uint64_t next_request_id = 1;
+
+    while (connection && connection->isConnected()) {
+        std::cout << "> ";
+        if (!std::getline(std::cin, command)) {
+            LOG("Main_Cli INFO : Échec de lecture de la commande (stdin) ou fin de fichier. Déconnexion.", "INFO");
+            break;
+        }
+
+        std::istringstream words(command);
+        std::string verb, argument;
+        words >> verb >> argument;
+        std::transform(verb.begin(), verb.end(), verb.begin(), ::toupper);
+        std::transform(argument.begin(), argument.end(), argument.begin(), ::toupper);
+        if (verb.empty()) {
+            continue;
+        }
+
+        // --- Encodage de la commande ---
+        uint64_t request_id = next_request_id++;
+        std::string frame;
+        bool is_trading_command = false;
+        if (verb == "BUY" || verb == "SELL") {
+            double percentage = 0.0;
+            if (!(words >> percentage)) {
+                std::cout << "Usage: " << verb << " <Currency> <Percentage>\n";
+                continue;
+            }
+            BinaryProtocol::encodeOrder(frame, verb == "BUY" ? BinaryProtocol::MessageType::BUY : BinaryProtocol::MessageType::SELL, request_id, argument, percentage);
+            is_trading_command = true;
+        } else if (verb == "GET_PRICE") {
+            BinaryProtocol::encodeGetPrice(frame, request_id, argument);
+        } else if (verb == "SHOW" && (argument == "WALLET" || argument == "TRANSACTIONS")) {
+            BinaryProtocol::encodeShow(frame, request_id, argument == "WALLET" ? BinaryProtocol::ShowTarget::WALLET : BinaryProtocol::ShowTarget::TRANSACTIONS);
+        } else if (verb == "QUIT") {
+            BinaryProtocol::encodeQuit(frame, request_id);
+        } else {
+            std::cout << "Commande non supportée en mode binaire. Utilisez BUY/SELL <Currency> <Percentage>, GET_PRICE <symbol>, SHOW WALLET|TRANSACTIONS ou QUIT.\n";
+            continue;
+        }
+
+        try {
+            if (connection->send(frame) <= 0) {
+                LOG("Main_Cli ERROR : Échec de l'envoi de la trame binaire pour la commande '" + command + "'.", "ERROR");
+                break;
+            }
+        } catch (const std::exception& e) {
+            LOG("Main_Cli ERROR : Exception lors de l'envoi de la trame binaire pour la commande '" + command + "'. Exception: " + std::string(e.what()), "ERROR");
+            break;
+        }
+        if (verb == "QUIT") {
+            break;
+        }
+
+        // --- Réception : jusqu'à la réponse finale portant l'identifiant de la commande ---
+        // (ACK puis TRANSACTION_RESULT pour un BUY/SELL accepté, une seule trame sinon).
+        try {
+            while (connection && connection->isConnected()) {
+                BinaryProtocol::FrameHeader header;
+                std::string_view body;
+                connection->receiveFrame(header, body);
+                if (header.type == BinaryProtocol::MessageType::PING) {
+                    // Heartbeat du serveur : répondre sans l'afficher.
+                    std::string pong;
+                    BinaryProtocol::encodeHeartbeat(pong, BinaryProtocol::MessageType::PONG, header.requestId);
+                    connection->send(pong);
+                    continue;
+                }
+                std::cout << "< " << BinaryProtocol::describe(header, body) << "\n";
+
+                if (header.requestId != request_id) {
+                    continue; // Trame d'une autre requête (ex: résultat d'un ordre du bot).
+                }
+                if (is_trading_command && header.type == BinaryProtocol::MessageType::ACK) {
+                    continue; // Accusé de soumission : attendre le TRANSACTION_RESULT.
+                }
+                break;
+            }
+        } catch (const std::exception& e) {
+            LOG("Main_Cli ERROR : Échec de la réception d'une trame binaire. Exception: " + std::string(e.what()), "ERROR");
+            break;
+        }
+    }
+
+    LOG("Main_Cli INFO : Sortie de la boucle de commande (protocole binaire).", "INFO");
+}
+
 // --- Fonction main : Point d'entrée du programme client ---
 int main(int argc, char* argv[]) {
     // Configuration initiale du Logger (si non fait dans son constructeur ou init)
@@ -164,9 +300,10 @@ int main(int argc, char* argv[]) {
 
     // --- Parsing des arguments de ligne de commande ---
     // Le client attend 4 arguments SUPPLÉMENTAIRES après le nom de l'exécutable (argv[0]):
-    // <server_host> <server_port> <client_id> <client_token>
-    if (argc != 5) {
-        std::cerr << "Usage: " << argv[0] << " <server_host> <server_port> <client_id> <client_token>\n";
+    // <server_host> <server_port> <client_id> <client_token> [--binary]
+    bool use_binary_protocol = (argc == 6 && std::string(argv[5]) == "--binary");
+    if (argc != 5 && !use_binary_protocol) {
+        std::cerr << "Usage: " << argv[0] << " <server_host> <server_port> <client_id> <client_token> [--binary]\n";
         LOG("Main_Cli ERROR : Nombre d'arguments incorrect. Attendu 4 (host, port, id, token), reçu " + std::to_string(argc - 1) + ".", "ERROR");
         return EXIT_FAILURE;
     }
@@ -257,8 +394,16 @@ int main(int argc, char* argv[]) {
             LOG("Main_Cli INFO : Authentification/enregistrement réussi(e).", "INFO");
             // Le client est authentifié, on peut passer à la boucle de commandes interactive.
 
-            // Lancer la boucle interactive de commandes.
-            start_command_loop(connection); // Appel de la fonction qui gère l'invite et les commandes.
+            // Lancer la boucle interactive de commandes (texte, ou binaire si demandé et accepté par le serveur).
+            if (use_binary_protocol) {
+                if (clientInitiator.EnableBinaryProtocol(*connection)) {
+                    start_binary_command_loop(connection);
+                } else {
+                    std::cerr << "Le serveur a refusé le protocole binaire." << std::endl;
+                }
+            } else {
+                start_command_loop(connection); // Appel de la fonction qui gère l'invite et les commandes.
+            }
 
             // Lorsque start_command_loop se termine (par QUIT ou erreur réseau),
             // la connexion sera fermée après (voir code ci-dessous).
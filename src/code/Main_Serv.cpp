@@ -7,6 +7,7 @@
 #include <vector>   
 #include <stdexcept> 
 #include <memory>   
+#include <csignal>  // Pour ignorer SIGPIPE
 
 // --- Initialisation globale OpenSSL ---
 void initialize_openssl() {
@@ -25,9 +26,12 @@ TransactionQueue txQueue; // Unique instance de la file de transactions globale.
 
 
 // --- Fonction main : Point d'entrée du programme serveur ---
-int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
+int main(int argc, char* argv[]) {
     LOG("Main_Serv INFO : Démarrage du programme serveur (config hardcodée).", "INFO");
 
+    // Un client qui ferme avant notre close_notify (reconnexions rapides, reprise de session) ne doit pas tuer le serveur.
+    signal(SIGPIPE, SIG_IGN);
+
     // --- Configuration Hardcodée ---
     int port = 4433; // Port d'écoute hardcodé
     std::string certFile = "../server.crt"; // Chemin du certificat hardcodé
@@ -37,6 +41,49 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
     std::string transactionHistoryFile = "../src/data/global_transactions.csv"; // Chemin historique hardcodé
     std::string walletsDir = "../src/data/wallets/"; // Répertoire portefeuilles hardcodé
 
+    ServerOptions options; // Options d'exécution (voir Server.h)
+    options.useReactor = true;     // Réacteur epoll ; false = un thread par session (repli)
+    options.reactorIoThreads = 0;  // 0 = nombre de coeurs
+    options.txQueueShards = 0;     // Shards de la TransactionQueue, ordres répartis par client (0 = nombre de coeurs)
+    options.groupCommit.intervalMicros = 1000; // Group commit : attente max. d'un lot avant écriture
+    options.groupCommit.maxBatch = 512;        // ... ou dès qu'il atteint cette taille
+    options.groupCommit.sync = true;           // Lot mis sur disque (syncfs) avant d'acquitter les clients
+    options.listenerShards = 0;    // Shards d'écoute SO_REUSEPORT (0 = un par coeur)
+    options.handshakeThreads = 0;  // Threads de handshake TLS par shard (0 = coeurs / shards)
+    options.handshakeTimeoutMs = 10000;
+    options.executorThreads = 0;   // Workers des tâches de connexion (0 = max(4, coeurs))
+    options.idleTimeoutSec = 900;      // Fermeture des sessions inactives (0 = jamais)
+    options.heartbeatIntervalSec = 60; // PING après ce délai sans activité (0 = désactivé)
+    options.upgradeSocketPath = "upgrade.sock"; // Mise à jour à chaud : "./Test_Serv --upgrade" reprend les sockets d'écoute
+    options.drainTimeoutSec = 300;              // Durée maximale de vidange de l'ancien processus
+    options.kernelTls = false;                  // true : chiffrement TLS par le noyau (kTLS) et exports par sendfile
+    options.unixSocketPath = "trading.sock";    // Accès local en clair (bots, benchmarks) ; "" = désactivé
+    // options.unixPeerAccounts[getuid()] = "bot1"; // Compte ouvert sans mot de passe par cet UID (les autres l'exigent)
+    options.shmGateway = true;                  // "SHM ATTACH" sur le socket Unix : ordres en mémoire partagée
+    // Contrôle d'admission avant TLS (0 = pas de limite). Pas de limite par IP : les benchmarks viennent tous de 127.0.0.1.
+    options.admission.maxConnections = 20000;        // Connexions TLS ouvertes simultanément
+    options.admission.maxConnectionsPerIp = 0;
+    options.admission.acceptRatePerSec = 0;          // Seau à jetons sur accept() (ex: 2000, rafale acceptBurst)
+    options.admission.maxPendingConnections = 4096;  // Handshakes + authentifications en cours avant refus (surcharge)
+    // Profil faible latence : seul TCP_NODELAY est actif (gratuit). Le reste consomme du CPU et n'a de sens
+    // que sur une machine dont les coeurs sont réservés au serveur.
+    options.lowLatency.tcpNoDelay = true;
+    // options.lowLatency.busyPollMicros = 50;       // SO_BUSY_POLL (carte réseau physique, CAP_NET_ADMIN)
+    // options.lowLatency.txQueueCpu = 2;            // Épinglage des threads chauds (-1 = non épinglé) ; shard i de la TQ sur txQueueCpu + i
+    // options.lowLatency.priceThreadCpu = 3;
+    // options.lowLatency.ioThreadCpus = {4, 5};
+    // options.lowLatency.spinWaitMicros = 200;      // Attente active des files avant de dormir
+    // --upgrade : démarrer en reprenant les sockets d'écoute du serveur en cours (qui se vide puis s'arrête).
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--upgrade") {
+            options.takeOverListeners = true;
+        }
+    }
+    options.resumption.sessionTickets = true;          // Tickets de session (stateless)
+    options.resumption.ticketKeyRotationSec = 3600;    // Rotation des clés de tickets
+    options.resumption.sharedSessionStore = false;     // true = cache de sessions partagé (stateful) à la place des tickets
+    options.resumption.sessionStoreCapacity = 20000;
+
     LOG("Main_Serv INFO : Configuration chargée (hardcodée). Port: " + std::to_string(port) + ", Cert: " + certFile + ", Key: " + keyFile + ", Users: " + usersFile + ", Counter: " + transactionCounterFile + ", History: " + transactionHistoryFile + ", Wallets Dir: " + walletsDir, "INFO");
 
 
@@ -49,7 +96,7 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
     try {
         // Utilise les valeurs hardcodées pour créer l'objet Server.
         server = std::make_shared<Server>(port, certFile, keyFile, usersFile,
-                                          transactionCounterFile, transactionHistoryFile, walletsDir);
+                                          transactionCounterFile, transactionHistoryFile, walletsDir, options);
 
         LOG("Main_Serv INFO : Objet Server créé. Démarrage...", "INFO");
         server->StartServer(); // Cette méthode bloquera jusqu'à l'arrêt.
@@ -0,0 +1,241 @@
+#include "../headers/MatchingEngine.h"
+#include "../headers/Logger.h"
+#include "../headers/LowLatency.h"
+
+#include <optional>
+#include <utility>
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Le mot d'état d'une case d'achèvement sert directement de futex.
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free,
+              "EngineCompletion::state doit être un mot de 32 bits sans verrou");
+
+static uint32_t* futexWord(std::atomic<uint32_t>& state) {
+    return reinterpret_cast<uint32_t*>(&state);
+}
+
+MatchingEngine::MatchingEngine() : ring(RING_CAPACITY) {
+}
+
+MatchingEngine::~MatchingEngine() {
+    stop();
+}
+
+uint32_t MatchingEngine::addBook(const BookConfig& config) {
+    int existing = findBook(config.symbol);
+    if (existing >= 0) {
+        return static_cast<uint32_t>(existing);
+    }
+    books.push_back(std::make_unique<OrderBook>(config.symbol, config.tickSize, config.lotSize, config.levelCount, config.orderCapacity));
+    return static_cast<uint32_t>(books.size() - 1);
+}
+
+int MatchingEngine::findBook(const std::string& symbol) const {
+    for (size_t i = 0; i < books.size(); ++i) {
+        if (books[i]->getSymbol() == symbol) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool MatchingEngine::start() {
+    if (running.load(std::memory_order_acquire) || matcher.joinable()) {
+        LOG("MatchingEngine::start WARNING : Thread d'appariement déjà démarré.", "WARNING");
+        return false;
+    }
+    running.store(true, std::memory_order_release);
+    matcher = std::thread(&MatchingEngine::run, this);
+    LOG("MatchingEngine::start INFO : Thread d'appariement démarré (" + std::to_string(books.size()) + " carnet(s)).", "INFO");
+    return true;
+}
+
+void MatchingEngine::stop() {
+    running.store(false, std::memory_order_release);
+    { // Sous le verrou : le thread entre son test et son attente ne manque pas la notification
+        std::lock_guard<std::mutex> lock(mtx);
+    }
+    cv.notify_all();
+    if (matcher.joinable()) {
+        matcher.join();
+        MatchingEngineStats s = getStats();
+        LOG("MatchingEngine::stop INFO : Thread d'appariement arrêté. " + std::to_string(s.commands) + " commandes, "
+            + std::to_string(s.fills) + " exécutions, " + std::to_string(s.rejected) + " refus.", "INFO");
+    }
+}
+
+void MatchingEngine::submit(EngineCommand command) {
+    if (!running.load(std::memory_order_acquire)) {
+        apply(command);
+        return;
+    }
+    while (!ring.tryPush(std::move(command))) {
+        std::this_thread::yield();
+    }
+    if (ring.consumerNeedsWakeup()) {
+        { std::lock_guard<std::mutex> lock(mtx); }
+        cv.notify_one();
+    }
+}
+
+ExecutionReport MatchingEngine::execute(EngineCommand command) {
+    // Une commande attendue à la fois par thread : la case est libre dès que le rapport est publié.
+    thread_local EngineCompletion completion;
+    ExecutionReport report;
+    completion.report = &report;
+    completion.state.store(EngineCompletion::PENDING, std::memory_order_relaxed);
+    command.completion = &completion;
+    submit(std::move(command)); // Moteur arrêté : déjà traitée au retour
+    waitFor(completion);
+    return report;
+}
+
+// --- Achèvement d'une commande attendue ---
+// Thread d'appariement : rapport déjà écrit, publié par 'state' ; réveil (appel système) seulement si
+// l'appelant a fini son attente active.
+void MatchingEngine::complete(EngineCompletion& completion) {
+    if (completion.state.exchange(EngineCompletion::DONE, std::memory_order_acq_rel) == EngineCompletion::SLEEPING) {
+        syscall(SYS_futex, futexWord(completion.state), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+    }
+}
+
+void MatchingEngine::waitFor(EngineCompletion& completion) {
+    // Attente active seulement si le thread d'appariement peut tourner en même temps : sur un seul coeur,
+    // elle ne ferait que retarder la commande attendue.
+    static const int spinPolls = std::thread::hardware_concurrency() > 1 ? SPIN_POLLS : 0;
+    for (int polls = 0; polls < spinPolls; ++polls) {
+        if (completion.state.load(std::memory_order_acquire) == EngineCompletion::DONE) {
+            return;
+        }
+        LowLatency::cpuRelax();
+    }
+    uint32_t expected = EngineCompletion::PENDING;
+    if (!completion.state.compare_exchange_strong(expected, EngineCompletion::SLEEPING, std::memory_order_acq_rel)) {
+        return; // Publié entre-temps (DONE)
+    }
+    // Réveils parasites possibles : dormir tant que le mot vaut SLEEPING.
+    while (completion.state.load(std::memory_order_acquire) == EngineCompletion::SLEEPING) {
+        syscall(SYS_futex, futexWord(completion.state), FUTEX_WAIT_PRIVATE, EngineCompletion::SLEEPING, nullptr, nullptr, 0);
+    }
+}
+
+MatchingEngineStats MatchingEngine::getStats() const {
+    MatchingEngineStats s;
+    s.commands = commandCount.load(std::memory_order_relaxed);
+    s.fills = fillCount.load(std::memory_order_relaxed);
+    s.rejected = rejectCount.load(std::memory_order_relaxed);
+    return s;
+}
+
+// --- Thread d'appariement ---
+void MatchingEngine::run() {
+    LowLatency::pinCurrentThread(engineCpu, "MatchingEngine");
+    while (true) {
+        std::optional<EngineCommand> command = ring.tryPop();
+        if (command) {
+            apply(*command);
+            continue;
+        }
+        int polls = 0;
+        while (ring.empty() && running.load(std::memory_order_acquire) && ++polls < SPIN_POLLS) {
+            LowLatency::cpuRelax();
+        }
+        if (ring.empty()) {
+            if (!running.load(std::memory_order_acquire)) {
+                break; // Arrêt demandé, anneau vide
+            }
+            if (ring.prepareToSleep()) {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&] { return !ring.empty() || !running.load(std::memory_order_acquire); });
+                ring.wokeUp();
+            }
+        }
+    }
+}
+
+// --- Traitement d'une commande (thread d'appariement, ou appelant moteur arrêté) ---
+void MatchingEngine::apply(EngineCommand& command) {
+    // Rapport écrit directement dans l'objet de l'appelant (execute) ; sinon dans un rapport local ignoré.
+    ExecutionReport ignored;
+    ExecutionReport& report = command.completion ? *command.completion->report : ignored;
+    std::vector<Fill>* fills = command.completion ? &report.fills : nullptr;
+    uint64_t fillTotal = 0;
+    bool selfTrade = false;
+    auto collect = [fills, &fillTotal](const Fill& fill) {
+        fillTotal++;
+        if (fills) fills->push_back(fill);
+    };
+
+    if (command.book >= books.size()) {
+        report.reason = "Unknown order book.";
+    } else {
+        OrderBook& book = *books[command.book];
+        switch (command.type) {
+            case EngineCommand::Type::MARKET:
+                // Carnet vide : niveaux recentrés sur la limite de protection (prix de référence) pour les
+                // ordres qui viendront s'y poser.
+                if (book.empty() && !book.inRange(command.priceTick)) {
+                    book.recenter(command.priceTick);
+                }
+                report.filledLots = book.match(command.side, command.quantity, command.priceTick, collect, command.owner, &selfTrade);
+                report.accepted = true;
+                if (selfTrade) {
+                    report.reason = "Self-trade prevented, remainder not matched.";
+                }
+                break;
+
+            case EngineCommand::Type::LIMIT:
+            case EngineCommand::Type::IOC:
+            case EngineCommand::Type::FOK:
+                if (book.empty() && !book.inRange(command.priceTick)) {
+                    book.recenter(command.priceTick);
+                }
+                if (command.quantity <= 0 || (command.type == EngineCommand::Type::LIMIT && !book.inRange(command.priceTick))) {
+                    report.reason = "Price outside of the order book range.";
+                    break;
+                }
+                if (command.type == EngineCommand::Type::FOK && book.available(command.side, command.priceTick, command.quantity, command.owner) < command.quantity) {
+                    report.reason = "Not enough liquidity to fill the whole quantity.";
+                    break;
+                }
+                report.filledLots = book.match(command.side, command.quantity, command.priceTick, collect, command.owner, &selfTrade);
+                report.accepted = true;
+                if (selfTrade) {
+                    // Ordre du même client au prix atteint : le reste de l'ordre entrant est annulé, jamais posé.
+                    report.reason = "Self-trade prevented, remainder cancelled.";
+                } else if (command.type == EngineCommand::Type::LIMIT && report.filledLots < command.quantity) {
+                    report.restingLots = command.quantity - report.filledLots;
+                    report.orderId = book.add(command.side, command.priceTick, report.restingLots, command.owner);
+                    if (report.orderId == 0) {
+                        report.restingLots = 0;
+                        report.reason = "Order book full, remainder not rested.";
+                    }
+                }
+                break;
+
+            case EngineCommand::Type::CANCEL: {
+                RestingOrder& removed = report.cancelled;
+                if (!book.find(command.orderId, removed) || removed.owner != command.owner) {
+                    report.reason = "Unknown order id.";
+                } else if (book.cancel(command.orderId)) {
+                    report.accepted = true;
+                    report.orderId = removed.id;
+                    report.restingLots = removed.quantity;
+                }
+                break;
+            }
+        }
+    }
+
+    commandCount.store(commandCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (!report.accepted) {
+        rejectCount.store(rejectCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    fillCount.store(fillCount.load(std::memory_order_relaxed) + fillTotal, std::memory_order_relaxed);
+    if (command.completion) {
+        complete(*command.completion);
+    }
+}
@@ -0,0 +1,261 @@
+#include "../headers/OrderBook.h"
+
+#include <cmath>
+
+OrderBook::OrderBook(const std::string& symbol, double tickSize, double lotSize, uint32_t levelCount, uint32_t orderCapacity)
+    : symbol(symbol), tickSize(tickSize), lotSize(lotSize), levelCount(levelCount < 64 ? 64 : levelCount),
+      levels(this->levelCount), orders(orderCapacity < 1 ? 1 : orderCapacity)
+{
+    size_t words = (static_cast<size_t>(this->levelCount) + 63) / 64;
+    occupancy.assign(words, 0);
+    summary.assign((words + 63) / 64, 0);
+    // Toutes les cases dans la liste libre, dans l'ordre (les premières servies sont les premières en mémoire).
+    for (uint32_t i = 0; i + 1 < orders.size(); ++i) {
+        orders[i].next = i + 1;
+    }
+    orders.back().next = NIL;
+    freeHead = 0;
+}
+
+int64_t OrderBook::toTicks(double price) const {
+    return static_cast<int64_t>(std::llround(price / tickSize));
+}
+
+int64_t OrderBook::toLots(double quantity) const {
+    return static_cast<int64_t>(std::llround(quantity / lotSize));
+}
+
+bool OrderBook::recenter(int64_t tick) {
+    if (orderCount != 0) {
+        return false;
+    }
+    baseTick = tick - static_cast<int64_t>(levelCount / 2);
+    if (baseTick < 1) {
+        baseTick = 1; // Pas de prix nul ou négatif.
+    }
+    return true;
+}
+
+int64_t OrderBook::getLevelQuantity(int64_t tick) const {
+    if (!inRange(tick)) {
+        return 0;
+    }
+    return levels[static_cast<size_t>(tick - baseTick)].quantity;
+}
+
+int64_t OrderBook::available(OrderSide side, int64_t limitTick, int64_t wanted, uint32_t takerOwner) const {
+    int64_t limit = limitTick - baseTick;
+    int64_t total = 0;
+    // Quantité d'un niveau utilisable par l'ordre entrant ; false au premier ordre de son propriétaire.
+    auto count = [&](int64_t level) {
+        const Level& l = levels[static_cast<size_t>(level)];
+        if (takerOwner == 0) {
+            total += l.quantity;
+            return true;
+        }
+        for (uint32_t slot = l.head; slot != NIL && total < wanted; slot = orders[slot].next) {
+            if (orders[slot].owner == takerOwner) {
+                return false;
+            }
+            total += orders[slot].quantity;
+        }
+        return true;
+    };
+    int64_t level = side == OrderSide::BUY ? bestAsk : bestBid;
+    while (level != NONE && (side == OrderSide::BUY ? level <= limit : level >= limit) && total < wanted && count(level)) {
+        level = side == OrderSide::BUY ? nextOccupied(level) : prevOccupied(level);
+    }
+    return total < wanted ? total : wanted;
+}
+
+uint64_t OrderBook::add(OrderSide side, int64_t priceTick, int64_t quantity, uint32_t owner) {
+    if (quantity <= 0 || !inRange(priceTick) || freeHead == NIL) {
+        return 0;
+    }
+    int64_t level = priceTick - baseTick;
+    // Un ordre au repos ne doit pas croiser le côté opposé (sinon il aurait dû être apparié).
+    if (side == OrderSide::BUY ? (bestAsk != NONE && level >= bestAsk) : (bestBid != NONE && level <= bestBid)) {
+        return 0;
+    }
+
+    uint32_t slot = freeHead;
+    Order& order = orders[slot];
+    freeHead = order.next;
+    // Identifiant : compteur (partie haute, jamais nul) et case (partie basse).
+    order.id = (++sequence << 32) | slot;
+    order.quantity = quantity;
+    order.owner = owner;
+    order.side = side;
+    order.level = static_cast<uint32_t>(level);
+    order.next = NIL;
+
+    Level& l = levels[static_cast<size_t>(level)];
+    order.prev = l.tail;
+    if (l.tail != NIL) {
+        orders[l.tail].next = slot;
+    } else {
+        l.head = slot;
+        setOccupied(level);
+    }
+    l.tail = slot;
+    l.quantity += quantity;
+    orderCount++;
+
+    if (side == OrderSide::BUY) {
+        if (bestBid == NONE || level > bestBid) bestBid = level;
+    } else {
+        if (bestAsk == NONE || level < bestAsk) bestAsk = level;
+    }
+    return order.id;
+}
+
+OrderBook::Order* OrderBook::lookup(uint64_t orderId) {
+    uint64_t slot = orderId & 0xFFFFFFFFull;
+    if (orderId == 0 || slot >= orders.size() || orders[slot].id != orderId) {
+        return nullptr;
+    }
+    return &orders[slot];
+}
+
+const OrderBook::Order* OrderBook::lookup(uint64_t orderId) const {
+    uint64_t slot = orderId & 0xFFFFFFFFull;
+    if (orderId == 0 || slot >= orders.size() || orders[slot].id != orderId) {
+        return nullptr;
+    }
+    return &orders[slot];
+}
+
+bool OrderBook::find(uint64_t orderId, RestingOrder& out) const {
+    const Order* order = lookup(orderId);
+    if (!order) {
+        return false;
+    }
+    out.id = order->id;
+    out.owner = order->owner;
+    out.side = order->side;
+    out.priceTick = baseTick + order->level;
+    out.quantity = order->quantity;
+    return true;
+}
+
+bool OrderBook::cancel(uint64_t orderId, RestingOrder* removed) {
+    Order* order = lookup(orderId);
+    if (!order) {
+        return false;
+    }
+    if (removed) {
+        find(orderId, *removed);
+    }
+    levels[order->level].quantity -= order->quantity;
+    unlink(static_cast<uint32_t>(orderId & 0xFFFFFFFFull));
+    return true;
+}
+
+void OrderBook::unlink(uint32_t slot) {
+    Order& order = orders[slot];
+    Level& l = levels[order.level];
+    if (order.prev != NIL) {
+        orders[order.prev].next = order.next;
+    } else {
+        l.head = order.next;
+    }
+    if (order.next != NIL) {
+        orders[order.next].prev = order.prev;
+    } else {
+        l.tail = order.prev;
+    }
+    int64_t level = order.level;
+
+    order.id = 0;
+    order.quantity = 0;
+    order.prev = NIL;
+    order.next = freeHead;
+    freeHead = slot;
+    orderCount--;
+
+    if (l.head == NIL) {
+        l.quantity = 0;
+        levelEmptied(level);
+    }
+}
+
+void OrderBook::levelEmptied(int64_t level) {
+    clearOccupied(level);
+    if (level == bestBid) {
+        bestBid = prevOccupied(level);
+    } else if (level == bestAsk) {
+        bestAsk = nextOccupied(level);
+    }
+}
+
+// --- Bitmap d'occupation ---
+void OrderBook::setOccupied(int64_t level) {
+    size_t word = static_cast<size_t>(level) >> 6;
+    occupancy[word] |= 1ull << (level & 63);
+    summary[word >> 6] |= 1ull << (word & 63);
+}
+
+void OrderBook::clearOccupied(int64_t level) {
+    size_t word = static_cast<size_t>(level) >> 6;
+    occupancy[word] &= ~(1ull << (level & 63));
+    if (occupancy[word] == 0) {
+        summary[word >> 6] &= ~(1ull << (word & 63));
+    }
+}
+
+int64_t OrderBook::nextOccupied(int64_t level) const {
+    size_t from = static_cast<size_t>(level + 1);
+    if (from >= static_cast<size_t>(levelCount)) {
+        return NONE;
+    }
+    size_t word = from >> 6;
+    uint64_t bits = occupancy[word] & (~0ull << (from & 63));
+    if (bits) {
+        return static_cast<int64_t>((word << 6) + __builtin_ctzll(bits));
+    }
+    // Mots suivants non nuls, via le résumé.
+    size_t nextWord = word + 1;
+    if (nextWord >= occupancy.size()) {
+        return NONE;
+    }
+    size_t s = nextWord >> 6;
+    uint64_t sbits = summary[s] & (~0ull << (nextWord & 63));
+    while (true) {
+        if (sbits) {
+            size_t w = (s << 6) + __builtin_ctzll(sbits);
+            return static_cast<int64_t>((w << 6) + __builtin_ctzll(occupancy[w]));
+        }
+        if (++s >= summary.size()) {
+            return NONE;
+        }
+        sbits = summary[s];
+    }
+}
+
+int64_t OrderBook::prevOccupied(int64_t level) const {
+    if (level <= 0) {
+        return NONE;
+    }
+    size_t from = static_cast<size_t>(level - 1);
+    size_t word = from >> 6;
+    uint64_t bits = occupancy[word] & (~0ull >> (63 - (from & 63)));
+    if (bits) {
+        return static_cast<int64_t>((word << 6) + 63 - __builtin_clzll(bits));
+    }
+    if (word == 0) {
+        return NONE;
+    }
+    size_t prevWord = word - 1;
+    size_t s = prevWord >> 6;
+    uint64_t sbits = summary[s] & (~0ull >> (63 - (prevWord & 63)));
+    while (true) {
+        if (sbits) {
+            size_t w = (s << 6) + 63 - __builtin_clzll(sbits);
+            return static_cast<int64_t>((w << 6) + 63 - __builtin_clzll(occupancy[w]));
+        }
+        if (s == 0) {
+            return NONE;
+        }
+        sbits = summary[--s];
+    }
+}
@@ -0,0 +1,121 @@
+#include "../headers/PriceFeed.h"
+#include "../headers/Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// Symboles diffusés : ceux dont Global génère le prix.
+PriceFeed::PriceFeed() {
+    topics.push_back(Topic{"SRD-BTC", 1, 0, nullptr, {}});
+}
+
+PriceFeed::Topic* PriceFeed::findTopic(const std::string& symbol) {
+    for (Topic& topic : topics) {
+        if (topic.symbol == symbol) {
+            return &topic;
+        }
+    }
+    return nullptr;
+}
+
+bool PriceFeed::subscribe(const std::string& symbol, const std::shared_ptr<ServerConnection>& connection) {
+    if (!connection) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    Topic* topic = findTopic(symbol);
+    if (!topic) {
+        return false;
+    }
+    bool already = std::any_of(topic->subscribers.begin(), topic->subscribers.end(),
+                               [&](const std::weak_ptr<ServerConnection>& s) { return s.lock() == connection; });
+    if (!already) {
+        topic->subscribers.push_back(connection);
+        LOG("PriceFeed::subscribe INFO : Socket FD " + std::to_string(connection->getSocketFD()) + " abonné à " + symbol + " (" + std::to_string(topic->subscribers.size()) + " abonnés).", "INFO");
+    }
+    // Dernier prix connu : l'abonné n'attend pas le prochain tick (jusqu'à 15 s).
+    if (topic->last) {
+        connection->offerConflated(topic->id, topic->last);
+    }
+    return true;
+}
+
+bool PriceFeed::unsubscribe(const std::string& symbol, const ServerConnection* connection) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Topic* topic = findTopic(symbol);
+    if (!topic) {
+        return false;
+    }
+    auto it = std::find_if(topic->subscribers.begin(), topic->subscribers.end(),
+                           [&](const std::weak_ptr<ServerConnection>& s) { return s.lock().get() == connection; });
+    if (it == topic->subscribers.end()) {
+        return false;
+    }
+    topic->subscribers.erase(it);
+    return true;
+}
+
+size_t PriceFeed::unsubscribeAll(const ServerConnection* connection) {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t removed = 0;
+    for (Topic& topic : topics) {
+        auto end = std::remove_if(topic.subscribers.begin(), topic.subscribers.end(), [&](const std::weak_ptr<ServerConnection>& s) {
+            std::shared_ptr<ServerConnection> conn = s.lock();
+            return !conn || conn.get() == connection;
+        });
+        removed += static_cast<size_t>(std::distance(end, topic.subscribers.end()));
+        topic.subscribers.erase(end, topic.subscribers.end());
+    }
+    return removed;
+}
+
+// --- Diffusion d'un prix (thread de génération des prix) ---
+void PriceFeed::publish(const std::string& symbol, double price) {
+    if (!(price > 0) || !std::isfinite(price)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    Topic* topic = findTopic(symbol);
+    if (!topic) {
+        return;
+    }
+
+    // Formaté une seule fois, partagé (immuable) par tous les abonnés.
+    char line[128];
+    int length = std::snprintf(line, sizeof(line), "PRICE_UPDATE %s %.8f %llu\n", topic->symbol.c_str(), price,
+                               static_cast<unsigned long long>(++topic->sequence));
+    if (length <= 0 || static_cast<size_t>(length) >= sizeof(line)) {
+        return;
+    }
+    topic->last = std::make_shared<const std::string>(line, static_cast<size_t>(length));
+
+    // Les connexions fermées (ou dont la file a débordé) sont retirées au passage.
+    size_t delivered = 0;
+    auto end = std::remove_if(topic->subscribers.begin(), topic->subscribers.end(), [&](const std::weak_ptr<ServerConnection>& s) {
+        std::shared_ptr<ServerConnection> conn = s.lock();
+        if (!conn || !conn->offerConflated(topic->id, topic->last)) {
+            return true;
+        }
+        delivered++;
+        return false;
+    });
+    topic->subscribers.erase(end, topic->subscribers.end());
+    if (delivered > 0) {
+        LOG("PriceFeed::publish INFO : Prix " + topic->symbol + " n°" + std::to_string(topic->sequence) + " diffusé à " + std::to_string(delivered) + " abonnés.", "INFO");
+    }
+}
+
+bool PriceFeed::hasSymbol(const std::string& symbol) const {
+    // Liste fixée à la construction : lecture sans verrou.
+    return std::any_of(topics.begin(), topics.end(), [&](const Topic& topic) { return topic.symbol == symbol; });
+}
+
+size_t PriceFeed::getSubscriberCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const Topic& topic : topics) {
+        count += topic.subscribers.size();
+    }
+    return count;
+}
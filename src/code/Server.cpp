@@ -34,18 +34,14 @@
 #include <cctype>              
 #include <cmath>
 #include <functional>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/un.h>
+#include <sys/stat.h>
 
 
 extern TransactionQueue txQueue;
 
-std::vector<std::thread> threadPool;
-    std::queue<std::function<void()>> taskQueue;
-    std::mutex taskQueueMutex;
-    std::condition_variable taskQueueCV;
-    bool stopThreadPool = false;
-
-    void threadPoolWorker(); // Fonction pour les threads du pool
-
 // --- Fonctions Utilitaires Globales ---
 // Les implémentations de GenerateRandomHex, GenerateRandomId, GenerateToken, HashPasswordSecure, VerifyPasswordSecure
 // sont maintenant dans Utils.cpp.
@@ -56,7 +52,7 @@ std::vector<std::thread> threadPool;
 // --- Constructeur Server ---
 Server::Server(int p, const std::string& certF, const std::string& keyF, const std::string& usersF,
     const std::string& transactionCounterF, const std::string& transactionHistoryF,
-    const std::string& walletsD)
+    const std::string& walletsD, const ServerOptions& opts)
 : port(p),
 certFile_path(certF),
 keyFile_path(keyF),
@@ -64,7 +60,7 @@ usersFile_path(usersF),
 transactionCounterFile_path(transactionCounterF),
 transactionHistoryFile_path(transactionHistoryF),
 wallets_dir_path(walletsD),
-serverSocket(-1),
+options(opts),
 ctx(nullptr),
 acceptingConnections(false)
 {
@@ -84,13 +80,10 @@ void Server::StartServer() {
     LOG("Server::StartServer INFO : Démarrage du serveur sur le port " + std::to_string(this->port) + "...", "INFO");
 
 
-    // Initialiser le pool de threads
-   // int threadPoolSize = std::thread::hardware_concurrency(); // Nombre de threads basé sur le CPU
-   int threadPoolSize = 4; // Nombre de threads fixe pour le pool (modifiable selon les besoins)
-    for (int i = 0; i < threadPoolSize; ++i) {
-        threadPool.emplace_back(&Server::threadPoolWorker, this);
-    }
-    LOG("Server::StartServer INFO : Pool de threads initialisé avec " + std::to_string(threadPoolSize) + " threads.", "INFO");
+    // Initialiser l'exécuteur des tâches de connexion (files par worker + vol de travail).
+    this->executor = std::make_unique<WorkStealingExecutor>(this->options.executorThreads);
+    this->executor->start();
+    LOG("Server::StartServer INFO : Exécuteur initialisé avec " + std::to_string(this->executor->getThreadCount()) + " workers.", "INFO");
     
     // 2. Charger le contexte SSL du serveur.
     this->ctx = InitServerCTX(this->certFile_path, this->keyFile_path);
@@ -112,62 +105,203 @@ void Server::StartServer() {
 
 
     // 5. Démarrer le thread de génération des prix SRD-BTC (module Global).
+    Global::setPriceThreadCpu(this->options.lowLatency.priceThreadCpu);
     Global::startPriceGenerationThread();
     LOG("Server::StartServer INFO : Thread de génération des prix SRD-BTC démarré (module Global).", "INFO");
 
 
-    // 6. Démarrer le thread de traitement de la TransactionQueue globale.
+    // 6. Démarrer les threads de traitement (un par shard) de la TransactionQueue globale.
+    txQueue.setShardCount(static_cast<size_t>(std::max(0, this->options.txQueueShards)));
+    txQueue.setGroupCommit(this->options.groupCommit, this->transactionHistoryFile_path);
+    txQueue.setLatencyProfile(this->options.lowLatency.txQueueCpu, std::chrono::microseconds(this->options.lowLatency.spinWaitMicros));
     txQueue.start();
-    LOG("Server::StartServer INFO : Thread de traitement de la TransactionQueue démarré.", "INFO");
+    LOG("Server::StartServer INFO : TransactionQueue démarrée (" + std::to_string(txQueue.getShardCount()) + " shards).", "INFO");
 
 
-    // 7. Configuration et liaison du socket serveur principal.
-    this->serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (this->serverSocket == -1) {
-        LOG("Server::StartServer ERROR : Échec de la création de la socket serveur. Erreur: " + std::string(strerror(errno)), "ERROR");
-        StopServer(); // Nettoie ce qui a été démarré.
-        return;
+    // 6b. Démarrer le réacteur epoll des sessions (sauf en mode un-thread-par-session).
+    if (this->options.useReactor) {
+        this->reactor = std::make_unique<SessionReactor>(this->options.reactorIoThreads);
+        // Les sessions terminées côté réacteur sont retirées de activeSessions (l'ID peut se reconnecter).
+        std::weak_ptr<Server> weak_self = weak_from_this();
+        this->reactor->setCloseHandler([weak_self](const std::string& clientId) {
+            if (auto self = weak_self.lock()) {
+                self->unregisterSession(clientId);
+            }
+        });
+        this->reactor->setLatencyProfile(this->options.lowLatency.ioThreadCpus, std::chrono::microseconds(this->options.lowLatency.spinWaitMicros));
+        if (!this->reactor->start()) {
+            LOG("Server::StartServer WARNING : Échec du démarrage du réacteur epoll. Repli sur un thread par session.", "WARNING");
+            this->reactor.reset();
+        } else {
+            LOG("Server::StartServer INFO : Réacteur epoll démarré (" + std::to_string(this->reactor->getIoThreadCount()) + " threads d'E/S).", "INFO");
+        }
+    } else {
+        LOG("Server::StartServer INFO : Mode un-thread-par-session (réacteur désactivé).", "INFO");
     }
 
-    // Configurer l'option SO_REUSEADDR.
-    int opt = 1;
-    if (setsockopt(this->serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        LOG("Server::StartServer WARNING : setsockopt(SO_REUSEADDR) a échoué. Erreur: " + std::string(strerror(errno)), "WARNING");
-    }
 
-    // Configure l'adresse et le port d'écoute.
-    sockaddr_in serverAddr{};
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_addr.s_addr = INADDR_ANY;
-    serverAddr.sin_port = htons(this->port);
+    // 7. Création des shards d'écoute. Chaque shard possède son propre socket SO_REUSEPORT,
+    // son thread d'acceptation et ses threads de handshake : le noyau répartit les nouvelles
+    // connexions entre les sockets, donc entre les coeurs.
+    int shard_count = this->options.listenerShards;
+    if (shard_count <= 0) {
+        shard_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    // Mise à jour à chaud : reprendre les sockets d'écoute (et leurs connexions en attente) du processus
+    // en cours plutôt que d'en créer. Un shard par socket reçu.
+    std::vector<int> inherited_sockets;
+    if (!this->options.upgradeSocketPath.empty()) {
+        this->upgrade = std::make_unique<HotUpgrade>(this->options.upgradeSocketPath);
+        // Le dernier Wallet d'un client détruit (sauvegarde finale faite) : bail rendu au processus suivant.
+        std::weak_ptr<Server> weak_self = weak_from_this();
+        Wallet::setReleaseHandler([weak_self](const std::string& clientId) {
+            if (auto self = weak_self.lock()) {
+                if (self->upgrade) {
+                    self->upgrade->releaseAccount(clientId);
+                }
+            }
+        });
+        if (this->options.takeOverListeners) {
+            HotUpgrade::Handoff handoff;
+            if (this->upgrade->requestHandoff(handoff, 10000)) {
+                inherited_sockets = std::move(handoff.listenSockets);
+                shard_count = static_cast<int>(inherited_sockets.size());
+                // Utilisateurs enregistrés par l'ancien processus depuis notre chargement (il n'en enregistre plus).
+                this->LoadUsers(this->usersFile_path);
+                // IDs de transaction : l'ancien processus garde [compteur, compteur + HANDOFF_ID_RANGE) pour sa vidange.
+                Transaction::advanceCounter(handoff.transactionCounter + HANDOFF_ID_RANGE);
+                Transaction::saveCounter(this->transactionCounterFile_path);
+                // Comptes encore tenus par l'ancien processus : pas de session avant leur RELEASE.
+                std::lock_guard<std::mutex> lock(this->sessionsMutex);
+                this->leasedAccounts.insert(handoff.leasedAccounts.begin(), handoff.leasedAccounts.end());
+            } else {
+                LOG("Server::StartServer WARNING : Reprise des sockets d'écoute impossible. Création de nouveaux sockets.", "WARNING");
+            }
+        }
+    }
+    // Contrôle d'admission des connexions TLS (limites, débit, surcharge), si au moins une limite est configurée.
+    auto admission_controller = std::make_unique<AdmissionController>(this->options.admission);
+    if (admission_controller->isEnabled()) {
+        this->admission = std::move(admission_controller);
+        LOG("Server::StartServer INFO : Contrôle d'admission actif (max connexions: " + std::to_string(this->options.admission.maxConnections) + ", par IP: " + std::to_string(this->options.admission.maxConnectionsPerIp) + ", débit: " + std::to_string(this->options.admission.acceptRatePerSec) + "/s, en cours max: " + std::to_string(this->options.admission.maxPendingConnections) + ").", "INFO");
+    }
 
-    // Lie l'adresse et le port.
-    if (bind(this->serverSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
-        LOG("Server::StartServer ERROR : Échec de la liaison (bind) de la socket serveur. Port : " + std::to_string(this->port) + ". Erreur: " + std::string(strerror(errno)), "ERROR");
-        close(this->serverSocket); this->serverSocket = -1;
-        StopServer();
-        return;
+    // Threads de handshake par shard : par défaut, les coeurs sont partagés entre les shards.
+    int handshake_threads = this->options.handshakeThreads;
+    if (handshake_threads <= 0) {
+        handshake_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / shard_count);
     }
-    LOG("Server::StartServer INFO : Socket serveur lié à l'adresse et au port " + std::to_string(this->port), "INFO");
 
+    for (int i = 0; i < shard_count; ++i) {
+        auto shard = std::make_unique<ListenerShard>();
+        shard->index = i;
+        // SO_REUSEPORT n'est nécessaire que s'il y a plusieurs sockets sur le même port.
+        shard->listenSocket = inherited_sockets.empty() ? CreateListenSocket(shard_count > 1) : inherited_sockets[i];
+        // Socket non bloquant + eventfd : pendant une mise à jour, le socket est partagé entre deux
+        // processus ; le thread d'acceptation attend dans poll() et se réveille sans shutdown().
+        shard->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (shard->listenSocket != -1 && (shard->wakeFd == -1 || fcntl(shard->listenSocket, F_SETFL, fcntl(shard->listenSocket, F_GETFL, 0) | O_NONBLOCK) == -1)) {
+            LOG("Server::StartServer ERROR : Échec eventfd/fcntl pour le shard " + std::to_string(i) + ". Erreur: " + std::string(strerror(errno)), "ERROR");
+            close(shard->listenSocket);
+            shard->listenSocket = -1;
+        }
+        if (shard->listenSocket == -1) {
+            LOG("Server::StartServer ERROR : Impossible de créer le socket d'écoute du shard " + std::to_string(i) + ". Arrêt.", "ERROR");
+            this->listenerShards.push_back(std::move(shard)); // Pour que StopServer nettoie les shards déjà créés.
+            StopServer();
+            return;
+        }
 
-    // Commence à écouter les connexions.
-    if (listen(this->serverSocket, SOMAXCONN) < 0) {
-        LOG("Server::StartServer ERROR : Échec de l'écoute (listen) sur la socket serveur. Erreur: " + std::string(strerror(errno)), "ERROR");
-        close(this->serverSocket); this->serverSocket = -1;
-        StopServer();
-        return;
+        // Handshakes TLS non bloquants hors du thread d'acceptation.
+        shard->handshakePool = std::make_unique<TlsHandshakePool>(this->ctx.get(), handshake_threads, this->options.handshakeTimeoutMs);
+        // Handshake abandonné (échec, délai) : libérer la place réservée par le contrôle d'admission.
+        shard->handshakePool->setCloseHandler([this](int clientSocket) {
+            this->ReleaseAdmission(clientSocket);
+        });
+        // Handshake terminé : l'authentification (bloquante) est confiée au pool de threads.
+        shard->handshakePool->setCompletionHandler([this](int clientSocket, SSL* ssl) {
+            if (this->resumption) {
+                this->resumption->recordHandshake(ssl);
+            }
+            this->SubmitClient(clientSocket, ssl);
+        });
+        if (!shard->handshakePool->start()) {
+            LOG("Server::StartServer WARNING : Échec du démarrage du pool de handshake du shard " + std::to_string(i) + ". Repli sur SSL_accept bloquant dans son thread d'acceptation.", "WARNING");
+            shard->handshakePool.reset();
+        }
+        this->listenerShards.push_back(std::move(shard));
     }
-    LOG("Server::StartServer INFO : Serveur en écoute sur le port " + std::to_string(this->port), "INFO");
+    LOG("Server::StartServer INFO : Serveur en écoute sur le port " + std::to_string(this->port) + " (" + std::to_string(shard_count) + " shards, " + std::to_string(handshake_threads) + " threads de handshake par shard).", "INFO");
 
 
-    // 8. Lancer la boucle d'acceptation des connexions dans un thread séparé.
+    // 8. Lancer une boucle d'acceptation par shard.
     this->acceptingConnections.store(true, std::memory_order_release);
-    this->acceptThread = std::thread(&Server::AcceptLoop, this);
-    LOG("Server::StartServer INFO : Thread d'acceptation des connexions démarré.", "INFO");
+    for (auto& shard : this->listenerShards) {
+        ListenerShard* raw_shard = shard.get();
+        shard->acceptThread = std::thread(&Server::AcceptLoop, this, std::ref(*raw_shard));
+    }
+    LOG("Server::StartServer INFO : Threads d'acceptation des connexions démarrés.", "INFO");
+
+    // 8b. Écoute locale en clair (socket Unix), si configurée. Un échec n'empêche pas le service TLS.
+    if (!this->options.unixSocketPath.empty()) {
+        this->unixListenSocket = CreateUnixListenSocket();
+        if (this->unixListenSocket != -1) {
+            this->unixWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (this->unixWakeFd == -1) {
+                LOG("Server::StartServer ERROR : Échec eventfd pour le socket Unix. Erreur: " + std::string(strerror(errno)) + ". Écoute locale désactivée.", "ERROR");
+                close(this->unixListenSocket);
+                this->unixListenSocket = -1;
+                unlink(this->options.unixSocketPath.c_str());
+            } else {
+                this->unixAcceptThread = std::thread(&Server::UnixAcceptLoop, this);
+            }
+        }
+    }
+    // 8c. Passerelle d'ordres en mémoire partagée : les canaux s'ouvrent depuis une session du socket Unix.
+    if (this->options.shmGateway) {
+        if (this->unixListenSocket == -1) {
+            LOG("Server::StartServer WARNING : Passerelle en mémoire partagée demandée sans socket Unix actif (unixSocketPath). Désactivée.", "WARNING");
+        } else {
+            this->shmGateway = std::make_unique<ShmGateway>(this->options.shmRingCapacity, this->options.shmSpinMicros);
+            if (!this->shmGateway->start()) {
+                LOG("Server::StartServer WARNING : Échec du démarrage de la passerelle en mémoire partagée. Désactivée.", "WARNING");
+                this->shmGateway.reset();
+            }
+        }
+    }
 
-    // La méthode StartServer() devient bloquante en joignant le thread d'acceptation.
-    this->acceptThread.join();
+    // 8d. Diffusion des prix aux abonnés : chaque nouveau prix de Global est publié par le PriceFeed.
+    Global::setPriceListener([this](const std::string& symbol, double price) { this->priceFeed.publish(symbol, price); });
+
+    // 9. Mise à jour à chaud : confirmer la reprise à l'ancien processus (il cesse alors d'accepter),
+    // puis se mettre à disposition de la prochaine mise à jour.
+    if (this->upgrade) {
+        if (!inherited_sockets.empty()) {
+            this->upgrade->confirmTakeover([this](const std::string& clientId) { this->ReleaseLease(clientId); });
+            LOG("Server::StartServer INFO : Reprise des sockets d'écoute confirmée à l'ancien processus.", "INFO");
+        }
+        HotUpgrade::Callbacks callbacks;
+        callbacks.prepare = [this]() { return this->PrepareHandoff(); };
+        callbacks.leasedAccounts = []() { return Wallet::liveClientIds(); };
+        callbacks.abort = [this]() { this->AbortHandoff(); };
+        callbacks.handoff = [this]() { this->BeginDrain(); };
+        this->upgrade->startListening(std::move(callbacks));
+    }
+
+    // La méthode StartServer() devient bloquante en joignant les threads d'acceptation.
+    for (auto& shard : this->listenerShards) {
+        if (shard->acceptThread.joinable()) {
+            shard->acceptThread.join();
+        }
+    }
+    if (this->unixAcceptThread.joinable()) {
+        this->unixAcceptThread.join();
+    }
+
+    // Sockets cédés à un nouveau processus : laisser les sessions existantes se terminer avant l'arrêt.
+    if (this->upgrade && this->upgrade->hasHandedOff()) {
+        DrainSessions();
+    }
 
     // StartServer se termine ici après l'arrêt propre de la boucle d'acceptation.
 }
@@ -184,21 +318,65 @@ void Server::StopServer() {
 
     LOG("Server::StopServer INFO : Arrêt ordonné du serveur demandé...", "INFO");
 
+    // 0. Plus de mise à jour à chaud possible pendant l'arrêt.
+    bool handed_off = this->upgrade && this->upgrade->hasHandedOff();
+    if (this->upgrade) {
+        this->upgrade->stop();
+    }
+
     // 1. Signaler au thread d'acceptation de s'arrêter.
     this->acceptingConnections.store(false, std::memory_order_release);
 
-    // 2. Débloquer la socket d'écoute.
-    if (this->serverSocket != -1) {
-        close(this->serverSocket);
-        this->serverSocket = -1;
+    // 2. Réveiller les threads d'acceptation (eventfd). Pas de shutdown() : après une mise à jour à chaud,
+    // le socket d'écoute est partagé avec le nouveau processus. Le close() n'a lieu qu'après le join.
+    WakeAcceptThreads();
+
+    // 3. Attendre la fin des threads d'acceptation, puis arrêter les threads de handshake
+    // (les handshakes inachevés sont abandonnés).
+    for (auto& shard : this->listenerShards) {
+        if (shard->acceptThread.joinable()) {
+            shard->acceptThread.join();
+        }
+        if (shard->listenSocket != -1) {
+            close(shard->listenSocket);
+            shard->listenSocket = -1;
+        }
+        if (shard->wakeFd != -1) {
+            close(shard->wakeFd);
+            shard->wakeFd = -1;
+        }
+        if (shard->handshakePool) {
+            shard->handshakePool->stop();
+        }
+    }
+    if (this->unixAcceptThread.joinable()) {
+        this->unixAcceptThread.join();
+    }
+    if (this->unixListenSocket != -1) {
+        close(this->unixListenSocket);
+        this->unixListenSocket = -1;
+        // Après une mise à jour à chaud, le chemin appartient au socket recréé par le nouveau processus.
+        if (!handed_off) {
+            unlink(this->options.unixSocketPath.c_str());
+        }
+    }
+    if (this->unixWakeFd != -1) {
+        close(this->unixWakeFd);
+        this->unixWakeFd = -1;
+    }
+    LOG("Server::StopServer INFO : Threads d'acceptation et de handshake arrêtés.", "INFO");
+    LogShardStats();
+    if (this->resumption) {
+        this->resumption->logStats();
     }
 
-    // 3. Attendre la fin du thread d'acceptation.
-    if (this->acceptThread.joinable()) {
-        this->acceptThread.join();
-        LOG("Server::StopServer INFO : Thread d'acceptation joint.", "INFO");
-    } else {
-        LOG("Server::StopServer WARNING : Thread d'acceptation non joignable lors de l'arrêt.", "WARNING");
+    // 3a. Plus de diffusion de prix (le thread de Global peut survivre au serveur).
+    Global::setPriceListener(nullptr);
+
+    // 3b. Arrêter les threads d'E/S du réacteur avant d'arrêter les sessions qu'ils pilotent.
+    if (this->reactor) {
+        this->reactor->stop();
+        LOG("Server::StopServer INFO : Réacteur epoll arrêté.", "INFO");
     }
 
     // 4. Signaler l'arrêt à toutes les sessions clientes actives et attendre leur fin.
@@ -219,14 +397,30 @@ void Server::StopServer() {
               session->stop(); // stop() de ClientSession doit joindre son thread interne.
          }
     }
+    // Les sessions ont fermé leurs canaux : arrêter le thread de la passerelle.
+    if (this->shmGateway) {
+        this->shmGateway->stop();
+        LOG("Server::StopServer INFO : Passerelle en mémoire partagée arrêtée.", "INFO");
+    }
 
     // 5. Sauvegarder la liste des utilisateurs sur disque. Utilise la méthode interne sécurisée.
-    this->SaveUsers(this->usersFile_path);
-    LOG("Server::StopServer INFO : Liste des utilisateurs sauvegardée.", "INFO");
+    // Après une mise à jour à chaud, le nouveau processus a pu enregistrer des utilisateurs : notre liste
+    // est périmée et chaque enregistrement a déjà été sauvegardé au fil de l'eau (processAuthRequest).
+    if (!handed_off) {
+        this->SaveUsers(this->usersFile_path);
+        LOG("Server::StopServer INFO : Liste des utilisateurs sauvegardée.", "INFO");
+    } else {
+        LOG("Server::StopServer INFO : Sockets cédés à un nouveau processus : liste des utilisateurs non réécrite.", "INFO");
+    }
 
-    // 6. Sauvegarder le compteur de transactions statique.
-    Transaction::saveCounter(this->transactionCounterFile_path);
-    LOG("Server::StopServer INFO : Compteur de transactions sauvegardé.", "INFO");
+    // 6. Sauvegarder le compteur de transactions statique. Après une mise à jour à chaud, le fichier appartient
+    // au nouveau processus (reparti au-delà de notre plage d'IDs) : ne pas l'écraser.
+    if (!handed_off) {
+        Transaction::saveCounter(this->transactionCounterFile_path);
+        LOG("Server::StopServer INFO : Compteur de transactions sauvegardé.", "INFO");
+    } else {
+        LOG("Server::StopServer INFO : Sockets cédés à un nouveau processus : compteur de transactions non réécrit.", "INFO");
+    }
 
     // 7. Signaler l'arrêt au thread de génération des prix (Global) et attendre sa fin.
     Global::stopPriceGenerationThread();
@@ -236,18 +430,15 @@ void Server::StopServer() {
     txQueue.stop();
     LOG("Server::StopServer INFO : Thread de traitement de la TransactionQueue arrêté.", "INFO");
 
-    // Arrêter le pool de threads
-    {
-        std::lock_guard<std::mutex> lock(taskQueueMutex);
-        stopThreadPool = true;
+    // Arrêter l'exécuteur (les tâches déjà soumises sont terminées avant l'arrêt des workers).
+    if (this->executor) {
+        this->executor->stop();
+        this->executor->logStats();
+        LOG("Server::StopServer INFO : Exécuteur arrêté.", "INFO");
     }
-    taskQueueCV.notify_all();
-    for (std::thread& thread : threadPool) {
-        if (thread.joinable()) {
-            thread.join();
-        }
+    if (this->admission) {
+        this->admission->logStats();
     }
-    LOG("Server::StopServer INFO : Pool de threads arrêté.", "INFO");
 
     // 9. Nettoyage final des ressources globales OpenSSL si nécessaire (dans main).
 
@@ -276,6 +467,84 @@ void Server::removeSession(const std::string& clientId) {
 }
 
 
+// --- Implémentation de la méthode Server::OpenChannelSession ---
+// Exécutée par le thread qui lit la connexion principale (thread d'E/S du réacteur ou thread de session) :
+// comme pour HandleClient, le chargement du Wallet se fait sous sessionsMutex.
+std::shared_ptr<ClientSession> Server::OpenChannelSession(const std::shared_ptr<ServerConnection>& conn, uint32_t channelId,
+                                                          const std::string& userId, const std::string& password,
+                                                          AuthOutcome& outcome, std::string& error) {
+    std::string authenticated_clientId;
+    outcome = processAuthRequest(userId, password, authenticated_clientId, PeerAccount(*conn));
+    if (outcome == AuthOutcome::FAIL || authenticated_clientId.empty()) {
+        LOG("Server::OpenChannelSession WARNING : Authentification refusée pour ID '" + userId + "' (canal " + std::to_string(channelId) + ", socket FD: " + std::to_string(conn->getSocketFD()) + ").", "WARNING");
+        error = "AUTH FAIL: Invalid ID or password.";
+        return nullptr;
+    }
+
+    // Mode thread : une session fermée encore dans la table est retirée, puis détruite hors du verrou
+    // (sauvegarde de son Wallet) avant le chargement du Wallet du canal (même règle que HandleClient).
+    if (!this->reactor) {
+        std::shared_ptr<ClientSession> stale_session;
+        {
+            std::lock_guard<std::mutex> lock(this->sessionsMutex);
+            auto existing = this->activeSessions.find(authenticated_clientId);
+            if (existing != this->activeSessions.end() && existing->second) {
+                auto existing_conn = existing->second->getClientConnection();
+                if (!existing_conn || !existing_conn->isConnected()) {
+                    stale_session = std::move(existing->second);
+                    this->activeSessions.erase(existing);
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<ClientSession> session;
+    {
+        std::lock_guard<std::mutex> lock(this->sessionsMutex);
+        if (this->activeSessions.count(authenticated_clientId)) {
+            LOG("Server::OpenChannelSession WARNING : Une session pour client ID '" + authenticated_clientId + "' est déjà active. Canal " + std::to_string(channelId) + " refusé.", "WARNING");
+            error = "AUTH FAIL: Already connected with this ID.";
+            return nullptr;
+        }
+        error = HandoffRefusal(authenticated_clientId);
+        if (!error.empty()) {
+            LOG("Server::OpenChannelSession WARNING : Canal " + std::to_string(channelId) + " refusé pour client ID '" + authenticated_clientId + "' pendant une mise à jour à chaud.", "WARNING");
+            return nullptr;
+        }
+
+        try {
+            auto wallet = std::make_shared<Wallet>(authenticated_clientId, this->wallets_dir_path);
+            session = std::make_shared<ClientSession>(authenticated_clientId, conn, wallet);
+        } catch (const std::exception& e) {
+            LOG("Server::OpenChannelSession ERROR : Exception lors de la création de la session du canal " + std::to_string(channelId) + " pour client ID " + authenticated_clientId + ": " + e.what(), "ERROR");
+            error = "ERROR: Server internal error initializing the channel session.";
+            return nullptr;
+        }
+        session->setShmGateway(nullptr);
+        session->startAsChannel(channelId);
+        this->activeSessions[authenticated_clientId] = session;
+    }
+
+    txQueue.registerSession(session);
+    LOG("Server::OpenChannelSession INFO : Canal " + std::to_string(channelId) + " ouvert pour client ID '" + authenticated_clientId + "' (" + authOutcomeToString(outcome) + ") sur socket FD: " + std::to_string(conn->getSocketFD()) + ".", "INFO");
+    return session;
+}
+
+
+// --- Implémentation de la méthode Server::CloseChannelSession ---
+void Server::CloseChannelSession(const std::shared_ptr<ClientSession>& session) {
+    if (!session) {
+        return;
+    }
+    session->stop(); // Désenregistre la session de la TQ ; ne ferme pas la connexion partagée.
+    std::lock_guard<std::mutex> lock(this->sessionsMutex);
+    auto it = this->activeSessions.find(session->getClientId());
+    if (it != this->activeSessions.end() && it->second == session) {
+        this->activeSessions.erase(it);
+    }
+}
+
+
 // --- Implémentation de la méthode Server::CreateWalletFile ---
 bool Server::CreateWalletFile(const std::string& clientId) {
     std::string walletFilename = this->wallets_dir_path + "/" + clientId + ".wallet";
@@ -395,14 +664,17 @@ void Server::SaveUsersInternal(const std::string& filename) {
 
 // --- Implémentation de la méthode Server::processAuthRequest ---
 // Combine la logique de vérification et d'enregistrement.
-AuthOutcome Server::processAuthRequest(const std::string& userIdPlainText, const std::string& passwordPlain, std::string& authenticatedUserId) {
+AuthOutcome Server::processAuthRequest(const std::string& userIdPlainText, const std::string& passwordPlain, std::string& authenticatedUserId, const std::string& peerAccount) {
     LOG("Server::processAuthRequest INFO : Tentative auth/enregistrement pour ID: '" + userIdPlainText + "'...", "INFO");
 
     // Initialise le paramètre de sortie pour s'assurer qu'il est vide par défaut si l'auth échoue.
     authenticatedUserId.clear();
 
+    // Pair local lié par le noyau (SO_PEERCRED) au compte demandé : seul cas sans mot de passe.
+    const bool trustedPeer = !peerAccount.empty() && peerAccount == userIdPlainText;
+
     // Vérifications de base.
-    if (userIdPlainText.empty() || passwordPlain.empty()) {
+    if (userIdPlainText.empty() || (passwordPlain.empty() && !trustedPeer)) {
         LOG("Server::processAuthRequest WARNING : ID ou Mot de passe vide fourni pour ID: '" + userIdPlainText + "'.", "WARNING");
         return AuthOutcome::FAIL;
     }
@@ -419,7 +691,8 @@ AuthOutcome Server::processAuthRequest(const std::string& userIdPlainText, const
         // Vérifie le mot de passe en clair par rapport au HASH stocké (it->second).
         // !!! C'est ici que la VÉRIFICATION SÉCURISÉE DOIT avoir lieu !!!
         // Appelle la fonction sécurisée VerifyPasswordSecure (déclarée dans Utils.h, implémentée dans Utils.cpp).
-        bool password_match = VerifyPasswordSecure(passwordPlain, it->second);
+        // Pair local (socket Unix) dont l'UID est lié à ce compte : déjà authentifié par le noyau via SO_PEERCRED.
+        bool password_match = trustedPeer || VerifyPasswordSecure(passwordPlain, it->second);
 
         if (password_match) {
             LOG("Server::processAuthRequest INFO : Authentification réussie pour ID existant : '" + userIdPlainText + "'.", "INFO");
@@ -433,6 +706,16 @@ AuthOutcome Server::processAuthRequest(const std::string& userIdPlainText, const
 
     } else {
         // --- Cas : Nouvel utilisateur ---
+        // Mise à jour à chaud en cours : le nouveau processus a relu (ou va relire) la liste ; plus d'ajout ici.
+        if (this->sessionsFrozen.load()) {
+            LOG("Server::processAuthRequest WARNING : Enregistrement refusé pour ID: '" + userIdPlainText + "' pendant une mise à jour à chaud.", "WARNING");
+            return AuthOutcome::FAIL;
+        }
+        // Même pour un pair local, le compte créé doit être protégé par un mot de passe (utilisable en TLS).
+        if (passwordPlain.empty()) {
+            LOG("Server::processAuthRequest WARNING : Enregistrement sans mot de passe refusé pour ID: '" + userIdPlainText + "'.", "WARNING");
+            return AuthOutcome::FAIL;
+        }
 
          // !!! C'est ici que le HACHAGE SÉCURISÉ DOIT avoir lieu pour le nouveau mot de passe !!!
         // Le mot de passe en clair (passwordPlain) doit être hashé avec un sel unique.
@@ -487,6 +770,11 @@ UniqueSSLCTX Server::InitServerCTX(const std::string& certFile, const std::strin
     SSL_CTX_set_info_callback(context.get(), openssl_debug_callback);
     SSL_CTX_set_min_proto_version(context.get(), TLS1_3_VERSION); // Activer uniquement TLS 1.3
     SSL_CTX_set_options(context.get(), SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3 | SSL_OP_NO_COMPRESSION | SSL_OP_NO_RENEGOTIATION | SSL_OP_SINGLE_DH_USE);
+    if (this->options.kernelTls) {
+        // Tentative par connexion à la fin du handshake (voir ServerConnection) ; repli automatique si refus.
+        SSL_CTX_set_options(context.get(), SSL_OP_ENABLE_KTLS);
+        LOG("Server::InitServerCTX INFO : Kernel TLS demandé (SSL_OP_ENABLE_KTLS).", "INFO");
+    }
 
     // Configurer les suites de chiffrement pour TLS 1.3
     SSL_CTX_set_ciphersuites(context.get(), "TLS_AES_256_GCM_SHA384:TLS_CHACHA20_POLY1305_SHA256");
@@ -513,24 +801,13 @@ UniqueSSLCTX Server::InitServerCTX(const std::string& certFile, const std::strin
         return nullptr;
     }
 
-    // Activer la réutilisation des sessions SSL
-    SSL_CTX_set_session_cache_mode(context.get(), SSL_SESS_CACHE_SERVER);
-    SSL_CTX_sess_set_cache_size(context.get(), 1024); // Limite à 2048 sessions dans le cache
-
-    // Ajouter des callbacks pour gérer les sessions
-    SSL_CTX_sess_set_new_cb(context.get(), [](SSL* ssl, SSL_SESSION* session) {
-        LOG("Server::InitServerCTX INFO : Nouvelle session SSL créée.", "INFO");
-        return 0; // Retourne 0 pour indiquer que la session est acceptée
-    });
-
-    SSL_CTX_sess_set_remove_cb(context.get(), [](SSL_CTX* ctx, SSL_SESSION* session) {
-        LOG("Server::InitServerCTX INFO : Session SSL supprimée.", "INFO");
-    });
-
-    SSL_CTX_sess_set_get_cb(context.get(), [](SSL* ssl, const unsigned char* id, int id_len, int* copy) -> SSL_SESSION* {
-        LOG("Server::InitServerCTX INFO : Reprise de session SSL demandée.", "INFO");
-        return nullptr; // Retourne nullptr si aucune session correspondante n'est trouvée
-    });
+    // Activer la reprise de session SSL (tickets à clés tournantes et/ou cache partagé borné).
+    // L'objet TlsResumption doit survivre au contexte : il est détenu par le Server.
+    this->resumption = std::make_unique<TlsResumption>(this->options.resumption);
+    if (!this->resumption->install(context.get())) {
+        LOG("Server::InitServerCTX ERROR : Échec de la configuration de la reprise de session SSL.", "ERROR");
+        return nullptr;
+    }
 
     LOG("Server::InitServerCTX INFO : Contexte SSL serveur initialisé avec succès.", "INFO");
     return context;
@@ -539,6 +816,7 @@ UniqueSSLCTX Server::InitServerCTX(const std::string& certFile, const std::strin
 UniqueSSL Server::AcceptSSLConnection(SSL_CTX* ctx_raw, int clientSocket) {
     if (!ctx_raw) {
         LOG("Server::AcceptSSLConnection ERROR : Contexte SSL raw est null. Fermeture socket FD: " + std::to_string(clientSocket), "ERROR");
+        ReleaseAdmission(clientSocket);
         close(clientSocket);
         return nullptr;
     }
@@ -547,6 +825,7 @@ UniqueSSL Server::AcceptSSLConnection(SSL_CTX* ctx_raw, int clientSocket) {
     if (!ssl_ptr) {
         LOG("Server::AcceptSSLConnection ERROR : Erreur SSL_new(). Socket FD: " + std::to_string(clientSocket), "ERROR");
         ERR_print_errors_fp(stderr);
+        ReleaseAdmission(clientSocket);
         close(clientSocket);
         return nullptr;
     }
@@ -554,6 +833,7 @@ UniqueSSL Server::AcceptSSLConnection(SSL_CTX* ctx_raw, int clientSocket) {
     if (SSL_set_fd(ssl_ptr.get(), clientSocket) <= 0) {
         LOG("Server::AcceptSSLConnection ERROR : Erreur SSL_set_fd(). Socket FD: " + std::to_string(clientSocket), "ERROR");
         ERR_print_errors_fp(stderr);
+        ReleaseAdmission(clientSocket);
         close(clientSocket);
         return nullptr;
     }
@@ -563,17 +843,22 @@ UniqueSSL Server::AcceptSSLConnection(SSL_CTX* ctx_raw, int clientSocket) {
         int ssl_err = SSL_get_error(ssl_ptr.get(), ssl_accept_ret);
         if (ssl_err == SSL_ERROR_WANT_READ || ssl_err == SSL_ERROR_WANT_WRITE) {
             LOG("Server::AcceptSSLConnection WARNING : SSL_accept() retourné WANT_READ/WRITE pour socket FD: " + std::to_string(clientSocket) + ". Erreur SSL: " + std::to_string(ssl_err) + ". Connexion fermée car handshake non immédiat en mode bloquant.", "WARNING");
+            ReleaseAdmission(clientSocket);
             close(clientSocket);
             return nullptr;
         } else {
             LOG("Server::AcceptSSLConnection ERROR : Erreur fatale lors du handshake SSL pour socket FD: " + std::to_string(clientSocket) + ". Erreur SSL: " + std::to_string(ssl_err), "ERROR");
             ERR_print_errors_fp(stderr);
+            ReleaseAdmission(clientSocket);
             close(clientSocket);
             return nullptr;
         }
     }
 
     // Vérifiez si une session existante a été reprise
+    if (this->resumption) {
+        this->resumption->recordHandshake(ssl_ptr.get());
+    }
     if (SSL_session_reused(ssl_ptr.get())) {
         LOG("Server::AcceptSSLConnection INFO : Session SSL existante reprise pour socket FD: " + std::to_string(clientSocket), "INFO");
     } else {
@@ -585,30 +870,26 @@ UniqueSSL Server::AcceptSSLConnection(SSL_CTX* ctx_raw, int clientSocket) {
 }
 
 // --- Implémentation de la méthode Server::HandleClient ---
-// Gère toute la durée de vie d'une connexion cliente dans son propre thread.
-void Server::HandleClient(int clientSocket, SSL* raw_ssl_ptr) {
+// Gère l'authentification puis le démarrage de la session d'une connexion (TLS ou socket Unix).
+void Server::HandleClient(std::shared_ptr<ServerConnection> client_conn) {
+    int clientSocket = client_conn ? client_conn->getSocketFD() : -1;
     LOG("Server::HandleClient INFO : Thread démarré pour socket FD: " + std::to_string(clientSocket), "INFO");
 
-    // Déclarer client_conn et session au début du scope du try/catch principal
-    // pour s'assurer que leur destruction (et donc le nettoyage de la connexion/session)
+    // Déclarer session au début du scope du try/catch principal
+    // pour s'assurer que sa destruction (et donc le nettoyage de la connexion/session)
     // se fasse même si une exception survient.
-    std::shared_ptr<ServerConnection> client_conn = nullptr;
     std::shared_ptr<ClientSession> session = nullptr; // Sera créé après l'authentification.
     std::string authenticated_clientId; // Variable pour stocker l'ID après auth réussie.
 
     try {
-        // --- 1. Créer l'objet ServerConnection ---
-        // Cet objet encapsule la socket et l'objet SSL.
-        client_conn = std::make_shared<ServerConnection>(clientSocket, raw_ssl_ptr);
-        // raw_ssl_ptr ne doit plus être utilisé directement après cette ligne si ServerConnection en prend possession.
-
-        // Vérification basique si l'objet a été créé et est connecté.
+        // --- 1. Vérifier l'objet ServerConnection ---
+        // Créé par SubmitClient (TLS) ou UnixAcceptLoop (clair) : il encapsule la socket et son transport.
         if (!client_conn || !client_conn->isConnected()) {
-             LOG("Server::HandleClient ERROR : Objet ServerConnection invalide ou non connecté après création pour socket FD: " + std::to_string(clientSocket) + ". Arrêt du thread.", "ERROR");
-             // Le destructeur de client_conn devrait fermer la socket/libérer SSL.
+             LOG("Server::HandleClient ERROR : Objet ServerConnection invalide ou non connecté pour socket FD: " + std::to_string(clientSocket) + ". Arrêt du thread.", "ERROR");
+             // Le destructeur de client_conn ferme la socket et libère le transport.
              return; // Quitte le thread de gestion client.
         }
-        LOG("Server::HandleClient INFO : Objet ServerConnection créé et connecté pour socket FD: " + std::to_string(client_conn->getSocketFD()), "INFO");
+        LOG("Server::HandleClient INFO : Connexion " + std::string(client_conn->getTransportName()) + " prête pour socket FD: " + std::to_string(client_conn->getSocketFD()), "INFO");
 
 
         // --- 2. Authentification du client ---
@@ -621,6 +902,10 @@ void Server::HandleClient(int clientSocket, SSL* raw_ssl_ptr) {
             // Appelle la méthode d'authentification.
             // AuthenticateClient a besoin d'une référence au serveur pour appeler processAuthRequest.
             authOutcome = authenticator.AuthenticateClient(*client_conn, *this, authenticated_clientId);
+            // Handshake et authentification terminés : la connexion ne compte plus dans le travail en cours.
+            if (this->admission) {
+                this->admission->markEstablished(client_conn->getSocketFD());
+            }
 
             // --- Vérifier le résultat de l'authentification ---
             if (authOutcome == AuthOutcome::FAIL) {
@@ -659,6 +944,26 @@ void Server::HandleClient(int clientSocket, SSL* raw_ssl_ptr) {
 
 
         // Charger ou créer le Wallet ET vérifier une session active ET créer la nouvelle session
+        // Mode thread : personne ne retire de la table une session fermée (inactivité, QUIT, pair disparu).
+        // Sa connexion étant fermée, elle ne doit pas bloquer la reconnexion : on la retire, puis on la
+        // détruit hors du verrou (sauvegarde de son Wallet) AVANT de charger le Wallet de la nouvelle session.
+        // (En mode réacteur, la callback de fin de session s'en charge.)
+        if (!this->reactor) {
+             std::shared_ptr<ClientSession> stale_session;
+             {
+                  std::lock_guard<std::mutex> lock(this->sessionsMutex);
+                  auto existing = this->activeSessions.find(authenticated_clientId);
+                  if (existing != this->activeSessions.end() && existing->second) {
+                       auto existing_conn = existing->second->getClientConnection();
+                       if (!existing_conn || !existing_conn->isConnected()) {
+                            LOG("Server::HandleClient INFO : Session précédente de client ID: '" + authenticated_clientId + "' déjà fermée. Retrait de la table avant reconnexion.", "INFO");
+                            stale_session = std::move(existing->second);
+                            this->activeSessions.erase(existing);
+                       }
+                  }
+             }
+        }
+
         { // Début du bloc pour le lock_guard protégeant activeSessions et la création/chargement du Wallet.
              std::lock_guard<std::mutex> lock(this->sessionsMutex);
 
@@ -673,6 +978,16 @@ void Server::HandleClient(int clientSocket, SSL* raw_ssl_ptr) {
                   }
                   return; // Quitte le thread de gestion client (HandleClient).
              }
+             // Mise à jour à chaud : ce processus ne crée plus de sessions, ou le compte est encore tenu par l'ancien.
+             std::string handoff_refusal = HandoffRefusal(authenticated_clientId);
+             if (!handoff_refusal.empty()) {
+                  LOG("Server::HandleClient WARNING : Connexion refusée pour client ID: '" + authenticated_clientId + "' pendant une mise à jour à chaud. Socket FD: " + std::to_string(client_conn->getSocketFD()), "WARNING");
+                  if(client_conn && client_conn->isConnected()) {
+                       try { client_conn->send(handoff_refusal + "\n"); } catch(...) {}
+                       client_conn->closeConnection();
+                  }
+                  return;
+             }
              // Si on arrive ici : Authentification réussie ET PAS DE SESSION ACTIVE EXISTANTE.
 
              // --- 2. Charger ou créer le Wallet pour ce client ID (sous lock) ---
@@ -704,6 +1019,12 @@ void Server::HandleClient(int clientSocket, SSL* raw_ssl_ptr) {
                      // APPEL à make_shared<ClientSession> avec les 3 arguments.
                      // ID Client (string), Connexion (shared_ptr<ServerConnection>), Wallet (shared_ptr<Wallet>)
                      session = std::make_shared<ClientSession>(authenticated_clientId, client_conn, clientWallet);
+                     if (session) {
+                         session->setIdlePolicy(std::chrono::seconds(this->options.idleTimeoutSec), std::chrono::seconds(this->options.heartbeatIntervalSec));
+                         session->setShmGateway(this->shmGateway.get());
+                         session->setPriceFeed(&this->priceFeed);
+                         session->setChannelHost(this, static_cast<size_t>(std::max(0, this->options.maxChannelsPerConnection)));
+                     }
 
                      // Vérifier si la création de la Session a échoué (ptr null).
                      if (!session) {
@@ -791,9 +1112,17 @@ void Server::HandleClient(int clientSocket, SSL* raw_ssl_ptr) {
         // Démarrer le thread de la ClientSession et finaliser la gestion (SANS LOCK)
         // La session est déjà créée et enregistrée. Reste à la démarrer (ce qui lance son thread run()).
         try {
-             // Le démarrage lance le thread run().
-             session->start();
-             LOG("Server::HandleClient INFO : Thread ClientSession démarré pour client ID: " + authenticated_clientId + ". Le thread HandleClient va se terminer normalement.", "INFO");
+             if (this->reactor) {
+                 // Mode réacteur : pas de thread dédié, un thread d'E/S du réacteur pilote la session.
+                 if (!session->startInReactor() || !this->reactor->addSession(session)) {
+                     throw std::runtime_error("Échec de l'attachement de la session au réacteur epoll.");
+                 }
+                 LOG("Server::HandleClient INFO : ClientSession pour client ID: " + authenticated_clientId + " confiée au réacteur epoll.", "INFO");
+             } else {
+                 // Le démarrage lance le thread run().
+                 session->start();
+                 LOG("Server::HandleClient INFO : Thread ClientSession démarré pour client ID: " + authenticated_clientId + ". Le thread HandleClient va se terminer normalement.", "INFO");
+             }
         } catch (const std::exception& e) {
              LOG("Server::HandleClient ERROR : Exception lors du démarrage du thread ClientSession pour client ID " + authenticated_clientId + ". Socket FD: " + std::to_string(client_conn->getSocketFD()) + ". Exception: " + e.what() + ". Tentative de nettoyage.", "ERROR");
              // Si le démarrage du thread échoue, il faut nettoyer la session (retirer de activeSessions, fermer connexion).
@@ -841,13 +1170,8 @@ void Server::HandleClient(int clientSocket, SSL* raw_ssl_ptr) {
              LOG("Server::HandleClient CRITICAL ERROR : Tentative de fermeture de client_conn (" + std::to_string(client_conn->getSocketFD()) + ") suite à exception.", "CRITICAL");
              try { client_conn->send("CRITICAL SERVER ERROR: Unhandled exception in your session thread. Connection closing.\n"); } catch(...) {}
              client_conn->closeConnection(); // Le destructeur ServerConnection s'assurera aussi du cleanup SSL/socket.
-        } else {
-            // Si client_conn n'a pas pu être créé ou connecté, il faut nettoyer raw_ssl_ptr et clientSocket manuellement.
-             LOG("Server::HandleClient CRITICAL ERROR : client_conn n'était pas valide/connecté. Tentative de nettoyage manuel socket/SSL (FD: " + std::to_string(clientSocket) + ") suite à exception.", "CRITICAL");
-            // Ssl_free gère les cas où le socket FD est déjà fermé. close gère les cas où FD est -1.
-            if (raw_ssl_ptr) { SSL_free(raw_ssl_ptr); raw_ssl_ptr = nullptr; }
-            if (clientSocket != -1) { close(clientSocket); clientSocket = -1; }
         }
+        // Sinon la connexion est déjà fermée (le destructeur de ServerConnection libère socket et transport).
 
         // 2. Si la session a été créée avant l'exception, tenter de la retirer des listes globales.
         // Pour l'instant, on retire la session de activeSessions si elle y a été ajoutée.
@@ -866,39 +1190,296 @@ void Server::HandleClient(int clientSocket, SSL* raw_ssl_ptr) {
     // Fin de la méthode Server::HandleClient. Le thread se termine ici.
 }
 
-void Server::threadPoolWorker() {
-    while (true) {
-        std::function<void()> task;
-        {
-            std::unique_lock<std::mutex> lock(taskQueueMutex);
-            taskQueueCV.wait(lock, [this]() { return !taskQueue.empty() || stopThreadPool; });
+// --- Implémentation de la méthode Server::SubmitClient ---
+// Connexion TLS dont le handshake est terminé : ServerConnection prend possession du socket et de l'objet SSL.
+void Server::SubmitClient(int clientSocket, SSL* ssl) {
+    auto client_conn = std::make_shared<ServerConnection>(clientSocket, ssl);
+    if (this->admission) {
+        // La place réservée à accept() est rendue à la fermeture de la connexion, quel qu'en soit le chemin.
+        client_conn->setCloseHandler([this](int fd) { this->ReleaseAdmission(fd); });
+    }
+    SubmitConnection(std::move(client_conn));
+}
 
-            if (stopThreadPool && taskQueue.empty()) {
-                return;
-            }
+// --- Implémentation de la méthode Server::ReleaseAdmission ---
+void Server::ReleaseAdmission(int clientSocket) {
+    if (this->admission) {
+        this->admission->release(clientSocket);
+    }
+}
 
-            task = std::move(taskQueue.front());
-            taskQueue.pop();
-        }
-        task(); // Exécuter la tâche
+// --- Implémentation de la méthode Server::getAdmissionStats ---
+AdmissionStats Server::getAdmissionStats() const {
+    return this->admission ? this->admission->getStats() : AdmissionStats();
+}
+
+// --- Implémentation de la méthode Server::getOverloadState ---
+OverloadState Server::getOverloadState() const {
+    return this->admission ? this->admission->getState() : OverloadState::NORMAL;
+}
+
+// --- Implémentation de la méthode Server::SubmitConnection ---
+// Confie HandleClient à l'exécuteur. La capture [this, shared_ptr] tient dans le stockage
+// interne d'InlineTask : pas d'allocation supplémentaire par connexion.
+void Server::SubmitConnection(std::shared_ptr<ServerConnection> client_conn) {
+    bool submitted = this->executor && this->executor->submit([this, client_conn]() {
+        this->HandleClient(client_conn);
+    });
+    if (!submitted) {
+        LOG("Server::SubmitConnection WARNING : Exécuteur arrêté. Connexion socket FD: " + std::to_string(client_conn->getSocketFD()) + " fermée.", "WARNING");
+        client_conn->closeConnection();
     }
 }
 
 // --- Implémentation de la méthode Server::AcceptLoop ---
-void Server::AcceptLoop() {
-    LOG("Server::AcceptLoop INFO : Thread démarré. En attente de connexions...", "INFO");
+// --- Implémentation de la méthode Server::CreateListenSocket ---
+// Crée, configure, lie et met en écoute un socket TCP sur le port du serveur.
+// Retourne le descripteur, ou -1 en cas d'échec (erreur déjà loggée).
+int Server::CreateListenSocket(bool reusePort) {
+    int listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket == -1) {
+        LOG("Server::CreateListenSocket ERROR : Échec de la création de la socket serveur. Erreur: " + std::string(strerror(errno)), "ERROR");
+        return -1;
+    }
+
+    // Configurer l'option SO_REUSEADDR.
+    int opt = 1;
+    if (setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        LOG("Server::CreateListenSocket WARNING : setsockopt(SO_REUSEADDR) a échoué. Erreur: " + std::string(strerror(errno)), "WARNING");
+    }
+    // SO_REUSEPORT : plusieurs sockets liés au même port, le noyau répartit les connexions entrantes.
+    if (reusePort && setsockopt(listenSocket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        LOG("Server::CreateListenSocket ERROR : setsockopt(SO_REUSEPORT) a échoué. Erreur: " + std::string(strerror(errno)), "ERROR");
+        close(listenSocket);
+        return -1;
+    }
+
+    // Configure l'adresse et le port d'écoute.
+    sockaddr_in serverAddr{};
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_addr.s_addr = INADDR_ANY;
+    serverAddr.sin_port = htons(this->port);
+
+    // Lie l'adresse et le port.
+    if (bind(listenSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+        LOG("Server::CreateListenSocket ERROR : Échec de la liaison (bind) de la socket serveur. Port : " + std::to_string(this->port) + ". Erreur: " + std::string(strerror(errno)), "ERROR");
+        close(listenSocket);
+        return -1;
+    }
+
+    // Commence à écouter les connexions.
+    if (listen(listenSocket, SOMAXCONN) < 0) {
+        LOG("Server::CreateListenSocket ERROR : Échec de l'écoute (listen) sur la socket serveur. Erreur: " + std::string(strerror(errno)), "ERROR");
+        close(listenSocket);
+        return -1;
+    }
+    return listenSocket;
+}
+
+
+// --- Implémentation de la méthode Server::getShardStats ---
+std::vector<ShardStats> Server::getShardStats() const {
+    std::vector<ShardStats> stats;
+    stats.reserve(this->listenerShards.size());
+    for (const auto& shard : this->listenerShards) {
+        ShardStats st;
+        st.index = shard->index;
+        st.accepted = shard->accepted.load(std::memory_order_relaxed);
+        st.shed = shard->shed.load(std::memory_order_relaxed);
+        if (shard->handshakePool) {
+            st.handshakesCompleted = shard->handshakePool->getCompletedCount();
+            st.handshakesFailed = shard->handshakePool->getFailedCount();
+            st.handshakesTimedOut = shard->handshakePool->getTimedOutCount();
+        }
+        stats.push_back(st);
+    }
+    return stats;
+}
+
+// --- Implémentation de la méthode Server::getResumptionStats ---
+TlsResumptionStats Server::getResumptionStats() const {
+    return this->resumption ? this->resumption->getStats() : TlsResumptionStats();
+}
+
+// --- Implémentation de la méthode Server::GetListenSockets ---
+std::vector<int> Server::GetListenSockets() const {
+    std::vector<int> sockets;
+    for (const auto& shard : this->listenerShards) {
+        if (shard->listenSocket != -1) {
+            sockets.push_back(shard->listenSocket);
+        }
+    }
+    return sockets;
+}
+
+// --- Implémentation de la méthode Server::WakeAcceptThreads ---
+void Server::WakeAcceptThreads() {
+    for (auto& shard : this->listenerShards) {
+        if (shard->wakeFd != -1) {
+            uint64_t one = 1;
+            ssize_t ignored = write(shard->wakeFd, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+    if (this->unixWakeFd != -1) {
+        uint64_t one = 1;
+        ssize_t ignored = write(this->unixWakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+// --- Implémentation de la méthode Server::BeginDrain ---
+// Le nouveau processus accepte sur les mêmes sockets : on cesse d'accepter. Les handshakes et
+// authentifications déjà commencés se terminent normalement (voir DrainSessions).
+void Server::BeginDrain() {
+    LOG("Server::BeginDrain INFO : Sockets d'écoute repris par le nouveau processus. Arrêt de l'acceptation.", "INFO");
+    this->acceptingConnections.store(false, std::memory_order_release);
+    WakeAcceptThreads();
+}
+
+// --- Implémentation de la méthode Server::PrepareHandoff ---
+// Appelée avant l'envoi des sockets : plus aucune session (ni enregistrement) créée ici, pour que la liste
+// des comptes tenus (Wallet::liveClientIds) soit complète. Les connexions encore acceptées ou authentifiées
+// d'ici READY sont refusées avec une invitation à se reconnecter (elles iront au nouveau processus).
+HotUpgrade::Handoff Server::PrepareHandoff() {
+    {
+        std::lock_guard<std::mutex> lock(this->sessionsMutex);
+        this->sessionsFrozen.store(true);
+    }
+    {
+        // Barrière : un enregistrement commencé avant le gel est sauvegardé avant que le nouveau processus relise le fichier.
+        std::lock_guard<std::mutex> lock(this->usersMutex);
+    }
+    HotUpgrade::Handoff handoff;
+    handoff.listenSockets = GetListenSockets();
+    handoff.transactionCounter = Transaction::getCounter();
+    LOG("Server::PrepareHandoff INFO : Création de sessions gelée pour la mise à jour à chaud (compteur " + std::to_string(handoff.transactionCounter) + ").", "INFO");
+    return handoff;
+}
+
+// --- Implémentation de la méthode Server::AbortHandoff ---
+void Server::AbortHandoff() {
+    std::lock_guard<std::mutex> lock(this->sessionsMutex);
+    this->sessionsFrozen.store(false);
+    LOG("Server::AbortHandoff INFO : Mise à jour à chaud non confirmée. Création de sessions rétablie.", "INFO");
+}
+
+// --- Implémentation de la méthode Server::ReleaseLease ---
+void Server::ReleaseLease(const std::string& clientId) {
+    std::lock_guard<std::mutex> lock(this->sessionsMutex);
+    if (clientId.empty()) {
+        if (!this->leasedAccounts.empty()) {
+            LOG("Server::ReleaseLease INFO : Ancien processus terminé : " + std::to_string(this->leasedAccounts.size()) + " compte(s) rendu(s).", "INFO");
+        }
+        this->leasedAccounts.clear();
+    } else if (this->leasedAccounts.erase(clientId) != 0) {
+        LOG("Server::ReleaseLease INFO : Compte '" + clientId + "' rendu par l'ancien processus.", "INFO");
+    }
+}
+
+// --- Implémentation de la méthode Server::HandoffRefusal ---
+std::string Server::HandoffRefusal(const std::string& clientId) const {
+    if (this->sessionsFrozen.load()) {
+        return "AUTH FAIL: Server is restarting. Please reconnect.";
+    }
+    if (this->leasedAccounts.count(clientId) != 0) {
+        return "AUTH FAIL: Session still closing on the previous server process. Please retry shortly.";
+    }
+    return std::string();
+}
+
+// --- Implémentation de la méthode Server::CountLiveSessions ---
+size_t Server::CountLiveSessions() {
+    std::lock_guard<std::mutex> lock(this->sessionsMutex);
+    size_t live = 0;
+    for (const auto& [clientId, session] : this->activeSessions) {
+        auto conn = session ? session->getClientConnection() : nullptr;
+        if (conn && conn->isConnected()) {
+            live++;
+        }
+    }
+    return live;
+}
+
+// --- Implémentation de la méthode Server::DrainSessions ---
+void Server::DrainSessions() {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(this->options.drainTimeoutSec);
+    auto next_log = std::chrono::steady_clock::now();
+
+    while (true) {
+        // Connexions encore en cours d'établissement : handshakes TLS, puis authentifications dans l'exécuteur.
+        uint64_t pending_handshakes = 0;
+        for (const ShardStats& st : getShardStats()) {
+            uint64_t finished = st.handshakesCompleted + st.handshakesFailed + st.handshakesTimedOut;
+            pending_handshakes += st.accepted > finished ? st.accepted - finished : 0;
+        }
+        ExecutorStats exec = getExecutorStats();
+        uint64_t pending_tasks = exec.submitted - exec.executed;
+        size_t live = CountLiveSessions();
+
+        auto now = std::chrono::steady_clock::now();
+        if (live == 0 && pending_handshakes == 0 && pending_tasks == 0) {
+            LOG("Server::DrainSessions INFO : Toutes les sessions sont terminées. Arrêt de l'ancien processus.", "INFO");
+            return;
+        }
+        if (now >= deadline) {
+            LOG("Server::DrainSessions WARNING : Délai de vidange dépassé (" + std::to_string(this->options.drainTimeoutSec) + " s). " + std::to_string(live) + " sessions encore actives seront fermées.", "WARNING");
+            return;
+        }
+        if (now >= next_log) {
+            LOG("Server::DrainSessions INFO : Vidange en cours : " + std::to_string(live) + " sessions, " + std::to_string(pending_handshakes) + " handshakes, " + std::to_string(pending_tasks) + " authentifications.", "INFO");
+            next_log = now + std::chrono::seconds(10);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+}
+
+// --- Implémentation de la méthode Server::getExecutorStats ---
+ExecutorStats Server::getExecutorStats() const {
+    return this->executor ? this->executor->getStats() : ExecutorStats();
+}
+
+// --- Implémentation de la méthode Server::LogShardStats ---
+// Une ligne par shard : permet de vérifier l'équilibrage SO_REUSEPORT.
+void Server::LogShardStats() const {
+    for (const ShardStats& st : getShardStats()) {
+        LOG("Server::LogShardStats INFO : Shard " + std::to_string(st.index) + " : acceptées=" + std::to_string(st.accepted) + ", refusées=" + std::to_string(st.shed) + ", handshakes réussis=" + std::to_string(st.handshakesCompleted) + ", échoués=" + std::to_string(st.handshakesFailed) + ", expirés=" + std::to_string(st.handshakesTimedOut), "INFO");
+    }
+}
+
+
+void Server::AcceptLoop(ListenerShard& shard) {
+    LOG("Server::AcceptLoop INFO : Thread démarré (shard " + std::to_string(shard.index) + "). En attente de connexions...", "INFO");
 
     while (this->acceptingConnections.load(std::memory_order_acquire)) {
         sockaddr_in clientAddr{};
         socklen_t clientLen = sizeof(clientAddr);
 
-        int clientSocket = accept(this->serverSocket, (struct sockaddr*)&clientAddr, &clientLen);
+        // Attente d'une connexion ou d'un réveil (arrêt, mise à jour à chaud).
+        pollfd fds[2] = {{shard.listenSocket, POLLIN, 0}, {shard.wakeFd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            LOG("Server::AcceptLoop ERROR : poll() a échoué. Erreur: " + std::string(strerror(errno)), "ERROR");
+            break;
+        }
+        if (fds[1].revents != 0) {
+            LOG("Server::AcceptLoop INFO : Réveil d'arrêt reçu (shard " + std::to_string(shard.index) + "). Sortie.", "INFO");
+            break;
+        }
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        int clientSocket = accept(shard.listenSocket, (struct sockaddr*)&clientAddr, &clientLen);
 
         if (clientSocket < 0) {
             if (!this->acceptingConnections.load(std::memory_order_acquire)) {
                 LOG("Server::AcceptLoop INFO : Signal d'arrêt détecté via acceptingConnections après accept() (socket < 0). Sortie.", "INFO");
                 break;
             }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                continue; // Connexion prise entre-temps (socket partagé avec un autre processus pendant une mise à jour).
+            }
             if (errno == EINTR) {
                 LOG("Server::AcceptLoop WARNING : Appel accept() interrompu par signal (EINTR). Continuation...", "WARNING");
                 continue;
@@ -917,10 +1498,32 @@ void Server::AcceptLoop() {
             break;
         }
 
+        // Contrôle d'admission AVANT tout travail TLS (SSL_new, handshake) : un refus ne coûte qu'un close().
+        // Les connexions refusées ne comptent pas dans 'accepted' (elles n'ont pas de handshake à attendre).
+        if (this->admission && this->admission->admit(clientSocket, clientAddr.sin_addr.s_addr) != AdmissionVerdict::ADMITTED) {
+            shard.shed.fetch_add(1, std::memory_order_relaxed);
+            AdmissionController::refuse(clientSocket);
+            continue;
+        }
+
+        shard.accepted.fetch_add(1, std::memory_order_relaxed);
+        LowLatency::configureSocket(clientSocket, this->options.lowLatency.tcpNoDelay, this->options.lowLatency.busyPollMicros);
+
         std::stringstream log_accept_ss;
-        log_accept_ss << "Server::AcceptLoop INFO : Nouvelle connexion acceptée. Socket FD: " << clientSocket << ", IP: " << inet_ntoa(clientAddr.sin_addr);
+        log_accept_ss << "Server::AcceptLoop INFO : Nouvelle connexion acceptée. Socket FD: " << clientSocket << ", shard: " << shard.index << ", IP: " << inet_ntoa(clientAddr.sin_addr);
         LOG(log_accept_ss.str(), "INFO");
 
+        // Handshake TLS non bloquant délégué au pool : accept() ne dépend jamais d'un aller-retour TLS.
+        if (shard.handshakePool) {
+            if (!shard.handshakePool->submit(clientSocket)) {
+                LOG("Server::AcceptLoop ERROR : Impossible de confier le socket FD " + std::to_string(clientSocket) + " au pool de handshake. Fermeture.", "ERROR");
+                ReleaseAdmission(clientSocket);
+                close(clientSocket);
+            }
+            continue;
+        }
+
+        // Repli : handshake bloquant sur le thread d'acceptation.
         UniqueSSL client_ssl = AcceptSSLConnection(this->ctx.get(), clientSocket);
 
         if (!client_ssl) {
@@ -929,19 +1532,121 @@ void Server::AcceptLoop() {
         }
         LOG("Server::AcceptLoop INFO : Handshake SSL réussi pour socket FD: " + std::to_string(clientSocket), "INFO");
 
-        // Ajouter la tâche au pool de threads
-        {
-            std::lock_guard<std::mutex> lock(taskQueueMutex);
-            taskQueue.emplace([this, clientSocket, ssl = client_ssl.release()]() {
-                this->HandleClient(clientSocket, ssl);
-            });
-        }
-        taskQueueCV.notify_one(); // Notifier un thread du pool
+        // Confier l'authentification à l'exécuteur.
+        SubmitClient(clientSocket, client_ssl.release());
     }
 
     LOG("Server::AcceptLoop INFO : Thread Server::AcceptLoop terminé.", "INFO");
 }
 
+// --- Implémentation de la méthode Server::CreateUnixListenSocket ---
+// Socket AF_UNIX en écoute sur options.unixSocketPath. Le fichier est créé avec les droits 0660
+// (umask temporaire) : seuls l'utilisateur du serveur et son groupe peuvent s'y connecter ;
+// SO_PEERCRED filtre ensuite les utilisateurs autorisés. Retourne -1 en cas d'échec (erreur loggée).
+int Server::CreateUnixListenSocket() {
+    const std::string& path = this->options.unixSocketPath;
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        LOG("Server::CreateUnixListenSocket ERROR : Chemin du socket Unix trop long : '" + path + "'.", "ERROR");
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        LOG("Server::CreateUnixListenSocket ERROR : Impossible de créer le socket Unix. Erreur: " + std::string(strerror(errno)), "ERROR");
+        return -1;
+    }
+    // Un fichier restant d'une exécution précédente (ou d'un ancien processus lors d'une mise à jour à chaud,
+    // qui garde son propre socket jusqu'à la fin de sa vidange) est remplacé.
+    unlink(path.c_str());
+    mode_t previous_mask = umask(0117);
+    int bound = bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    umask(previous_mask);
+    if (bound < 0 || listen(sock, SOMAXCONN) < 0 || fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK) == -1) {
+        LOG("Server::CreateUnixListenSocket ERROR : Échec bind/listen sur '" + path + "'. Erreur: " + std::string(strerror(errno)), "ERROR");
+        close(sock);
+        if (bound == 0) {
+            unlink(path.c_str());
+        }
+        return -1;
+    }
+    LOG("Server::CreateUnixListenSocket INFO : Écoute locale en clair sur '" + path + "'.", "INFO");
+    return sock;
+}
+
+// --- Implémentation de la méthode Server::IsAllowedPeer ---
+bool Server::IsAllowedPeer(uid_t uid) const {
+    if (this->options.unixAllowedUids.empty()) {
+        return uid == geteuid();
+    }
+    return std::find(this->options.unixAllowedUids.begin(), this->options.unixAllowedUids.end(), uid) != this->options.unixAllowedUids.end();
+}
+
+// --- Implémentation de la méthode Server::PeerAccount ---
+// Le filtre IsAllowedPeer autorise seulement la connexion ; l'accès sans mot de passe est limité au compte lié à l'UID.
+std::string Server::PeerAccount(const ServerConnection& conn) const {
+    if (!conn.isPeerTrusted()) {
+        return std::string();
+    }
+    auto it = this->options.unixPeerAccounts.find(conn.getPeerUid());
+    return it != this->options.unixPeerAccounts.end() ? it->second : std::string();
+}
+
+// --- Implémentation de la méthode Server::UnixAcceptLoop ---
+// Pas de handshake : l'identité du processus pair est fournie par le noyau (SO_PEERCRED) et la connexion
+// passe directement à l'exécuteur, puis au même chemin d'authentification et de session que TLS.
+void Server::UnixAcceptLoop() {
+    LOG("Server::UnixAcceptLoop INFO : Thread démarré. En attente de connexions locales...", "INFO");
+
+    while (this->acceptingConnections.load(std::memory_order_acquire)) {
+        pollfd fds[2] = {{this->unixListenSocket, POLLIN, 0}, {this->unixWakeFd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            LOG("Server::UnixAcceptLoop ERROR : poll() a échoué. Erreur: " + std::string(strerror(errno)), "ERROR");
+            break;
+        }
+        if (fds[1].revents != 0) {
+            LOG("Server::UnixAcceptLoop INFO : Réveil d'arrêt reçu. Sortie.", "INFO");
+            break;
+        }
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        // Socket client bloquant (comme après le handshake TLS) : le réacteur le repasse en non bloquant.
+        int clientSocket = accept4(this->unixListenSocket, nullptr, nullptr, SOCK_CLOEXEC);
+        if (clientSocket < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            LOG("Server::UnixAcceptLoop ERROR : Échec inattendu accept(). Erreur: " + std::string(strerror(errno)), "ERROR");
+            continue;
+        }
+
+        ucred peer{};
+        socklen_t peer_len = sizeof(peer);
+        if (getsockopt(clientSocket, SOL_SOCKET, SO_PEERCRED, &peer, &peer_len) != 0) {
+            LOG("Server::UnixAcceptLoop ERROR : SO_PEERCRED indisponible. Erreur: " + std::string(strerror(errno)) + ". Connexion fermée.", "ERROR");
+            close(clientSocket);
+            continue;
+        }
+        if (!IsAllowedPeer(peer.uid)) {
+            LOG("Server::UnixAcceptLoop WARNING : Connexion locale refusée pour uid " + std::to_string(peer.uid) + " (pid " + std::to_string(peer.pid) + ").", "WARNING");
+            close(clientSocket);
+            continue;
+        }
+        LOG("Server::UnixAcceptLoop INFO : Nouvelle connexion locale. Socket FD: " + std::to_string(clientSocket) + ", pid: " + std::to_string(peer.pid) + ", uid: " + std::to_string(peer.uid), "INFO");
+
+        auto client_conn = std::make_shared<ServerConnection>(clientSocket, std::make_unique<PlainTransport>(clientSocket));
+        client_conn->setPeerCredentials(peer.pid, peer.uid);
+        SubmitConnection(client_conn);
+    }
+
+    LOG("Server::UnixAcceptLoop INFO : Thread terminé.", "INFO");
+}
+
 
 
 
@@ -22,44 +22,50 @@
 #include <netinet/in.h> 
 #include <arpa/inet.h>
 #include <unistd.h>     
+#include <fcntl.h>
+#include <poll.h>
 #include <openssl/ssl.h> 
 #include <openssl/err.h> 
 
 
 // --- Constructeur ---
-// Crée un ServerConnection pour une connexion acceptée. Prend possession du SSL* via UniqueSSL.
+// Crée un ServerConnection pour une connexion acceptée. Prend possession du SSL* (transport TLS).
 ServerConnection::ServerConnection(int socket_fd, SSL* ssl_ptr)
+    : ServerConnection(socket_fd, ssl_ptr ? std::make_unique<TlsTransport>(ssl_ptr) : nullptr)
+{
+}
+
+// Crée un ServerConnection sur un transport déjà établi (TLS après handshake, ou socket en clair).
+ServerConnection::ServerConnection(int socket_fd, std::unique_ptr<Transport> transport_ptr)
     // Liste d'initialisation : dans l'ordre de déclaration dans ServerConnection.h
     : clientSocket(socket_fd),
       clientId(), // Valeur par défaut
       token(),    // Valeur par défaut
       m_markedForClose(false),
-      // Initialise le unique_ptr 'ssl' avec le pointeur brut. UniqueSSL doit avoir le bon deleter (SSL_free).
-      ssl(ssl_ptr)
+      transport(std::move(transport_ptr)),
+      inputFramer(RECEIVE_RING_CAPACITY, MAX_LINE_LENGTH)
 {
-    // Validation : le pointeur SSL ne devrait pas être null si le handshake a réussi.
-    if (ssl_ptr) {
-         LOG("ServerConnection::ServerConnection INFO : Objet créé avec socket (" + std::to_string(clientSocket) + ") et SSL existants.", "INFO");
+    // Validation : le transport ne devrait pas être null si le handshake a réussi.
+    if (transport) {
+         LOG("ServerConnection::ServerConnection INFO : Objet créé avec socket (" + std::to_string(clientSocket) + ") et transport " + std::string(transport->name()) + ".", "INFO");
     } else {
         // Cas d'erreur : socket accepté mais handshake SSL échoué.
-        LOG("ServerConnection::ServerConnection ERROR : Objet créé avec socket valide (" + std::to_string(clientSocket) + ") mais SSL null. Tentative de fermeture du socket.", "ERROR");
+        LOG("ServerConnection::ServerConnection ERROR : Objet créé avec socket valide (" + std::to_string(clientSocket) + ") mais transport null. Tentative de fermeture du socket.", "ERROR");
         if (clientSocket != -1) {
              ::close(clientSocket); // Utilise la fonction système close() explicitement
              clientSocket = -1; // Marque le socket comme fermé
-             LOG("ServerConnection::ServerConnection ERROR : Socket fermé car SSL était null.", "ERROR");
+             LOG("ServerConnection::ServerConnection ERROR : Socket fermé car transport null.", "ERROR");
         }
-        // Le unique_ptr 'ssl' est déjà nullptr car initialisé avec ssl_ptr qui était null.
     }
     // Les membres string clientId et token sont vides par défaut, définis après authentification.
     // m_markedForClose est false par défaut.
-    // commMutex est initialisé par défaut.
 }
 
 // --- Destructeur ---
 // Assure la fermeture propre de la connexion et la libération des ressources.
 ServerConnection::~ServerConnection() {
     closeConnection(); // Appelle la méthode principale de nettoyage.
-    // Le unique_ptr 'ssl' sera automatiquement détruit ici, appelant son deleter (SSL_free) si non-null.
+    // Le transport (et son objet SSL) est libéré par closeConnection().
     // Le unique_ptr 'ctx' (s'il existait dans cette classe) serait aussi détruit ici.
 }
 
@@ -68,147 +74,398 @@ int ServerConnection::getSocketFD() const { return clientSocket; }
 const std::string& ServerConnection::getClientId() const { return clientId; }
 const std::string& ServerConnection::getToken() const { return token; }
 bool ServerConnection::isMarkedForClose() const { return m_markedForClose; }
+bool ServerConnection::canSendFile() const { return transport && transport->canSendFile(); }
+bool ServerConnection::canPassDescriptors() const { return transport && transport->canPassDescriptors(); }
+std::string ServerConnection::getTransportName() const { return transport ? transport->name() : "aucun"; }
+bool ServerConnection::isPeerTrusted() const { return peerTrusted; }
+uid_t ServerConnection::getPeerUid() const { return peerUid; }
 
 // Vérifie si la connexion est active et utilisable.
 bool ServerConnection::isConnected() const {
     // La connexion est active si le socket est valide, l'objet SSL* existe, ET n'est PAS marquée pour fermeture.
-    return clientSocket != -1 && ssl != nullptr && !m_markedForClose;
+    return clientSocket != -1 && transport != nullptr && !m_markedForClose;
 }
 
 
 // --- Setters ---
 void ServerConnection::setClientId(const std::string& id) { this->clientId = id; }
 void ServerConnection::setToken(const std::string& tok) { this->token = tok; }
+void ServerConnection::setPeerCredentials(pid_t pid, uid_t uid) {
+    this->peerPid = pid;
+    this->peerUid = uid;
+    this->peerTrusted = true;
+}
+
+void ServerConnection::setCloseHandler(std::function<void(int)> handler) {
+    this->closeHandler = std::move(handler);
+}
 
 
 // --- Méthodes de Communication Réseau ---
 
+// Délai maximal d'attente d'un socket non bloquant pendant un envoi.
+static const int SEND_WAIT_TIMEOUT_MS = 5000;
+
 // Envoie des données via la connexion SSL.
-// Retourne le nombre d'octets envoyés (>0), 0 si SSL_write retourne 0, < 0 en cas d'erreur fatale.
-// Gère les erreurs SSL_ERROR_WANT_READ/WRITE en mode bloquant en réessayant.
+// Le message est déposé dans la file d'envoi. Si un écrivain est attaché à la connexion (session démarrée),
+// il s'occupera de l'écriture et send() retourne immédiatement 'size'. Sinon (phase d'authentification),
+// la file est vidée ici même, en attendant le socket si nécessaire.
+// Retourne le nombre d'octets envoyés/déposés (>0), < 0 en cas d'erreur fatale.
 int ServerConnection::send(const char* data, int size) {
-    // Note Thread-Safety : Dans l'architecture ClientSession-par-thread, l'accès est sérialisé par le thread de session.
-
     if (!isConnected()) { // Vérifie l'état valide de la connexion.
         LOG("ServerConnection::send ERROR : Connexion non valide ou marquée pour fermeture. Socket FD: " + std::to_string(clientSocket), "ERROR");
         return -1; // Indique une erreur.
     }
+    if (size <= 0) {
+        return 0;
+    }
 
-    int bytesSent = 0;
-    int totalBytesSent = 0;
-    int remaining = size;
-    const char* current_data = data;
-
-    // Boucle pour gérer les écritures partielles et les erreurs WANT_WRITE en mode bloquant.
-    while (remaining > 0) {
-        bytesSent = SSL_write(ssl.get(), current_data, remaining);
-
-        if (bytesSent > 0) {
-            // Succès (partiel ou complet).
-            totalBytesSent += bytesSent;
-            current_data += bytesSent;
-            remaining -= bytesSent;
-            // Si remaining > 0, la boucle continue.
-
-        } else if (bytesSent == 0) {
-             // Peut indiquer une déconnexion propre (rare sur write).
-             int error = SSL_get_error(ssl.get(), bytesSent);
-             if (error == SSL_ERROR_ZERO_RETURN) {
-                  LOG("ServerConnection::send INFO : SSL_write retourné 0 (SSL_ERROR_ZERO_RETURN).", "INFO");
-             } else {
-                  LOG("ServerConnection::send WARNING : SSL_write retourné 0. Erreur code: " + std::to_string(error) + ". Socket FD: " + std::to_string(clientSocket), "WARNING");
-                  ERR_print_errors_fp(stderr);
-             }
-             markForClose(); // La connexion n'est plus bonne.
-             return -1; // Indique un échec.
-
-        } else { // bytesSent < 0 (erreur)
-            int error = SSL_get_error(ssl.get(), bytesSent);
-
-            if (error == SSL_ERROR_WANT_WRITE) {
-                 LOG("ServerConnection::send WARNING : SSL_ERROR_WANT_WRITE en mode bloquant. Réessai... Socket FD: " + std::to_string(clientSocket), "WARNING");
-                 continue; // Recommence la boucle.
-            } else if (error == SSL_ERROR_WANT_READ) {
-                 LOG("ServerConnection::send WARNING : SSL_ERROR_WANT_READ sur SSL_write en mode bloquant. Traité comme erreur fatale. Socket FD: " + std::to_string(clientSocket), "WARNING");
-                 markForClose();
-                 return -1;
-
-            } else if (error == SSL_ERROR_SYSCALL) {
-                 LOG("ServerConnection::send ERROR : Erreur système SSL_write (SSL_ERROR_SYSCALL). errno: " + std::string(strerror(errno)) + ". Socket FD: " + std::to_string(clientSocket), "ERROR");
-                 ERR_print_errors_fp(stderr);
-                 markForClose();
-                 return -1;
+    bool writer_attached;
+    {
+        std::lock_guard<std::mutex> lock(outboundMutex);
+        writer_attached = writerAttached;
+    }
+    if (!enqueueSend(std::string(data, static_cast<size_t>(size)))) {
+        return -1;
+    }
+    if (writer_attached) {
+        return size; // L'écrivain de la connexion enverra le message.
+    }
+    return flushBlocking() < 0 ? -1 : size;
+}
 
-            } else {
-                LOG("ServerConnection::send ERROR : Erreur SSL non gérée lors de l'envoi. Code: " + std::to_string(error) + ". Socket FD: " + std::to_string(clientSocket), "ERROR");
-                ERR_print_errors_fp(stderr);
-                markForClose();
-                return -1;
-            }
+// --- Dépôt d'un message dans la file d'envoi ---
+bool ServerConnection::enqueueSend(std::string message) {
+    if (message.empty()) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(outboundMutex);
+    if (outboundClosed) {
+        return false;
+    }
+    if (outboundQueue.size() >= MAX_OUTBOUND_MESSAGES || outboundBytes + message.size() > MAX_OUTBOUND_BYTES) {
+        // Le client ne lit plus assez vite : plutôt que de bufferiser sans limite, on ferme la connexion.
+        LOG("ServerConnection::enqueueSend WARNING : File d'envoi pleine (" + std::to_string(outboundQueue.size()) + " messages, " + std::to_string(outboundBytes) + " octets). Client trop lent, connexion marquée pour fermeture. Socket FD: " + std::to_string(clientSocket), "WARNING");
+        outboundClosed = true;
+        markForClose();
+        if (writeNotifier) writeNotifier(); // L'écrivain constatera la fermeture.
+        return false;
+    }
+    bool was_empty = outboundQueue.empty();
+    outboundBytes += message.size();
+    outboundQueue.emplace_back(std::move(message));
+    if (was_empty && writeNotifier) {
+        writeNotifier();
+    }
+    return true;
+}
+
+// --- Mise à jour remplaçable (conflation) ---
+bool ServerConnection::offerConflated(uint32_t key, std::shared_ptr<const std::string> update) {
+    if (!update || update->empty()) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(outboundMutex);
+    if (outboundClosed) {
+        return false;
+    }
+    for (auto& pending : conflatedUpdates) {
+        if (pending.first == key) {
+            pending.second = std::move(update); // L'écrivain est déjà prévenu.
+            return true;
         }
     }
+    bool was_idle = outboundQueue.empty() && conflatedUpdates.empty();
+    conflatedUpdates.emplace_back(key, std::move(update));
+    if (was_idle && writeNotifier) {
+        writeNotifier();
+    }
+    return true;
+}
 
-    return totalBytesSent; // Retourne le nombre total d'octets envoyés.
+// --- Dépôt d'un fichier dans la file d'envoi ---
+bool ServerConnection::enqueueFile(int fd, off_t offset, size_t size) {
+    OutboundItem item(fd, offset, size); // Ferme 'fd' si on ne le garde pas.
+    if (fd < 0 || size == 0) {
+        return fd >= 0;
+    }
+    bool writer_attached;
+    {
+        std::lock_guard<std::mutex> lock(outboundMutex);
+        if (outboundClosed) {
+            return false;
+        }
+        // Un fichier compte comme un message : ses octets ne sont pas en mémoire.
+        if (outboundQueue.size() >= MAX_OUTBOUND_MESSAGES) {
+            LOG("ServerConnection::enqueueFile WARNING : File d'envoi pleine (" + std::to_string(outboundQueue.size()) + " messages). Client trop lent, connexion marquée pour fermeture. Socket FD: " + std::to_string(clientSocket), "WARNING");
+            outboundClosed = true;
+            markForClose();
+            if (writeNotifier) writeNotifier();
+            return false;
+        }
+        bool was_empty = outboundQueue.empty();
+        outboundQueue.push_back(std::move(item));
+        if (was_empty && writeNotifier) {
+            writeNotifier();
+        }
+        writer_attached = writerAttached;
+    }
+    return writer_attached || flushBlocking() == 0;
 }
 
-// Reçoit des données via la connexion SSL.
-// Retourne le nombre d'octets reçus (>0), 0 pour déconnexion propre (SSL_ERROR_ZERO_RETURN), < 0 pour erreur fatale.
-// Gère les erreurs SSL_ERROR_WANT_READ/WRITE en mode bloquant en retournant 0.
-int ServerConnection::receive(char* buffer, int size) {
-     // Note Thread-Safety : Voir commentaires dans send().
+// --- Dépôt d'un message accompagné de descripteurs ---
+bool ServerConnection::enqueueWithDescriptors(std::string message, std::vector<int> fds) {
+    OutboundItem item(std::move(message), std::move(fds)); // Ferme les descripteurs si on ne le garde pas.
+    if (item.data.empty() || !canPassDescriptors()) {
+        return false;
+    }
+    bool writer_attached;
+    {
+        std::lock_guard<std::mutex> lock(outboundMutex);
+        if (outboundClosed) {
+            return false;
+        }
+        if (outboundQueue.size() >= MAX_OUTBOUND_MESSAGES || outboundBytes + item.data.size() > MAX_OUTBOUND_BYTES) {
+            LOG("ServerConnection::enqueueWithDescriptors WARNING : File d'envoi pleine. Client trop lent, connexion marquée pour fermeture. Socket FD: " + std::to_string(clientSocket), "WARNING");
+            outboundClosed = true;
+            markForClose();
+            if (writeNotifier) writeNotifier();
+            return false;
+        }
+        bool was_empty = outboundQueue.empty();
+        outboundBytes += item.data.size();
+        outboundQueue.push_back(std::move(item));
+        if (was_empty && writeNotifier) {
+            writeNotifier();
+        }
+        writer_attached = writerAttached;
+    }
+    return writer_attached || flushBlocking() == 0;
+}
 
-    if (!isConnected()) {
-        LOG("ServerConnection::receive ERROR : Connexion non valide ou marquée pour fermeture. Socket FD: " + std::to_string(clientSocket), "ERROR");
-        return -1;
+static void closeDescriptors(std::vector<int>& fds) {
+    for (int fd : fds) {
+        ::close(fd);
     }
+    fds.clear();
+}
 
-    int bytesRead = 0;
+// --- Élément de la file d'envoi ---
+ServerConnection::OutboundItem::OutboundItem(OutboundItem&& other) noexcept
+    : data(std::move(other.data)), fileFd(other.fileFd), fileOffset(other.fileOffset), fileRemaining(other.fileRemaining),
+      descriptors(std::move(other.descriptors))
+{
+    other.descriptors.clear();
+    other.fileFd = -1;
+    other.fileRemaining = 0;
+}
 
-    // En mode bloquant, SSL_read devrait bloquer jusqu'à ce qu'il y ait des données OU une erreur.
-    // L'appelant (ClientSession::run) est responsable de boucler sur receive() et de gérer la reconstruction des messages complets.
-    bytesRead = SSL_read(ssl.get(), buffer, size);
-
-    // --- Gestion du résultat de SSL_read ---
-    if (bytesRead > 0) {
-        // Lecture réussie.
-        return bytesRead; // Retourne le nombre d'octets lus (> 0).
-
-    } else if (bytesRead == 0) {
-        // SSL_read retourne 0. Indique généralement une déconnexion propre.
-        int error = SSL_get_error(ssl.get(), bytesRead);
-        if (error == SSL_ERROR_ZERO_RETURN) {
-            LOG("ServerConnection::receive INFO : Connexion fermée proprement par le pair (SSL_ERROR_ZERO_RETURN). Socket FD: " + std::to_string(clientSocket), "INFO");
-        } else {
-             LOG("ServerConnection::receive WARNING : SSL_read retourné 0. Erreur code: " + std::to_string(error) + ". Socket FD: " + std::to_string(clientSocket), "WARNING");
-             ERR_print_errors_fp(stderr);
+ServerConnection::OutboundItem& ServerConnection::OutboundItem::operator=(OutboundItem&& other) noexcept {
+    if (this != &other) {
+        if (fileFd != -1) {
+            ::close(fileFd);
         }
-        markForClose(); // La connexion est terminée.
-        return 0; // Retourne 0 pour indiquer la déconnexion propre.
+        closeDescriptors(descriptors);
+        data = std::move(other.data);
+        fileFd = other.fileFd;
+        fileOffset = other.fileOffset;
+        fileRemaining = other.fileRemaining;
+        descriptors = std::move(other.descriptors);
+        other.fileFd = -1;
+        other.fileRemaining = 0;
+        other.descriptors.clear();
+    }
+    return *this;
+}
 
-    } else { // bytesRead < 0 (erreur)
-        int error = SSL_get_error(ssl.get(), bytesRead);
+ServerConnection::OutboundItem::~OutboundItem() {
+    if (fileFd != -1) {
+        ::close(fileFd);
+    }
+    closeDescriptors(descriptors);
+}
 
-        if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE) {
-             // En mode bloquant, cela ne devrait pas arriver ou indique qu'aucune donnée n'est disponible POUR L'INSTANT.
-             // Retourne 0 pour signaler à l'appelant qu'il faut réessayer (ou qu'il est bloqué en attendant).
-             return 0; // Rien lu pour l'instant.
+// --- Désignation de l'écrivain ---
+void ServerConnection::attachWriter(std::function<void()> notifier) {
+    std::lock_guard<std::mutex> lock(outboundMutex);
+    writerAttached = true;
+    writeNotifier = std::move(notifier);
+}
 
-        } else if (error == SSL_ERROR_SYSCALL) {
-             LOG("ServerConnection::receive ERROR : Erreur système SSL_read (SSL_ERROR_SYSCALL). errno: " + std::string(strerror(errno)) + ". Socket FD: " + std::to_string(clientSocket), "ERROR");
-             ERR_print_errors_fp(stderr);
-             markForClose();
-             return -1;
+// --- Vidange de la file d'envoi ---
+// Regroupe les messages en attente en lots d'au plus MAX_COALESCED_BYTES, une écriture par lot.
+// En non bloquant, un lot interrompu (WANT_WRITE) est conservé tel quel dans writeBuffer : OpenSSL
+// exige que la tentative suivante repasse exactement les mêmes données.
+// Un fichier en file n'est jamais regroupé avec des messages : il part après eux, bloc par bloc.
+// Un message portant des descripteurs commence toujours un nouveau lot (ils partent avec son premier octet).
+ServerConnection::FlushResult ServerConnection::flushOutbound() {
+    std::lock_guard<std::mutex> write_lock(writeMutex);
+
+    while (true) {
+        if (writeBuffer.empty() && !pendingFile.isFile()) {
+            std::lock_guard<std::mutex> lock(outboundMutex);
+            if (outboundQueue.empty() && conflatedUpdates.empty()) {
+                return FlushResult::DRAINED;
+            }
+            if (outboundQueue.empty()) {
+                // Seulement des mises à jour remplaçables : ajoutées ci-dessous.
+            } else if (outboundQueue.front().isFile()) {
+                pendingFile = std::move(outboundQueue.front());
+                outboundQueue.pop_front();
+            } else {
+                writeBuffer.swap(outboundQueue.front().data);
+                pendingDescriptors.swap(outboundQueue.front().descriptors);
+                outboundBytes -= writeBuffer.size();
+                outboundQueue.pop_front();
+                while (!outboundQueue.empty() && !outboundQueue.front().isFile() && outboundQueue.front().descriptors.empty()
+                       && writeBuffer.size() + outboundQueue.front().data.size() <= MAX_COALESCED_BYTES) {
+                    writeBuffer += outboundQueue.front().data;
+                    outboundBytes -= outboundQueue.front().data.size();
+                    outboundQueue.pop_front();
+                }
+            }
+            // Mises à jour remplaçables en fin de lot, une fois la file vidée : elles ne doublent pas les
+            // réponses déjà en file. Jusqu'à leur copie ici, un tick plus récent peut encore les remplacer.
+            if (!pendingFile.isFile() && outboundQueue.empty()) {
+                size_t taken = 0;
+                while (taken < conflatedUpdates.size()
+                       && (writeBuffer.empty() || writeBuffer.size() + conflatedUpdates[taken].second->size() <= MAX_COALESCED_BYTES)) {
+                    writeBuffer += *conflatedUpdates[taken].second;
+                    taken++;
+                }
+                conflatedUpdates.erase(conflatedUpdates.begin(), conflatedUpdates.begin() + static_cast<std::ptrdiff_t>(taken));
+            }
+        }
 
+        if (!transport || clientSocket == -1 || m_markedForClose) {
+            return FlushResult::FAILED;
         }
-        else {
-            LOG("ServerConnection::receive ERROR : Erreur SSL non gérée lors de la réception. Code: " + std::to_string(error) + ". Socket FD: " + std::to_string(clientSocket), "ERROR");
-            ERR_print_errors_fp(stderr);
+
+        if (writeBuffer.empty()) {
+            // Fichier en cours : un bloc par tour (sendfile, ou lecture puis écriture ci-dessous).
+            FlushResult result = sendFileChunk();
+            if (result != FlushResult::DRAINED) {
+                return result;
+            }
+            continue;
+        }
+
+        TransportResult written = pendingDescriptors.empty()
+            ? transport->write(writeBuffer.data(), writeBuffer.size())
+            : transport->writeWithDescriptors(writeBuffer.data(), writeBuffer.size(), pendingDescriptors);
+        if (written.status == TransportStatus::OK) {
+            // TLS écrit tout le lot ; un socket en clair peut écrire partiellement.
+            writeBuffer.erase(0, static_cast<size_t>(written.bytes));
+            closeDescriptors(pendingDescriptors); // Transmis : le pair a ses propres copies.
+            continue;
+        }
+        return writeFailure(written);
+    }
+}
+
+// --- Envoi d'un bloc du fichier en cours ---
+ServerConnection::FlushResult ServerConnection::sendFileChunk() {
+    if (pendingFile.fileRemaining == 0) {
+        pendingFile = OutboundItem(); // Fichier terminé : descripteur fermé.
+        return FlushResult::DRAINED;
+    }
+
+    if (transport->canSendFile()) {
+        // Le noyau envoie directement depuis le cache de pages (et chiffre, avec kTLS).
+        size_t chunk = std::min(pendingFile.fileRemaining, SENDFILE_CHUNK_BYTES);
+        TransportResult sent = transport->sendFile(pendingFile.fileFd, pendingFile.fileOffset, chunk);
+        if (sent.status == TransportStatus::OK) {
+            pendingFile.fileOffset += sent.bytes;
+            pendingFile.fileRemaining -= static_cast<size_t>(sent.bytes);
+            return FlushResult::DRAINED;
+        }
+        return writeFailure(sent);
+    }
+
+    // Repli sans kTLS : un bloc lu dans writeBuffer, écrit comme un message.
+    size_t chunk = std::min(pendingFile.fileRemaining, MAX_COALESCED_BYTES);
+    writeBuffer.resize(chunk);
+    ssize_t got = pread(pendingFile.fileFd, &writeBuffer[0], chunk, pendingFile.fileOffset);
+    if (got <= 0) {
+        LOG("ServerConnection::sendFileChunk ERROR : Lecture du fichier à envoyer impossible (" + std::string(got < 0 ? strerror(errno) : "fin de fichier prématurée") + "). Socket FD: " + std::to_string(clientSocket), "ERROR");
+        writeBuffer.clear();
+        pendingFile = OutboundItem();
+        markForClose();
+        return FlushResult::FAILED;
+    }
+    writeBuffer.resize(static_cast<size_t>(got));
+    pendingFile.fileOffset += got;
+    pendingFile.fileRemaining -= static_cast<size_t>(got);
+    return FlushResult::DRAINED;
+}
+
+// --- Échec d'écriture ---
+// Le transport a déjà loggé les erreurs fatales.
+ServerConnection::FlushResult ServerConnection::writeFailure(const TransportResult& result) {
+    if (result.status == TransportStatus::WANT_WRITE || result.status == TransportStatus::WANT_READ) {
+        return FlushResult::WOULD_BLOCK;
+    }
+    markForClose();
+    return FlushResult::FAILED;
+}
+
+// --- Octets restant à écrire ---
+bool ServerConnection::hasPendingOutput() {
+    std::lock_guard<std::mutex> write_lock(writeMutex);
+    std::lock_guard<std::mutex> lock(outboundMutex);
+    return !writeBuffer.empty() || pendingFile.isFile() || !outboundQueue.empty() || !conflatedUpdates.empty();
+}
+
+// --- Vidange bloquante (pas d'écrivain attaché) ---
+// Sur socket non bloquant, attend qu'il redevienne inscriptible au lieu de boucler activement.
+int ServerConnection::flushBlocking() {
+    while (true) {
+        FlushResult result = flushOutbound();
+        if (result == FlushResult::DRAINED) {
+            return 0;
+        }
+        if (result == FlushResult::FAILED) {
+            return -1;
+        }
+        if (!waitForSocket(POLLOUT, SEND_WAIT_TIMEOUT_MS)) {
+            LOG("ServerConnection::send ERROR : Socket non prêt après " + std::to_string(SEND_WAIT_TIMEOUT_MS) + " ms (pair trop lent ?). Socket FD: " + std::to_string(clientSocket), "ERROR");
             markForClose();
             return -1;
         }
     }
 }
 
+// Reçoit des données via le transport de la connexion.
+// Retourne le nombre d'octets reçus (>0), 0 pour déconnexion propre (connexion alors marquée fermée), < 0 pour erreur fatale.
+// Retourne aussi 0, sans marquer la connexion, quand rien n'est disponible pour l'instant (WANT_READ/WRITE).
+int ServerConnection::receive(char* buffer, int size) {
+     // Note Thread-Safety : appelée uniquement par le thread propriétaire de la connexion (qui est aussi son écrivain).
+
+    if (!isConnected()) {
+        LOG("ServerConnection::receive ERROR : Connexion non valide ou marquée pour fermeture. Socket FD: " + std::to_string(clientSocket), "ERROR");
+        return -1;
+    }
+
+    // En mode bloquant, la lecture bloque jusqu'à ce qu'il y ait des données OU une erreur.
+    // L'appelant (ClientSession::run) est responsable de boucler sur receive() et de gérer la reconstruction des messages complets.
+    TransportResult result = transport->read(buffer, static_cast<size_t>(size));
+
+    switch (result.status) {
+        case TransportStatus::OK:
+            return static_cast<int>(result.bytes); // Retourne le nombre d'octets lus (> 0).
+        case TransportStatus::WANT_READ:
+        case TransportStatus::WANT_WRITE:
+            // Aucune donnée disponible POUR L'INSTANT (socket non bloquant) : l'appelant réessaiera.
+            return 0;
+        case TransportStatus::CLOSED:
+            markForClose(); // La connexion est terminée.
+            return 0; // Retourne 0 pour indiquer la déconnexion propre.
+        default:
+            markForClose(); // Erreur fatale, déjà loggée par le transport.
+            return -1;
+    }
+}
+
 // Méthode utilitaire pour envoyer une string.
 int ServerConnection::send(const std::string& data) {
     if (data.empty()) {
@@ -223,7 +480,7 @@ int ServerConnection::send(const std::string& data) {
 
 // Marque la connexion pour fermeture interne.
 void ServerConnection::markForClose() {
-    // Un simple bool suffit si l'accès est mono-threadé par ClientSession.
+    // Atomique : peut être levé par un thread déposant dans la file d'envoi (débordement).
     this->m_markedForClose = true;
 }
 
@@ -235,24 +492,34 @@ void ServerConnection::closeConnection() {
 
     LOG("ServerConnection::closeConnection INFO : Fermeture de la connexion pour socket FD: " + std::to_string(clientSocket), "INFO");
 
-    // Tenter une fermeture propre de la connexion SSL.
-    // SSL_shutdown envoie "close_notify".
-    if (ssl) { // Vérifie si l'objet SSL est valide
-        int shutdown_ret = SSL_shutdown(ssl.get());
-        if (shutdown_ret == 0) {
-             // Étape 1/2 terminée.
-             // Optionnel : tenter le second appel, mais attention au blocage infini en mode bloquant.
-             // shutdown_ret = SSL_shutdown(ssl.get());
-        }
-        if (shutdown_ret < 0) {
-             LOG("ServerConnection::closeConnection ERROR : Erreur lors du SSL_shutdown(). Socket FD: " + std::to_string(clientSocket), "ERROR");
-             ERR_print_errors_fp(stderr);
-        }
-        ssl.reset(); // Libère explicitement l'objet SSL (appelle deleter).
+    // Plus aucun message accepté ; l'écrivain (s'il existe) n'est plus notifié.
+    {
+        std::lock_guard<std::mutex> lock(outboundMutex);
+        outboundClosed = true;
+        writeNotifier = nullptr;
+        conflatedUpdates.clear();
+    }
+    // Dernière tentative (non bloquante si le socket l'est) pour les réponses encore en file,
+    // ex: "OK: Disconnecting." après QUIT. Appelée par l'écrivain ou après son arrêt.
+    if (transport && !m_markedForClose) {
+        flushOutbound();
     }
 
-    // Ferme le socket TCP sous-jacent.
+    // Tenter une fermeture propre du transport (TLS : "close_notify"), puis le libérer (SSL_free).
+    if (transport) {
+        transport->shutdown();
+        std::lock_guard<std::mutex> write_lock(writeMutex);
+        transport.reset();
+        closeDescriptors(pendingDescriptors);
+    }
+
+    // Ferme le socket sous-jacent (le gestionnaire est prévenu tant que le numéro n'est pas réutilisable).
     if (clientSocket != -1) {
+        if (closeHandler) {
+            auto handler = std::move(closeHandler);
+            closeHandler = nullptr;
+            handler(clientSocket);
+        }
         if (::close(clientSocket) == -1) {
             LOG("ServerConnection::closeConnection ERROR : Erreur lors de la fermeture du socket FD: " + std::to_string(clientSocket) + ". Erreur système: " + std::string(strerror(errno)), "ERROR");
         } else {
@@ -266,78 +533,138 @@ void ServerConnection::closeConnection() {
 }
 
 // --- Implémentation de receiveLine ---
-// Lit depuis la connexion jusqu'à trouver un newline ('\n'). Accumule les données si nécessaire.
-// Peut lancer une exception en cas d'erreur (connexion fermée, erreur SSL/socket).
+// Lit depuis la connexion jusqu'à obtenir une ligne complète ('\n') dans le buffer circulaire.
+// Peut lancer une exception en cas d'erreur (connexion fermée, erreur SSL/socket, ligne trop longue).
 std::string ServerConnection::receiveLine() {
-    char buffer[1024]; // Buffer temporaire pour les appels à receive
-    size_t newline_pos;
-
-    // Boucle tant qu'un newline n'est pas trouvé dans le buffer d'accumulation
-    while ((newline_pos = receive_buffer.find('\n')) == std::string::npos) {
-        // Le newline n'est pas dans le buffer d'accumulation. Lire plus de données.
-        int bytes_read = 0;
-        // Utilise la méthode receive existante pour lire depuis le socket SSL.
-        try {
-             // Lire dans le buffer temporaire.
-             bytes_read = receive(buffer, sizeof(buffer) - 1); // Appelle this->receive(char*, int)
-
-        } catch (const std::exception& e) {
-             // Si la méthode receive (this->receive) lance une exception (ex: erreur SSL), la propager.
-             LOG("ServerConnection ERROR : Exception propagée de receive() dans receiveLine() pour socket FD: " + std::to_string(clientSocket) + ". Exception: " + e.what(), "ERROR");
-             closeConnection(); // S'assurer que l'état interne de la connexion est marqué comme fermée.
-             throw; // Re-lance l'exception pour être gérée plus haut dans la pile (ex: dans main()).
+    std::string_view line;
+
+    while (true) {
+        LineFramer::Status status = inputFramer.nextLine(line);
+        if (status == LineFramer::Status::LINE) {
+            return std::string(line); // Retourne la ligne complète lue (sans le '\n').
+        }
+        if (status == LineFramer::Status::LINE_TOO_LONG) {
+            LOG("ServerConnection ERROR : Ligne reçue trop longue (> " + std::to_string(MAX_LINE_LENGTH) + " octets) pendant receiveLine() pour socket FD: " + std::to_string(clientSocket) + ".", "ERROR");
+            closeConnection();
+            throw std::runtime_error("Line exceeds maximum length during receiveLine().");
         }
 
+        // Pas encore de ligne complète : lire plus de données directement dans le buffer circulaire.
+        fillFramerBlocking("receiveLine()");
+    }
+}
 
-        if (bytes_read > 0) {
-            // Des données ont été lues. Ajouter au buffer d'accumulation.
-            buffer[bytes_read] = '\0'; // Null-terminer le buffer temporaire
-            receive_buffer.append(buffer, bytes_read); // Ajouter les octets lus au buffer d'accumulation
-
-             // Re-vérifier si le newline est maintenant dans le buffer d'accumulation après l'ajout.
-             newline_pos = receive_buffer.find('\n');
-
-        } else if (bytes_read == 0) {
-            // receive retourne 0 lorsque le pair ferme la connexion proprement.
-            // Si le buffer d'accumulation n'est pas vide, cela signifie que le pair s'est déconnecté au milieu d'une ligne.
-            // Selon le protocole, cela peut être considéré comme une erreur.
-            LOG("ServerConnection INFO : Connexion fermée par le pair pendant receiveLine() pour socket FD: " + std::to_string(clientSocket) + ". Buffer accumulation size: " + std::to_string(receive_buffer.size()) + ".", "INFO");
-            closeConnection(); // Marquer la connexion comme fermée.
-             if (!receive_buffer.empty()) {
-                  LOG("ServerConnection WARNING : Déconnexion pair avec données partielles dans buffer: '" + receive_buffer + "'", "WARNING");
-             }
-            throw std::runtime_error("Connection closed by peer while reading a line."); // Lancer une exception.
-
-        } else { // bytes_read < 0
-            // receive retourne une valeur négative pour des erreurs fatales non gérées par receive en interne.
-             unsigned long ssl_err = ERR_get_error(); // Obtenir l'erreur SSL si disponible
-             std::string err_msg = "Unknown error";
-             if (ssl_err != 0) {
-                 char err_buf[256];
-                 ERR_error_string_n(ssl_err, err_buf, sizeof(err_buf));
-                 err_msg = "SSL error: " + std::string(err_buf);
-             } else if (errno != 0) { // Si pas d'erreur SSL, vérifier l'erreur système (errno)
-                  err_msg = "System error: " + std::string(strerror(errno));
-             } else {
-                  err_msg = "Unknown error code from receive: " + std::to_string(bytes_read);
-             }
-
-             LOG("ServerConnection ERROR : Erreur fatale (" + std::to_string(bytes_read) + ") pendant receiveLine() pour socket FD: " + std::to_string(clientSocket) + ". Erreur: " + err_msg, "ERROR");
-             closeConnection(); // Marquer la connexion comme fermée.
-             throw std::runtime_error("Fatal error during receiveLine(): " + err_msg); // Lancer une exception.
+// --- Implémentation de receiveFrame ---
+// Lit depuis la connexion jusqu'à obtenir une trame binaire complète dans le buffer circulaire.
+// Peut lancer une exception en cas d'erreur (connexion fermée, erreur SSL/socket, trame invalide).
+void ServerConnection::receiveFrame(BinaryProtocol::FrameHeader& header, std::string_view& body) {
+    while (true) {
+        BinaryProtocol::DecodeStatus status = BinaryProtocol::nextFrame(inputFramer, header, body);
+        if (status == BinaryProtocol::DecodeStatus::FRAME) {
+            return;
+        }
+        if (status == BinaryProtocol::DecodeStatus::INVALID) {
+            LOG("ServerConnection ERROR : En-tête de trame binaire invalide (version " + std::to_string(header.version) + ", taille " + std::to_string(header.length) + ") pendant receiveFrame() pour socket FD: " + std::to_string(clientSocket) + ".", "ERROR");
+            closeConnection();
+            throw std::runtime_error("Invalid binary frame header during receiveFrame().");
+        }
+        fillFramerBlocking("receiveFrame()");
+    }
+}
 
+// --- Lecture bloquante d'octets supplémentaires dans le buffer circulaire ---
+// Utilisée par receiveLine()/receiveFrame() ; lance une exception si la connexion est fermée ou en erreur.
+void ServerConnection::fillFramerBlocking(const char* caller) {
+    int bytes_read = 0;
+    try {
+         bytes_read = receiveIntoFramer();
+    } catch (const std::exception& e) {
+         // Si la méthode receive (this->receive) lance une exception (ex: erreur SSL), la propager.
+         LOG("ServerConnection ERROR : Exception propagée de receive() dans " + std::string(caller) + " pour socket FD: " + std::to_string(clientSocket) + ". Exception: " + e.what(), "ERROR");
+         closeConnection(); // S'assurer que l'état interne de la connexion est marqué comme fermée.
+         throw; // Re-lance l'exception pour être gérée plus haut dans la pile (ex: dans main()).
+    }
+
+    if (bytes_read == 0) {
+        // receive retourne 0 lorsque le pair ferme la connexion proprement.
+        // Si des octets sont en attente, le pair s'est déconnecté au milieu d'un message.
+        LOG("ServerConnection INFO : Connexion fermée par le pair pendant " + std::string(caller) + " pour socket FD: " + std::to_string(clientSocket) + ". Octets en attente: " + std::to_string(inputFramer.buffered()) + ".", "INFO");
+        closeConnection(); // Marquer la connexion comme fermée.
+        if (inputFramer.buffered() > 0) {
+             LOG("ServerConnection WARNING : Déconnexion pair avec un message partiel dans le buffer.", "WARNING");
         }
+        throw std::runtime_error("Connection closed by peer during " + std::string(caller) + "."); // Lancer une exception.
+
+    } else if (bytes_read < 0) {
+        // receive retourne une valeur négative pour des erreurs fatales non gérées par receive en interne.
+         unsigned long ssl_err = ERR_get_error(); // Obtenir l'erreur SSL si disponible
+         std::string err_msg = "Unknown error";
+         if (ssl_err != 0) {
+             char err_buf[256];
+             ERR_error_string_n(ssl_err, err_buf, sizeof(err_buf));
+             err_msg = "SSL error: " + std::string(err_buf);
+         } else if (errno != 0) { // Si pas d'erreur SSL, vérifier l'erreur système (errno)
+              err_msg = "System error: " + std::string(strerror(errno));
+         } else {
+              err_msg = "Unknown error code from receive: " + std::to_string(bytes_read);
+         }
+
+         LOG("ServerConnection ERROR : Erreur fatale (" + std::to_string(bytes_read) + ") pendant " + std::string(caller) + " pour socket FD: " + std::to_string(clientSocket) + ". Erreur: " + err_msg, "ERROR");
+         closeConnection(); // Marquer la connexion comme fermée.
+         throw std::runtime_error("Fatal error during " + std::string(caller) + ": " + err_msg); // Lancer une exception.
+    }
+    // bytes_read > 0 : les octets sont dans le buffer circulaire, l'appelant recherche à nouveau un message complet.
+}
 
-        // Si newline_pos est toujours std::string::npos, la boucle while continue pour lire plus de données.
+// --- Lecture directe dans le buffer circulaire ---
+int ServerConnection::receiveIntoFramer() {
+    size_t space = inputFramer.writableSize();
+    if (space == 0) {
+        // Ne peut arriver que si l'appelant n'extrait pas les lignes complètes avant de relire.
+        LOG("ServerConnection::receiveIntoFramer ERROR : Buffer de réception plein. Socket FD: " + std::to_string(clientSocket), "ERROR");
+        markForClose();
+        return -1;
     }
+    int bytes_read = receive(inputFramer.writePtr(), static_cast<int>(space));
+    if (bytes_read > 0) {
+        inputFramer.commitWrite(static_cast<size_t>(bytes_read));
+    }
+    return bytes_read;
+}
 
-    // Un newline a été trouvé dans receive_buffer.
-    // Extraire la ligne complète (sans le newline final).
-    std::string complete_line = receive_buffer.substr(0, newline_pos);
+LineFramer& ServerConnection::getInputFramer() {
+    return inputFramer;
+}
 
-    // Retirer la ligne extraite (et le newline) du buffer d'accumulation
-    // pour les lectures futures.
-    receive_buffer.erase(0, newline_pos + 1); // +1 pour retirer le '\n'
+// --- Passage en mode non bloquant ---
+bool ServerConnection::setNonBlocking(bool enable) {
+    if (clientSocket == -1) {
+        return false;
+    }
+    int flags = fcntl(clientSocket, F_GETFL, 0);
+    if (flags == -1) {
+        LOG("ServerConnection::setNonBlocking ERROR : fcntl(F_GETFL) a échoué. Socket FD: " + std::to_string(clientSocket) + ". Erreur: " + std::string(strerror(errno)), "ERROR");
+        return false;
+    }
+    flags = enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    if (fcntl(clientSocket, F_SETFL, flags) == -1) {
+        LOG("ServerConnection::setNonBlocking ERROR : fcntl(F_SETFL) a échoué. Socket FD: " + std::to_string(clientSocket) + ". Erreur: " + std::string(strerror(errno)), "ERROR");
+        return false;
+    }
+    return true;
+}
 
-    return complete_line; // Retourne la ligne complète lue (sans le '\n').
-}
\ No newline at end of file
+// --- Attente de disponibilité du socket ---
+bool ServerConnection::waitForSocket(short events, int timeoutMs) {
+    if (clientSocket == -1) {
+        return false;
+    }
+    pollfd pfd{};
+    pfd.fd = clientSocket;
+    pfd.events = events;
+    int ret;
+    do {
+        ret = ::poll(&pfd, 1, timeoutMs);
+    } while (ret < 0 && errno == EINTR);
+    return ret > 0 && !(pfd.revents & (POLLERR | POLLNVAL));
+}
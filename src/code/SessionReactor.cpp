@@ -0,0 +1,433 @@
+#include "../headers/SessionReactor.h"
+#include "../headers/ClientSession.h"
+#include "../headers/ServerConnection.h"
+#include "../headers/Logger.h"
+#include "../headers/LowLatency.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+
+// --- Constructeur ---
+SessionReactor::SessionReactor(int ioThreads)
+    : running(false),
+      nextWorker(0)
+{
+    int count = ioThreads;
+    if (count <= 0) {
+        count = static_cast<int>(std::thread::hardware_concurrency());
+        // Quelques threads suffisent : le travail par événement est court (lecture + dispatch).
+        count = std::clamp(count, 1, 8);
+    }
+    for (int i = 0; i < count; ++i) {
+        workers.push_back(std::make_unique<IoWorker>());
+    }
+    LOG("SessionReactor::SessionReactor INFO : Réacteur créé avec " + std::to_string(count) + " threads d'E/S.", "INFO");
+}
+
+// --- Destructeur ---
+SessionReactor::~SessionReactor() {
+    stop();
+}
+
+// --- Profil faible latence ---
+void SessionReactor::setLatencyProfile(const std::vector<int>& cpus, std::chrono::microseconds spin) {
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+    }
+    spinWait = spin;
+}
+
+// --- Démarrage des threads d'E/S ---
+bool SessionReactor::start() {
+    if (running.load()) {
+        LOG("SessionReactor::start WARNING : Réacteur déjà démarré.", "WARNING");
+        return true;
+    }
+
+    // Création des descripteurs epoll/eventfd de chaque worker AVANT de lancer les threads.
+    for (auto& worker : workers) {
+        worker->epollFd = epoll_create1(EPOLL_CLOEXEC);
+        worker->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (worker->epollFd == -1 || worker->wakeFd == -1) {
+            LOG("SessionReactor::start ERROR : Échec epoll_create1/eventfd. Erreur: " + std::string(strerror(errno)), "ERROR");
+            stop();
+            return false;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = worker->wakeFd;
+        if (epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, worker->wakeFd, &ev) == -1) {
+            LOG("SessionReactor::start ERROR : Échec enregistrement eventfd dans epoll. Erreur: " + std::string(strerror(errno)), "ERROR");
+            stop();
+            return false;
+        }
+    }
+
+    running.store(true);
+    for (auto& worker : workers) {
+        IoWorker* w = worker.get();
+        w->thread = std::thread(&SessionReactor::ioLoop, this, std::ref(*w));
+    }
+    LOG("SessionReactor::start INFO : " + std::to_string(workers.size()) + " threads d'E/S démarrés.", "INFO");
+    return true;
+}
+
+// --- Arrêt des threads d'E/S ---
+void SessionReactor::stop() {
+    bool was_running = running.exchange(false);
+
+    // Réveiller chaque thread d'E/S bloqué dans epoll_wait.
+    for (auto& worker : workers) {
+        if (worker->wakeFd != -1) {
+            uint64_t one = 1;
+            ssize_t ignored = ::write(worker->wakeFd, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    // Relâcher les sessions encore détenues. Leur arrêt (stop/close) est orchestré par le Server.
+    for (auto& worker : workers) {
+        worker->sessions.clear();
+        worker->waitingWritable.clear();
+        {
+            std::lock_guard<std::mutex> lock(worker->pendingMutex);
+            worker->pending.clear();
+            worker->flushRequests.clear();
+        }
+        if (worker->epollFd != -1) { ::close(worker->epollFd); worker->epollFd = -1; }
+        if (worker->wakeFd != -1) { ::close(worker->wakeFd); worker->wakeFd = -1; }
+    }
+
+    if (was_running) {
+        LOG("SessionReactor::stop INFO : Threads d'E/S arrêtés.", "INFO");
+    }
+}
+
+// --- Ajout d'une session ---
+bool SessionReactor::addSession(std::shared_ptr<ClientSession> session) {
+    if (!running.load() || !session || workers.empty()) {
+        LOG("SessionReactor::addSession ERROR : Réacteur non démarré ou session invalide.", "ERROR");
+        return false;
+    }
+
+    // Affectation round-robin : la session restera sur ce thread d'E/S jusqu'à sa fermeture.
+    IoWorker& worker = *workers[nextWorker.fetch_add(1) % workers.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.pendingMutex);
+        worker.pending.push_back(std::move(session));
+    }
+    uint64_t one = 1;
+    if (::write(worker.wakeFd, &one, sizeof(one)) != sizeof(one)) {
+        LOG("SessionReactor::addSession WARNING : Échec écriture eventfd. Erreur: " + std::string(strerror(errno)), "WARNING");
+    }
+    return true;
+}
+
+void SessionReactor::setCloseHandler(CloseHandler handler) {
+    closeHandler = std::move(handler);
+}
+
+size_t SessionReactor::getIoThreadCount() const {
+    return workers.size();
+}
+
+// --- Prise en charge des sessions en attente (exécuté par le thread d'E/S) ---
+void SessionReactor::adoptPendingSessions(IoWorker& worker) {
+    std::vector<std::shared_ptr<ClientSession>> to_adopt;
+    {
+        std::lock_guard<std::mutex> lock(worker.pendingMutex);
+        to_adopt.swap(worker.pending);
+    }
+
+    for (auto& session : to_adopt) {
+        auto conn = session->getClientConnection();
+        int fd = conn ? conn->getSocketFD() : -1;
+        if (fd == -1) {
+            LOG("SessionReactor::adoptPendingSessions WARNING : Session " + session->getClientId() + " sans socket valide. Ignorée.", "WARNING");
+            continue;
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        if (epoll_ctl(worker.epollFd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            LOG("SessionReactor::adoptPendingSessions ERROR : epoll_ctl(ADD) a échoué pour client " + session->getClientId() + ". Erreur: " + std::string(strerror(errno)), "ERROR");
+            session->stop();
+            if (closeHandler) closeHandler(session->getClientId());
+            continue;
+        }
+        SessionEntry& entry = worker.sessions[fd];
+        entry.session = session;
+
+        // Ce thread devient l'unique écrivain de la connexion : les autres threads (TQ) déposent
+        // leurs messages dans la file et le réveillent.
+        IoWorker* owner = &worker;
+        conn->attachWriter([this, owner, fd]() { requestFlush(*owner, fd); });
+
+        // Première lecture : des octets ont pu arriver (et être déchiffrés) pendant l'authentification ;
+        // epoll ne signalerait pas des données déjà présentes dans les buffers SSL.
+        if (!armSessionTimers(worker, fd, entry) || !session->onReadable() || !flushSession(worker, fd, *session)) {
+            closeSession(worker, fd);
+        }
+    }
+}
+
+// --- Fermeture d'une session (exécuté par le thread d'E/S propriétaire) ---
+void SessionReactor::closeSession(IoWorker& worker, int fd) {
+    auto it = worker.sessions.find(fd);
+    if (it == worker.sessions.end()) {
+        return;
+    }
+    std::shared_ptr<ClientSession> session = std::move(it->second.session);
+    worker.timers.cancel(it->second.idleTimer);
+    worker.timers.cancel(it->second.botTimer);
+    worker.sessions.erase(it);
+    worker.waitingWritable.erase(fd);
+
+    // Retirer le fd d'epoll AVANT de fermer la connexion (le fd pourrait être réutilisé).
+    epoll_ctl(worker.epollFd, EPOLL_CTL_DEL, fd, nullptr);
+
+    const std::string clientId = session->getClientId();
+    LOG("SessionReactor::closeSession INFO : Fin de session pour client " + clientId + " (socket FD: " + std::to_string(fd) + ").", "INFO");
+    session->stop(); // Ferme la connexion et désenregistre la session de la TQ.
+
+    if (closeHandler) {
+        closeHandler(clientId); // Retire la session de la table du Server.
+    }
+    // La dernière référence peut disparaître ici : ~ClientSession s'exécute sur le thread d'E/S.
+}
+
+// --- Demande de vidange (thread quelconque, file d'envoi de la connexion verrouillée) ---
+void SessionReactor::requestFlush(IoWorker& worker, int fd) {
+    {
+        std::lock_guard<std::mutex> lock(worker.pendingMutex);
+        worker.flushRequests.push_back(fd);
+    }
+    // Lecture après la publication de la demande : si le thread d'E/S a déjà quitté l'attente active, il
+    // revérifie les demandes après avoir baissé 'spinning' (voir ioLoop) ou reçoit ce réveil.
+    if (worker.wakeFd != -1 && !worker.spinning.load(std::memory_order_seq_cst)) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(worker.wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+// --- Traitement des demandes de vidange (exécuté par le thread d'E/S) ---
+size_t SessionReactor::processFlushRequests(IoWorker& worker) {
+    std::vector<int> fds;
+    {
+        std::lock_guard<std::mutex> lock(worker.pendingMutex);
+        fds.swap(worker.flushRequests);
+    }
+    for (int fd : fds) {
+        auto it = worker.sessions.find(fd);
+        if (it == worker.sessions.end()) {
+            continue; // Session fermée entre-temps.
+        }
+        if (!flushSession(worker, fd, *it->second.session)) {
+            closeSession(worker, fd);
+        }
+    }
+    return fds.size();
+}
+
+// --- Vidange de la file d'envoi d'une session (exécuté par le thread d'E/S) ---
+bool SessionReactor::flushSession(IoWorker& worker, int fd, ClientSession& session) {
+    auto conn = session.getClientConnection();
+    if (!conn) {
+        return false;
+    }
+    ServerConnection::FlushResult result = conn->flushOutbound();
+    if (result == ServerConnection::FlushResult::FAILED) {
+        return false;
+    }
+
+    // S'abonner à EPOLLOUT seulement tant qu'il reste des données : sinon epoll réveillerait en permanence.
+    bool want_writable = (result == ServerConnection::FlushResult::WOULD_BLOCK);
+    bool watching = worker.waitingWritable.count(fd) > 0;
+    if (want_writable != watching) {
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP | (want_writable ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        ev.data.fd = fd;
+        if (epoll_ctl(worker.epollFd, EPOLL_CTL_MOD, fd, &ev) == -1) {
+            LOG("SessionReactor::flushSession ERROR : epoll_ctl(MOD) a échoué pour client " + session.getClientId() + ". Erreur: " + std::string(strerror(errno)), "ERROR");
+            return false;
+        }
+        if (want_writable) {
+            worker.waitingWritable.insert(fd);
+        } else {
+            worker.waitingWritable.erase(fd);
+        }
+    }
+    return true;
+}
+
+// --- Boucle d'un thread d'E/S ---
+void SessionReactor::ioLoop(IoWorker& worker) {
+    LOG("SessionReactor::ioLoop INFO : Thread d'E/S démarré.", "INFO");
+    LowLatency::pinCurrentThread(worker.cpu, "E/S du réacteur");
+
+    constexpr int MAX_EVENTS = 64;
+    epoll_event events[MAX_EVENTS];
+    auto spin_until = TimingWheel::Clock::now();
+
+    while (running.load()) {
+        // Attente jusqu'au prochain tick de la roue (indéfinie si aucun timer n'est armé).
+        auto now = TimingWheel::Clock::now();
+        int timeout_ms = worker.timers.millisecondsUntilNextTick(now);
+        if (spinWait.count() > 0) {
+            // Profil faible latence : epoll interrogé sans bloquer jusqu'à 'spinWait' après le dernier travail.
+            bool spin = now < spin_until;
+            if (!spin && worker.spinning.load(std::memory_order_relaxed)) {
+                worker.spinning.store(false, std::memory_order_seq_cst);
+                // Une demande de vidange publiée pendant l'attente active n'a pas réveillé wakeFd.
+                std::lock_guard<std::mutex> lock(worker.pendingMutex);
+                spin = !worker.flushRequests.empty() || !worker.pending.empty();
+            }
+            if (spin) {
+                timeout_ms = 0;
+            }
+        }
+        int n = epoll_wait(worker.epollFd, events, MAX_EVENTS, timeout_ms);
+        if (spinWait.count() > 0 && n > 0) {
+            spin_until = TimingWheel::Clock::now() + spinWait;
+            worker.spinning.store(true, std::memory_order_seq_cst);
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG("SessionReactor::ioLoop ERROR : epoll_wait a échoué. Erreur: " + std::string(strerror(errno)), "ERROR");
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+
+            if (fd == worker.wakeFd) {
+                uint64_t value;
+                while (::read(worker.wakeFd, &value, sizeof(value)) > 0) {}
+                continue;
+            }
+
+            auto it = worker.sessions.find(fd);
+            if (it == worker.sessions.end()) {
+                continue; // Session déjà fermée dans cette même itération.
+            }
+
+            bool keep = true;
+            try {
+                // Même sur EPOLLRDHUP/EPOLLHUP, on lit d'abord : les dernières commandes
+                // (ex: "QUIT") peuvent précéder la fermeture.
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                    keep = it->second.session->onReadable();
+                }
+                if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                    keep = false;
+                }
+                // Les réponses produites par les commandes lues (et tout ce qui attendait EPOLLOUT)
+                // partent en un minimum d'enregistrements TLS.
+                if (keep) {
+                    keep = flushSession(worker, fd, *it->second.session);
+                }
+            } catch (const std::exception& e) {
+                LOG("SessionReactor::ioLoop ERROR : Exception lors du traitement de la session " + it->second.session->getClientId() + ": " + e.what(), "ERROR");
+                keep = false;
+            }
+
+            if (!keep) {
+                closeSession(worker, fd);
+            }
+        }
+
+        if (!running.load()) break;
+
+        adoptPendingSessions(worker);
+        if (processFlushRequests(worker) > 0 && spinWait.count() > 0) {
+            // Réponse de la TransactionQueue envoyée : la commande suivante du client est probablement proche.
+            spin_until = TimingWheel::Clock::now() + spinWait;
+            worker.spinning.store(true, std::memory_order_seq_cst);
+        }
+
+        // --- Timers échus (inactivité, heartbeat, bot) ---
+        processTimers(worker);
+    }
+
+    LOG("SessionReactor::ioLoop INFO : Thread d'E/S terminé.", "INFO");
+}
+
+// --- Armement d'un timer de session ---
+void SessionReactor::armTimer(IoWorker& worker, int fd, TimerKind kind, std::chrono::milliseconds delay, TimingWheel::TimerId& id) {
+    id = worker.timers.arm(delay, (static_cast<uint64_t>(fd) << 1) | static_cast<uint64_t>(kind));
+}
+
+// --- Timers d'une session adoptée ---
+bool SessionReactor::armSessionTimers(IoWorker& worker, int fd, SessionEntry& entry) {
+    ClientSession::IdleCheck check = entry.session->checkIdle(TimingWheel::Clock::now());
+    if (check.expired) {
+        return false;
+    }
+    if (check.nextCheck.count() > 0) {
+        armTimer(worker, fd, TimerKind::IDLE, check.nextCheck, entry.idleTimer);
+    }
+    // Le bot peut être démarré à tout moment par une commande : le timer tourne pour chaque session
+    // (une échéance toutes les BOT_CALL_INTERVAL, sans effet tant qu'aucun bot n'est actif).
+    armTimer(worker, fd, TimerKind::BOT, ClientSession::BOT_CALL_INTERVAL, entry.botTimer);
+    return true;
+}
+
+// --- Traitement des timers échus (exécuté par le thread d'E/S) ---
+void SessionReactor::processTimers(IoWorker& worker) {
+    auto now = TimingWheel::Clock::now();
+    worker.expiredTimers.clear();
+    if (worker.timers.advance(now, worker.expiredTimers) == 0) {
+        return;
+    }
+
+    for (uint64_t data : worker.expiredTimers) {
+        int fd = static_cast<int>(data >> 1);
+        TimerKind kind = static_cast<TimerKind>(data & 1);
+        auto it = worker.sessions.find(fd);
+        if (it == worker.sessions.end()) {
+            continue; // Session fermée par un timer précédent du même lot.
+        }
+        SessionEntry& entry = it->second;
+
+        bool keep = true;
+        try {
+            if (kind == TimerKind::IDLE) {
+                entry.idleTimer = 0;
+                // Peut déposer un PING dans la file d'envoi (vidée via requestFlush au tour suivant).
+                ClientSession::IdleCheck check = entry.session->checkIdle(now);
+                keep = !check.expired;
+                if (keep && check.nextCheck.count() > 0) {
+                    armTimer(worker, fd, TimerKind::IDLE, check.nextCheck, entry.idleTimer);
+                }
+            } else {
+                entry.botTimer = 0;
+                keep = entry.session->onBotTimer();
+                if (keep) {
+                    armTimer(worker, fd, TimerKind::BOT, ClientSession::BOT_CALL_INTERVAL, entry.botTimer);
+                }
+            }
+        } catch (const std::exception& e) {
+            LOG("SessionReactor::processTimers ERROR : Exception lors du traitement d'un timer de la session " + entry.session->getClientId() + ": " + e.what(), "ERROR");
+            keep = false;
+        }
+
+        if (!keep) {
+            closeSession(worker, fd);
+        }
+    }
+}
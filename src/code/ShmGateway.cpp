@@ -0,0 +1,370 @@
+#include "../headers/ShmGateway.h"
+#include "../headers/Transaction.h"
+
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <chrono>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+
+// ============================================================================
+// === ShmChannel ===
+// ============================================================================
+
+ShmChannel::ShmChannel(const std::string& clientId, int memFd, void* mapping, size_t mappingSize, int orderDoorbell, int reportDoorbell)
+    : clientId(clientId), memFd(memFd), mapping(mapping), mappingSize(mappingSize),
+      orderDoorbell(orderDoorbell), reportDoorbell(reportDoorbell)
+{
+    // Capacités lues avant tout partage du segment : le client ne peut plus les modifier à notre insu.
+    auto* header = static_cast<ShmSegmentHeader*>(mapping);
+    uint32_t order_capacity = header->orderCapacity;
+    uint32_t report_capacity = header->reportCapacity;
+    auto* base = static_cast<char*>(mapping);
+    orderRing = ShmRing<ShmOrderRecord>(&header->orders, reinterpret_cast<ShmOrderRecord*>(base + ShmLayout::ordersOffset()), order_capacity);
+    reportRing = ShmRing<ShmReportRecord>(&header->reports, reinterpret_cast<ShmReportRecord*>(base + ShmLayout::reportsOffset(order_capacity)), report_capacity);
+}
+
+ShmChannel::~ShmChannel() {
+    if (mapping) {
+        munmap(mapping, mappingSize);
+    }
+    for (int fd : {memFd, orderDoorbell, reportDoorbell}) {
+        if (fd != -1) {
+            ::close(fd);
+        }
+    }
+}
+
+uint32_t ShmChannel::getOrderCapacity() const { return orderRing.getCapacity(); }
+uint32_t ShmChannel::getReportCapacity() const { return reportRing.getCapacity(); }
+
+static void copyField(char* destination, size_t size, const std::string& value) {
+    size_t n = std::min(value.size(), size - 1);
+    std::memcpy(destination, value.data(), n);
+    destination[n] = '\0';
+}
+
+void ShmChannel::onTransactionResult(const Transaction& tx, uint64_t correlationId) {
+    ShmReportRecord report;
+    report.clientOrderId = correlationId;
+    report.status = static_cast<uint8_t>(tx.getStatus());
+    report.side = static_cast<uint8_t>(tx.getType() == TransactionType::SELL ? ShmLayout::Side::SELL : ShmLayout::Side::BUY);
+    report.quantity = tx.getQuantity();
+    report.unitPrice = tx.getUnitPrice();
+    report.totalAmount = tx.getTotalAmount();
+    report.fee = tx.getFee();
+    copyField(report.transactionId, sizeof(report.transactionId), tx.getId());
+    if (tx.getStatus() == TransactionStatus::FAILED) {
+        copyField(report.reason, sizeof(report.reason), tx.getFailureReason());
+    }
+    pushReport(report);
+}
+
+void ShmChannel::reject(const ShmOrderRecord& order, const char* reason) {
+    ShmReportRecord report;
+    report.clientOrderId = order.clientOrderId;
+    report.status = static_cast<uint8_t>(TransactionStatus::FAILED);
+    report.side = order.side;
+    report.quantity = order.quantity;
+    copyField(report.reason, sizeof(report.reason), reason);
+    pushReport(report);
+}
+
+void ShmChannel::pushReport(const ShmReportRecord& report) {
+    if (isClosed()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(reportMutex);
+    if (!reportRing.tryPush(report)) {
+        // Le client ne lit plus ses rapports : la TQ ne doit jamais attendre un client.
+        reportsDropped.fetch_add(1, std::memory_order_relaxed);
+        LOG("ShmChannel::pushReport WARNING : Anneau des rapports plein" + std::string(reportRing.isCorrupted() ? " ou corrompu" : "") + " pour client " + clientId + ". Rapport de l'ordre " + std::to_string(report.clientOrderId) + " perdu.", "WARNING");
+        return;
+    }
+    reportsSent.fetch_add(1, std::memory_order_relaxed);
+    if (reportRing.consumerNeedsWakeup()) {
+        uint64_t one = 1;
+        ssize_t ignored = write(reportDoorbell, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+
+// ============================================================================
+// === ShmGateway ===
+// ============================================================================
+
+ShmGateway::ShmGateway(uint32_t ringCapacity, int spinMicros)
+    : ringCapacity(ringCapacity), spinMicros(spinMicros), epollFd(-1), wakeFd(-1), running(false), channelsVersion(0)
+{
+}
+
+ShmGateway::~ShmGateway() {
+    stop();
+}
+
+bool ShmGateway::start() {
+    if (!ShmLayout::isValidCapacity(ringCapacity)) {
+        LOG("ShmGateway::start ERROR : Capacité d'anneau invalide (" + std::to_string(ringCapacity) + ", puissance de 2 attendue).", "ERROR");
+        return false;
+    }
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeFd;
+    if (epollFd == -1 || wakeFd == -1 || epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev) != 0) {
+        LOG("ShmGateway::start ERROR : Échec epoll/eventfd. Erreur: " + std::string(strerror(errno)), "ERROR");
+        stop();
+        return false;
+    }
+    running.store(true, std::memory_order_release);
+    thread = std::thread(&ShmGateway::pollLoop, this);
+    LOG("ShmGateway::start INFO : Passerelle d'ordres en mémoire partagée démarrée (anneaux de " + std::to_string(ringCapacity) + " enregistrements, attente active " + std::to_string(spinMicros) + " us).", "INFO");
+    return true;
+}
+
+void ShmGateway::stop() {
+    running.store(false, std::memory_order_release);
+    if (wakeFd != -1) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(channelsMutex);
+        for (auto& [fd, channel] : channels) {
+            channel->close();
+        }
+        channels.clear();
+        channelsVersion++;
+    }
+    if (wakeFd != -1) {
+        ::close(wakeFd);
+        wakeFd = -1;
+    }
+    if (epollFd != -1) {
+        ::close(epollFd);
+        epollFd = -1;
+    }
+}
+
+std::shared_ptr<ShmChannel> ShmGateway::attach(const std::string& clientId, std::vector<int>& clientFds) {
+    if (!running.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    size_t size = ShmLayout::segmentSize(ringCapacity, ringCapacity);
+
+    // Segment anonyme scellé : le client ne peut ni le réduire (SIGBUS côté serveur) ni l'agrandir.
+    int mem_fd = memfd_create("ppn_order_gateway", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (mem_fd == -1 || ftruncate(mem_fd, static_cast<off_t>(size)) != 0
+        || fcntl(mem_fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+        LOG("ShmGateway::attach ERROR : Création du segment partagé impossible pour client " + clientId + ". Erreur: " + std::string(strerror(errno)), "ERROR");
+        if (mem_fd != -1) ::close(mem_fd);
+        return nullptr;
+    }
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, 0);
+    if (mapping == MAP_FAILED) {
+        LOG("ShmGateway::attach ERROR : mmap du segment impossible pour client " + clientId + ". Erreur: " + std::string(strerror(errno)), "ERROR");
+        ::close(mem_fd);
+        return nullptr;
+    }
+    auto* header = new (mapping) ShmSegmentHeader();
+    header->orderCapacity = ringCapacity;
+    header->reportCapacity = ringCapacity;
+
+    int order_doorbell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int report_doorbell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    // Le canal possède désormais le segment et les eventfds (libérés par son destructeur en cas d'échec).
+    auto channel = std::make_shared<ShmChannel>(clientId, mem_fd, mapping, size, order_doorbell, report_doorbell);
+    if (order_doorbell == -1 || report_doorbell == -1) {
+        LOG("ShmGateway::attach ERROR : eventfd impossible pour client " + clientId + ". Erreur: " + std::string(strerror(errno)), "ERROR");
+        return nullptr;
+    }
+
+    clientFds.clear();
+    for (int fd : {mem_fd, order_doorbell, report_doorbell}) {
+        int copy = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (copy == -1) {
+            LOG("ShmGateway::attach ERROR : dup impossible pour client " + clientId + ". Erreur: " + std::string(strerror(errno)), "ERROR");
+            for (int opened : clientFds) ::close(opened);
+            clientFds.clear();
+            return nullptr;
+        }
+        clientFds.push_back(copy);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(channelsMutex);
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = order_doorbell;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, order_doorbell, &ev) != 0) {
+            LOG("ShmGateway::attach ERROR : epoll_ctl impossible pour client " + clientId + ". Erreur: " + std::string(strerror(errno)), "ERROR");
+            for (int opened : clientFds) ::close(opened);
+            clientFds.clear();
+            return nullptr;
+        }
+        channels[order_doorbell] = channel;
+        channelsVersion++;
+    }
+    // Le thread de la passerelle dort peut-être : il doit prendre en compte le nouveau canal.
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+
+    LOG("ShmGateway::attach INFO : Canal en mémoire partagée ouvert pour client " + clientId + " (" + std::to_string(size) + " octets).", "INFO");
+    return channel;
+}
+
+void ShmGateway::detach(const std::shared_ptr<ShmChannel>& channel) {
+    if (!channel) {
+        return;
+    }
+    channel->close();
+    removeChannel(channel);
+    LOG("ShmGateway::detach INFO : Canal fermé pour client " + channel->getClientId() + " (ordres reçus: " + std::to_string(channel->ordersReceived.load()) + ", rapports envoyés: " + std::to_string(channel->reportsSent.load()) + ", perdus: " + std::to_string(channel->reportsDropped.load()) + ").", "INFO");
+}
+
+void ShmGateway::removeChannel(const std::shared_ptr<ShmChannel>& channel) {
+    std::lock_guard<std::mutex> lock(channelsMutex);
+    auto it = channels.find(channel->getOrderDoorbell());
+    if (it != channels.end() && it->second == channel) {
+        // L'eventfd reste ouvert jusqu'à la destruction du canal : pas de réutilisation du numéro entre-temps.
+        if (epollFd != -1) {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, channel->getOrderDoorbell(), nullptr);
+        }
+        channels.erase(it);
+        channelsVersion++;
+    }
+}
+
+void ShmGateway::pollLoop() {
+    LOG("ShmGateway::pollLoop INFO : Thread démarré.", "INFO");
+    std::vector<std::shared_ptr<ShmChannel>> active;
+    uint64_t seen_version = ~uint64_t(0);
+    auto spin = std::chrono::microseconds(spinMicros);
+    auto last_order = std::chrono::steady_clock::now();
+    epoll_event events[64];
+
+    while (running.load(std::memory_order_acquire)) {
+        {
+            std::lock_guard<std::mutex> lock(channelsMutex);
+            if (channelsVersion != seen_version) {
+                active.clear();
+                for (auto& [fd, channel] : channels) {
+                    active.push_back(channel);
+                }
+                seen_version = channelsVersion;
+            }
+        }
+
+        size_t received = 0;
+        for (const auto& channel : active) {
+            received += drainChannel(channel);
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (received > 0) {
+            last_order = now;
+            continue;
+        }
+        if (now - last_order < spin) {
+            continue; // Attente active : le prochain ordre d'une rafale est lu sans réveil.
+        }
+
+        // Plus rien depuis 'spinMicros' : lever les drapeaux d'attente puis dormir sur les eventfds.
+        bool can_sleep = true;
+        for (const auto& channel : active) {
+            if (!channel->isClosed() && !channel->getOrderRing().prepareToSleep()) {
+                can_sleep = false;
+            }
+        }
+        if (can_sleep) {
+            int n = epoll_wait(epollFd, events, 64, -1);
+            for (int i = 0; i < n; ++i) {
+                // Seuls les eventfds dont on tient le canal sont lus (un canal retiré entre-temps a pu libérer
+                // son numéro) ; un canal tout juste ajouté sera pris en compte au prochain tour.
+                int fd = events[i].data.fd;
+                bool known = fd == wakeFd;
+                for (const auto& channel : active) {
+                    known = known || channel->getOrderDoorbell() == fd;
+                }
+                if (known) {
+                    uint64_t counter;
+                    ssize_t ignored = read(fd, &counter, sizeof(counter));
+                    (void)ignored;
+                }
+            }
+            if (n < 0 && errno != EINTR) {
+                LOG("ShmGateway::pollLoop ERROR : epoll_wait a échoué. Erreur: " + std::string(strerror(errno)), "ERROR");
+            }
+        }
+        for (const auto& channel : active) {
+            if (!channel->isClosed()) {
+                channel->getOrderRing().wokeUp();
+            }
+        }
+        last_order = std::chrono::steady_clock::now();
+    }
+    LOG("ShmGateway::pollLoop INFO : Thread terminé.", "INFO");
+}
+
+size_t ShmGateway::drainChannel(const std::shared_ptr<ShmChannel>& channel) {
+    if (channel->isClosed()) {
+        removeChannel(channel);
+        return 0;
+    }
+    ShmRing<ShmOrderRecord>& ring = channel->getOrderRing();
+    ShmOrderRecord order;
+    size_t count = 0;
+    // Au plus un anneau complet par passage : un client très actif ne monopolise pas le thread.
+    while (count < ringCapacity && ring.tryPop(order)) {
+        submitOrder(channel, order);
+        count++;
+    }
+    if (ring.isCorrupted()) {
+        LOG("ShmGateway::drainChannel ERROR : Anneau des ordres corrompu pour client " + channel->getClientId() + ". Canal fermé.", "ERROR");
+        channel->close();
+        removeChannel(channel);
+    }
+    return count;
+}
+
+// Mêmes contrôles que les commandes texte ; l'enregistrement a été copié hors du segment partagé.
+void ShmGateway::submitOrder(const std::shared_ptr<ShmChannel>& channel, const ShmOrderRecord& order) {
+    channel->ordersReceived.fetch_add(1, std::memory_order_relaxed);
+
+    RequestType type;
+    if (order.side == static_cast<uint8_t>(ShmLayout::Side::BUY)) {
+        type = RequestType::BUY;
+    } else if (order.side == static_cast<uint8_t>(ShmLayout::Side::SELL)) {
+        type = RequestType::SELL;
+    } else {
+        channel->reject(order, "Invalid side.");
+        return;
+    }
+    if (!(order.quantity > 0) || !std::isfinite(order.quantity)) {
+        channel->reject(order, "Invalid quantity.");
+        return;
+    }
+    std::string symbol(order.symbol, strnlen(order.symbol, sizeof(order.symbol)));
+    if (symbol != "SRD-BTC") {
+        channel->reject(order, "Unsupported symbol.");
+        return;
+    }
+
+    TransactionRequest request(channel->getClientId(), type, symbol, order.quantity);
+    request.correlationId = order.clientOrderId;
+    request.reportSink = channel;
+    txQueue.addRequest(std::move(request));
+}
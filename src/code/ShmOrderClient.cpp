@@ -0,0 +1,298 @@
+#include "../headers/ShmOrderClient.h"
+#include "../headers/Logger.h"
+
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <sstream>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// Nombre maximal de descripteurs acceptés dans un message (la réponse à SHM ATTACH en porte trois).
+static constexpr size_t MAX_RECEIVED_FDS = 8;
+
+ShmOrderClient::~ShmOrderClient() {
+    close();
+}
+
+// --- Connexion, authentification et ouverture du canal ---
+bool ShmOrderClient::connect(const std::string& socketPath, const std::string& clientId, const std::string& password) {
+    close();
+    socketClosed = false;
+
+    sockaddr_un serverAddr{};
+    if (socketPath.empty() || socketPath.size() >= sizeof(serverAddr.sun_path)) {
+        LOG("ShmOrderClient::connect ERROR : Chemin du socket Unix invalide: '" + socketPath + "'.", "ERROR");
+        return false;
+    }
+    serverAddr.sun_family = AF_UNIX;
+    std::memcpy(serverAddr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    socketFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socketFd < 0 || ::connect(socketFd, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) < 0) {
+        LOG("ShmOrderClient::connect ERROR : Connexion à '" + socketPath + "' impossible. Erreur: " + std::string(strerror(errno)), "ERROR");
+        close();
+        return false;
+    }
+
+    // 1. Authentification (même message que les autres clients).
+    std::string line;
+    if (!sendLine("ID:" + clientId + ",TOKEN:" + password + "\n") || !receiveLine(line)) {
+        close();
+        return false;
+    }
+    if (line != "AUTH SUCCESS") {
+        LOG("ShmOrderClient::connect ERROR : Authentification refusée pour client " + clientId + " : '" + line + "'", "ERROR");
+        close();
+        return false;
+    }
+
+    // 2. Demande du canal : la réponse porte les descripteurs. Les PING éventuels sont ignorés.
+    if (!sendLine("SHM ATTACH\n")) {
+        close();
+        return false;
+    }
+    do {
+        if (!receiveLine(line)) {
+            close();
+            return false;
+        }
+    } while (line == "PING");
+
+    std::istringstream iss(line);
+    std::string shm_word, attached_word;
+    uint32_t order_capacity = 0, report_capacity = 0;
+    size_t size = 0;
+    if (!(iss >> shm_word >> attached_word >> order_capacity >> report_capacity >> size)
+        || shm_word != "SHM" || attached_word != "ATTACHED" || receivedFds.size() != 3) {
+        LOG("ShmOrderClient::connect ERROR : Réponse inattendue à SHM ATTACH : '" + line + "' (" + std::to_string(receivedFds.size()) + " descripteur(s) reçu(s)).", "ERROR");
+        close();
+        return false;
+    }
+    memFd = receivedFds[0];
+    orderDoorbell = receivedFds[1];
+    reportDoorbell = receivedFds[2];
+    receivedFds.clear();
+
+    if (!mapSegment(order_capacity, report_capacity, size)) {
+        close();
+        return false;
+    }
+    LOG("ShmOrderClient::connect INFO : Canal en mémoire partagée ouvert pour client " + clientId + " (" + std::to_string(order_capacity) + " ordres, " + std::to_string(report_capacity) + " rapports).", "INFO");
+    return true;
+}
+
+bool ShmOrderClient::mapSegment(uint32_t orderCapacity, uint32_t reportCapacity, size_t size) {
+    struct stat st{};
+    if (!ShmLayout::isValidCapacity(orderCapacity) || !ShmLayout::isValidCapacity(reportCapacity)
+        || size != ShmLayout::segmentSize(orderCapacity, reportCapacity)
+        || fstat(memFd, &st) != 0 || static_cast<size_t>(st.st_size) != size) {
+        LOG("ShmOrderClient::mapSegment ERROR : Dimensions du segment incohérentes.", "ERROR");
+        return false;
+    }
+    mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        LOG("ShmOrderClient::mapSegment ERROR : mmap impossible. Erreur: " + std::string(strerror(errno)), "ERROR");
+        return false;
+    }
+    mappingSize = size;
+
+    auto* header = static_cast<ShmSegmentHeader*>(mapping);
+    if (header->magic != ShmLayout::MAGIC || header->version != ShmLayout::VERSION
+        || header->orderCapacity != orderCapacity || header->reportCapacity != reportCapacity) {
+        LOG("ShmOrderClient::mapSegment ERROR : En-tête du segment invalide (magic/version).", "ERROR");
+        return false;
+    }
+    auto* base = static_cast<char*>(mapping);
+    orderRing = ShmRing<ShmOrderRecord>(&header->orders, reinterpret_cast<ShmOrderRecord*>(base + ShmLayout::ordersOffset()), orderCapacity);
+    reportRing = ShmRing<ShmReportRecord>(&header->reports, reinterpret_cast<ShmReportRecord*>(base + ShmLayout::reportsOffset(orderCapacity)), reportCapacity);
+    return true;
+}
+
+void ShmOrderClient::close() {
+    if (socketFd >= 0 && !socketClosed) {
+        sendLine("QUIT\n"); // Le serveur ferme la session, donc le canal.
+    }
+    if (mapping) {
+        munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+    for (int* fd : {&memFd, &orderDoorbell, &reportDoorbell, &socketFd}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+    for (int fd : receivedFds) {
+        ::close(fd);
+    }
+    receivedFds.clear();
+    inputBuffer.clear();
+    orderRing = ShmRing<ShmOrderRecord>();
+    reportRing = ShmRing<ShmReportRecord>();
+}
+
+// --- Chemin critique ---
+bool ShmOrderClient::submit(uint64_t clientOrderId, ShmLayout::Side side, double quantity, const std::string& symbol) {
+    if (!mapping) {
+        return false;
+    }
+    ShmOrderRecord order;
+    order.clientOrderId = clientOrderId;
+    order.side = static_cast<uint8_t>(side);
+    order.quantity = quantity;
+    std::memcpy(order.symbol, symbol.data(), std::min(symbol.size(), ShmLayout::SYMBOL_SIZE - 1));
+    if (!orderRing.tryPush(order)) {
+        return false;
+    }
+    if (orderRing.consumerNeedsWakeup()) {
+        uint64_t one = 1;
+        if (::write(orderDoorbell, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            LOG("ShmOrderClient::submit WARNING : Réveil de la passerelle impossible. Erreur: " + std::string(strerror(errno)), "WARNING");
+        }
+    }
+    return true;
+}
+
+bool ShmOrderClient::poll(ShmReportRecord& report) {
+    return mapping && reportRing.tryPop(report);
+}
+
+bool ShmOrderClient::waitReport(ShmReportRecord& report, int timeoutMs, int spinMicros) {
+    if (!mapping) {
+        return false;
+    }
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    const auto spin_until = start + std::chrono::microseconds(spinMicros);
+    while (true) {
+        if (reportRing.tryPop(report)) {
+            return true;
+        }
+        if (reportRing.isCorrupted()) {
+            return false;
+        }
+        auto now = clock::now();
+        if (now < spin_until) {
+            continue;
+        }
+        int wait_ms = -1;
+        if (timeoutMs >= 0) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count();
+            if (elapsed >= timeoutMs) {
+                return false;
+            }
+            wait_ms = static_cast<int>(timeoutMs - elapsed);
+        }
+        if (!reportRing.prepareToSleep()) {
+            continue; // Un rapport est arrivé entre-temps.
+        }
+        pollfd fds[2] = {{reportDoorbell, POLLIN, 0}, {socketFd, POLLIN, 0}};
+        int ready = ::poll(fds, 2, wait_ms);
+        reportRing.wokeUp();
+        if (ready < 0 && errno != EINTR) {
+            return false;
+        }
+        if (fds[0].revents & POLLIN) {
+            uint64_t count = 0;
+            ssize_t ignored = ::read(reportDoorbell, &count, sizeof(count));
+            (void)ignored;
+        }
+        if ((fds[1].revents & (POLLIN | POLLHUP | POLLERR)) && !serviceSocket()) {
+            return reportRing.tryPop(report); // Session fermée : dernier rapport éventuel.
+        }
+    }
+}
+
+// --- Session texte ---
+bool ShmOrderClient::serviceSocket() {
+    if (socketFd < 0 || socketClosed) {
+        return false;
+    }
+    while (receiveChunk(MSG_DONTWAIT)) {
+    }
+    size_t pos;
+    while ((pos = inputBuffer.find('\n')) != std::string::npos) {
+        std::string line = inputBuffer.substr(0, pos);
+        inputBuffer.erase(0, pos + 1);
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line == "PING") {
+            sendLine("PONG\n");
+        }
+    }
+    return !socketClosed;
+}
+
+bool ShmOrderClient::sendLine(const std::string& line) {
+    size_t sent = 0;
+    while (sent < line.size()) {
+        ssize_t n = ::send(socketFd, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            LOG("ShmOrderClient::sendLine ERROR : Échec de l'envoi sur le socket de la session. Erreur: " + std::string(strerror(errno)), "ERROR");
+            socketClosed = true;
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool ShmOrderClient::receiveLine(std::string& line) {
+    size_t pos;
+    while ((pos = inputBuffer.find('\n')) == std::string::npos) {
+        if (!receiveChunk(0)) {
+            LOG("ShmOrderClient::receiveLine ERROR : Session fermée par le serveur avant la réponse attendue.", "ERROR");
+            return false;
+        }
+    }
+    line = inputBuffer.substr(0, pos);
+    inputBuffer.erase(0, pos + 1);
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return true;
+}
+
+// recvmsg (et non recv) : les descripteurs joints à un message ne sont livrés qu'avec un tampon de contrôle.
+bool ShmOrderClient::receiveChunk(int flags) {
+    char buffer[4096];
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_RECEIVED_FDS)];
+    iovec iov{buffer, sizeof(buffer)};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n;
+    do {
+        n = ::recvmsg(socketFd, &msg, flags | MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return false;
+    }
+    if (n <= 0) {
+        socketClosed = true;
+        return false;
+    }
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const auto* fds = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+            receivedFds.insert(receivedFds.end(), fds, fds + count);
+        }
+    }
+    inputBuffer.append(buffer, static_cast<size_t>(n));
+    return true;
+}
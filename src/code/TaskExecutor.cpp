@@ -0,0 +1,210 @@
+#include "../headers/TaskExecutor.h"
+
+#include <algorithm>
+#include <exception>
+#include <string>
+
+
+// Worker courant (thread_local) : permet à une tâche qui soumet une autre tâche de la déposer
+// dans la file de son propre worker plutôt que dans celle d'un autre.
+static thread_local const WorkStealingExecutor* currentExecutor = nullptr;
+static thread_local size_t currentWorkerIndex = 0;
+
+
+// --- Constructeur ---
+WorkStealingExecutor::WorkStealingExecutor(int threads)
+    : running(false),
+      nextWorker(0),
+      pendingTasks(0),
+      idleWorkers(0),
+      peakPending(0),
+      submitted(0),
+      executed(0),
+      stolen(0),
+      heapAllocated(0)
+{
+    int count = threads;
+    if (count <= 0) {
+        count = std::max(DEFAULT_MIN_THREADS, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    count = std::clamp(count, 1, MAX_THREADS);
+    for (int i = 0; i < count; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    LOG("WorkStealingExecutor::WorkStealingExecutor INFO : Exécuteur créé avec " + std::to_string(count) + " workers.", "INFO");
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+    stop();
+}
+
+// --- Démarrage ---
+bool WorkStealingExecutor::start() {
+    if (running.load()) {
+        return true;
+    }
+    running.store(true);
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->thread = std::thread(&WorkStealingExecutor::workerLoop, this, i);
+    }
+    LOG("WorkStealingExecutor::start INFO : " + std::to_string(workers.size()) + " workers démarrés.", "INFO");
+    return true;
+}
+
+// --- Arrêt ---
+// Les tâches déjà soumises sont exécutées avant que les workers ne se terminent.
+void WorkStealingExecutor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        if (!running.load()) {
+            return;
+        }
+        running.store(false);
+    }
+    sleepCv.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    LOG("WorkStealingExecutor::stop INFO : Workers arrêtés.", "INFO");
+}
+
+// --- Soumission ---
+bool WorkStealingExecutor::submit(InlineTask task) {
+    if (!task || !running.load()) {
+        return false;
+    }
+    if (!task.isInline()) {
+        heapAllocated.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Depuis un worker : dans sa propre file. Sinon : répartition en tourniquet.
+    size_t index = (currentExecutor == this)
+        ? currentWorkerIndex
+        : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    push(index, std::move(task));
+    submitted.fetch_add(1, std::memory_order_relaxed);
+
+    // Réveil d'un worker endormi. pendingTasks est incrémenté (dans push) AVANT la lecture de idleWorkers,
+    // et un worker incrémente idleWorkers AVANT de relire pendingTasks : l'un des deux voit toujours l'autre.
+    // Le passage par sleepMutex garantit que le worker est bien dans wait() quand la notification part.
+    if (idleWorkers.load() > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        sleepCv.notify_one();
+    }
+    return true;
+}
+
+void WorkStealingExecutor::push(size_t index, InlineTask&& task) {
+    Worker& worker = *workers[index];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    size_t pending = pendingTasks.fetch_add(1) + 1;
+    size_t peak = peakPending.load(std::memory_order_relaxed);
+    while (pending > peak && !peakPending.compare_exchange_weak(peak, pending, std::memory_order_relaxed)) {
+    }
+}
+
+// --- File locale : le worker reprend sa tâche la plus récente (LIFO) ---
+bool WorkStealingExecutor::popLocal(size_t index, InlineTask& task) {
+    Worker& worker = *workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    pendingTasks.fetch_sub(1);
+    return true;
+}
+
+// --- Vol : la tâche la plus ancienne (FIFO) d'un autre worker ---
+bool WorkStealingExecutor::steal(size_t thief, InlineTask& task) {
+    for (size_t offset = 1; offset < workers.size(); ++offset) {
+        Worker& victim = *workers[(thief + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) {
+            continue;
+        }
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        pendingTasks.fetch_sub(1);
+        stolen.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingExecutor::runTask(InlineTask& task) {
+    try {
+        task();
+    } catch (const std::exception& e) {
+        LOG("WorkStealingExecutor::runTask ERROR : Exception dans une tâche : " + std::string(e.what()), "ERROR");
+    } catch (...) {
+        LOG("WorkStealingExecutor::runTask ERROR : Exception inconnue dans une tâche.", "ERROR");
+    }
+    task.reset();
+    executed.fetch_add(1, std::memory_order_relaxed);
+}
+
+// --- Boucle d'un worker ---
+void WorkStealingExecutor::workerLoop(size_t index) {
+    currentExecutor = this;
+    currentWorkerIndex = index;
+
+    InlineTask task;
+    while (true) {
+        if (popLocal(index, task) || steal(index, task)) {
+            runTask(task);
+            continue;
+        }
+
+        // Rien à faire : dormir jusqu'à la prochaine soumission (ou l'arrêt, une fois toutes les files vidées).
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        idleWorkers.fetch_add(1);
+        sleepCv.wait(lock, [this] { return pendingTasks.load() > 0 || !running.load(); });
+        idleWorkers.fetch_sub(1);
+        if (!running.load() && pendingTasks.load() == 0) {
+            break;
+        }
+    }
+
+    currentExecutor = nullptr;
+}
+
+// --- Statistiques ---
+size_t WorkStealingExecutor::getThreadCount() const {
+    return workers.size();
+}
+
+ExecutorStats WorkStealingExecutor::getStats() const {
+    ExecutorStats stats;
+    stats.threads = workers.size();
+    for (const auto& worker : workers) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        stats.queueDepths.push_back(worker->tasks.size());
+        stats.queuedTasks += worker->tasks.size();
+    }
+    stats.peakQueuedTasks = peakPending.load(std::memory_order_relaxed);
+    stats.submitted = submitted.load(std::memory_order_relaxed);
+    stats.executed = executed.load(std::memory_order_relaxed);
+    stats.stolen = stolen.load(std::memory_order_relaxed);
+    stats.heapAllocatedTasks = heapAllocated.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void WorkStealingExecutor::logStats() const {
+    ExecutorStats st = getStats();
+    std::string depths;
+    for (size_t depth : st.queueDepths) {
+        depths += (depths.empty() ? "" : "/") + std::to_string(depth);
+    }
+    LOG("WorkStealingExecutor::logStats INFO : Workers=" + std::to_string(st.threads) + ", soumises=" + std::to_string(st.submitted)
+        + ", exécutées=" + std::to_string(st.executed) + ", volées=" + std::to_string(st.stolen)
+        + ", allouées sur le tas=" + std::to_string(st.heapAllocatedTasks) + ", en attente=" + std::to_string(st.queuedTasks)
+        + " (" + depths + ", pic " + std::to_string(st.peakQueuedTasks) + ").", "INFO");
+}
@@ -0,0 +1,170 @@
+#include "../headers/TimingWheel.h"
+
+#include <algorithm>
+
+
+// --- Constructeur ---
+TimingWheel::TimingWheel(std::chrono::milliseconds tick, Clock::time_point now)
+    : tickDuration(std::max(tick, std::chrono::milliseconds(1))),
+      origin(now)
+{
+    heads.fill(NIL);
+}
+
+uint64_t TimingWheel::tickOf(Clock::time_point time) const {
+    if (time <= origin) {
+        return 0;
+    }
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(time - origin) / tickDuration);
+}
+
+// --- Armement ---
+TimingWheel::TimerId TimingWheel::arm(std::chrono::milliseconds delay, uint64_t userData) {
+    uint32_t index;
+    if (freeHead != NIL) {
+        index = freeHead;
+        freeHead = nodes[index].next;
+    } else {
+        index = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    // Arrondi au tick supérieur, relatif au tick courant de l'horloge (et non au dernier tick traité).
+    uint64_t now_tick = std::max(currentTick, tickOf(Clock::now()));
+    if (armedCount == 0) {
+        currentTick = now_tick; // Roue vide : rattraper l'horloge sans parcourir les ticks.
+    }
+    uint64_t ticks = delay.count() <= 0 ? 0 : static_cast<uint64_t>((delay + tickDuration - std::chrono::milliseconds(1)) / tickDuration);
+    uint64_t max_ticks = (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+
+    Node& node = nodes[index];
+    // Borné à la portée de la roue mesurée depuis le dernier tick traité.
+    node.expireTick = std::min(now_tick + ticks, currentTick + max_ticks);
+    node.userData = userData;
+    place(index);
+    armedCount++;
+    return (static_cast<TimerId>(node.generation) << 32) | index;
+}
+
+// --- Annulation ---
+bool TimingWheel::cancel(TimerId id) {
+    uint32_t index = static_cast<uint32_t>(id);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    if (id == 0 || index >= nodes.size() || nodes[index].generation != generation || nodes[index].bucket == NIL) {
+        return false;
+    }
+    unlink(index);
+    release(index);
+    armedCount--;
+    return true;
+}
+
+// --- Rangement d'un noeud dans la case correspondant à son échéance ---
+void TimingWheel::place(uint32_t index) {
+    Node& node = nodes[index];
+    if (node.expireTick < currentTick) {
+        // Échéance déjà passée (cascade tardive, délai nul) : traitée au prochain tick.
+        link(index, static_cast<uint32_t>(currentTick & SLOT_MASK));
+        return;
+    }
+    uint64_t delta = node.expireTick - currentTick;
+    size_t level = 0;
+    while (level + 1 < LEVELS && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    uint64_t slot = (node.expireTick >> (SLOT_BITS * level)) & SLOT_MASK;
+    link(index, static_cast<uint32_t>(level * SLOTS + slot));
+}
+
+void TimingWheel::link(uint32_t index, uint32_t bucket) {
+    Node& node = nodes[index];
+    node.bucket = bucket;
+    node.prev = NIL;
+    node.next = heads[bucket];
+    if (node.next != NIL) {
+        nodes[node.next].prev = index;
+    }
+    heads[bucket] = index;
+}
+
+void TimingWheel::unlink(uint32_t index) {
+    Node& node = nodes[index];
+    if (node.prev != NIL) {
+        nodes[node.prev].next = node.next;
+    } else {
+        heads[node.bucket] = node.next;
+    }
+    if (node.next != NIL) {
+        nodes[node.next].prev = node.prev;
+    }
+    node.prev = node.next = NIL;
+    node.bucket = NIL;
+}
+
+// Remet le noeud dans la liste libre ; la génération invalide les identifiants encore détenus.
+void TimingWheel::release(uint32_t index) {
+    Node& node = nodes[index];
+    node.generation = (node.generation == UINT32_MAX) ? 1 : node.generation + 1;
+    node.next = freeHead;
+    freeHead = index;
+}
+
+// Redistribue vers les niveaux inférieurs la case du niveau 'level' qui arrive à échéance.
+void TimingWheel::cascade(size_t level) {
+    uint32_t bucket = static_cast<uint32_t>(level * SLOTS + ((currentTick >> (SLOT_BITS * level)) & SLOT_MASK));
+    uint32_t index = heads[bucket];
+    heads[bucket] = NIL;
+    while (index != NIL) {
+        uint32_t next = nodes[index].next;
+        place(index);
+        index = next;
+    }
+}
+
+// --- Avancement ---
+size_t TimingWheel::advance(Clock::time_point now, std::vector<uint64_t>& expired) {
+    uint64_t target = tickOf(now);
+    size_t fired = 0;
+
+    while (currentTick <= target) {
+        if (armedCount == 0) {
+            currentTick = target + 1; // Rien d'armé : inutile de parcourir les ticks un par un.
+            break;
+        }
+
+        // Début d'un tour du niveau 0 : descendre la case correspondante du niveau 1 (et ainsi de suite).
+        for (size_t level = 1; level < LEVELS; ++level) {
+            if (((currentTick >> (SLOT_BITS * (level - 1))) & SLOT_MASK) != 0) {
+                break;
+            }
+            cascade(level);
+        }
+
+        uint32_t bucket = static_cast<uint32_t>(currentTick & SLOT_MASK);
+        uint32_t index = heads[bucket];
+        heads[bucket] = NIL;
+        while (index != NIL) {
+            uint32_t next = nodes[index].next;
+            expired.push_back(nodes[index].userData);
+            nodes[index].bucket = NIL;
+            nodes[index].prev = nodes[index].next = NIL;
+            release(index);
+            armedCount--;
+            fired++;
+            index = next;
+        }
+        currentTick++;
+    }
+    return fired;
+}
+
+int TimingWheel::millisecondsUntilNextTick(Clock::time_point now) const {
+    if (armedCount == 0) {
+        return -1;
+    }
+    Clock::time_point next = origin + tickDuration * currentTick;
+    if (next <= now) {
+        return 0;
+    }
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count()) + 1;
+}
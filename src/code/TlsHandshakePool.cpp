@@ -0,0 +1,321 @@
+#include "../headers/TlsHandshakePool.h"
+#include "../headers/Logger.h"
+
+#include <openssl/err.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+
+// Passe un socket en mode (non) bloquant. Retourne false en cas d'échec fcntl.
+static bool setSocketBlocking(int fd, bool blocking) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1) return false;
+    flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+    return fcntl(fd, F_SETFL, flags) != -1;
+}
+
+
+// --- Constructeur ---
+TlsHandshakePool::TlsHandshakePool(SSL_CTX* context, int threads, int timeout)
+    : ctx(context),
+      timeoutMs(timeout),
+      running(false),
+      nextWorker(0),
+      completed(0),
+      failed(0),
+      timedOut(0)
+{
+    int count = threads;
+    if (count <= 0) {
+        count = static_cast<int>(std::thread::hardware_concurrency());
+        count = std::clamp(count, 1, 8);
+    }
+    for (int i = 0; i < count; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    LOG("TlsHandshakePool::TlsHandshakePool INFO : Pool de handshake créé avec " + std::to_string(count) + " threads (timeout " + std::to_string(timeoutMs) + " ms).", "INFO");
+}
+
+TlsHandshakePool::~TlsHandshakePool() {
+    stop();
+}
+
+// --- Démarrage ---
+bool TlsHandshakePool::start() {
+    if (running.load()) {
+        return true;
+    }
+    if (!ctx) {
+        LOG("TlsHandshakePool::start ERROR : Contexte SSL null.", "ERROR");
+        return false;
+    }
+
+    for (auto& worker : workers) {
+        worker->epollFd = epoll_create1(EPOLL_CLOEXEC);
+        worker->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (worker->epollFd == -1 || worker->wakeFd == -1) {
+            LOG("TlsHandshakePool::start ERROR : Échec epoll_create1/eventfd. Erreur: " + std::string(strerror(errno)), "ERROR");
+            stop();
+            return false;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = worker->wakeFd;
+        if (epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, worker->wakeFd, &ev) == -1) {
+            LOG("TlsHandshakePool::start ERROR : Échec enregistrement eventfd. Erreur: " + std::string(strerror(errno)), "ERROR");
+            stop();
+            return false;
+        }
+    }
+
+    running.store(true);
+    for (auto& worker : workers) {
+        Worker* w = worker.get();
+        w->thread = std::thread(&TlsHandshakePool::workerLoop, this, std::ref(*w));
+    }
+    LOG("TlsHandshakePool::start INFO : " + std::to_string(workers.size()) + " threads de handshake démarrés.", "INFO");
+    return true;
+}
+
+// --- Arrêt ---
+void TlsHandshakePool::stop() {
+    bool was_running = running.exchange(false);
+
+    for (auto& worker : workers) {
+        if (worker->wakeFd != -1) {
+            uint64_t one = 1;
+            ssize_t ignored = ::write(worker->wakeFd, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    // Fermer les connexions dont le handshake n'a pas abouti.
+    for (auto& worker : workers) {
+        for (auto& [fd, hs] : worker->inProgress) {
+            hs.ssl.reset();
+            closeSocket(fd);
+        }
+        worker->inProgress.clear();
+        {
+            std::lock_guard<std::mutex> lock(worker->pendingMutex);
+            for (int fd : worker->pending) closeSocket(fd);
+            worker->pending.clear();
+        }
+        if (worker->epollFd != -1) { ::close(worker->epollFd); worker->epollFd = -1; }
+        if (worker->wakeFd != -1) { ::close(worker->wakeFd); worker->wakeFd = -1; }
+    }
+
+    if (was_running) {
+        LOG("TlsHandshakePool::stop INFO : Threads de handshake arrêtés. Réussis: " + std::to_string(getCompletedCount()) + ", échoués: " + std::to_string(getFailedCount()) + ", expirés: " + std::to_string(getTimedOutCount()) + ".", "INFO");
+    }
+}
+
+// --- Soumission d'un socket accepté (thread d'acceptation) ---
+bool TlsHandshakePool::submit(int clientSocket) {
+    if (!running.load() || workers.empty()) {
+        return false;
+    }
+    Worker& worker = *workers[nextWorker.fetch_add(1) % workers.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.pendingMutex);
+        worker.pending.push_back(clientSocket);
+    }
+    uint64_t one = 1;
+    if (::write(worker.wakeFd, &one, sizeof(one)) != sizeof(one)) {
+        LOG("TlsHandshakePool::submit WARNING : Échec écriture eventfd. Erreur: " + std::string(strerror(errno)), "WARNING");
+    }
+    return true;
+}
+
+void TlsHandshakePool::setCompletionHandler(CompletionHandler handler) {
+    completionHandler = std::move(handler);
+}
+
+void TlsHandshakePool::setCloseHandler(CloseHandler handler) {
+    closeHandler = std::move(handler);
+}
+
+void TlsHandshakePool::closeSocket(int fd) {
+    if (closeHandler) {
+        closeHandler(fd);
+    }
+    ::close(fd);
+}
+
+size_t TlsHandshakePool::getThreadCount() const {
+    return workers.size();
+}
+
+// --- Prise en charge des sockets soumis (thread de handshake) ---
+void TlsHandshakePool::adoptPending(Worker& worker) {
+    std::vector<int> fds;
+    {
+        std::lock_guard<std::mutex> lock(worker.pendingMutex);
+        fds.swap(worker.pending);
+    }
+
+    for (int fd : fds) {
+        if (!setSocketBlocking(fd, false)) {
+            LOG("TlsHandshakePool::adoptPending ERROR : Impossible de passer le socket FD " + std::to_string(fd) + " en non bloquant.", "ERROR");
+            closeSocket(fd);
+            failed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        Handshake hs;
+        hs.fd = fd;
+        hs.ssl.reset(SSL_new(ctx));
+        if (!hs.ssl || SSL_set_fd(hs.ssl.get(), fd) <= 0) {
+            LOG("TlsHandshakePool::adoptPending ERROR : Erreur SSL_new()/SSL_set_fd(). Socket FD: " + std::to_string(fd), "ERROR");
+            ERR_print_errors_fp(stderr);
+            hs.ssl.reset();
+            closeSocket(fd);
+            failed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        hs.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+        auto [it, inserted] = worker.inProgress.emplace(fd, std::move(hs));
+        if (!inserted) {
+            // Ne devrait pas arriver : un fd n'est réutilisé qu'après fermeture.
+            LOG("TlsHandshakePool::adoptPending ERROR : Socket FD " + std::to_string(fd) + " déjà en cours de handshake.", "ERROR");
+            continue;
+        }
+        // Première tentative immédiate : le ClientHello est souvent déjà arrivé.
+        if (advance(worker, it->second)) {
+            worker.inProgress.erase(it);
+        }
+    }
+}
+
+// --- Fait avancer la machine à états du handshake ---
+bool TlsHandshakePool::advance(Worker& worker, Handshake& hs) {
+    ERR_clear_error();
+    int ret = SSL_accept(hs.ssl.get());
+
+    if (ret == 1) {
+        // Handshake terminé : le fd quitte l'epoll du pool, la suite (authentification) est bloquante.
+        if (hs.watchedEvents != 0) {
+            epoll_ctl(worker.epollFd, EPOLL_CTL_DEL, hs.fd, nullptr);
+        }
+        setSocketBlocking(hs.fd, true);
+        completed.fetch_add(1, std::memory_order_relaxed);
+
+        if (SSL_session_reused(hs.ssl.get())) {
+            LOG("TlsHandshakePool::advance INFO : Session SSL existante reprise pour socket FD: " + std::to_string(hs.fd), "INFO");
+        }
+        LOG("TlsHandshakePool::advance INFO : Handshake SSL réussi pour socket FD: " + std::to_string(hs.fd), "INFO");
+
+        if (completionHandler) {
+            completionHandler(hs.fd, hs.ssl.release());
+        } else {
+            hs.ssl.reset();
+            closeSocket(hs.fd);
+        }
+        return true;
+    }
+
+    int err = SSL_get_error(hs.ssl.get(), ret);
+    uint32_t wanted = 0;
+    if (err == SSL_ERROR_WANT_READ) {
+        wanted = EPOLLIN;
+    } else if (err == SSL_ERROR_WANT_WRITE) {
+        wanted = EPOLLOUT;
+    } else {
+        LOG("TlsHandshakePool::advance ERROR : Erreur fatale lors du handshake SSL pour socket FD: " + std::to_string(hs.fd) + ". Erreur SSL: " + std::to_string(err), "ERROR");
+        ERR_print_errors_fp(stderr);
+        failed.fetch_add(1, std::memory_order_relaxed);
+        abandon(worker, hs);
+        return true;
+    }
+
+    // Handshake incomplet : (ré)armer l'événement attendu.
+    if (hs.watchedEvents != wanted) {
+        epoll_event ev{};
+        ev.events = wanted | EPOLLRDHUP;
+        ev.data.fd = hs.fd;
+        int op = (hs.watchedEvents == 0) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+        if (epoll_ctl(worker.epollFd, op, hs.fd, &ev) == -1) {
+            LOG("TlsHandshakePool::advance ERROR : epoll_ctl a échoué pour socket FD: " + std::to_string(hs.fd) + ". Erreur: " + std::string(strerror(errno)), "ERROR");
+            failed.fetch_add(1, std::memory_order_relaxed);
+            abandon(worker, hs);
+            return true;
+        }
+        hs.watchedEvents = wanted;
+    }
+    return false;
+}
+
+// --- Abandon d'un handshake (échec ou délai dépassé) ---
+void TlsHandshakePool::abandon(Worker& worker, Handshake& hs) {
+    if (hs.watchedEvents != 0) {
+        epoll_ctl(worker.epollFd, EPOLL_CTL_DEL, hs.fd, nullptr);
+        hs.watchedEvents = 0;
+    }
+    hs.ssl.reset();
+    closeSocket(hs.fd);
+}
+
+// --- Expiration des handshakes trop lents ---
+void TlsHandshakePool::expireHandshakes(Worker& worker) {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = worker.inProgress.begin(); it != worker.inProgress.end(); ) {
+        if (now >= it->second.deadline) {
+            LOG("TlsHandshakePool::expireHandshakes WARNING : Handshake non terminé après " + std::to_string(timeoutMs) + " ms. Fermeture socket FD: " + std::to_string(it->first), "WARNING");
+            timedOut.fetch_add(1, std::memory_order_relaxed);
+            abandon(worker, it->second);
+            it = worker.inProgress.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// --- Boucle d'un thread de handshake ---
+void TlsHandshakePool::workerLoop(Worker& worker) {
+    constexpr int MAX_EVENTS = 64;
+    epoll_event events[MAX_EVENTS];
+
+    while (running.load()) {
+        int n = epoll_wait(worker.epollFd, events, MAX_EVENTS, POLL_INTERVAL_MS);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG("TlsHandshakePool::workerLoop ERROR : epoll_wait a échoué. Erreur: " + std::string(strerror(errno)), "ERROR");
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == worker.wakeFd) {
+                uint64_t value;
+                while (::read(worker.wakeFd, &value, sizeof(value)) > 0) {}
+                continue;
+            }
+            auto it = worker.inProgress.find(fd);
+            if (it == worker.inProgress.end()) {
+                continue;
+            }
+            // Même sur EPOLLHUP/ERR, SSL_accept() rapportera l'erreur et la connexion sera abandonnée.
+            if (advance(worker, it->second)) {
+                worker.inProgress.erase(it);
+            }
+        }
+
+        if (!running.load()) break;
+        adoptPending(worker);
+        expireHandshakes(worker);
+    }
+}
@@ -0,0 +1,303 @@
+#include "../headers/TlsResumption.h"
+#include "../headers/Logger.h"
+
+#include <openssl/rand.h>
+#include <openssl/err.h>
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+#include <cstring>
+#include <string>
+
+
+// Index ex_data du SSL_CTX où est rangé le pointeur vers l'instance TlsResumption.
+static int resumptionExDataIndex() {
+    static const int idx = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return idx;
+}
+
+// Contexte d'identifiant de session (requis pour la reprise côté serveur).
+static const unsigned char SESSION_ID_CONTEXT[] = "PPN_CTS";
+
+
+// --- Constructeur ---
+TlsResumption::TlsResumption(const TlsResumptionConfig& cfg)
+    : config(cfg),
+      resumedHandshakes(0),
+      fullHandshakes(0),
+      ticketKeyHits(0),
+      ticketKeyMisses(0),
+      storeHits(0),
+      storeMisses(0),
+      storeEvictions(0)
+{
+}
+
+// --- Destructeur ---
+// Libère les références détenues par le cache partagé. Le SSL_CTX doit déjà être libéré.
+TlsResumption::~TlsResumption() {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    for (auto& entry : lru) {
+        SSL_SESSION_free(entry.second);
+    }
+    lru.clear();
+    index.clear();
+    for (TicketKey* key : {&currentKey, &previousKey}) {
+        OPENSSL_cleanse(key->aesKey, sizeof(key->aesKey));
+        OPENSSL_cleanse(key->hmacKey, sizeof(key->hmacKey));
+    }
+}
+
+// --- Installation sur le contexte serveur ---
+bool TlsResumption::install(SSL_CTX* ctx) {
+    if (!ctx || resumptionExDataIndex() < 0) {
+        LOG("TlsResumption::install ERROR : Contexte SSL null ou index ex_data indisponible.", "ERROR");
+        return false;
+    }
+    SSL_CTX_set_ex_data(ctx, resumptionExDataIndex(), this);
+    SSL_CTX_set_session_id_context(ctx, SESSION_ID_CONTEXT, sizeof(SESSION_ID_CONTEXT) - 1);
+    SSL_CTX_set_timeout(ctx, config.sessionLifetimeSec);
+
+    if (config.sharedSessionStore) {
+        // Reprise "stateful" : en TLS 1.3, SSL_OP_NO_TICKET fait émettre un identifiant au lieu d'un ticket chiffré.
+        // Le cache interne d'OpenSSL est désactivé : seul notre cache borné et partagé est utilisé.
+        SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+        SSL_CTX_sess_set_new_cb(ctx, &TlsResumption::newSessionCallback);
+        SSL_CTX_sess_set_remove_cb(ctx, &TlsResumption::removeSessionCallback);
+        SSL_CTX_sess_set_get_cb(ctx, &TlsResumption::getSessionCallback);
+        LOG("TlsResumption::install INFO : Reprise de session via cache partagé (capacité " + std::to_string(config.sessionStoreCapacity) + ", durée de vie " + std::to_string(config.sessionLifetimeSec) + " s).", "INFO");
+        return true;
+    }
+
+    if (config.sessionTickets) {
+        // Reprise "stateless" : aucun état serveur, le ticket est chiffré avec une clé tournante.
+        {
+            std::lock_guard<std::mutex> lock(keysMutex);
+            if (!generateKey(currentKey)) {
+                LOG("TlsResumption::install ERROR : Échec de génération de la clé de tickets.", "ERROR");
+                return false;
+            }
+        }
+        SSL_CTX_clear_options(ctx, SSL_OP_NO_TICKET);
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+        if (SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx, &TlsResumption::ticketKeyCallback) != 1) {
+            LOG("TlsResumption::install ERROR : SSL_CTX_set_tlsext_ticket_key_evp_cb a échoué.", "ERROR");
+            ERR_print_errors_fp(stderr);
+            return false;
+        }
+        LOG("TlsResumption::install INFO : Reprise de session via tickets (rotation des clés toutes les " + std::to_string(config.ticketKeyRotationSec) + " s).", "INFO");
+        return true;
+    }
+
+    // Aucune reprise : chaque connexion paie un handshake complet.
+    SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+    SSL_CTX_set_num_tickets(ctx, 0);
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+    LOG("TlsResumption::install INFO : Reprise de session désactivée.", "INFO");
+    return true;
+}
+
+// --- Comptage des handshakes ---
+void TlsResumption::recordHandshake(const SSL* ssl) {
+    if (!ssl) return;
+    if (SSL_session_reused(const_cast<SSL*>(ssl))) {
+        resumedHandshakes.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        fullHandshakes.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+TlsResumptionStats TlsResumption::getStats() const {
+    TlsResumptionStats st;
+    st.resumedHandshakes = resumedHandshakes.load(std::memory_order_relaxed);
+    st.fullHandshakes = fullHandshakes.load(std::memory_order_relaxed);
+    st.ticketKeyHits = ticketKeyHits.load(std::memory_order_relaxed);
+    st.ticketKeyMisses = ticketKeyMisses.load(std::memory_order_relaxed);
+    st.storeHits = storeHits.load(std::memory_order_relaxed);
+    st.storeMisses = storeMisses.load(std::memory_order_relaxed);
+    st.storeEvictions = storeEvictions.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        st.storeSize = lru.size();
+    }
+    return st;
+}
+
+void TlsResumption::logStats() const {
+    TlsResumptionStats st = getStats();
+    LOG("TlsResumption::logStats INFO : Handshakes repris=" + std::to_string(st.resumedHandshakes) + ", complets=" + std::to_string(st.fullHandshakes)
+        + " | tickets: clé connue=" + std::to_string(st.ticketKeyHits) + ", clé inconnue=" + std::to_string(st.ticketKeyMisses)
+        + " | cache: hits=" + std::to_string(st.storeHits) + ", misses=" + std::to_string(st.storeMisses) + ", évictions=" + std::to_string(st.storeEvictions) + ", taille=" + std::to_string(st.storeSize), "INFO");
+}
+
+TlsResumption* TlsResumption::fromSsl(const SSL* ssl) {
+    SSL_CTX* ctx = SSL_get_SSL_CTX(ssl);
+    return ctx ? static_cast<TlsResumption*>(SSL_CTX_get_ex_data(ctx, resumptionExDataIndex())) : nullptr;
+}
+
+
+// --- Clés de tickets ---
+
+bool TlsResumption::generateKey(TicketKey& key) {
+    if (RAND_bytes(key.name, sizeof(key.name)) != 1 ||
+        RAND_bytes(key.aesKey, sizeof(key.aesKey)) != 1 ||
+        RAND_bytes(key.hmacKey, sizeof(key.hmacKey)) != 1) {
+        return false;
+    }
+    key.created = std::chrono::steady_clock::now();
+    return true;
+}
+
+// Appelée avec keysMutex verrouillé.
+void TlsResumption::rotateKeysIfNeeded() {
+    auto age = std::chrono::steady_clock::now() - currentKey.created;
+    if (age < std::chrono::seconds(config.ticketKeyRotationSec)) {
+        return;
+    }
+    TicketKey fresh;
+    if (!generateKey(fresh)) {
+        LOG("TlsResumption::rotateKeysIfNeeded ERROR : Échec de génération d'une nouvelle clé de tickets. Clé actuelle conservée.", "ERROR");
+        return;
+    }
+    previousKey = currentKey;
+    hasPreviousKey = true;
+    currentKey = fresh;
+    OPENSSL_cleanse(&fresh, sizeof(fresh));
+    LOG("TlsResumption::rotateKeysIfNeeded INFO : Rotation de la clé des tickets de session.", "INFO");
+}
+
+// Callback OpenSSL : chiffrement (enc=1) ou déchiffrement (enc=0) d'un ticket.
+// Retour en déchiffrement : 0 = clé inconnue (handshake complet), 1 = OK, 2 = OK mais ticket à renouveler.
+int TlsResumption::ticketKeyCallback(SSL* ssl, unsigned char keyName[16], unsigned char* iv,
+                                     EVP_CIPHER_CTX* cipherCtx, EVP_MAC_CTX* macCtx, int enc) {
+    TlsResumption* self = fromSsl(ssl);
+    if (!self) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(self->keysMutex);
+    const TicketKey* key = nullptr;
+    int result = 1;
+
+    if (enc) {
+        self->rotateKeysIfNeeded();
+        key = &self->currentKey;
+        std::memcpy(keyName, key->name, sizeof(key->name));
+        if (RAND_bytes(iv, EVP_CIPHER_get_iv_length(EVP_aes_256_cbc())) != 1) {
+            return -1;
+        }
+        if (EVP_EncryptInit_ex(cipherCtx, EVP_aes_256_cbc(), nullptr, key->aesKey, iv) != 1) {
+            return -1;
+        }
+    } else {
+        if (std::memcmp(keyName, self->currentKey.name, sizeof(self->currentKey.name)) == 0) {
+            key = &self->currentKey;
+        } else if (self->hasPreviousKey && std::memcmp(keyName, self->previousKey.name, sizeof(self->previousKey.name)) == 0) {
+            key = &self->previousKey;
+            result = 2; // Encore valide, mais le client recevra un ticket chiffré avec la clé courante.
+        } else {
+            self->ticketKeyMisses.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+        self->ticketKeyHits.fetch_add(1, std::memory_order_relaxed);
+        if (EVP_DecryptInit_ex(cipherCtx, EVP_aes_256_cbc(), nullptr, key->aesKey, iv) != 1) {
+            return -1;
+        }
+    }
+
+    OSSL_PARAM params[3];
+    params[0] = OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, const_cast<unsigned char*>(key->hmacKey), sizeof(key->hmacKey));
+    params[1] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char*>("SHA256"), 0);
+    params[2] = OSSL_PARAM_construct_end();
+    if (EVP_MAC_CTX_set_params(macCtx, params) != 1) {
+        return -1;
+    }
+    return result;
+}
+
+
+// --- Cache de sessions partagé ---
+
+// OpenSSL nous confie une référence sur la session (retour 1).
+int TlsResumption::newSessionCallback(SSL* ssl, SSL_SESSION* session) {
+    TlsResumption* self = fromSsl(ssl);
+    if (!self) {
+        return 0; // On ne garde pas la référence.
+    }
+    self->storeSession(session);
+    return 1;
+}
+
+void TlsResumption::removeSessionCallback(SSL_CTX* ctx, SSL_SESSION* session) {
+    TlsResumption* self = static_cast<TlsResumption*>(SSL_CTX_get_ex_data(ctx, resumptionExDataIndex()));
+    if (self) {
+        self->eraseSession(session);
+    }
+}
+
+SSL_SESSION* TlsResumption::getSessionCallback(SSL* ssl, const unsigned char* id, int idLen, int* copy) {
+    TlsResumption* self = fromSsl(ssl);
+    if (!self) {
+        return nullptr;
+    }
+    // lookupSession() prend une référence sous le verrou (une éviction concurrente ne peut donc pas
+    // libérer la session avant qu'OpenSSL ne la récupère) : cette référence est cédée à OpenSSL.
+    *copy = 0;
+    return self->lookupSession(id, idLen);
+}
+
+void TlsResumption::storeSession(SSL_SESSION* session) {
+    unsigned int len = 0;
+    const unsigned char* id = SSL_SESSION_get_id(session, &len);
+    std::string key(reinterpret_cast<const char*>(id), len);
+
+    std::lock_guard<std::mutex> lock(storeMutex);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        // Même identifiant (ne devrait pas arriver) : remplacer l'entrée.
+        SSL_SESSION_free(it->second->second);
+        lru.erase(it->second);
+        index.erase(it);
+    }
+    lru.emplace_front(key, session);
+    index[key] = lru.begin();
+
+    // Éviction LRU au-delà de la capacité.
+    while (lru.size() > config.sessionStoreCapacity && !lru.empty()) {
+        auto& oldest = lru.back();
+        index.erase(oldest.first);
+        SSL_SESSION_free(oldest.second);
+        lru.pop_back();
+        storeEvictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+SSL_SESSION* TlsResumption::lookupSession(const unsigned char* id, int idLen) {
+    std::string key(reinterpret_cast<const char*>(id), static_cast<size_t>(idLen));
+    std::lock_guard<std::mutex> lock(storeMutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        storeMisses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    // Remonter l'entrée en tête de la LRU.
+    lru.splice(lru.begin(), lru, it->second);
+    storeHits.fetch_add(1, std::memory_order_relaxed);
+    SSL_SESSION_up_ref(it->second->second);
+    return it->second->second;
+}
+
+void TlsResumption::eraseSession(SSL_SESSION* session) {
+    unsigned int len = 0;
+    const unsigned char* id = SSL_SESSION_get_id(session, &len);
+    std::string key(reinterpret_cast<const char*>(id), len);
+
+    std::lock_guard<std::mutex> lock(storeMutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return;
+    }
+    SSL_SESSION_free(it->second->second);
+    lru.erase(it->second);
+    index.erase(it);
+}
@@ -22,7 +22,7 @@
 
 // --- Définition et initialisation des membres statiques ---
 // Ces membres statiques déclarés dans le .h doivent être définis (et initialisés si besoin) dans UN SEUL fichier .cpp
-int Transaction::counter = 0; // Initialisation du compteur d'ID unique à 0.
+long long Transaction::counter = 0; // Initialisation du compteur d'ID unique à 0.
 std::mutex Transaction::counterMutex; // Définition du mutex statique pour le compteur.
 std::mutex Transaction::persistenceMutex; // Définition du mutex statique pour les accès fichiers statiques.
 
@@ -173,28 +173,13 @@ void Transaction::logTransactionToCSV(const std::string &filename, const Transac
 
     if (current_pos == 0) { // Si la position est 0, le fichier était vide
          // Écrire l'en-tête. Assure-toi que l'en-tête correspond au format d'écriture ci-dessous.
-         logFile << "ID,Client ID,Type,Crypto,Quantite,Prix Unitaire,Montant Total,Frais,Timestamp (Epoch),Timestamp (String),Statut,Description,Raison Echec\n";
+         logFile << csvHeader();
          LOG("Transaction Fichier de log transaction CSV créé avec en-tête: " + filename, "INFO");
     }
      // Si le fichier n'était pas vide, tellp() est à la fin, on peut écrire directement.
 
 
-    // Format CSV : ID,Client ID,Type,Crypto,Quantité,Prix Unitaire,Montant Total,Frais,Timestamp (Epoch),Timestamp (String),Statut,Description,Raison Echec
-    // Utilise get...() pour accéder aux données de la transaction (passée par référence const).
-    logFile << tx_to_log.getId() << ","
-            << tx_to_log.getClientId() << ","
-            << transactionTypeToString(tx_to_log.getType()) << "," // Helper
-            << tx_to_log.getCryptoName() << ","
-            << std::fixed << std::setprecision(10) << tx_to_log.getQuantity() << ","
-            << std::fixed << std::setprecision(10) << tx_to_log.getUnitPrice() << ","
-            << std::fixed << std::setprecision(10) << tx_to_log.getTotalAmount() << ","
-            << std::fixed << std::setprecision(10) << tx_to_log.getFee() << ","
-            << tx_to_log.getTimestamp_t() << "," // Timestamp Epoch.
-            << tx_to_log.getTimestampString() << "," // Timestamp formaté (getter helper).
-            << transactionStatusToString(tx_to_log.getStatus()) << "," // Statut en string (Helper).
-            << "\"" << tx_to_log.getDescription() << "\"," // Description, potentiellement avec espaces/virgules, entre guillemets.
-            << "\"" << tx_to_log.getFailureReason() << "\"" // Raison d'échec, entre guillemets.
-            << "\n"; // Nouvelle ligne.
+    logFile << tx_to_log.toCSVLine();
 
     // Pas besoin de log de succès ici, ça serait trop verbeux.
 
@@ -206,13 +191,38 @@ void Transaction::logTransactionToCSV(const std::string &filename, const Transac
     }
 }
 
+// En-tête du format CSV des transactions.
+const char* Transaction::csvHeader() {
+    return "ID,Client ID,Type,Crypto,Quantite,Prix Unitaire,Montant Total,Frais,Timestamp (Epoch),Timestamp (String),Statut,Description,Raison Echec\n";
+}
+
+// Ligne CSV de la transaction (terminée par '\n'), dans l'ordre des colonnes de csvHeader().
+std::string Transaction::toCSVLine() const {
+    std::stringstream line;
+    line << getId() << ","
+         << getClientId() << ","
+         << transactionTypeToString(getType()) << "," // Helper
+         << getCryptoName() << ","
+         << std::fixed << std::setprecision(10) << getQuantity() << ","
+         << std::fixed << std::setprecision(10) << getUnitPrice() << ","
+         << std::fixed << std::setprecision(10) << getTotalAmount() << ","
+         << std::fixed << std::setprecision(10) << getFee() << ","
+         << getTimestamp_t() << "," // Timestamp Epoch.
+         << getTimestampString() << "," // Timestamp formaté (getter helper).
+         << transactionStatusToString(getStatus()) << "," // Statut en string (Helper).
+         << "\"" << getDescription() << "\"," // Description, potentiellement avec espaces/virgules, entre guillemets.
+         << "\"" << getFailureReason() << "\"" // Raison d'échec, entre guillemets.
+         << "\n";
+    return line.str();
+}
+
 // Charge la dernière valeur du compteur de transactions depuis un fichier (lors de l'initialisation). Thread-safe.
 // Protégé par persistenceMutex (accès fichier) et counterMutex (mise à jour compteur statique).
 void Transaction::loadCounter(const std::string& filename) {
     std::lock_guard<std::mutex> lock_file(persistenceMutex); // Protège l'accès au fichier du compteur.
 
     std::ifstream counterFile(filename);
-    int loadedCounter = 0; // Valeur par défaut si fichier non trouvé ou vide.
+    long long loadedCounter = 0; // Valeur par défaut si fichier non trouvé ou vide.
 
     if (counterFile.is_open()) {
         counterFile >> loadedCounter; // Tente de lire la valeur.
@@ -240,10 +250,22 @@ void Transaction::loadCounter(const std::string& filename) {
     } // counterMutex libéré.
 }
 
+long long Transaction::getCounter() {
+    std::lock_guard<std::mutex> lock(counterMutex);
+    return counter;
+}
+
+void Transaction::advanceCounter(long long floor) {
+    std::lock_guard<std::mutex> lock(counterMutex);
+    if (counter < floor) {
+        counter = floor;
+    }
+}
+
 // Sauvegarde la valeur actuelle du compteur de transactions dans un fichier. Thread-safe.
 // Protégé par persistenceMutex (accès fichier) et counterMutex (accès compteur).
 void Transaction::saveCounter(const std::string& filename) {
-    int currentCounterValue;
+    long long currentCounterValue;
     { // Bloc pour limiter la portée de counterMutex.
          std::lock_guard<std::mutex> lock_counter(counterMutex);
          currentCounterValue = counter; // Lire le compteur sous sa protection.
@@ -4,6 +4,7 @@
 #include "../headers/Logger.h" 
 #include "../headers/Global.h" 
 #include "../headers/Transaction.h"
+#include "../headers/LowLatency.h"
 
 
 // Includes pour les fonctionnalités standards :
@@ -26,6 +27,9 @@
 #include <sstream>
 #include <iomanip>
 #include <cctype>
+#include <functional>
+#include <algorithm>
+#include <optional>
 
 
 // --- Implémentation de requestTypeToString ---
@@ -34,19 +38,34 @@ std::string requestTypeToString(RequestType type) {
     switch (type) {
         case RequestType::BUY: return "BUY";
         case RequestType::SELL: return "SELL";
+        case RequestType::CANCEL: return "CANCEL";
         case RequestType::UNKNOWN_REQUEST: return "UNKNOWN_REQUEST";
         default: return "UNKNOWN_REQUEST"; // Devrait pas arriver avec les types définis
     }
 }
 
+std::string orderTypeToString(OrderType type) {
+    switch (type) {
+        case OrderType::MARKET: return "MARKET";
+        case OrderType::LIMIT: return "LIMIT";
+        case OrderType::IOC: return "IOC";
+        case OrderType::FOK: return "FOK";
+        default: return "MARKET";
+    }
+}
+
 
 // --- Initialisation des membres NON statiques ---
 // Ils sont initialisés dans le constructeur.
 
 
 // --- Constructeur de TransactionQueue ---
-// Initialise le flag running à false.
+// Initialise le flag running à false et crée le carnet d'ordres du seul symbole échangé.
 TransactionQueue::TransactionQueue() : running(false) {
+    MatchingEngine::BookConfig srdBtc;
+    srdBtc.symbol = "SRD-BTC";
+    matchingEngine.addBook(srdBtc);
+    owners.emplace_back(); // Propriétaire 0 : ordres qui ne restent jamais au repos (MARKET)
 }
 
 // --- Destructeur de TransactionQueue ---
@@ -70,86 +89,185 @@ void TransactionQueue::registerSession(const std::shared_ptr<ClientSession>& ses
 // --- Désenregistre une ClientSession ---
 // Supprime l'entrée de sessionMap. Thread-safe.
 void TransactionQueue::unregisterSession(const std::string& clientId) {
-    std::lock_guard<std::mutex> lock(sessionMapMtx);
-    auto it = sessionMap.find(clientId);
-    if (it != sessionMap.end()) {
-        sessionMap.erase(it);
-        LOG("TransactionQueue::unregisterSession Session désenregistrée pour client ID: " + clientId, "INFO");
-    } else {
-        LOG("TransactionQueue::unregisterSession Session pour client ID: " + clientId + " non trouvée dans sessionMap lors du désenregistrement.", "WARNING");
+    {
+        std::lock_guard<std::mutex> lock(sessionMapMtx);
+        auto it = sessionMap.find(clientId);
+        if (it != sessionMap.end()) {
+            sessionMap.erase(it);
+            LOG("TransactionQueue::unregisterSession Session désenregistrée pour client ID: " + clientId, "INFO");
+        } else {
+            LOG("TransactionQueue::unregisterSession Session pour client ID: " + clientId + " non trouvée dans sessionMap lors du désenregistrement.", "WARNING");
+        }
     }
+    // Annulation à la déconnexion : aucun ordre ne reste exécutable pour un client absent. Après le retrait
+    // de sessionMap : un ordre posé pendant ce temps est annulé par son shard (voir processLimitOrder).
+    cancelAllOrders(clientId);
 }
 
 // --- Implémentation de start ---
-// Démarre le thread de traitement de la file. Appelée par le Server au démarrage.
+// Crée les shards et démarre leurs threads de traitement. Appelée par le Server au démarrage.
 void TransactionQueue::start() {
-    // Vérifie si le thread n'est pas déjà en cours et s'il n'est pas joignable.
-    if (!running.load(std::memory_order_acquire) && !worker.joinable()) {
-        running.store(true, std::memory_order_release); // Indique que la file doit tourner
-        worker = std::thread(&TransactionQueue::process, this); // Lance le thread worker sur la méthode process
-        LOG("TransactionQueue::start Thread de traitement démarré.", "INFO");
-    } else {
-        LOG("TransactionQueue::start Thread de traitement déjà en cours ou non démarrable.", "WARNING");
+    // Vérifie si les threads ne sont pas déjà en cours.
+    if (running.load(std::memory_order_acquire)) {
+        LOG("TransactionQueue::start Threads de traitement déjà en cours.", "WARNING");
+        return;
     }
+
+    shards.clear(); // Shards d'un cycle start()/stop() précédent (threads déjà joints)
+    for (size_t i = 0; i < shardCount; ++i) {
+        shards.push_back(std::make_unique<Shard>());
+        shards.back()->index = i;
+    }
+    commitStage.start(); // Avant les shards : il reçoit leurs résultats
+    matchingEngine.start(); // Avant les shards : ils y envoient leurs ordres
+    running.store(true, std::memory_order_release); // Indique que la file doit tourner
+    for (auto& shard : shards) {
+        shard->worker = std::thread(&TransactionQueue::process, this, std::ref(*shard)); // Un thread par shard
+    }
+    LOG("TransactionQueue::start " + std::to_string(shards.size()) + " threads de traitement démarrés (un par shard).", "INFO");
 }
 
-// --- Demande l'arrêt du thread et attend sa fin ---
-// Appelée par le Server ou le destructeur. Thread-safe.
+// --- Demande l'arrêt des threads et attend leur fin ---
+// Appelée par le Server ou le destructeur. Chaque shard termine d'abord les requêtes de sa file.
 void TransactionQueue::stop() {
-    if (running.load(std::memory_order_acquire) || worker.joinable()) {
-        { // Section critique pour running flag
-            std::lock_guard<std::mutex> lock(mtx);
-            running.store(false, std::memory_order_release);
-        } // Le verrou est libéré
-
-        cv.notify_all(); // Réveille le worker
+    bool joinable = std::any_of(shards.begin(), shards.end(), [](const std::unique_ptr<Shard>& s) { return s->worker.joinable(); });
+    if (!running.load(std::memory_order_acquire) && !joinable) {
+        LOG("TransactionQueue::stop Threads de traitement déjà arrêtés ou non démarrés.", "WARNING");
+        return;
+    }
 
-        if (worker.joinable()) {
-            worker.join();
-             LOG("TransactionQueue::stop Thread de traitement joint.", "INFO");
-        } else {
-             LOG("TransactionQueue::stop Thread de traitement non joignable.", "WARNING");
+    running.store(false, std::memory_order_release);
+    for (auto& shard : shards) {
+        { // Sous le verrou du shard : un worker entre son test et son attente ne manque pas la notification
+            std::lock_guard<std::mutex> lock(shard->mtx);
         }
-    } else {
-        LOG("TransactionQueue::stop Thread de traitement déjà arrêté ou non démarré.", "WARNING");
+        shard->cv.notify_all(); // Réveille le worker
     }
+    for (auto& shard : shards) {
+        if (shard->worker.joinable()) {
+            shard->worker.join();
+        }
+    }
+    LOG("TransactionQueue::stop " + std::to_string(shards.size()) + " threads de traitement joints.", "INFO");
+    matchingEngine.stop();
+    commitStage.stop(); // Écrit et acquitte les dernières requêtes traitées
 }
 
-// --- Fonction principale du thread worker ---
-// Tourne en boucle, attendant et traitant les requêtes.
-void TransactionQueue::process() {
-    LOG("TransactionQueue::process Thread de traitement en cours...", "INFO");
+// --- Group commit ---
+void TransactionQueue::setGroupCommit(const GroupCommitConfig& config, const std::string& journalPath) {
+    commitStage.configure(config, journalPath);
+}
 
-    while (true) {
-        std::unique_lock<std::mutex> lock(mtx);
+// --- Nombre de shards ---
+void TransactionQueue::setShardCount(size_t count) {
+    if (count == 0) {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    shardCount = std::min(count, MAX_SHARDS);
+}
+
+size_t TransactionQueue::getShardCount() const {
+    return shardCount;
+}
 
-        cv.wait(lock, [&] {
-            return !queue.empty() || !running.load(std::memory_order_acquire);
-        });
+// --- Shard d'un client ---
+// Le même clientId mène toujours au même shard tant que la file tourne : ses ordres restent dans l'ordre.
+TransactionQueue::Shard& TransactionQueue::shardFor(const std::string& clientId) {
+    return *shards[std::hash<std::string>{}(clientId) % shards.size()];
+}
+
+// --- Profil faible latence ---
+void TransactionQueue::setLatencyProfile(int cpu, std::chrono::microseconds spin) {
+    workerCpu = cpu;
+    spinWait = spin;
+}
 
-        // Condition de sortie : arrêt demandé ET queue vide.
-        if (!running.load(std::memory_order_acquire) && queue.empty()) {
-            LOG("TransactionQueue::process Conditions d'arrêt atteintes. Sortie de la boucle de traitement.", "INFO");
-            break;
+// --- Fonction principale d'un thread worker ---
+// Tourne en boucle, attendant et traitant les requêtes de son shard.
+void TransactionQueue::process(Shard& shard) {
+    LOG("TransactionQueue::process Thread de traitement du shard " + std::to_string(shard.index) + " en cours...", "INFO");
+    LowLatency::pinCurrentThread(workerCpu < 0 ? -1 : workerCpu + static_cast<int>(shard.index), "TransactionQueue shard " + std::to_string(shard.index));
+
+    while (true) {
+        std::optional<TransactionRequest> req = shard.ring.tryPop();
+
+        if (!req) {
+            // Brève attente active (sans verrou), prolongée par le profil faible latence, avant de dormir. La
+            // requête suivante d'une rafale est prise sans réveil (ni appel système côté producteur, ni délai
+            // d'ordonnancement).
+            auto spin_until = std::chrono::steady_clock::now() + spinWait;
+            int polls = 0;
+            while (shard.ring.empty() && running.load(std::memory_order_acquire)
+                   && (++polls < SPIN_POLLS || std::chrono::steady_clock::now() < spin_until)) {
+                LowLatency::cpuRelax();
+            }
+
+            if (shard.ring.empty()) {
+                // Condition de sortie : arrêt demandé ET anneau vide.
+                if (!running.load(std::memory_order_acquire)) {
+                    LOG("TransactionQueue::process Shard " + std::to_string(shard.index) + " : conditions d'arrêt atteintes. Sortie de la boucle de traitement.", "INFO");
+                    break;
+                }
+                // Dormir : lever le drapeau de l'anneau puis attendre qu'un producteur le voie (ou l'arrêt).
+                if (shard.ring.prepareToSleep()) {
+                    std::unique_lock<std::mutex> lock(shard.mtx);
+                    shard.cv.wait(lock, [&] {
+                        return !shard.ring.empty() || !running.load(std::memory_order_acquire);
+                    });
+                    shard.ring.wokeUp();
+                }
+            }
+            continue;
         }
 
-        // Traitement si queue non vide.
-        if (!queue.empty()) {
-            TransactionRequest req = queue.front();
-            queue.pop();
+        LOG("TransactionQueue::process Traitement requête pour client ID: " + req->clientId + ", Type: " + requestTypeToString(req->type) + ", Quantité: " + std::to_string(req->quantity), "INFO");
 
-            lock.unlock(); // Libère le verrou pendant le traitement (potentiellement long)
+        // Appelle la méthode interne pour traiter cette requête.
+        processRequest(*req);
+    }
 
-            LOG("TransactionQueue::process Traitement requête pour client ID: " + req.clientId + ", Type: " + requestTypeToString(req.type) + ", Quantité: " + std::to_string(req.quantity), "INFO");
+    LOG("TransactionQueue::process Thread de traitement du shard " + std::to_string(shard.index) + " terminé.", "INFO");
+}
 
-            // Appelle la méthode interne pour traiter cette requête.
-            processRequest(req); // req est passé par référence et modifié ici.
 
-            // Fin Traitement
-        }
+// --- Exécution d'un ordre au marché contre le carnet ---
+// Appelée sous le verrou du Wallet du client, ordre validé. La quantité est appariée par le thread
+// d'appariement contre les ordres au repos à des prix au moins aussi bons que le prix de référence (limite
+// de protection arrondie en faveur du client) ; le reste est exécuté par le simulateur au prix de référence,
+// comme avant le carnet (contrepartie de dernier recours). Retourne le prix moyen d'exécution.
+double TransactionQueue::executeMarketOrder(const TransactionRequest& request, double referencePrice, std::vector<Fill>& fills) {
+    int bookIndex = matchingEngine.findBook(request.cryptoName);
+    if (bookIndex < 0) {
+        return referencePrice;
+    }
+    const OrderBook& book = matchingEngine.getBook(static_cast<uint32_t>(bookIndex));
+
+    EngineCommand command;
+    command.type = EngineCommand::Type::MARKET;
+    command.side = request.type == RequestType::BUY ? OrderSide::BUY : OrderSide::SELL;
+    command.book = static_cast<uint32_t>(bookIndex);
+    command.owner = findOwner(request.clientId); // Pas d'exécution contre ses propres ordres au repos
+    command.quantity = book.toLots(request.quantity);
+    double ticks = referencePrice / book.getTickSize();
+    command.priceTick = static_cast<int64_t>(command.side == OrderSide::BUY ? std::floor(ticks) : std::ceil(ticks));
+    if (command.quantity <= 0) {
+        return referencePrice;
     }
 
-    LOG("TransactionQueue::process Thread de traitement terminé.", "INFO");
+    ExecutionReport report = matchingEngine.execute(command);
+    if (report.filledLots <= 0) {
+        return referencePrice;
+    }
+    double notional = 0.0;
+    for (const Fill& fill : report.fills) {
+        notional += book.toPrice(fill.priceTick) * book.toQuantity(fill.quantity);
+    }
+    fills = std::move(report.fills); // Réglées côté teneurs par settleMakers, après le verrou du Wallet
+    double bookQuantity = std::min(book.toQuantity(report.filledLots), request.quantity);
+    double houseQuantity = request.quantity - bookQuantity;
+    LOG("TransactionQueue::executeMarketOrder INFO : Client " + request.clientId + " : " + std::to_string(bookQuantity) + " " + request.cryptoName
+        + " exécutés contre le carnet (" + std::to_string(fills.size()) + " ordres), " + std::to_string(houseQuantity) + " au prix de référence.", "INFO");
+    return (notional + houseQuantity * referencePrice) / request.quantity;
 }
 
 
@@ -158,6 +276,16 @@ void TransactionQueue::process() {
 // met à jour le Wallet, ajoute à l'historique, crée la Transaction finale,
 // et notifie la ClientSession.
 void TransactionQueue::processRequest(const TransactionRequest& request) {
+    // Ordres à cours limité et annulations : traitement propre (réservation des fonds, ordre au repos).
+    if (request.type == RequestType::CANCEL) {
+        processCancel(request);
+        return;
+    }
+    if (request.orderType != OrderType::MARKET) {
+        processLimitOrder(request);
+        return;
+    }
+
     // Log d'entrée de la fonction (utile pour voir que la TQ prend la requête)
     LOG("TransactionQueue::processRequest INFO : Début traitement requête ID client: " + request.clientId + ", Type: " + requestTypeToString(request.type) + ", Quantité: " + std::to_string(request.quantity), "INFO");
 
@@ -184,6 +312,7 @@ void TransactionQueue::processRequest(const TransactionRequest& request) {
     // --- Préliminaires (accès session/wallet) ---
     std::shared_ptr<ClientSession> session = nullptr;
     std::shared_ptr<Wallet> wallet = nullptr;
+    std::vector<Fill> bookFills; // Exécutions contre des ordres au repos (réglées après le verrou du Wallet)
 
     { // Verrou pour accéder à sessionMap
         std::lock_guard<std::mutex> sessionLock(sessionMapMtx);
@@ -231,7 +360,7 @@ void TransactionQueue::processRequest(const TransactionRequest& request) {
 
                 if (request.type == RequestType::BUY) {
                     double usd_cost = quantity_to_trade_crypto * unitPrice;
-                    fee = usd_cost * 0.0001; // Frais sur le montant USD
+                    fee = usd_cost * FEE_RATE; // Frais sur le montant USD
                     totalAmount = usd_cost + fee; // Coût total en USD (montant échangé + frais)
                     amount_to_use_from_balance = totalAmount; // On utilise ce totalAmount du solde USD
 
@@ -248,7 +377,7 @@ void TransactionQueue::processRequest(const TransactionRequest& request) {
                 } else if (request.type == RequestType::SELL) {
                     amount_to_use_from_balance = quantity_to_trade_crypto;
                     totalAmount = quantity_to_trade_crypto * unitPrice;
-                    fee = totalAmount * 0.0001;
+                    fee = totalAmount * FEE_RATE;
                     totalAmount -= fee;
 
                     if (wallet->getBalance(Currency::SRD_BTC) >= amount_to_use_from_balance) { // APPEL POTENTIELLEMENT CRITIQUE wallet->getBalance !
@@ -266,8 +395,24 @@ void TransactionQueue::processRequest(const TransactionRequest& request) {
                 }
 
 
-                // --- Si la transaction est COMPLETED, mettre à jour les soldes ---
+                // --- Si la transaction est COMPLETED, apparier contre le carnet puis mettre à jour les soldes ---
                 if (status == TransactionStatus::COMPLETED) {
+                    // Prix moyen jamais moins bon que le prix de référence : coût et produit restent dans les
+                    // bornes des fonds vérifiés ci-dessus.
+                    double executionPrice = executeMarketOrder(request, unitPrice, bookFills);
+                    if (executionPrice != unitPrice) {
+                        unitPrice = executionPrice;
+                        if (request.type == RequestType::BUY) {
+                            double usd_cost = request.quantity * unitPrice;
+                            fee = usd_cost * FEE_RATE;
+                            totalAmount = usd_cost + fee;
+                        } else {
+                            totalAmount = request.quantity * unitPrice;
+                            fee = totalAmount * FEE_RATE;
+                            totalAmount -= fee;
+                        }
+                    }
+
                     if (request.type == RequestType::BUY) {
                         wallet->updateBalance(Currency::USD, -totalAmount); // APPEL POTENTIELLEMENT CRITIQUE wallet->updateBalance !
                         wallet->updateBalance(Currency::SRD_BTC, request.quantity); // APPEL POTENTIELLEMENT CRITIQUE
@@ -276,8 +421,7 @@ void TransactionQueue::processRequest(const TransactionRequest& request) {
                          wallet->updateBalance(Currency::USD, totalAmount); // APPEL POTENTIELLEMENT CRITIQUE
                     }
 
-                    wallet->saveToFile(); // APPEL POTENTIELLEMENT CRITIQUE wallet->saveToFile !
-                    LOG("TransactionQueue::processRequest INFO : Client " + request.clientId + ": Wallet sauvegardé après Tx COMPLETED.", "INFO");
+                    // La sauvegarde du Wallet est faite par le group commit (une fois par lot), voir plus bas.
 
                 } // Fin if (status == TransactionStatus::COMPLETED)
 
@@ -319,6 +463,13 @@ void TransactionQueue::processRequest(const TransactionRequest& request) {
 
         } // Le lock_guard walletLock libère le mutex du Wallet ici !
 
+        // Côté teneurs : fonds réservés dépensés, contrepartie créditée. Hors du verrou de ce Wallet (un shard
+        // ne tient jamais deux verrous de Wallet).
+        if (!bookFills.empty()) {
+            settleMakers(bookFills, request.type == RequestType::BUY ? OrderSide::SELL : OrderSide::BUY,
+                         static_cast<uint32_t>(matchingEngine.findBook(request.cryptoName)), request.cryptoName);
+        }
+
     } // Fin du grand 'else' (Session et Wallet disponibles)
 
 
@@ -364,54 +515,507 @@ void TransactionQueue::processRequest(const TransactionRequest& request) {
     // À ce point, final_transaction_ptr est GARANTI non-null (soit créé sous verrou, soit créé ici en FAILED).
 
 
-    // --- Logguer la transaction finale globalement ---
-    // On utilise ici l'objet via le shared_ptr.
-    // Transaction::logTransactionToCSV doit être thread-safe.
-    // TODO: Définir le chemin du fichier CSV global (assurez-vous que ../src/data existe).
-    Transaction::logTransactionToCSV("../src/data/global_transactions.csv", *final_transaction_ptr); // Déréférencer le shared_ptr.
-     LOG("TransactionQueue::processRequest INFO : Transaction ID: " + final_transaction_ptr->getId() + " logguée globalement pour client " + final_transaction_ptr->getClientId() + " avec statut: " + transactionStatusToString(final_transaction_ptr->getStatus()), "INFO");
+    // --- Écriture durable puis notification (group commit) ---
+    // La ligne du journal global et la sauvegarde du Wallet (si la transaction l'a modifié) sont confiées au
+    // group commit, qui les écrit par lots ; la ClientSession n'est notifiée qu'une fois le lot sur disque.
+    CommitEntry entry;
+    entry.clientId = request.clientId;
+    entry.transaction = final_transaction_ptr;
+    if (status == TransactionStatus::COMPLETED) {
+        entry.wallet = wallet;
+    }
+    entry.acknowledge = [session, reportSink = request.reportSink, correlationId = request.correlationId, transaction = final_transaction_ptr]() {
+        notifyResult(session, reportSink, correlationId, *transaction);
+    };
+    commitStage.submit(std::move(entry));
 
 
-    // --- Notifier la ClientSession correspondante ---
-    // Utilisez le sessionPtr obtenu plus tôt.
-    if (session) { // session est le shared_ptr obtenu de la map plus tôt (il pourrait être null ici si le cas initial était !session)
+    // Log de fin de la fonction
+    LOG("TransactionQueue::processRequest INFO : --- Fin traitement requête ID: " + transactionId + " pour client " + request.clientId + " avec statut final: " + transactionStatusToString(final_transaction_ptr->getStatus()) + " ---", "INFO");
+
+    // La variable shared_ptr<Transaction> final_transaction_ptr sort de portée ici et libère l'objet Transaction si c'était le dernier shared_ptr.
+
+} // Fin du corps de la fonction processRequest
+
+
+// --- Notifier la ClientSession correspondante ---
+// Appelée par le group commit une fois la transaction durable.
+void TransactionQueue::notifyResult(const std::shared_ptr<ClientSession>& session, const std::shared_ptr<TransactionReportSink>& reportSink,
+                                    uint64_t correlationId, const Transaction& transaction) {
+    // Ordre soumis hors de la connexion de la session (mémoire partagée) : le résultat repart par le même canal,
+    // même si la session a disparu entre-temps.
+    if (reportSink) {
+        reportSink->onTransactionResult(transaction, correlationId);
+    } else if (session) { // session est le shared_ptr obtenu de la map (null si la session n'existait plus)
         try {
-            // Si session est non-null, on appelle applyTransactionRequest.
-            // Si session était null au début, ce bloc n'est pas exécuté, ce qui est correct.
-            session->applyTransactionRequest(*final_transaction_ptr); // Appel de notification (déréférencement)
+            session->applyTransactionRequest(transaction, correlationId); // Appel de notification
 
         } catch (const std::exception& e) {
-            LOG("TransactionQueue::processRequest ERROR : Exception lors de l'appel à applyTransactionRequest pour client ID: " + request.clientId + ", Transaction ID: " + final_transaction_ptr->getId() + ". Erreur: " + std::string(e.what()), "ERROR");
+            LOG("TransactionQueue::notifyResult ERROR : Exception lors de l'appel à applyTransactionRequest pour client ID: " + transaction.getClientId() + ", Transaction ID: " + transaction.getId() + ". Erreur: " + std::string(e.what()), "ERROR");
         } catch (...) {
-             LOG("TransactionQueue::processRequest ERROR : Exception inconnue lors de l'appel à applyTransactionRequest pour client ID: " + request.clientId + ", Transaction ID: " + final_transaction_ptr->getId() + ".", "ERROR");
+             LOG("TransactionQueue::notifyResult ERROR : Exception inconnue lors de l'appel à applyTransactionRequest pour client ID: " + transaction.getClientId() + ", Transaction ID: " + transaction.getId() + ".", "ERROR");
         }
     } else {
-         // Ce log s'affiche si session était null au début.
-         LOG("TransactionQueue::processRequest WARNING : ClientSession introuvable ou invalide pour client ID: " + request.clientId + " lors de la notification. Transaction ID: " + final_transaction_ptr->getId() + ". Le résultat ne sera pas appliqué à la session.", "WARNING");
+         LOG("TransactionQueue::notifyResult WARNING : ClientSession introuvable ou invalide pour client ID: " + transaction.getClientId() + " lors de la notification. Transaction ID: " + transaction.getId() + ". Le résultat ne sera pas appliqué à la session.", "WARNING");
     }
+}
 
 
-    // Log de fin de la fonction
-    LOG("TransactionQueue::processRequest INFO : --- Fin traitement requête ID: " + transactionId + " pour client " + request.clientId + " avec statut final: " + transactionStatusToString(final_transaction_ptr->getStatus()) + " ---", "INFO");
+// --- Implémentation de addRequest ---
+void TransactionQueue::addRequest(TransactionRequest request) {
+    if (!running.load(std::memory_order_acquire)) {
+        LOG("TransactionQueue::addRequest Erreur : Tentative d'ajouter une requête alors que la file n'est pas en cours d'exécution pour client ID: " + request.clientId + ", Type: " + requestTypeToString(request.type), "ERROR");
+        return;
+    }
 
-    // La variable shared_ptr<Transaction> final_transaction_ptr sort de portée ici et libère l'objet Transaction si c'était le dernier shared_ptr.
+    Shard& shard = shardFor(request.clientId);
+    // Déplacement dans une case de l'anneau, sans verrou. Anneau plein (le worker a SHARD_CAPACITY requêtes
+    // de retard) : céder le coeur jusqu'à ce qu'une case se libère.
+    while (!shard.ring.tryPush(std::move(request))) {
+        if (!running.load(std::memory_order_acquire)) {
+            LOG("TransactionQueue::addRequest Erreur : File arrêtée pendant l'attente d'une place pour client ID: " + request.clientId + ". Requête abandonnée.", "ERROR");
+            return;
+        }
+        std::this_thread::yield();
+    }
 
-} // Fin du corps de la fonction processRequest
+    // Worker occupé ou en attente active : inutile de le notifier.
+    if (shard.ring.consumerNeedsWakeup()) {
+        { // Sous le verrou : le worker est soit avant son test (et verra la requête), soit endormi
+            std::lock_guard<std::mutex> lock(shard.mtx);
+        }
+        shard.cv.notify_one();
+    }
+}
 
+// ============================================================================================
+// --- Ordres à cours limité (LIMIT / IOC / FOK) et annulations ---
+// Un ordre réserve dans le Wallet le montant qu'il peut coûter au prix limite (USD + frais pour un achat,
+// SRD-BTC pour une vente) avant d'entrer dans le carnet. Chaque exécution dépense la réservation (et rend
+// l'écart de prix à un preneur mieux servi que sa limite) ; annulation et reste non posé la rendent.
+// Le résultat part, après le group commit, dans une ligne ORDER_STATUS (précédée d'un TRANSACTION_RESULT
+// si une partie a été exécutée) ; le teneur d'un ordre exécuté plus tard reçoit ORDER_FILL.
+// ============================================================================================
+
+// --- Session d'un client (nullptr si déconnecté) ---
+std::shared_ptr<ClientSession> TransactionQueue::findSession(const std::string& clientId) {
+    std::lock_guard<std::mutex> lock(sessionMapMtx);
+    auto it = sessionMap.find(clientId);
+    return it != sessionMap.end() ? it->second.lock() : nullptr;
+}
 
-// --- Implémentation de addRequest ---
-void TransactionQueue::addRequest(const TransactionRequest& request) { // Signature modifiée
-    if (!running.load(std::memory_order_acquire)) {
-        LOG("TransactionQueue::addRequest Erreur : Tentative d'ajouter une requête alors que la file n'est pas en cours d'exécution pour client ID: " + request.clientId + ", Type: " + requestTypeToString(request.type), "ERROR");
+// --- Propriétaire d'ordres d'un client, sans l'enregistrer (0 si le client n'a jamais posé d'ordre) ---
+uint32_t TransactionQueue::findOwner(const std::string& clientId) {
+    std::lock_guard<std::mutex> lock(ownersMtx);
+    auto it = ownerIndex.find(clientId);
+    return it != ownerIndex.end() ? it->second : 0;
+}
+
+// --- Propriétaire d'ordres (indice dans le carnet) d'un client ---
+uint32_t TransactionQueue::ownerFor(const std::string& clientId, const std::shared_ptr<Wallet>& wallet) {
+    std::lock_guard<std::mutex> lock(ownersMtx);
+    auto it = ownerIndex.find(clientId);
+    if (it == ownerIndex.end()) {
+        it = ownerIndex.emplace(clientId, static_cast<uint32_t>(owners.size())).first;
+        owners.emplace_back();
+        owners.back().clientId = clientId;
+    }
+    OrderOwner& owner = owners[it->second];
+    // Nouvelle session (reconnexion) : son Wallet remplace l'ancien, qui n'a plus d'ordre au repos.
+    if (!owner.wallet || owner.restingOrders.empty()) {
+        owner.wallet = wallet;
+    }
+    return it->second;
+}
+
+std::pair<Currency, double> TransactionQueue::reservationFor(const OrderBook& book, OrderSide side, int64_t lots, int64_t tick) {
+    double quantity = book.toQuantity(lots);
+    if (side == OrderSide::BUY) {
+        return {Currency::USD, quantity * book.toPrice(tick) * (1.0 + FEE_RATE)};
+    }
+    return {Currency::SRD_BTC, quantity};
+}
+
+// --- Notification d'un ordre (ORDER_STATUS / ORDER_FILL) ---
+void TransactionQueue::notifyOrderStatus(const std::shared_ptr<ClientSession>& session, uint64_t correlationId, const std::string& status) {
+    if (!session) {
+        return; // Client déconnecté : l'exécution est dans son historique.
+    }
+    try {
+        session->applyOrderStatus(status, correlationId);
+    } catch (const std::exception& e) {
+        LOG("TransactionQueue::notifyOrderStatus ERROR : Exception lors de la notification de client ID: " + session->getClientId() + ". Erreur: " + std::string(e.what()), "ERROR");
+    } catch (...) {
+        LOG("TransactionQueue::notifyOrderStatus ERROR : Exception inconnue lors de la notification de client ID: " + session->getClientId() + ".", "ERROR");
+    }
+}
+
+// --- LIMIT / IOC / FOK ---
+void TransactionQueue::processLimitOrder(const TransactionRequest& request) {
+    std::shared_ptr<ClientSession> session = findSession(request.clientId);
+    std::shared_ptr<Wallet> wallet = session ? session->getClientWallet() : nullptr;
+    OrderSide side = request.type == RequestType::BUY ? OrderSide::BUY : OrderSide::SELL;
+    int bookIndex = matchingEngine.findBook(request.cryptoName);
+
+    std::ostringstream status;
+    status << std::fixed << std::setprecision(8);
+    double price = request.limitPrice; // Ramené au tick du carnet une fois celui-ci connu
+    auto header = [&](uint64_t orderId) {
+        status << "ORDER_STATUS ORDER=" << orderId << " TYPE=" << orderTypeToString(request.orderType) << " SIDE=" << requestTypeToString(request.type)
+               << " SYMBOL=" << request.cryptoName << " PRICE=" << price;
+    };
+    // Refus sans effet sur le Wallet : passe quand même par le group commit, derrière les résultats précédents du client.
+    auto reject = [&](const std::string& reason) {
+        header(0);
+        status << " STATE=REJECTED FILLED=0 REMAINING=" << request.quantity << " REASON=\"" << reason << "\"";
+        LOG("TransactionQueue::processLimitOrder WARNING : Client " + request.clientId + " : ordre " + orderTypeToString(request.orderType) + " refusé (" + reason + ").", "WARNING");
+        CommitEntry entry;
+        entry.clientId = request.clientId;
+        entry.acknowledge = [session, correlationId = request.correlationId, line = status.str()] {
+            notifyOrderStatus(session, correlationId, line);
+        };
+        commitStage.submit(std::move(entry));
+    };
+
+    if (!session || !wallet) {
+        reject("Client session or wallet not available.");
+        return;
+    }
+    if (bookIndex < 0 || (request.type != RequestType::BUY && request.type != RequestType::SELL)) {
+        reject("Unsupported symbol or side.");
         return;
     }
+    const OrderBook& book = matchingEngine.getBook(static_cast<uint32_t>(bookIndex));
+    int64_t lots = book.toLots(request.quantity);
+    int64_t tick = book.toTicks(request.limitPrice);
+    price = book.toPrice(tick);
+    if (lots <= 0 || tick <= 0) {
+        reject("Quantity or price below the minimum increment.");
+        return;
+    }
+    uint32_t owner = ownerFor(request.clientId, wallet);
 
-    { // Section critique pour la file
-        std::lock_guard<std::mutex> lock(mtx);
-        queue.push(request); // 'request' est une const ref, elle est copiée dans la queue
-    } // Le verrou est libéré
+    ExecutionReport report;
+    std::shared_ptr<Transaction> transaction;
+    bool executed = false; // Passé par le moteur (sinon : réservation refusée)
+    int64_t rejectedLots = 0;
+    {
+        std::lock_guard<std::mutex> walletLock(wallet->getMutex());
+        std::pair<Currency, double> reservation = reservationFor(book, side, lots, tick);
+        if (!wallet->reserveFunds(reservation.first, reservation.second)) {
+            report.reason = side == OrderSide::BUY ? "Insufficient USD funds." : "Insufficient SRD-BTC funds.";
+        } else {
+            EngineCommand command;
+            command.type = request.orderType == OrderType::LIMIT ? EngineCommand::Type::LIMIT
+                         : request.orderType == OrderType::IOC ? EngineCommand::Type::IOC : EngineCommand::Type::FOK;
+            command.side = side;
+            command.book = static_cast<uint32_t>(bookIndex);
+            command.owner = owner;
+            command.priceTick = tick;
+            command.quantity = lots;
+            report = matchingEngine.execute(command);
+            executed = true;
+
+            // Partie exécutée : réservation dépensée au prix obtenu, l'écart avec la limite est rendu.
+            double notional = 0.0;
+            for (const Fill& fill : report.fills) {
+                notional += book.toPrice(fill.priceTick) * book.toQuantity(fill.quantity);
+            }
+            double filledQuantity = book.toQuantity(report.filledLots);
+            double fee = notional * FEE_RATE;
+            if (report.filledLots > 0) {
+                double reservedForFilled = reservationFor(book, side, report.filledLots, tick).second;
+                if (side == OrderSide::BUY) {
+                    wallet->consumeReserved(Currency::USD, notional + fee);
+                    wallet->releaseReserved(Currency::USD, std::max(0.0, reservedForFilled - (notional + fee)));
+                    wallet->updateBalance(Currency::SRD_BTC, filledQuantity);
+                } else {
+                    wallet->consumeReserved(Currency::SRD_BTC, filledQuantity);
+                    wallet->updateBalance(Currency::USD, notional - fee);
+                }
+            }
+            // Reste ni exécuté ni posé (IOC, FOK, refus du carnet) : réservation rendue.
+            rejectedLots = lots - report.filledLots - report.restingLots;
+            if (rejectedLots > 0) {
+                std::pair<Currency, double> unused = reservationFor(book, side, rejectedLots, tick);
+                wallet->releaseReserved(unused.first, unused.second);
+            }
+
+            if (report.filledLots > 0) {
+                transaction = std::make_shared<Transaction>(
+                    Transaction::generateNewIdString(), request.clientId,
+                    side == OrderSide::BUY ? TransactionType::BUY : TransactionType::SELL,
+                    request.cryptoName, filledQuantity, notional / filledQuantity,
+                    side == OrderSide::BUY ? notional + fee : notional - fee, fee,
+                    std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()),
+                    TransactionStatus::COMPLETED);
+                wallet->addTransaction(*transaction);
+            }
+
+            // Ordre posé : enregistré avant de relâcher le verrou du Wallet. Une exécution par un autre shard
+            // est réglée (settleMakers) sous ce même verrou, donc le trouve toujours, pas encore annoncé.
+            if (report.orderId != 0) {
+                std::lock_guard<std::mutex> lock(ownersMtx);
+                owners[owner].restingOrders[report.orderId].book = static_cast<uint32_t>(bookIndex);
+                owners[owner].wallet = wallet;
+            }
+        }
+    } // Verrou du Wallet libéré
+
+    // --- Statut de l'ordre ---
+    double filledQuantity = book.toQuantity(report.filledLots);
+    header(report.orderId);
+    const char* state;
+    if (!report.accepted) {
+        // FOK refusé par le moteur : liquidité insuffisante jusqu'à la limite.
+        state = executed && request.orderType == OrderType::FOK ? "KILLED" : "REJECTED";
+    } else if (report.filledLots == lots) {
+        state = "FILLED";
+    } else if (report.orderId != 0) {
+        state = "RESTING";
+    } else {
+        state = "CANCELLED";
+    }
+    status << " STATE=" << state << " FILLED=" << filledQuantity << " REMAINING=" << book.toQuantity(lots - report.filledLots);
+    if (report.reason[0] != '\0') {
+        status << " REASON=\"" << report.reason << "\"";
+    }
+    LOG("TransactionQueue::processLimitOrder INFO : Client " + request.clientId + " : " + status.str(), "INFO");
+
+    CommitEntry entry;
+    entry.clientId = request.clientId;
+    entry.transaction = transaction;
+    entry.wallet = wallet;
+    entry.acknowledge = [session, reportSink = request.reportSink, correlationId = request.correlationId, transaction, line = status.str()] {
+        if (transaction) {
+            notifyResult(session, reportSink, correlationId, *transaction);
+        }
+        notifyOrderStatus(session, correlationId, line);
+    };
+    commitStage.submit(std::move(entry));
+
+    // Statut soumis : les ORDER_FILL retenus entre-temps partent derrière lui, les suivants directement.
+    if (report.orderId != 0) {
+        std::vector<CommitEntry> heldFills;
+        {
+            std::lock_guard<std::mutex> lock(ownersMtx);
+            auto& restingOrders = owners[owner].restingOrders;
+            auto it = restingOrders.find(report.orderId);
+            if (it != restingOrders.end()) {
+                it->second.announced = true;
+                heldFills.swap(it->second.heldFills);
+                if (it->second.filled) {
+                    restingOrders.erase(it);
+                }
+            }
+        }
+        for (CommitEntry& fill : heldFills) {
+            commitStage.submit(std::move(fill));
+        }
+        // Déconnexion pendant le traitement : unregisterSession a pu passer avant l'annonce de l'ordre.
+        if (!findSession(request.clientId)) {
+            cancelAllOrders(request.clientId);
+        }
+    }
+    settleMakers(report.fills, side == OrderSide::BUY ? OrderSide::SELL : OrderSide::BUY, static_cast<uint32_t>(bookIndex), request.cryptoName);
+}
+
+// --- Règlement côté teneurs ---
+void TransactionQueue::settleMakers(const std::vector<Fill>& fills, OrderSide makerSide, uint32_t bookIndex, const std::string& symbol) {
+    if (fills.empty()) {
+        return;
+    }
+    const OrderBook& book = matchingEngine.getBook(bookIndex);
+    for (const Fill& fill : fills) {
+        std::shared_ptr<Wallet> wallet;
+        std::string clientId;
+        {
+            std::lock_guard<std::mutex> lock(ownersMtx);
+            if (fill.makerOwner == 0 || fill.makerOwner >= owners.size()) {
+                continue;
+            }
+            OrderOwner& owner = owners[fill.makerOwner];
+            wallet = owner.wallet;
+            clientId = owner.clientId;
+        }
+        if (!wallet) {
+            LOG("TransactionQueue::settleMakers ERROR : Wallet du teneur " + clientId + " indisponible pour l'ordre " + std::to_string(fill.makerOrderId) + ". Exécution non réglée.", "ERROR");
+            continue;
+        }
+
+        double quantity = book.toQuantity(fill.quantity);
+        double price = book.toPrice(fill.priceTick);
+        double notional = quantity * price;
+        double fee = notional * FEE_RATE;
+        std::shared_ptr<ClientSession> session = findSession(clientId);
+        CommitEntry entry;
+        entry.clientId = clientId;
+        bool held = false;
+        {
+            std::lock_guard<std::mutex> walletLock(wallet->getMutex());
+            if (makerSide == OrderSide::BUY) {
+                wallet->consumeReserved(Currency::USD, notional + fee);
+                wallet->updateBalance(Currency::SRD_BTC, quantity);
+            } else {
+                wallet->consumeReserved(Currency::SRD_BTC, quantity);
+                wallet->updateBalance(Currency::USD, notional - fee);
+            }
+            auto transaction = std::make_shared<Transaction>(
+                Transaction::generateNewIdString(), clientId,
+                makerSide == OrderSide::BUY ? TransactionType::BUY : TransactionType::SELL,
+                symbol, quantity, price, makerSide == OrderSide::BUY ? notional + fee : notional - fee, fee,
+                std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()),
+                TransactionStatus::COMPLETED);
+            wallet->addTransaction(*transaction);
+
+            std::ostringstream line;
+            line << std::fixed << std::setprecision(8) << "ORDER_FILL ORDER=" << fill.makerOrderId << " TX=" << transaction->getId()
+                 << " SIDE=" << (makerSide == OrderSide::BUY ? "BUY" : "SELL") << " SYMBOL=" << symbol << " PRICE=" << price
+                 << " QUANTITY=" << quantity << " REMAINING=" << book.toQuantity(fill.makerRemaining);
+            entry.transaction = transaction;
+            entry.wallet = wallet;
+            entry.acknowledge = [session, text = line.str()] {
+                notifyOrderStatus(session, 0, text);
+            };
+
+            // Ordre pas encore annoncé à son propriétaire (ORDER_STATUS en cours de soumission par son shard) :
+            // notification retenue, soumise par processLimitOrder juste après le statut.
+            std::lock_guard<std::mutex> lock(ownersMtx);
+            auto& restingOrders = owners[fill.makerOwner].restingOrders;
+            auto it = restingOrders.find(fill.makerOrderId);
+            if (it != restingOrders.end()) {
+                if (!it->second.announced) {
+                    it->second.filled = fill.makerRemaining == 0;
+                    it->second.heldFills.push_back(std::move(entry));
+                    held = true;
+                } else if (fill.makerRemaining == 0) {
+                    restingOrders.erase(it);
+                }
+            }
+        }
+        if (!held) {
+            commitStage.submit(std::move(entry)); // Jamais sous le verrou du Wallet (le group commit le prend)
+        }
+    }
+}
+
+// --- CANCEL <orderId> ---
+// L'identifiant désigne directement la case de l'ordre dans le carnet (voir OrderBook) : ni recherche ni
+// parcours, ici comme dans le moteur.
+void TransactionQueue::processCancel(const TransactionRequest& request) {
+    std::shared_ptr<ClientSession> session = findSession(request.clientId);
+    uint32_t owner = 0;
+    uint32_t bookIndex = 0;
+    std::shared_ptr<Wallet> wallet;
+    {
+        std::lock_guard<std::mutex> lock(ownersMtx);
+        auto it = ownerIndex.find(request.clientId);
+        if (it != ownerIndex.end()) {
+            auto order = owners[it->second].restingOrders.find(request.orderId);
+            // Un ordre pas encore annoncé n'est pas connu du client (et ses ORDER_FILL retenus ne doivent pas être perdus).
+            if (order != owners[it->second].restingOrders.end() && order->second.announced) {
+                owner = it->second;
+                bookIndex = order->second.book;
+                wallet = owners[it->second].wallet;
+            }
+        }
+    }
+
+    std::ostringstream status;
+    status << std::fixed << std::setprecision(8) << "ORDER_STATUS ORDER=" << request.orderId << " TYPE=CANCEL";
+    bool released = false;
+    if (owner == 0 || !wallet) {
+        status << " STATE=REJECTED REASON=\"Unknown order id.\"";
+    } else {
+        EngineCommand command;
+        command.type = EngineCommand::Type::CANCEL;
+        command.book = bookIndex;
+        command.owner = owner;
+        command.orderId = request.orderId;
+        ExecutionReport report = matchingEngine.execute(command);
+        const OrderBook& book = matchingEngine.getBook(bookIndex);
+        if (report.accepted) {
+            std::pair<Currency, double> reservation = reservationFor(book, report.cancelled.side, report.cancelled.quantity, report.cancelled.priceTick);
+            {
+                std::lock_guard<std::mutex> walletLock(wallet->getMutex());
+                wallet->releaseReserved(reservation.first, reservation.second);
+            }
+            released = true;
+            status << " STATE=CANCELLED SIDE=" << (report.cancelled.side == OrderSide::BUY ? "BUY" : "SELL") << " SYMBOL=" << book.getSymbol()
+                   << " PRICE=" << book.toPrice(report.cancelled.priceTick) << " REMAINING=" << book.toQuantity(report.cancelled.quantity);
+        } else {
+            status << " STATE=REJECTED REASON=\"Order is no longer resting.\"";
+        }
+        std::lock_guard<std::mutex> lock(ownersMtx);
+        owners[owner].restingOrders.erase(request.orderId);
+    }
+    LOG("TransactionQueue::processCancel INFO : Client " + request.clientId + " : " + status.str(), "INFO");
+
+    CommitEntry entry;
+    entry.clientId = request.clientId;
+    if (released) {
+        entry.wallet = wallet;
+    }
+    entry.acknowledge = [session, correlationId = request.correlationId, line = status.str()] {
+        notifyOrderStatus(session, correlationId, line);
+    };
+    commitStage.submit(std::move(entry));
+}
+
+// --- Annulation de tous les ordres au repos d'un client (déconnexion) ---
+void TransactionQueue::cancelAllOrders(const std::string& clientId) {
+    uint32_t owner = 0;
+    std::shared_ptr<Wallet> wallet;
+    std::vector<std::pair<uint64_t, uint32_t>> orders; // Identifiant, carnet
+    {
+        std::lock_guard<std::mutex> lock(ownersMtx);
+        auto it = ownerIndex.find(clientId);
+        if (it == ownerIndex.end()) {
+            return;
+        }
+        owner = it->second;
+        wallet = owners[owner].wallet;
+        // Ordres pas encore annoncés : laissés à processLimitOrder, qui rappelle cancelAllOrders après l'annonce.
+        for (const auto& order : owners[owner].restingOrders) {
+            if (order.second.announced) {
+                orders.emplace_back(order.first, order.second.book);
+            }
+        }
+    }
 
-    cv.notify_one();
+    size_t cancelled = 0;
+    for (const auto& order : orders) {
+        EngineCommand command;
+        command.type = EngineCommand::Type::CANCEL;
+        command.book = order.second;
+        command.owner = owner;
+        command.orderId = order.first;
+        ExecutionReport report = matchingEngine.execute(command);
+        if (report.accepted && wallet) {
+            const OrderBook& book = matchingEngine.getBook(order.second);
+            std::pair<Currency, double> reservation = reservationFor(book, report.cancelled.side, report.cancelled.quantity, report.cancelled.priceTick);
+            std::lock_guard<std::mutex> walletLock(wallet->getMutex());
+            wallet->releaseReserved(reservation.first, reservation.second);
+            cancelled++;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(ownersMtx);
+        for (const auto& order : orders) {
+            owners[owner].restingOrders.erase(order.first);
+        }
+        if (owners[owner].restingOrders.empty()) {
+            owners[owner].wallet.reset(); // Le Wallet n'est plus gardé pour des exécutions à venir
+        }
+    }
+    if (cancelled > 0) {
+        LOG("TransactionQueue::cancelAllOrders INFO : " + std::to_string(cancelled) + " ordre(s) au repos de " + clientId + " annulé(s), fonds réservés rendus.", "INFO");
+        CommitEntry entry;
+        entry.clientId = clientId;
+        entry.wallet = wallet;
+        commitStage.submit(std::move(entry));
+    }
 }
 
 
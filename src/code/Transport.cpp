@@ -0,0 +1,183 @@
+#include "../headers/Transport.h"
+#include "../headers/Logger.h"
+
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <openssl/err.h>
+
+
+// ============================================================================
+// === Transport TLS ===
+// ============================================================================
+
+TlsTransport::TlsTransport(SSL* ssl_ptr)
+    : ssl(ssl_ptr)
+{
+    // kTLS : OpenSSL a tenté de confier les clés au noyau à la fin du handshake si l'option était demandée.
+    kernelTlsSend = BIO_get_ktls_send(SSL_get_wbio(ssl_ptr)) == 1;
+    kernelTlsRecv = BIO_get_ktls_recv(SSL_get_rbio(ssl_ptr)) == 1;
+    if (SSL_get_options(ssl_ptr) & SSL_OP_ENABLE_KTLS) {
+        std::string fd = std::to_string(SSL_get_fd(ssl_ptr));
+        if (kernelTlsSend || kernelTlsRecv) {
+            LOG("TlsTransport::TlsTransport INFO : Kernel TLS actif (émission: " + std::string(kernelTlsSend ? "oui" : "non") + ", réception: " + std::string(kernelTlsRecv ? "oui" : "non") + "). Socket FD: " + fd, "INFO");
+        } else {
+            LOG("TlsTransport::TlsTransport INFO : Kernel TLS refusé par le noyau, chiffrement en espace utilisateur. Socket FD: " + fd, "INFO");
+        }
+    }
+}
+
+TransportResult TlsTransport::read(char* buffer, size_t size) {
+    ERR_clear_error();
+    int bytes = SSL_read(ssl.get(), buffer, static_cast<int>(size));
+    if (bytes > 0) {
+        return {bytes, TransportStatus::OK};
+    }
+    return failure(bytes, "SSL_read");
+}
+
+TransportResult TlsTransport::write(const char* data, size_t size) {
+    ERR_clear_error();
+    // Sans SSL_MODE_ENABLE_PARTIAL_WRITE, SSL_write n'aboutit que lorsque tout le bloc est écrit.
+    int written = SSL_write(ssl.get(), data, static_cast<int>(size));
+    if (written > 0) {
+        return {written, TransportStatus::OK};
+    }
+    return failure(written, "SSL_write");
+}
+
+TransportResult TlsTransport::sendFile(int fileFd, off_t offset, size_t size) {
+    // Le noyau lit le cache de pages, chiffre et envoie : aucune copie en espace utilisateur.
+    ERR_clear_error();
+    ossl_ssize_t sent = SSL_sendfile(ssl.get(), fileFd, offset, size, 0);
+    if (sent > 0) {
+        return {static_cast<long>(sent), TransportStatus::OK};
+    }
+    return failure(static_cast<long>(sent), "SSL_sendfile");
+}
+
+void TlsTransport::shutdown() {
+    // SSL_shutdown envoie "close_notify" (premier temps uniquement : pas d'attente de la réponse du pair).
+    if (SSL_shutdown(ssl.get()) < 0) {
+        LOG("TlsTransport::shutdown ERROR : Erreur lors du SSL_shutdown(). Socket FD: " + std::to_string(SSL_get_fd(ssl.get())), "ERROR");
+        ERR_print_errors_fp(stderr);
+    }
+}
+
+TransportResult TlsTransport::failure(long result, const char* operation) {
+    std::string fd = std::to_string(SSL_get_fd(ssl.get()));
+    int error = SSL_get_error(ssl.get(), static_cast<int>(result));
+    if (error == SSL_ERROR_WANT_READ) {
+        return {0, TransportStatus::WANT_READ};
+    }
+    if (error == SSL_ERROR_WANT_WRITE) {
+        return {0, TransportStatus::WANT_WRITE};
+    }
+    if (error == SSL_ERROR_ZERO_RETURN) {
+        LOG("TlsTransport INFO : Connexion fermée proprement par le pair (" + std::string(operation) + ", SSL_ERROR_ZERO_RETURN). Socket FD: " + fd, "INFO");
+        return {0, TransportStatus::CLOSED};
+    }
+    if (error == SSL_ERROR_SYSCALL) {
+        LOG("TlsTransport ERROR : Erreur système " + std::string(operation) + " (SSL_ERROR_SYSCALL). errno: " + std::string(strerror(errno)) + ". Socket FD: " + fd, "ERROR");
+    } else {
+        LOG("TlsTransport ERROR : Erreur SSL non gérée (" + std::string(operation) + "). Code: " + std::to_string(error) + ". Socket FD: " + fd, "ERROR");
+    }
+    ERR_print_errors_fp(stderr);
+    return {0, TransportStatus::FAILED};
+}
+
+
+// ============================================================================
+// === Transport en clair ===
+// ============================================================================
+
+PlainTransport::PlainTransport(int socket_fd)
+    : fd(socket_fd)
+{
+}
+
+TransportResult PlainTransport::read(char* buffer, size_t size) {
+    while (true) {
+        ssize_t bytes = ::recv(fd, buffer, size, 0);
+        if (bytes > 0) {
+            return {static_cast<long>(bytes), TransportStatus::OK};
+        }
+        if (bytes == 0) {
+            LOG("PlainTransport INFO : Connexion fermée par le pair. Socket FD: " + std::to_string(fd), "INFO");
+            return {0, TransportStatus::CLOSED};
+        }
+        if (errno != EINTR) {
+            return failure("recv");
+        }
+    }
+}
+
+TransportResult PlainTransport::write(const char* data, size_t size) {
+    while (true) {
+        // MSG_NOSIGNAL : un pair disparu donne EPIPE au lieu de SIGPIPE.
+        ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (written > 0) {
+            return {static_cast<long>(written), TransportStatus::OK};
+        }
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        return failure("send");
+    }
+}
+
+TransportResult PlainTransport::sendFile(int fileFd, off_t offset, size_t size) {
+    while (true) {
+        ssize_t sent = ::sendfile(fd, fileFd, &offset, size);
+        if (sent > 0) {
+            return {static_cast<long>(sent), TransportStatus::OK};
+        }
+        if (sent == 0) {
+            LOG("PlainTransport ERROR : sendfile : fin de fichier prématurée. Socket FD: " + std::to_string(fd), "ERROR");
+            return {0, TransportStatus::FAILED};
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        return failure("sendfile");
+    }
+}
+
+TransportResult PlainTransport::writeWithDescriptors(const char* data, size_t size, const std::vector<int>& fds) {
+    if (fds.empty()) {
+        return write(data, size);
+    }
+    iovec iov{const_cast<char*>(data), size};
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * fds.size()));
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+    std::memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+    while (true) {
+        ssize_t written = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (written > 0) {
+            return {static_cast<long>(written), TransportStatus::OK};
+        }
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        return failure("sendmsg");
+    }
+}
+
+TransportResult PlainTransport::failure(const char* operation) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        // recv : rien à lire ; send/sendfile : buffer d'émission plein.
+        return {0, std::string(operation) == "recv" ? TransportStatus::WANT_READ : TransportStatus::WANT_WRITE};
+    }
+    LOG("PlainTransport ERROR : Erreur système " + std::string(operation) + ". errno: " + std::string(strerror(errno)) + ". Socket FD: " + std::to_string(fd), "ERROR");
+    return {0, TransportStatus::FAILED};
+}
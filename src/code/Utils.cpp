@@ -103,7 +103,8 @@ void openssl_debug_callback(const SSL* ssl, int where, int ret) {
     else if (w == SSL_ST_ACCEPT) str = "SSL_accept";
     else str = "undefined";
 
-    if (where & SSL_CB_EXIT) {
+    // En non bloquant, SSL_accept() sort aussi (ret < 0) sur WANT_READ/WANT_WRITE : seul ret == 0 est un échec.
+    if ((where & SSL_CB_EXIT) && ret == 0) {
          LOG("OpenSSL Callback: SSL_CB_ERROR - " + std::string(SSL_state_string_long(ssl)), "ERROR");
     }
 }
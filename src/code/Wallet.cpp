@@ -16,6 +16,13 @@
 #include <mutex>       
 #include <cerrno>       
 #include <cstring>      
+#include <cstdio>       // Pour std::rename
+#include <fcntl.h>      // Pour open (mise sur disque)
+#include <unistd.h>     // Pour fsync, fdatasync
+
+std::mutex Wallet::liveMutex;
+std::unordered_map<std::string, int> Wallet::liveWallets;
+std::function<void(const std::string&)> Wallet::releaseHandler;
 
 //IMPORTANT : Le verrouillage du Wallet se fait actuellement déjà dans le ProcessRequest. 
 //Il n'y a donc pas besoin de passer par un mutex interne dans les méthodes à suivre.
@@ -93,10 +100,17 @@ Wallet::Wallet(const std::string& clientId, const std::string& dataDirPath)
       dataDirectoryPath(dataDirPath), // dataDirPath EST le chemin du répertoire wallets
       walletFilePath(generateWalletFilePath(dataDirPath))
 {
+    {
+        std::lock_guard<std::mutex> lock(liveMutex);
+        liveWallets[clientId]++;
+    }
+
     // Initialise les soldes par défaut si le fichier ne contient pas ces devises.
     // loadFromFile va écraser si elles sont présentes dans le fichier.
     balances[Currency::USD] = 0.0;
     balances[Currency::SRD_BTC] = 0.0;
+    reservedBalances[Currency::USD] = 0.0;
+    reservedBalances[Currency::SRD_BTC] = 0.0;
 
     // Tente de charger depuis le fichier.
     if (loadFromFile()) {
@@ -114,6 +128,35 @@ Wallet::~Wallet() {
     } else {
         LOG("Wallet Échec de la sauvegarde finale du portefeuille pour client ID: " + clientId + " vers " + walletFilePath + ".", "ERROR");
     }
+
+    // Dernier Wallet de ce client dans le processus : son fichier ne sera plus écrit ici.
+    std::function<void(const std::string&)> handler;
+    {
+        std::lock_guard<std::mutex> lock(liveMutex);
+        auto it = liveWallets.find(clientId);
+        if (it != liveWallets.end() && --it->second <= 0) {
+            liveWallets.erase(it);
+            handler = releaseHandler;
+        }
+    }
+    if (handler) {
+        handler(clientId);
+    }
+}
+
+std::vector<std::string> Wallet::liveClientIds() {
+    std::lock_guard<std::mutex> lock(liveMutex);
+    std::vector<std::string> ids;
+    ids.reserve(liveWallets.size());
+    for (const auto& entry : liveWallets) {
+        ids.push_back(entry.first);
+    }
+    return ids;
+}
+
+void Wallet::setReleaseHandler(std::function<void(const std::string& clientId)> handler) {
+    std::lock_guard<std::mutex> lock(liveMutex);
+    releaseHandler = std::move(handler);
 }
 
 // --- Implémentation des méthodes de solde ---
@@ -134,6 +177,7 @@ void Wallet::addTransaction(const Transaction& tx) {
         LOG("Wallet Portefeuille (" + clientId + ") : Tentative d'ajouter transaction avec ClientId non correspondant ('" + tx.getClientId() + "' vs '" + this->clientId + "'). Transaction ID: " + tx.getId() + ". Ignorée.", "ERROR");
         return;
     }
+    historyIndex[tx.getId()] = transactionHistory.size();
     transactionHistory.push_back(tx);
     LOG("Wallet Portefeuille (" + clientId + ") : Transaction ajoutée à l'historique. ID: " + tx.getId() + ", Type: " + transactionTypeToString(tx.getType()) + ", Statut: " + transactionStatusToString(tx.getStatus()), "INFO");
 }
@@ -142,6 +186,34 @@ std::vector<Transaction> Wallet::getTransactionHistory() const {
     return transactionHistory; // Retourne une copie (thread-safe)
 }
 
+Wallet::TransactionPage Wallet::visitTransactionPage(size_t limit, const std::string& beforeId,
+                                                     const std::function<void(const Transaction&)>& visit) const {
+    std::lock_guard<std::mutex> lock(walletMutex);
+    TransactionPage page;
+    page.total = transactionHistory.size();
+
+    // Fin (exclue) de la page : la position du curseur, la transaction du curseur étant exclue.
+    size_t end = transactionHistory.size();
+    if (!beforeId.empty()) {
+        auto cursor = historyIndex.find(beforeId);
+        if (cursor == historyIndex.end()) {
+            page.cursorFound = false;
+            return page;
+        }
+        end = cursor->second;
+    }
+
+    size_t start = end > limit ? end - limit : 0;
+    for (size_t i = start; i < end; ++i) {
+        visit(transactionHistory[i]);
+    }
+    page.count = end - start;
+    if (start > 0) {
+        page.nextCursor = transactionHistory[start].getId();
+    }
+    return page;
+}
+
 // --- Implémentation des méthodes de persistance ---
 
 bool Wallet::loadFromFile() {
@@ -161,6 +233,7 @@ bool Wallet::loadFromFile() {
     // Efface les données actuelles avant de charger
     balances.clear();
     transactionHistory.clear();
+    historyIndex.clear();
 
     // Ré-initialise les soldes par défaut au cas où le fichier soit vide ou mal formaté
     balances[Currency::USD] = 0.0;
@@ -171,7 +244,9 @@ bool Wallet::loadFromFile() {
     int balances_read_count = 0;
 
     // Lecture des soldes attendus en début de fichier
-    while(std::getline(file, line) && balances_read_count < 2) { // Limite la boucle aux 2 premières lignes pour les soldes
+    // Le compteur est testé avant getline : dans l'ordre inverse, la ligne suivant le second solde
+    // (la première transaction) serait consommée puis perdue à la sortie de la boucle.
+    while(balances_read_count < 2 && std::getline(file, line)) { // Limite la boucle aux 2 premières lignes pour les soldes
         std::stringstream ss(line);
         std::string currency_str;
         double balance_val;
@@ -191,7 +266,7 @@ bool Wallet::loadFromFile() {
              file.seekg(-(line.length() + 1), std::ios_base::cur); // Déplace le curseur avant la ligne lue
              break;
         }
-         // La condition de la boucle while(std::getline(file, line) && balances_read_count < 2) gère déjà la sortie après 2 soldes.
+         // La condition de la boucle gère déjà la sortie après 2 soldes.
     }
 
     if (balances_read_count < 2) {
@@ -244,6 +319,7 @@ bool Wallet::loadFromFile() {
             Transaction loaded_tx(id_str, clientId_str, type_enum, cryptoName_str, quantity_val, unitPrice_val, totalAmount_val, fee_val, loaded_time_t, status_enum);
 
             // Ajout à l'historique en mémoire
+            historyIndex[loaded_tx.getId()] = transactionHistory.size();
             transactionHistory.push_back(loaded_tx);
 
         } else {
@@ -264,21 +340,70 @@ bool Wallet::loadFromFile() {
 }
 
 bool Wallet::saveToFile() const {
+    return writeWalletFile(walletFilePath);
+}
+
+bool Wallet::saveToFileAtomic() const {
+    // Contenu sur disque AVANT le renommage : sinon un arrêt de la machine peut laisser le nouveau nom sur un
+    // fichier vide ou tronqué.
+    return writeTemporaryFile() && syncPath(walletFilePath + ".tmp", false) && publishTemporaryFile()
+        && syncPath(getDirectoryPath(), true);
+}
+
+bool Wallet::writeTemporaryFile() const {
+    return writeWalletFile(walletFilePath + ".tmp");
+}
+
+bool Wallet::publishTemporaryFile() const {
+    std::string temporaryPath = walletFilePath + ".tmp";
+    if (std::rename(temporaryPath.c_str(), walletFilePath.c_str()) != 0) {
+        if (errno == ENOENT) {
+            // Déjà publié par un saveToFileAtomic plus récent (même verrou, même fichier temporaire) : le
+            // portefeuille contient cet état ou un plus récent, déjà sur disque.
+            return true;
+        }
+        LOG("Wallet Erreur: Impossible de renommer " + temporaryPath + " en " + walletFilePath + ". Erreur système: " + std::string(strerror(errno)), "ERROR");
+        return false;
+    }
+    return true;
+}
+
+std::string Wallet::getDirectoryPath() const {
+    return std::filesystem::path(walletFilePath).parent_path().string();
+}
+
+bool Wallet::syncPath(const std::string& path, bool directory) {
+    int fd = open(path.empty() ? "." : path.c_str(), O_RDONLY | O_CLOEXEC | (directory ? O_DIRECTORY : 0));
+    if (fd < 0) {
+        LOG("Wallet Erreur: Impossible d'ouvrir " + path + " pour la mise sur disque. Erreur système: " + std::string(strerror(errno)), "ERROR");
+        return false;
+    }
+    int rc = directory ? fsync(fd) : fdatasync(fd);
+    int error = errno;
+    close(fd);
+    if (rc != 0) {
+        LOG("Wallet Erreur: Échec de la mise sur disque de " + path + ". Erreur système: " + std::string(strerror(error)), "ERROR");
+        return false;
+    }
+    return true;
+}
+
+bool Wallet::writeWalletFile(const std::string& path) const {
     if (!ensureWalletsDirectoryExists()) {
          // ensureWalletsDirectoryExists loggue déjà l'erreur
          return false;
      }
 
-    std::ofstream file(walletFilePath, std::ios::trunc); // Ouvre (ou crée) et vide le fichier
+    std::ofstream file(path, std::ios::trunc); // Ouvre (ou crée) et vide le fichier
     if (!file.is_open()) {
-        LOG("Wallet Erreur: Impossible d'ouvrir fichier portefeuille pour sauvegarde: " + walletFilePath + ". Erreur système: " + std::string(strerror(errno)), "ERROR");
+        LOG("Wallet Erreur: Impossible d'ouvrir fichier portefeuille pour sauvegarde: " + path + ". Erreur système: " + std::string(strerror(errno)), "ERROR");
         return false;
     }
 
 
-    // Sauvegarde des soldes
-    file << currencyToString(Currency::USD) << " " << std::fixed << std::setprecision(10) << balances.at(Currency::USD) << "\n"; // Utilise .at() pour un accès sécurisé (lève exception si la devise n'existe pas, ce qui ne devrait pas arriver)
-    file << currencyToString(Currency::SRD_BTC) << " " << std::fixed << std::setprecision(10) << balances.at(Currency::SRD_BTC) << "\n";
+    // Sauvegarde des soldes (fonds réservés inclus : le carnet d'ordres n'est pas persistant)
+    file << currencyToString(Currency::USD) << " " << std::fixed << std::setprecision(10) << balances.at(Currency::USD) + reservedBalances.at(Currency::USD) << "\n"; // Utilise .at() pour un accès sécurisé (lève exception si la devise n'existe pas, ce qui ne devrait pas arriver)
+    file << currencyToString(Currency::SRD_BTC) << " " << std::fixed << std::setprecision(10) << balances.at(Currency::SRD_BTC) + reservedBalances.at(Currency::SRD_BTC) << "\n";
 
     // Sauvegarde de l'historique des transactions
     for (const auto& tx : transactionHistory) {
@@ -303,7 +428,7 @@ bool Wallet::saveToFile() const {
 
     // Vérifie si des erreurs d'écriture se sont produites avant ou pendant la fermeture
     if (file.fail()) {
-         LOG("Wallet Erreur: Échec opération écriture/fermeture fichier portefeuille: " + walletFilePath + ". Erreur système: " + std::string(strerror(errno)), "ERROR");
+         LOG("Wallet Erreur: Échec opération écriture/fermeture fichier portefeuille: " + path + ". Erreur système: " + std::string(strerror(errno)), "ERROR");
          return false;
     }
 
@@ -315,6 +440,45 @@ bool Wallet::saveToFile() const {
     return true; // Sauvegarde réussie
 }
 
+// --- Fonds réservés ---
+bool Wallet::reserveFunds(Currency currency, double amount) {
+    auto it = balances.find(currency);
+    if (amount < 0 || it == balances.end() || it->second < amount) {
+        return false;
+    }
+    it->second -= amount;
+    reservedBalances[currency] += amount;
+    return true;
+}
+
+void Wallet::releaseReserved(Currency currency, double amount) {
+    double& reserved = reservedBalances[currency];
+    // Arrondis des montants recalculés : jamais plus que ce qui est réservé.
+    if (amount > reserved) {
+        amount = reserved;
+    }
+    reserved -= amount;
+    balances[currency] += amount;
+}
+
+void Wallet::consumeReserved(Currency currency, double amount) {
+    double& reserved = reservedBalances[currency];
+    if (amount > reserved) {
+        if (amount - reserved > 1e-9) { // Au-delà des arrondis
+            LOG("Wallet WARNING : Client " + clientId + " : exécution de " + std::to_string(amount) + " " + currencyToString(currency)
+                + " pour " + std::to_string(reserved) + " réservés. Différence prise sur le solde disponible.", "WARNING");
+        }
+        balances[currency] -= amount - reserved;
+        amount = reserved;
+    }
+    reserved -= amount;
+}
+
+double Wallet::getReserved(Currency currency) const {
+    auto it = reservedBalances.find(currency);
+    return it != reservedBalances.end() ? it->second : 0.0;
+}
+
 // --- Implémentation de updateBalance ---
 // Met à jour le solde pour une devise donnée avec un montant donné.
 // Le montant peut être positif (crédit) ou négatif (débit).
@@ -0,0 +1,217 @@
+// Micro-benchmark du découpage + dispatch des commandes texte de ClientSession (sans réseau ni traitement).
+// Compare, sur le même mélange de commandes :
+//  - stringstream : implémentation d'origine (std::stringstream, std::transform en majuscules, chaîne de
+//                   if/else sur std::string, arguments relus avec >>),
+//  - chaîne       : mots en std::string_view, chaîne de equalsIgnoreCase, nombres par std::strtod,
+//  - table        : CommandTable::lookup (hachage parfait constexpr) + std::from_chars (ClientSession actuel).
+// Chaque variante retourne le verbe reconnu et ses arguments numériques pour que rien ne soit éliminé.
+//
+// Compilation : g++ -std=c++17 -O2 -Isrc/headers src/code/bench_dispatch.cpp -o bench_dispatch
+// Usage       : ./bench_dispatch [itérations (défaut 2000000)]
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../headers/CommandTable.h"
+
+struct ParsedCommand {
+    int verb = -1;      // CommandVerb, -1 = inconnu
+    double number = 0.0;
+    size_t wordLength = 0; // Longueur de l'argument texte (devise, symbole, cible)
+};
+
+// --- Implémentation d'origine ---
+static ParsedCommand parseStringstream(const std::string& command) {
+    ParsedCommand out;
+    std::stringstream ss(command);
+    std::string base_command;
+    ss >> base_command;
+    std::transform(base_command.begin(), base_command.end(), base_command.begin(), ::toupper);
+
+    if (base_command == "QUIT") {
+        out.verb = static_cast<int>(CommandVerb::QUIT);
+    } else if (base_command == "SHOW") {
+        std::string target;
+        ss >> target;
+        std::transform(target.begin(), target.end(), target.begin(), ::toupper);
+        out.verb = static_cast<int>(CommandVerb::SHOW);
+        out.wordLength = target.size();
+    } else if (base_command == "GET_PRICE") {
+        std::string symbol;
+        ss >> symbol;
+        std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::toupper);
+        out.verb = static_cast<int>(CommandVerb::GET_PRICE);
+        out.wordLength = symbol.size();
+    } else if (base_command == "BUY" || base_command == "SELL") {
+        std::string currency_str;
+        double percentage = 0.0;
+        ss >> currency_str >> percentage;
+        std::transform(currency_str.begin(), currency_str.end(), currency_str.begin(), ::toupper);
+        out.verb = static_cast<int>(base_command == "BUY" ? CommandVerb::BUY : CommandVerb::SELL);
+        out.number = (ss && !ss.fail()) ? percentage : -1.0;
+        out.wordLength = currency_str.size();
+    } else if (base_command == "START") {
+        std::string bot_keyword;
+        double bollingerK = 0.0;
+        ss >> bot_keyword;
+        out.verb = static_cast<int>(CommandVerb::START);
+        if (bot_keyword == "BOT" && ss >> bollingerK) {
+            out.number = bollingerK;
+        }
+    } else if (base_command == "STOP") {
+        std::string bot_keyword;
+        ss >> bot_keyword;
+        out.verb = static_cast<int>(CommandVerb::STOP);
+        out.wordLength = bot_keyword.size();
+    } else if (base_command == "PIPELINE") {
+        std::string mode;
+        ss >> mode;
+        out.verb = static_cast<int>(CommandVerb::PIPELINE);
+        out.wordLength = mode.size();
+    }
+    return out;
+}
+
+// --- Chaîne de comparaisons sur std::string_view (avant la table) ---
+static bool nextDoubleStrtod(CommandTokens& tokens, double& value) {
+    std::string_view word = tokens.next();
+    char buffer[64];
+    if (word.empty() || word.size() >= sizeof(buffer)) {
+        return false;
+    }
+    std::memcpy(buffer, word.data(), word.size());
+    buffer[word.size()] = '\0';
+    char* end = nullptr;
+    value = std::strtod(buffer, &end);
+    return end == buffer + word.size();
+}
+
+static ParsedCommand parseChain(std::string_view command) {
+    using CommandTable::equalsIgnoreCase;
+    ParsedCommand out;
+    CommandTokens tokens(command);
+    std::string_view base_command = tokens.next();
+
+    if (equalsIgnoreCase(base_command, "QUIT")) {
+        out.verb = static_cast<int>(CommandVerb::QUIT);
+    } else if (equalsIgnoreCase(base_command, "SHOW")) {
+        out.verb = static_cast<int>(CommandVerb::SHOW);
+        out.wordLength = tokens.next().size();
+    } else if (equalsIgnoreCase(base_command, "EXPORT")) {
+        out.verb = static_cast<int>(CommandVerb::EXPORT);
+    } else if (equalsIgnoreCase(base_command, "SHM")) {
+        out.verb = static_cast<int>(CommandVerb::SHM);
+    } else if (equalsIgnoreCase(base_command, "GET_PRICE")) {
+        out.verb = static_cast<int>(CommandVerb::GET_PRICE);
+        out.wordLength = tokens.next().size();
+    } else if (equalsIgnoreCase(base_command, "BUY") || equalsIgnoreCase(base_command, "SELL")) {
+        out.verb = static_cast<int>(equalsIgnoreCase(base_command, "BUY") ? CommandVerb::BUY : CommandVerb::SELL);
+        out.wordLength = tokens.next().size();
+        if (!nextDoubleStrtod(tokens, out.number)) out.number = -1.0;
+    } else if (equalsIgnoreCase(base_command, "START")) {
+        out.verb = static_cast<int>(CommandVerb::START);
+        if (tokens.next() == "BOT") nextDoubleStrtod(tokens, out.number);
+    } else if (equalsIgnoreCase(base_command, "STOP")) {
+        out.verb = static_cast<int>(CommandVerb::STOP);
+        out.wordLength = tokens.next().size();
+    } else if (equalsIgnoreCase(base_command, "PIPELINE")) {
+        out.verb = static_cast<int>(CommandVerb::PIPELINE);
+        out.wordLength = tokens.next().size();
+    }
+    return out;
+}
+
+// --- Table à hachage parfait + from_chars (ClientSession::processClientCommand) ---
+// Un pointeur de fonction par verbe, comme ClientSession::commandHandlers.
+using TableHandler = void (*)(CommandTokens&, ParsedCommand&);
+static void tableWord(CommandTokens& tokens, ParsedCommand& out) { out.wordLength = tokens.next().size(); }
+static void tableNone(CommandTokens&, ParsedCommand&) {}
+static void tableTrade(CommandTokens& tokens, ParsedCommand& out) {
+    out.wordLength = tokens.next().size();
+    if (!tokens.nextDouble(out.number)) out.number = -1.0;
+}
+static void tableStart(CommandTokens& tokens, ParsedCommand& out) {
+    if (tokens.next() == "BOT") tokens.nextDouble(out.number);
+}
+static constexpr TableHandler TABLE_HANDLERS[] = {
+    tableNone,  // QUIT
+    tableWord,  // SHOW
+    tableNone,  // EXPORT
+    tableNone,  // SHM
+    tableWord,  // GET_PRICE
+    tableTrade, // BUY
+    tableTrade, // SELL
+    tableStart, // START
+    tableWord,  // STOP
+    tableWord,  // PIPELINE
+    tableNone,  // CHANNEL
+    tableNone,  // BINARY
+    tableNone,  // PING
+    tableNone,  // PONG
+    tableNone,  // SUBSCRIBE
+    tableNone,  // UNSUBSCRIBE
+    tableNone,  // LIMIT
+    tableNone,  // IOC
+    tableNone,  // FOK
+    tableNone,  // CANCEL
+    tableNone,  // UNKNOWN
+};
+static_assert(sizeof(TABLE_HANDLERS) / sizeof(TABLE_HANDLERS[0]) == COMMAND_VERB_COUNT,
+              "bench_dispatch: TABLE_HANDLERS doit avoir une entrée par CommandVerb");
+
+static ParsedCommand parseTable(std::string_view command) {
+    ParsedCommand out;
+    CommandTokens tokens(command);
+    CommandVerb verb = CommandTable::lookup(tokens.next());
+    out.verb = verb == CommandVerb::UNKNOWN ? -1 : static_cast<int>(verb);
+    TABLE_HANDLERS[static_cast<size_t>(verb)](tokens, out);
+    return out;
+}
+
+template <typename Parser>
+static double run(const char* name, const std::vector<std::string>& commands, size_t iterations, Parser parser, double& checksum) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        ParsedCommand parsed = parser(commands[i % commands.size()]);
+        checksum += parsed.verb + parsed.number + static_cast<double>(parsed.wordLength);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(iterations);
+    std::cout << std::left << std::setw(14) << name << std::right << std::fixed << std::setprecision(1) << std::setw(8) << ns << " ns/commande\n";
+    return ns;
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    if (iterations == 0) iterations = 1;
+
+    // Mélange proche d'un client actif : surtout des ordres et des prix, un peu de consultation.
+    const std::vector<std::string> commands = {
+        "BUY SRD-BTC 5", "SELL SRD-BTC 12.5", "GET_PRICE SRD-BTC", "buy srd-btc 1", "SHOW WALLET",
+        "SELL SRD-BTC 50", "GET_PRICE srd-btc", "START BOT 2.0", "STOP BOT", "BUY SRD-BTC 100",
+        "SHOW TRANSACTIONS", "PIPELINE ON", "HELLO WORLD",
+    };
+
+    // Les trois variantes doivent reconnaître la même chose.
+    for (const std::string& command : commands) {
+        ParsedCommand a = parseStringstream(command), b = parseChain(command), c = parseTable(command);
+        if (a.verb != c.verb || b.verb != c.verb || a.number != c.number || b.number != c.number) {
+            std::cerr << "Résultats différents pour '" << command << "'\n";
+            return 1;
+        }
+    }
+
+    std::cout << "=== Découpage + dispatch de " << iterations << " commandes (" << commands.size() << " commandes distinctes) ===\n";
+    double checksum = 0.0;
+    double ss_ns = run("stringstream", commands, iterations, [](const std::string& c) { return parseStringstream(c); }, checksum);
+    double chain_ns = run("chaîne", commands, iterations, [](const std::string& c) { return parseChain(c); }, checksum);
+    double table_ns = run("table", commands, iterations, [](const std::string& c) { return parseTable(c); }, checksum);
+    std::cout << std::setprecision(1) << "Gain table : x" << ss_ns / table_ns << " vs stringstream, x" << chain_ns / table_ns << " vs chaîne"
+              << " (checksum " << std::setprecision(0) << checksum << ")\n";
+    return 0;
+}
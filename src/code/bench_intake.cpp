@@ -0,0 +1,207 @@
+// Micro-benchmark de l'entrée d'un shard de la TransactionQueue (sans traitement des ordres).
+// Compare, avec P threads producteurs (les sessions) et un consommateur (le worker du shard) :
+//  - mutex   : conception précédente, std::queue protégée par un mutex, requête copiée à l'entrée et à la
+//              sortie, notification de la condition quand le worker dort,
+//  - anneau  : MpscRing (TransactionQueue actuelle), cases pré-allouées, requête déplacée, worker qui
+//              attend activement SPIN_POLLS lectures puis dort (notifié seulement s'il dort).
+// Mesure la latence de chaque dépôt (appel de addRequest côté session) et le débit total.
+//
+// Compilation : g++ -std=c++17 -O2 -pthread -Isrc/headers src/code/bench_intake.cpp -o bench_intake
+// Usage       : ./bench_intake [producteurs (défaut 4)] [requêtes par producteur (défaut 200000)] [travail du worker en ns (défaut 0)]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../headers/TransactionQueue.h" // TransactionRequest, SHARD_CAPACITY
+#include "../headers/MpscRing.h"
+#include "../headers/LowLatency.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Traitement simulé d'une requête par le worker (attente active de 'ns' nanosecondes).
+static void simulateWork(long ns, double& checksum, const TransactionRequest& request) {
+    checksum += request.quantity + static_cast<double>(request.clientId.size());
+    if (ns <= 0) {
+        return;
+    }
+    auto until = Clock::now() + std::chrono::nanoseconds(ns);
+    while (Clock::now() < until) {
+        LowLatency::cpuRelax();
+    }
+}
+
+// --- Conception précédente : mutex + std::queue + condition ---
+class MutexIntake {
+public:
+    void push(const TransactionRequest& request) {
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            queue.push(request);
+            wake = workerSleeping;
+        }
+        if (wake) {
+            cv.notify_one();
+        }
+    }
+
+    // Retourne false à l'arrêt, file vide.
+    bool pop(std::optional<TransactionRequest>& out) {
+        std::unique_lock<std::mutex> lock(mtx);
+        workerSleeping = true;
+        cv.wait(lock, [&] { return !queue.empty() || stopped; });
+        workerSleeping = false;
+        if (queue.empty()) {
+            return false;
+        }
+        out.emplace(queue.front());
+        queue.pop();
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopped = true;
+        }
+        cv.notify_all();
+    }
+
+private:
+    std::queue<TransactionRequest> queue;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool workerSleeping = false;
+    bool stopped = false;
+};
+
+// --- Conception actuelle : MpscRing + sommeil sur condition (voir TransactionQueue::process) ---
+class RingIntake {
+public:
+    RingIntake() : ring(TransactionQueue::SHARD_CAPACITY) {}
+
+    void push(TransactionRequest request) {
+        while (!ring.tryPush(std::move(request))) {
+            std::this_thread::yield();
+        }
+        if (ring.consumerNeedsWakeup()) {
+            { std::lock_guard<std::mutex> lock(mtx); }
+            cv.notify_one();
+        }
+    }
+
+    bool pop(std::optional<TransactionRequest>& out) {
+        while (true) {
+            out = ring.tryPop();
+            if (out) {
+                return true;
+            }
+            int polls = 0;
+            while (ring.empty() && !stopped.load(std::memory_order_acquire) && ++polls < 256) {
+                LowLatency::cpuRelax();
+            }
+            if (ring.empty()) {
+                if (stopped.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                if (ring.prepareToSleep()) {
+                    std::unique_lock<std::mutex> lock(mtx);
+                    cv.wait(lock, [&] { return !ring.empty() || stopped.load(std::memory_order_acquire); });
+                    ring.wokeUp();
+                }
+            }
+        }
+    }
+
+    void stop() {
+        stopped.store(true, std::memory_order_release);
+        { std::lock_guard<std::mutex> lock(mtx); }
+        cv.notify_all();
+    }
+
+private:
+    MpscRing<TransactionRequest> ring;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::atomic<bool> stopped{false};
+};
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+template <typename Intake>
+static void run(const char* name, int producers, size_t perProducer, long workNs) {
+    Intake intake;
+    double checksum = 0.0;
+    size_t consumed = 0;
+    std::thread worker([&] {
+        std::optional<TransactionRequest> request;
+        while (intake.pop(request)) {
+            simulateWork(workNs, checksum, *request);
+            consumed++;
+        }
+    });
+
+    std::vector<std::vector<double>> latencies(static_cast<size_t>(producers));
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            std::vector<double>& local = latencies[static_cast<size_t>(p)];
+            local.reserve(perProducer);
+            // Identifiant de la taille d'un vrai clientId (hors optimisation des petites chaînes).
+            std::string clientId = "bench_client_" + std::to_string(100000 + p);
+            for (size_t i = 0; i < perProducer; ++i) {
+                TransactionRequest request(clientId, (i % 2 == 0) ? RequestType::BUY : RequestType::SELL, "SRD-BTC", 0.001 * static_cast<double>(i % 100));
+                request.correlationId = i;
+                auto before = Clock::now();
+                intake.push(std::move(request));
+                local.push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    intake.stop();
+    worker.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> all;
+    for (auto& local : latencies) {
+        all.insert(all.end(), local.begin(), local.end());
+    }
+    std::sort(all.begin(), all.end());
+    std::cout << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(0)
+              << " dépôt (ns) : p50 " << std::setw(6) << percentile(all, 50) << "  p99 " << std::setw(7) << percentile(all, 99)
+              << "  p99.9 " << std::setw(8) << percentile(all, 99.9) << "  max " << std::setw(9) << (all.empty() ? 0.0 : all.back())
+              << " | " << std::setprecision(2) << static_cast<double>(consumed) / seconds / 1e6 << " M requêtes/s"
+              << " (" << consumed << " traitées, checksum " << std::setprecision(0) << checksum << ")\n";
+}
+
+int main(int argc, char* argv[]) {
+    int producers = argc > 1 ? std::max(1, std::atoi(argv[1])) : 4;
+    size_t perProducer = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200000;
+    long workNs = argc > 3 ? std::atol(argv[3]) : 0;
+    if (perProducer == 0) perProducer = 1;
+
+    std::cout << "=== Entrée d'un shard : " << producers << " producteurs x " << perProducer << " requêtes, travail du worker "
+              << workNs << " ns, " << std::thread::hardware_concurrency() << " coeurs ===\n";
+    run<MutexIntake>("mutex", producers, perProducer, workNs);
+    run<RingIntake>("anneau", producers, perProducer, workNs);
+    return 0;
+}
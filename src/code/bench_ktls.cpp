@@ -0,0 +1,201 @@
+// Benchmark du Kernel TLS : coût CPU par Mo envoyé, avec et sans délégation du chiffrement au noyau.
+// Mesure le thread émetteur (temps CPU utilisateur + système, le chiffrement kTLS étant fait pendant
+// l'appel système) sur une connexion TLS 1.3 locale, pour trois chemins d'envoi :
+//   - "userspace"     : pread() + SSL_write, chiffrement OpenSSL (repli du serveur sans kTLS)
+//   - "ktls-write"    : SSL_write avec kTLS actif (copie utilisateur -> noyau, chiffrement noyau)
+//   - "ktls-sendfile" : SSL_sendfile avec kTLS actif (cache de pages -> socket, aucune copie)
+// Les modes kTLS sont ignorés si le noyau refuse (module 'tls' absent) : le benchmark l'indique.
+//
+// Compilation (depuis la racine du projet) :
+//   g++ -std=c++17 -O2 -pthread -Isrc/headers src/code/bench_ktls.cpp -o bench_ktls -lssl -lcrypto
+// Usage : ./bench_ktls [taille en Mo (256)] [certificat (server.crt)] [clé (server.key)]
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include "../headers/OpenSSLDeleters.h"
+
+enum class SendMode { USERSPACE, KTLS_WRITE, KTLS_SENDFILE };
+
+struct BenchResult {
+    bool ran = false;
+    bool kernelTls = false;
+    double cpuMs = 0;
+    double wallMs = 0;
+};
+
+static const char* modeName(SendMode mode) {
+    switch (mode) {
+        case SendMode::USERSPACE: return "userspace";
+        case SendMode::KTLS_WRITE: return "ktls-write";
+        default: return "ktls-sendfile";
+    }
+}
+
+static double threadCpuMs() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Fichier temporaire de 'size' octets (déjà dans le cache de pages après écriture).
+static int makeDataFile(size_t size) {
+    char path[] = "/tmp/bench_ktls_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return -1;
+    unlink(path);
+    std::vector<char> block(1 << 20);
+    for (size_t i = 0; i < block.size(); ++i) block[i] = static_cast<char>('A' + (i * 7) % 26);
+    for (size_t done = 0; done < size; ) {
+        size_t n = std::min(block.size(), size - done);
+        if (write(fd, block.data(), n) != static_cast<ssize_t>(n)) { close(fd); return -1; }
+        done += n;
+    }
+    return fd;
+}
+
+// Côté récepteur : lit et jette 'total' octets.
+static void receiveAll(SSL_CTX* ctx, int port, size_t total) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) { close(sock); return; }
+    UniqueSSL ssl(SSL_new(ctx));
+    SSL_set_fd(ssl.get(), sock);
+    if (SSL_connect(ssl.get()) == 1) {
+        std::vector<char> buffer(64 * 1024);
+        size_t received = 0;
+        while (received < total) {
+            int n = SSL_read(ssl.get(), buffer.data(), static_cast<int>(buffer.size()));
+            if (n <= 0) break;
+            received += static_cast<size_t>(n);
+        }
+        SSL_shutdown(ssl.get());
+    }
+    close(sock);
+}
+
+static BenchResult runOnce(SSL_CTX* serverCtx, SSL_CTX* clientCtx, SendMode mode, int fileFd, size_t size) {
+    BenchResult result;
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listener, 1) != 0
+        || getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        close(listener);
+        return result;
+    }
+    std::thread receiver(receiveAll, clientCtx, ntohs(addr.sin_port), size);
+
+    int sock = accept(listener, nullptr, nullptr);
+    close(listener);
+    UniqueSSL ssl(SSL_new(serverCtx));
+    SSL_set_fd(ssl.get(), sock);
+    if (mode != SendMode::USERSPACE) {
+        SSL_set_options(ssl.get(), SSL_OP_ENABLE_KTLS);
+    }
+    if (SSL_accept(ssl.get()) == 1) {
+        result.kernelTls = BIO_get_ktls_send(SSL_get_wbio(ssl.get())) == 1;
+        if (mode == SendMode::USERSPACE || result.kernelTls) {
+            result.ran = true;
+            std::vector<char> buffer(16 * 1024); // Un enregistrement TLS, comme le repli du serveur
+            auto wall_start = std::chrono::steady_clock::now();
+            double cpu_start = threadCpuMs();
+            off_t offset = 0;
+            while (static_cast<size_t>(offset) < size) {
+                size_t chunk = std::min(size - static_cast<size_t>(offset), mode == SendMode::KTLS_SENDFILE ? size_t(1 << 20) : buffer.size());
+                long sent;
+                if (mode == SendMode::KTLS_SENDFILE) {
+                    sent = SSL_sendfile(ssl.get(), fileFd, offset, chunk, 0);
+                } else {
+                    ssize_t got = pread(fileFd, buffer.data(), chunk, offset);
+                    sent = got > 0 ? SSL_write(ssl.get(), buffer.data(), static_cast<int>(got)) : -1;
+                }
+                if (sent <= 0) {
+                    std::cerr << "Erreur d'envoi (" << modeName(mode) << ")\n";
+                    ERR_print_errors_fp(stderr);
+                    result.ran = false;
+                    break;
+                }
+                offset += sent;
+            }
+            result.cpuMs = threadCpuMs() - cpu_start;
+            result.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+        }
+        SSL_shutdown(ssl.get());
+    } else {
+        ERR_print_errors_fp(stderr);
+    }
+    ssl.reset();
+    shutdown(sock, SHUT_RDWR); // Débloque le récepteur si l'envoi a été interrompu
+    receiver.join();
+    close(sock);
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 256;
+    std::string cert = argc > 2 ? argv[2] : "server.crt";
+    std::string key = argc > 3 ? argv[3] : "server.key";
+    size_t size = std::max<size_t>(megabytes, 1) * 1024 * 1024;
+
+    UniqueSSLCTX serverCtx(SSL_CTX_new(TLS_server_method()));
+    UniqueSSLCTX clientCtx(SSL_CTX_new(TLS_client_method()));
+    SSL_CTX_set_min_proto_version(serverCtx.get(), TLS1_3_VERSION);
+    SSL_CTX_set_ciphersuites(serverCtx.get(), "TLS_AES_256_GCM_SHA384"); // Suite supportée par kTLS
+    SSL_CTX_set_verify(clientCtx.get(), SSL_VERIFY_NONE, nullptr);
+    if (SSL_CTX_use_certificate_file(serverCtx.get(), cert.c_str(), SSL_FILETYPE_PEM) <= 0
+        || SSL_CTX_use_PrivateKey_file(serverCtx.get(), key.c_str(), SSL_FILETYPE_PEM) <= 0) {
+        std::cerr << "Impossible de charger " << cert << " / " << key << "\n";
+        ERR_print_errors_fp(stderr);
+        return 1;
+    }
+
+    int fileFd = makeDataFile(size);
+    if (fileFd < 0) {
+        std::cerr << "Impossible de créer le fichier de données.\n";
+        return 1;
+    }
+
+    std::ofstream csv("ktls_benchmark.csv", std::ios::app);
+    std::cout << "Envoi de " << megabytes << " Mo par mode (TLS 1.3, AES-256-GCM, boucle locale)\n";
+    std::cout << std::left << std::setw(16) << "Mode" << std::setw(16) << "CPU ms/Mo" << std::setw(14) << "Débit Mo/s" << "\n";
+    for (SendMode mode : {SendMode::USERSPACE, SendMode::KTLS_WRITE, SendMode::KTLS_SENDFILE}) {
+        BenchResult r = runOnce(serverCtx.get(), clientCtx.get(), mode, fileFd, size);
+        if (!r.ran) {
+            std::cout << std::setw(16) << modeName(mode)
+                      << (mode != SendMode::USERSPACE && !r.kernelTls ? "ignoré : kTLS refusé par le noyau (module 'tls' absent ?)" : "échec") << "\n";
+            continue;
+        }
+        double cpu_per_mb = r.cpuMs / megabytes;
+        double throughput = megabytes / (r.wallMs / 1000.0);
+        std::cout << std::setw(16) << modeName(mode) << std::setw(16) << std::fixed << std::setprecision(3) << cpu_per_mb
+                  << std::setw(14) << std::setprecision(1) << throughput << "\n";
+        if (csv.is_open()) {
+            csv << modeName(mode) << "," << megabytes << "," << cpu_per_mb << "," << throughput << "\n";
+        }
+    }
+    close(fileFd);
+    return 0;
+}
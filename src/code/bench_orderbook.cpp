@@ -0,0 +1,188 @@
+// Benchmark du carnet d'ordres et du moteur d'appariement sur un flux synthétique.
+// Flux : prix médian en marche aléatoire (en ticks) ; à chaque événement, ordre à cours limité posé autour du
+// médian (une partie croise et s'exécute), annulation d'un ordre au repos tiré au hasard, ou ordre au marché.
+//  - carnet : OrderBook appelé directement par un thread (coût de l'appariement seul),
+//  - moteur : le même flux rejoué à travers MatchingEngine (anneau MPSC + thread d'appariement dédié),
+//             déposé par un producteur sans attendre les rapports.
+// Les identifiants attribués par le carnet sont déterministes : le rejeu par le moteur annule les mêmes ordres.
+//
+// Compilation : g++ -std=c++17 -O2 -pthread -Isrc/headers src/code/bench_orderbook.cpp src/code/OrderBook.cpp
+//               src/code/MatchingEngine.cpp src/code/LowLatency.cpp src/code/Logger.cpp -o bench_orderbook
+// Usage       : ./bench_orderbook [événements (défaut 5000000)] [% limites (défaut 60)] [% annulations (défaut 30)]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../headers/OrderBook.h"
+#include "../headers/MatchingEngine.h"
+
+using Clock = std::chrono::steady_clock;
+
+static MatchingEngine::BookConfig benchConfig() {
+    MatchingEngine::BookConfig config;
+    config.symbol = "SRD-BTC";
+    return config; // Réglages du serveur
+}
+
+// Génère le flux en l'appliquant à un carnet (qui fournit les identifiants à annuler). Retourne les
+// commandes dans l'ordre, pour le rejeu.
+static std::vector<EngineCommand> generate(size_t events, int limitPercent, int cancelPercent, int64_t midTick) {
+    MatchingEngine::BookConfig config = benchConfig();
+    OrderBook book(config.symbol, config.tickSize, config.lotSize, config.levelCount, config.orderCapacity);
+    book.recenter(midTick);
+
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int64_t> offset(0, 40);
+    std::uniform_int_distribution<int64_t> lots(1, 200);
+    std::vector<uint64_t> live;
+    std::vector<EngineCommand> commands;
+    commands.reserve(events);
+
+    int64_t mid = midTick;
+    for (size_t i = 0; i < events; ++i) {
+        if (i % 64 == 0) {
+            mid += static_cast<int64_t>(percent(rng) % 3) - 1; // Marche aléatoire du médian
+        }
+        EngineCommand command;
+        command.side = (rng() & 1) ? OrderSide::BUY : OrderSide::SELL;
+        command.quantity = lots(rng) * 1000;
+        int roll = percent(rng);
+        // Annulations : seulement des ordres encore au repos (les ordres exécutés sont retirés au tirage).
+        RestingOrder resting;
+        while (!live.empty() && roll >= limitPercent && roll < limitPercent + cancelPercent) {
+            size_t pick = static_cast<size_t>(rng() % live.size());
+            if (book.find(live[pick], resting)) {
+                command.orderId = live[pick];
+                command.owner = resting.owner; // Le moteur n'annule que pour le propriétaire
+            }
+            live[pick] = live.back();
+            live.pop_back();
+            if (command.orderId != 0) {
+                break;
+            }
+        }
+        if (roll < limitPercent || (command.orderId == 0 && roll < limitPercent + cancelPercent)) {
+            command.type = EngineCommand::Type::LIMIT;
+            // Surtout passif ; un ordre sur dix croise de quelques ticks.
+            int64_t distance = offset(rng) - (percent(rng) < 10 ? 5 : 0);
+            command.priceTick = command.side == OrderSide::BUY ? mid - distance : mid + distance;
+            command.owner = static_cast<uint32_t>(i & 0xFF);
+        } else if (roll < limitPercent + cancelPercent) {
+            command.type = EngineCommand::Type::CANCEL;
+        } else {
+            command.type = EngineCommand::Type::MARKET;
+            command.priceTick = command.side == OrderSide::BUY ? mid + 100 : mid - 100; // Protection
+        }
+        commands.push_back(command);
+
+        // Application (mêmes règles que MatchingEngine::apply).
+        if (command.type == EngineCommand::Type::CANCEL) {
+            book.cancel(command.orderId);
+        } else {
+            bool selfTrade = false;
+            int64_t filled = book.match(command.side, command.quantity, command.priceTick, [](const Fill&) {}, command.owner, &selfTrade);
+            if (command.type == EngineCommand::Type::LIMIT && filled < command.quantity && !selfTrade) {
+                uint64_t id = book.add(command.side, command.priceTick, command.quantity - filled, command.owner);
+                if (id != 0) {
+                    live.push_back(id);
+                }
+            }
+        }
+    }
+    return commands;
+}
+
+struct Totals {
+    uint64_t fills = 0;
+    uint64_t rejected = 0;
+    size_t resting = 0;
+    bool consistent = true;
+};
+
+// Carnet seul : rejeu des commandes sur un carnet neuf, un thread.
+static Totals runBook(const std::vector<EngineCommand>& commands, int64_t midTick, double& seconds) {
+    MatchingEngine::BookConfig config = benchConfig();
+    OrderBook book(config.symbol, config.tickSize, config.lotSize, config.levelCount, config.orderCapacity);
+    book.recenter(midTick);
+    Totals totals;
+    auto countFill = [&totals](const Fill&) { totals.fills++; };
+
+    auto start = Clock::now();
+    for (const EngineCommand& command : commands) {
+        if (command.type == EngineCommand::Type::CANCEL) {
+            if (!book.cancel(command.orderId)) totals.rejected++;
+            continue;
+        }
+        bool selfTrade = false;
+        int64_t filled = book.match(command.side, command.quantity, command.priceTick, countFill, command.owner, &selfTrade);
+        if (command.type == EngineCommand::Type::LIMIT && filled < command.quantity && !selfTrade) {
+            if (book.add(command.side, command.priceTick, command.quantity - filled, command.owner) == 0) totals.rejected++;
+        }
+    }
+    seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    totals.resting = book.getOrderCount();
+    totals.consistent = !(book.hasBid() && book.hasAsk()) || book.getBestBid() < book.getBestAsk();
+    return totals;
+}
+
+// Moteur : même rejeu déposé dans l'anneau, traité par le thread d'appariement.
+static Totals runEngine(const std::vector<EngineCommand>& commands, int64_t midTick, double& seconds) {
+    MatchingEngine engine;
+    uint32_t bookIndex = engine.addBook(benchConfig());
+    engine.getBook(bookIndex).recenter(midTick);
+    engine.start();
+
+    auto start = Clock::now();
+    for (const EngineCommand& command : commands) {
+        engine.submit(command);
+    }
+    engine.stop(); // Attend le traitement de tout l'anneau
+    seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    MatchingEngineStats stats = engine.getStats();
+    const OrderBook& book = engine.getBook(bookIndex);
+    Totals totals;
+    totals.fills = stats.fills;
+    totals.rejected = stats.rejected;
+    totals.resting = book.getOrderCount();
+    totals.consistent = !(book.hasBid() && book.hasAsk()) || book.getBestBid() < book.getBestAsk();
+    return totals;
+}
+
+static void report(const char* name, size_t events, const Totals& totals, double seconds) {
+    std::cout << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(2)
+              << static_cast<double>(events) / seconds / 1e6 << " M ordres/s, "
+              << static_cast<double>(events + totals.fills) / seconds / 1e6 << " M événements/s (ordres + exécutions) | "
+              << totals.fills << " exécutions, " << totals.rejected << " refus, " << totals.resting << " au repos, "
+              << std::setprecision(1) << seconds * 1e9 / static_cast<double>(events) << " ns/ordre"
+              << (totals.consistent ? "" : "  CARNET CROISÉ !") << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t events = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+    int limitPercent = argc > 2 ? std::clamp(std::atoi(argv[2]), 1, 100) : 60;
+    int cancelPercent = argc > 3 ? std::clamp(std::atoi(argv[3]), 0, 100 - limitPercent) : 30;
+    if (events == 0) events = 1;
+    const int64_t midTick = 600000; // 60000.0 USD
+
+    std::vector<EngineCommand> commands = generate(events, limitPercent, cancelPercent, midTick);
+    std::cout << "=== Carnet SRD-BTC : " << events << " ordres (" << limitPercent << "% limites, " << cancelPercent << "% annulations, "
+              << (100 - limitPercent - cancelPercent) << "% au marché), " << std::thread::hardware_concurrency() << " coeurs ===\n";
+
+    double seconds = 0.0;
+    Totals book = runBook(commands, midTick, seconds);
+    report("carnet", events, book, seconds);
+    Totals engine = runEngine(commands, midTick, seconds);
+    report("moteur", events, engine, seconds);
+    if (book.fills != engine.fills || book.resting != engine.resting) {
+        std::cout << "Résultats différents entre le carnet et le moteur !\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,251 @@
+// Benchmark de la passerelle en mémoire partagée : latence d'un aller-retour ordre -> rapport.
+//   - "ring"   : deux threads d'un même processus, segment memfd et anneaux de ShmRing.h, un thread
+//                "passerelle" qui renvoie chaque ordre en rapport. Mesure le coût du transport seul, avec
+//                attente active (50 us, le réglage par défaut) puis avec sommeil systématique sur eventfd, comparé à un aller-retour
+//                sur une paire de sockets Unix (le chemin texte local le plus court).
+//   - "server" : de bout en bout contre un serveur lancé (ServerOptions::shmGateway), via ShmOrderClient.
+//                Inclut la TransactionQueue (contrôle des fonds, écriture du portefeuille).
+// Résultats : percentiles p50 / p99 / p99.9 et maximum, en microsecondes.
+//
+// Compilation (depuis la racine du projet) :
+//   g++ -std=c++17 -O2 -pthread -Isrc/headers src/code/bench_shm.cpp src/code/ShmOrderClient.cpp src/code/Logger.cpp -o bench_shm
+// Usage : ./bench_shm ring [ordres (100000)]
+//         ./bench_shm server <socket Unix> <ID client> [ordres (2000)] [mot de passe]
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+
+#include "../headers/ShmRing.h"
+#include "../headers/ShmOrderClient.h"
+
+using Clock = std::chrono::steady_clock;
+
+static void print_percentiles(const std::string& label, std::vector<double>& samples_us) {
+    if (samples_us.empty()) {
+        std::cout << std::left << std::setw(28) << label << "aucune mesure\n";
+        return;
+    }
+    std::sort(samples_us.begin(), samples_us.end());
+    auto at = [&](double q) { return samples_us[std::min(samples_us.size() - 1, static_cast<size_t>(q * samples_us.size()))]; };
+    std::cout << std::left << std::setw(28) << label << std::right << std::fixed << std::setprecision(2)
+              << "p50 " << std::setw(9) << at(0.50) << "  p99 " << std::setw(9) << at(0.99)
+              << "  p99.9 " << std::setw(9) << at(0.999) << "  max " << std::setw(10) << samples_us.back()
+              << "   (" << samples_us.size() << " mesures)\n";
+}
+
+// --- Mode "ring" ---
+
+// Attente d'un enregistrement : 'spinMicros' d'attente active puis sommeil sur l'eventfd (comme la passerelle).
+template <typename Record>
+static bool wait_pop(ShmRing<Record>& ring, Record& record, int doorbell, int spinMicros, const std::atomic<bool>& running) {
+    auto spin_until = Clock::now() + std::chrono::microseconds(spinMicros);
+    while (running.load(std::memory_order_relaxed)) {
+        if (ring.tryPop(record)) {
+            return true;
+        }
+        if (Clock::now() < spin_until) {
+            continue;
+        }
+        if (!ring.prepareToSleep()) {
+            continue;
+        }
+        pollfd pfd{doorbell, POLLIN, 0};
+        ::poll(&pfd, 1, 100);
+        ring.wokeUp();
+        uint64_t count;
+        (void)!::read(doorbell, &count, sizeof(count));
+    }
+    return false;
+}
+
+template <typename Record>
+static void push_and_ring(ShmRing<Record>& ring, const Record& record, int doorbell) {
+    while (!ring.tryPush(record)) {
+    }
+    if (ring.consumerNeedsWakeup()) {
+        uint64_t one = 1;
+        (void)!::write(doorbell, &one, sizeof(one));
+    }
+}
+
+static std::vector<double> run_ring(int orders, int spinMicros) {
+    const uint32_t capacity = 1024;
+    size_t size = ShmLayout::segmentSize(capacity, capacity);
+    int mem_fd = memfd_create("bench_shm", MFD_CLOEXEC);
+    if (mem_fd < 0 || ftruncate(mem_fd, static_cast<off_t>(size)) != 0) {
+        std::cerr << "memfd_create/ftruncate : " << strerror(errno) << "\n";
+        return {};
+    }
+    // Deux projections du même memfd, comme entre deux processus.
+    void* server_map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, 0);
+    void* client_map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, 0);
+    auto* header = new (server_map) ShmSegmentHeader();
+    header->orderCapacity = capacity;
+    header->reportCapacity = capacity;
+    int order_doorbell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int report_doorbell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    auto make_rings = [&](void* map, ShmRing<ShmOrderRecord>& orders_ring, ShmRing<ShmReportRecord>& reports_ring) {
+        auto* h = static_cast<ShmSegmentHeader*>(map);
+        auto* base = static_cast<char*>(map);
+        orders_ring = ShmRing<ShmOrderRecord>(&h->orders, reinterpret_cast<ShmOrderRecord*>(base + ShmLayout::ordersOffset()), capacity);
+        reports_ring = ShmRing<ShmReportRecord>(&h->reports, reinterpret_cast<ShmReportRecord*>(base + ShmLayout::reportsOffset(capacity)), capacity);
+    };
+
+    std::atomic<bool> running(true);
+    std::thread gateway([&]() {
+        ShmRing<ShmOrderRecord> orders_ring;
+        ShmRing<ShmReportRecord> reports_ring;
+        make_rings(server_map, orders_ring, reports_ring);
+        ShmOrderRecord order;
+        while (wait_pop(orders_ring, order, order_doorbell, spinMicros, running)) {
+            ShmReportRecord report;
+            report.clientOrderId = order.clientOrderId;
+            report.side = order.side;
+            report.quantity = order.quantity;
+            push_and_ring(reports_ring, report, report_doorbell);
+        }
+    });
+
+    ShmRing<ShmOrderRecord> orders_ring;
+    ShmRing<ShmReportRecord> reports_ring;
+    make_rings(client_map, orders_ring, reports_ring);
+    std::vector<double> samples;
+    samples.reserve(orders);
+    for (int i = 0; i < orders; ++i) {
+        ShmOrderRecord order;
+        order.clientOrderId = static_cast<uint64_t>(i) + 1;
+        order.side = static_cast<uint8_t>(ShmLayout::Side::BUY);
+        order.quantity = 0.001;
+        auto start = Clock::now();
+        push_and_ring(orders_ring, order, order_doorbell);
+        ShmReportRecord report;
+        if (!wait_pop(reports_ring, report, report_doorbell, spinMicros, running) || report.clientOrderId != order.clientOrderId) {
+            std::cerr << "Rapport inattendu pour l'ordre " << order.clientOrderId << "\n";
+            break;
+        }
+        samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    running.store(false);
+    uint64_t one = 1;
+    (void)!::write(order_doorbell, &one, sizeof(one));
+    gateway.join();
+
+    munmap(server_map, size);
+    munmap(client_map, size);
+    close(mem_fd);
+    close(order_doorbell);
+    close(report_doorbell);
+    return samples;
+}
+
+// Référence : même aller-retour (64 octets aller, 128 retour) sur une paire de sockets Unix bloquants.
+static std::vector<double> run_socketpair(int orders) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+        std::cerr << "socketpair : " << strerror(errno) << "\n";
+        return {};
+    }
+    std::thread echo([&]() {
+        ShmOrderRecord order;
+        ShmReportRecord report;
+        while (recv(fds[1], &order, sizeof(order), MSG_WAITALL) == static_cast<ssize_t>(sizeof(order))) {
+            report.clientOrderId = order.clientOrderId;
+            send(fds[1], &report, sizeof(report), MSG_NOSIGNAL);
+        }
+    });
+    std::vector<double> samples;
+    samples.reserve(orders);
+    for (int i = 0; i < orders; ++i) {
+        ShmOrderRecord order;
+        order.clientOrderId = static_cast<uint64_t>(i) + 1;
+        ShmReportRecord report;
+        auto start = Clock::now();
+        send(fds[0], &order, sizeof(order), MSG_NOSIGNAL);
+        recv(fds[0], &report, sizeof(report), MSG_WAITALL);
+        samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    shutdown(fds[0], SHUT_WR);
+    echo.join();
+    close(fds[0]);
+    close(fds[1]);
+    return samples;
+}
+
+// --- Mode "server" ---
+static int run_server(const std::string& socketPath, const std::string& clientId, int orders, const std::string& password) {
+    ShmOrderClient client;
+    if (!client.connect(socketPath, clientId, password)) {
+        std::cerr << "Connexion à la passerelle impossible (voir les logs).\n";
+        return 1;
+    }
+    std::vector<double> samples;
+    samples.reserve(orders);
+    int completed = 0, failed = 0;
+    for (int i = 0; i < orders; ++i) {
+        // Achats et ventes alternés de petites quantités : le solde du portefeuille reste stable.
+        ShmLayout::Side side = (i % 2 == 0) ? ShmLayout::Side::BUY : ShmLayout::Side::SELL;
+        uint64_t id = static_cast<uint64_t>(i) + 1;
+        auto start = Clock::now();
+        if (!client.submit(id, side, 0.0001)) {
+            std::cerr << "Anneau des ordres plein ou canal fermé.\n";
+            break;
+        }
+        ShmReportRecord report;
+        if (!client.waitReport(report, 5000)) {
+            std::cerr << "Pas de rapport pour l'ordre " << id << " après 5 s.\n";
+            break;
+        }
+        samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        if (report.clientOrderId != id) {
+            std::cerr << "Rapport hors séquence : " << report.clientOrderId << " (attendu " << id << ").\n";
+            break;
+        }
+        // La raison n'est renseignée que pour un ordre refusé (TransactionStatus::FAILED).
+        if (report.reason[0] == '\0') {
+            ++completed;
+        } else {
+            ++failed;
+        }
+    }
+    print_percentiles("passerelle -> TQ -> rapport", samples);
+    std::cout << "Exécutés : " << completed << ", refusés : " << failed << "\n";
+    client.close();
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "ring";
+    if (mode == "ring") {
+        int orders = argc > 2 ? std::atoi(argv[2]) : 100000;
+        std::cout << "Aller-retour ordre -> rapport, " << orders << " ordres, un seul ordre en vol :\n";
+        if (std::thread::hardware_concurrency() < 2) {
+            std::cout << "(un seul coeur : les deux threads ne peuvent pas attendre activement en même temps, résultats pessimistes)\n";
+        }
+        auto spin = run_ring(orders, 50);
+        print_percentiles("anneau (attente 50 us)", spin);
+        auto doorbell = run_ring(orders, 0);
+        print_percentiles("anneau (eventfd)", doorbell);
+        auto sockets = run_socketpair(orders);
+        print_percentiles("socketpair AF_UNIX", sockets);
+        return 0;
+    }
+    if (mode == "server" && argc > 3) {
+        int orders = argc > 4 ? std::atoi(argv[4]) : 2000;
+        return run_server(argv[2], argv[3], orders, argc > 5 ? argv[5] : "");
+    }
+    std::cerr << "Usage : " << argv[0] << " ring [ordres] | server <socket Unix> <ID client> [ordres] [mot de passe]\n";
+    return 1;
+}
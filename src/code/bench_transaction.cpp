@@ -4,19 +4,36 @@
 #include <chrono>
 #include <atomic>
 #include <mutex>
+#include <string>
+#include <algorithm>
+#include <unordered_map>
+#include <sys/resource.h>
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 #include "../headers/ServerConnection.h"
 #include "../headers/ClientInitiator.h"
+#include "../headers/BinaryProtocol.h"
 
 constexpr const char* SERVER_IP = "127.0.0.1";
 constexpr int SERVER_PORT = 4433;
-constexpr int NUM_CLIENTS = 3;
+// Nombre de connexions clientes. Les 3 comptes fixes de 'credentials' par défaut ; avec un nombre donné en
+// argument, un compte distinct par connexion ("bench<i>", jeton "pwbench<i>", créé à la première connexion).
+int num_clients = 3;
+bool distinct_accounts = false;
 constexpr int TRANSACTIONS_PER_CLIENT = 100;
+// Nombre d'ordres en vol par connexion (mode PIPELINE). 1 = un aller-retour par ordre, comme avant.
+int pipeline_window = 64;
+// Protocole binaire (BinaryProtocol) au lieu des commandes texte préfixées par "#<id>".
+bool use_binary = false;
+// Chemin du socket Unix du serveur (ServerOptions::unixSocketPath) : connexion locale en clair au lieu de TLS.
+std::string unix_socket_path;
 
 std::atomic<int> successful_transactions(0);
 std::atomic<int> failed_transactions(0);
 std::mutex cout_mutex;
+// Latence envoi -> TRANSACTION_RESULT de chaque ordre réussi (microsecondes), tous clients confondus.
+std::vector<double> latencies_us;
+std::mutex latencies_mutex;
 #include <fstream>
 
 void save_results_to_csv(const std::string& filename, int num_transactions, double tps, double duration, int success, int fail) {
@@ -45,35 +62,105 @@ void send_transactions(int client_id, SSL_CTX* ctx) {
     };
 
     try {
-        connection = clientInitiator.ConnectToServer(SERVER_IP, SERVER_PORT, ctx);
+        connection = unix_socket_path.empty() ? clientInitiator.ConnectToServer(SERVER_IP, SERVER_PORT, ctx)
+                                              : clientInitiator.ConnectToUnixSocket(unix_socket_path);
         if (!connection || !connection->isConnected()) {
             throw std::runtime_error("Failed to connect to server");
         }
 
         // Authentification avec l'ID et le token
-        const auto& [id, token] = credentials[client_id % credentials.size()];
+        std::string generated_id = "bench" + std::to_string(client_id);
+        const auto& [id, token] = distinct_accounts ? std::make_pair(generated_id, "pw" + generated_id)
+                                                    : credentials[client_id % credentials.size()];
         std::string authMessage = "ID:" + id + ",TOKEN:" + token + "\n";
         connection->send(authMessage);
 
         std::string authResponse = connection->receiveLine();
-        if (authResponse.find("AUTH SUCCESS") == std::string::npos) {
+        if (authResponse.find("AUTH SUCCESS") == std::string::npos && authResponse.find("AUTH NEW") == std::string::npos) {
             throw std::runtime_error("Authentication failed: " + authResponse);
         }
 
-        // Envoi des transactions après authentification réussie
-        for (int i = 0; i < TRANSACTIONS_PER_CLIENT; ++i) {
-            std::string transaction = (i % 2 == 0) ? "BUY SRD-BTC 5\n" : "SELL SRD-BTC 5\n";
-            try {
-                connection->send(transaction);
+        // Mode pipeline : chaque ordre porte un identifiant "#<id>" repris par le serveur dans ses réponses,
+        // ce qui permet de garder 'pipeline_window' ordres en vol sans attendre chaque TRANSACTION_RESULT.
+        // En protocole binaire, l'identifiant est dans l'en-tête de chaque trame.
+        if (use_binary) {
+            if (!clientInitiator.EnableBinaryProtocol(*connection)) {
+                throw std::runtime_error("Binary protocol refused");
+            }
+        } else {
+            connection->send("PIPELINE ON\n");
+            std::string pipelineResponse = connection->receiveLine();
+            if (pipelineResponse.rfind("OK", 0) != 0) {
+                throw std::runtime_error("Pipeline mode refused: " + pipelineResponse);
+            }
+        }
+
+        using Clock = std::chrono::steady_clock;
+        std::unordered_map<uint64_t, Clock::time_point> in_flight; // Ordre en vol -> instant d'envoi
+        std::vector<double> local_latencies;
+        auto complete = [&](uint64_t id, bool success) {
+            auto it = in_flight.find(id);
+            if (it == in_flight.end()) {
+                return;
+            }
+            if (success) {
+                local_latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - it->second).count());
+                successful_transactions++;
+            } else {
+                failed_transactions++;
+            }
+            in_flight.erase(it);
+        };
+        uint64_t next_id = 1;
+        int sent = 0;
+        try {
+            while (sent < TRANSACTIONS_PER_CLIENT || !in_flight.empty()) {
+                // Remplir la fenêtre d'ordres en vol.
+                while (sent < TRANSACTIONS_PER_CLIENT && static_cast<int>(in_flight.size()) < pipeline_window) {
+                    uint64_t id = next_id++;
+                    std::string transaction;
+                    if (use_binary) {
+                        BinaryProtocol::encodeOrder(transaction, (sent % 2 == 0) ? BinaryProtocol::MessageType::BUY : BinaryProtocol::MessageType::SELL, id, "SRD-BTC", 5.0);
+                    } else {
+                        transaction = "#" + std::to_string(id) + ((sent % 2 == 0) ? " BUY SRD-BTC 5\n" : " SELL SRD-BTC 5\n");
+                    }
+                    auto sent_at = Clock::now();
+                    connection->send(transaction);
+                    in_flight.emplace(id, sent_at);
+                    sent++;
+                }
+
+                // Lire une réponse et la rattacher à son ordre grâce à l'identifiant.
+                if (use_binary) {
+                    BinaryProtocol::FrameHeader header;
+                    std::string_view body;
+                    connection->receiveFrame(header, body);
+                    if (header.type == BinaryProtocol::MessageType::TRANSACTION_RESULT) {
+                        complete(header.requestId, true);
+                    } else if (header.type == BinaryProtocol::MessageType::ERROR_TEXT) {
+                        complete(header.requestId, false);
+                    }
+                    continue;
+                }
                 std::string response = connection->receiveLine();
+                if (response.empty() || response[0] != '#') {
+                    continue; // Ligne sans identifiant (ex: résultat d'un ordre de bot).
+                }
+                uint64_t id = std::stoull(response.substr(1));
                 if (response.find("TRANSACTION_RESULT") != std::string::npos) {
-                    successful_transactions++;
-                } else {
-                    failed_transactions++;
+                    complete(id, true);
+                } else if (response.find("ERROR") != std::string::npos) {
+                    // Ordre refusé avant la TQ : pas de TRANSACTION_RESULT à attendre.
+                    complete(id, false);
                 }
-            } catch (...) {
-                failed_transactions++;
+                // Les accusés "OK: ... submitted" ne libèrent pas la fenêtre.
             }
+        } catch (...) {
+            failed_transactions += static_cast<int>(in_flight.size()) + (TRANSACTIONS_PER_CLIENT - sent);
+        }
+        {
+            std::lock_guard<std::mutex> lock(latencies_mutex);
+            latencies_us.insert(latencies_us.end(), local_latencies.begin(), local_latencies.end());
         }
 
         connection->closeConnection();
@@ -84,7 +171,40 @@ void send_transactions(int client_id, SSL_CTX* ctx) {
     }
 }
 
-int main() {
+// Percentile (0-100) d'un échantillon trié.
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+double cpu_seconds(const rusage& usage) {
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+    // ./bench_transaction [fenêtre] [binary|text] [socket Unix|tls] [clients] : nombre d'ordres en vol par connexion
+    // (défaut 64), protocole binaire, connexion locale en clair (ex: trading.sock) pour mesurer le coût de TLS, et
+    // nombre de clients (un compte chacun).
+    // Passage à l'échelle de la TransactionQueue : avec assez de comptes (ex: 32), relancer le serveur avec
+    // ServerOptions::txQueueShards = 1, 2, 4... ; les ordres de comptes différents sont traités en parallèle.
+    // Avec une fenêtre de 1, les percentiles de latence mesurent l'aller-retour d'un ordre isolé : c'est le
+    // réglage pour comparer le profil faible latence du serveur (ServerOptions::lowLatency) activé/désactivé.
+    // Le temps CPU affiché est celui du benchmark ; celui du serveur se lit avec "time" ou /proc/<pid>/stat.
+    if (argc > 1) {
+        pipeline_window = std::max(1, std::stoi(argv[1]));
+    }
+    use_binary = (argc > 2 && std::string(argv[2]) == "binary");
+    if (argc > 3 && std::string(argv[3]) != "tls") {
+        unix_socket_path = argv[3];
+    }
+    if (argc > 4) {
+        num_clients = std::max(1, std::stoi(argv[4]));
+        distinct_accounts = true;
+    }
+
     SSL_library_init();
     SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
     if (!ctx) {
@@ -95,7 +215,7 @@ int main() {
     std::vector<std::thread> threads;
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    for (int i = 0; i < NUM_CLIENTS; ++i) {
+    for (int i = 0; i < num_clients; ++i) {
         threads.emplace_back(send_transactions, i, ctx);
     }
 
@@ -109,12 +229,22 @@ int main() {
     double tps = successful_transactions / duration.count();
 
     std::cout << "=== Benchmark Results ===" << std::endl;
-    std::cout << "Total Transactions: " << NUM_CLIENTS * TRANSACTIONS_PER_CLIENT << std::endl;
+    std::cout << "Pipeline window: " << pipeline_window << (use_binary ? " (binary protocol)" : " (text protocol)")
+              << (unix_socket_path.empty() ? " over TLS" : " over unix socket " + unix_socket_path) << std::endl;
+    std::cout << "Clients: " << num_clients << (distinct_accounts ? " (one account each)" : "") << std::endl;
+    std::cout << "Total Transactions: " << num_clients * TRANSACTIONS_PER_CLIENT << std::endl;
     std::cout << "Successful Transactions: " << successful_transactions.load() << std::endl;
     std::cout << "Failed Transactions: " << failed_transactions.load() << std::endl;
     std::cout << "Duration: " << duration.count() << " seconds" << std::endl;
     std::cout << "Transactions Per Second (TPS): " << tps << std::endl;
 
+    std::sort(latencies_us.begin(), latencies_us.end());
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << "Latency (us): p50 " << percentile(latencies_us, 50) << ", p99 " << percentile(latencies_us, 99)
+              << ", p99.9 " << percentile(latencies_us, 99.9) << ", max " << (latencies_us.empty() ? 0.0 : latencies_us.back()) << std::endl;
+    std::cout << "Benchmark CPU time: " << cpu_seconds(usage) << " s (" << 100.0 * cpu_seconds(usage) / duration.count() << "% of one core)" << std::endl;
+
     SSL_CTX_free(ctx);
     return 0;
 }
\ No newline at end of file
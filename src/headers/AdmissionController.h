@@ -0,0 +1,120 @@
+#ifndef ADMISSION_CONTROLLER_H
+#define ADMISSION_CONTROLLER_H
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "Logger.h"
+
+// --- Réglages du contrôle d'admission (voir ServerOptions) ---
+// Toutes les limites valent 0 par défaut (= pas de limite) : le comportement historique est conservé.
+struct AdmissionConfig {
+    // Connexions TLS ouvertes simultanément (de accept() à la fermeture), tous clients confondus.
+    int maxConnections = 0;
+    // Connexions TLS ouvertes simultanément depuis une même adresse IP.
+    int maxConnectionsPerIp = 0;
+    // Seau à jetons sur les acceptations : débit moyen (connexions / s) et rafale tolérée
+    // (0 = égale au débit, au moins 1).
+    double acceptRatePerSec = 0.0;
+    int acceptBurst = 0;
+    // Connexions en cours d'établissement (handshake TLS puis authentification). Au-delà, le serveur est
+    // SURCHARGÉ : il ne prend plus de nouveau travail tant que celui en cours n'a pas avancé.
+    int maxPendingConnections = 0;
+};
+
+// État de charge rapporté par le serveur.
+enum class OverloadState {
+    NORMAL,     // Sous 75 % de toutes les limites configurées
+    ELEVATED,   // Une limite est utilisée à 75 % ou plus : tout est encore admis
+    OVERLOADED  // Limite globale ou limite des connexions en cours atteinte : les nouvelles connexions sont refusées
+};
+
+// Décision pour une connexion qui vient d'être acceptée.
+enum class AdmissionVerdict {
+    ADMITTED,
+    GLOBAL_LIMIT,
+    PER_IP_LIMIT,
+    RATE_LIMITED,
+    OVERLOADED
+};
+
+std::string overloadStateToString(OverloadState state);
+std::string admissionVerdictToString(AdmissionVerdict verdict);
+
+struct AdmissionStats {
+    uint64_t admitted = 0;
+    uint64_t shedGlobalLimit = 0;
+    uint64_t shedPerIpLimit = 0;
+    uint64_t shedRateLimited = 0;
+    uint64_t shedOverloaded = 0;
+    size_t openConnections = 0;    // Admises et pas encore fermées
+    size_t pendingConnections = 0; // Parmi elles, pas encore authentifiées
+    size_t peakOpenConnections = 0;
+    OverloadState state = OverloadState::NORMAL;
+};
+
+// --- Classe AdmissionController ---
+// Décide, juste après accept() et AVANT tout travail TLS (SSL_new, handshake), si une connexion est
+// prise en charge. Un refus coûte un close() : sous une charge excessive, le serveur continue de servir
+// les connexions déjà admises au lieu de s'effondrer en handshakes et authentifications sans fin.
+//
+// Les connexions admises sont suivies par descripteur jusqu'à leur fermeture. Règle impérative pour
+// l'appelant : release(fd) est appelé AVANT close(fd) (sinon le numéro pourrait être réattribué à une
+// nouvelle connexion entre-temps et libéré à sa place).
+//
+// Thread-safe : appelé par les threads d'acceptation, de handshake, de l'exécuteur et du réacteur.
+class AdmissionController {
+public:
+    explicit AdmissionController(const AdmissionConfig& config);
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    // Connexion acceptée sur 'fd' depuis l'adresse IPv4 'ip' (ordre réseau). ADMITTED : la connexion est
+    // comptée jusqu'à release(fd) ; sinon l'appelant la ferme immédiatement (voir refuse()).
+    AdmissionVerdict admit(int fd, uint32_t ip);
+    // Handshake et authentification terminés : la connexion ne compte plus dans les connexions en cours.
+    void markEstablished(int fd);
+    // La connexion va être fermée. Sans effet pour un fd non admis (déjà libéré, socket Unix, ...).
+    void release(int fd);
+
+    // Fermeture d'une connexion refusée : RST (SO_LINGER 0) plutôt qu'une fermeture normale, le serveur
+    // ne garde ainsi aucun socket en TIME_WAIT pour les connexions rejetées.
+    static void refuse(int fd);
+
+    OverloadState getState() const;
+    AdmissionStats getStats() const;
+    bool isEnabled() const;
+    void logStats() const;
+
+private:
+    struct Tracked {
+        uint32_t ip = 0;
+        bool established = false;
+    };
+
+    // À appeler sous 'mutex'.
+    bool takeToken(std::chrono::steady_clock::time_point now);
+    OverloadState computeState() const;
+    void updateState();
+    void recordShed(AdmissionVerdict verdict);
+
+    AdmissionConfig config;
+    double bucketCapacity;
+
+    mutable std::mutex mutex;
+    std::unordered_map<int, Tracked> connections;    // Par descripteur
+    std::unordered_map<uint32_t, int> perIpCount;     // Connexions ouvertes par adresse
+    size_t pendingCount = 0;
+    double tokens;
+    std::chrono::steady_clock::time_point lastRefill;
+    OverloadState state = OverloadState::NORMAL;
+    uint64_t consecutiveSheds = 0; // Refus depuis la dernière admission (journalisation des épisodes)
+    AdmissionStats stats;
+};
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef BINARY_PROTOCOL_H
+#define BINARY_PROTOCOL_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+#include "LineFramer.h"
+
+// --- Protocole binaire à trames préfixées par leur longueur ---
+// Alternative compacte au protocole texte, négociée APRÈS l'authentification par la commande texte
+// "BINARY ON" (réponse texte "OK: ..."). À partir de là, et pour toute la durée de la connexion, les
+// deux sens n'échangent plus que des trames binaires. Le protocole texte reste le défaut.
+//
+// Trame = en-tête fixe de HEADER_SIZE octets + corps dont la disposition dépend du type.
+// Les requêtes ont un corps de taille FIXE ; seules les réponses ERROR_TEXT/TEXT et la raison d'un
+// TRANSACTION_RESULT ont une partie texte de longueur variable. Entiers et doubles (IEEE 754) sont
+// transmis en ordre réseau (big-endian).
+//
+// Le décodage se fait sur des vues (std::string_view) du buffer de réception : aucune allocation.
+// Les fonctions encode* ajoutent une trame complète à la fin d'une std::string.
+namespace BinaryProtocol {
+
+constexpr uint8_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 16;
+// Taille maximale d'une trame (en-tête compris) : bornée par le tampon de travail du LineFramer.
+constexpr size_t MAX_FRAME_SIZE = 4096;
+constexpr size_t SYMBOL_SIZE = 16;
+constexpr size_t TRANSACTION_ID_SIZE = 40;
+
+enum class MessageType : uint8_t {
+    // Client -> serveur
+    BUY = 0x01,
+    SELL = 0x02,
+    GET_PRICE = 0x03,
+    SHOW = 0x04,
+    QUIT = 0x05,
+    // Heartbeat, dans les deux sens (corps vide) : PING appelle un PONG reprenant le même requestId.
+    PING = 0x06,
+    PONG = 0x07,
+    // Serveur -> client
+    ACK = 0x81,                // Commande acceptée (corps vide)
+    ERROR_TEXT = 0x82,         // Commande refusée (corps = message texte)
+    PRICE = 0x83,
+    WALLET = 0x84,
+    TRANSACTION_RESULT = 0x85,
+    TEXT = 0x86                // Réponse texte libre (ex: historique des transactions)
+};
+
+enum class ShowTarget : uint8_t { WALLET = 1, TRANSACTIONS = 2 };
+
+// --- En-tête (16 octets) ---
+//  0: uint32 length    taille totale de la trame, en-tête compris
+//  4: uint8  type      MessageType
+//  5: uint8  version   VERSION
+//  6: uint16 reserved  0
+//  8: uint64 requestId choisi par le client (0 = aucun), repris dans les réponses
+struct FrameHeader {
+    uint32_t length = 0;
+    MessageType type = MessageType::ACK;
+    uint8_t version = VERSION;
+    uint16_t reserved = 0;
+    uint64_t requestId = 0;
+};
+
+// --- Corps de taille fixe ---
+// Les symboles sont complétés par des '\0' (SYMBOL_SIZE octets, pas forcément terminés par '\0').
+
+// BUY / SELL (24 octets) : symbol[16], double percentage (0 < p <= 100).
+struct OrderBody {
+    char symbol[SYMBOL_SIZE] = {};
+    double percentage = 0.0;
+};
+constexpr size_t ORDER_BODY_SIZE = SYMBOL_SIZE + 8;
+
+// GET_PRICE (16 octets) : symbol[16].
+struct SymbolBody {
+    char symbol[SYMBOL_SIZE] = {};
+};
+constexpr size_t SYMBOL_BODY_SIZE = SYMBOL_SIZE;
+
+// SHOW (8 octets) : uint8 target (ShowTarget), 7 octets réservés.
+struct ShowBody {
+    ShowTarget target = ShowTarget::WALLET;
+};
+constexpr size_t SHOW_BODY_SIZE = 8;
+
+// PRICE (24 octets) : symbol[16], double price.
+struct PriceBody {
+    char symbol[SYMBOL_SIZE] = {};
+    double price = 0.0;
+};
+constexpr size_t PRICE_BODY_SIZE = SYMBOL_SIZE + 8;
+
+// WALLET (16 octets) : double usd, double srdBtc.
+struct WalletBody {
+    double usd = 0.0;
+    double srdBtc = 0.0;
+};
+constexpr size_t WALLET_BODY_SIZE = 16;
+
+// TRANSACTION_RESULT (48 octets + raison) : transactionId[40], uint8 status (TransactionStatus),
+// 7 octets réservés, puis la raison de l'échec (texte, éventuellement vide) jusqu'à la fin de la trame.
+struct TransactionResultBody {
+    char transactionId[TRANSACTION_ID_SIZE] = {};
+    uint8_t status = 0;
+};
+constexpr size_t TRANSACTION_RESULT_BODY_SIZE = TRANSACTION_ID_SIZE + 8;
+
+// --- Extraction d'une trame du buffer de réception ---
+enum class DecodeStatus {
+    FRAME,     // Trame complète : 'header' et 'body' sont remplis
+    NEED_MORE, // Trame incomplète pour l'instant
+    INVALID    // En-tête invalide (version, taille) : flux inutilisable, fermer la connexion
+};
+// 'body' est une vue sur le buffer du framer, valide jusqu'au prochain appel non const du framer.
+DecodeStatus nextFrame(LineFramer& framer, FrameHeader& header, std::string_view& body);
+
+// --- Décodage des corps (sans allocation). Retournent false si la taille ne correspond pas. ---
+bool decodeOrder(std::string_view body, OrderBody& order);
+bool decodeSymbol(std::string_view body, SymbolBody& symbol);
+bool decodeShow(std::string_view body, ShowBody& show);
+bool decodePrice(std::string_view body, PriceBody& price);
+bool decodeWallet(std::string_view body, WalletBody& wallet);
+// 'reason' : vue sur la partie texte qui suit le corps fixe.
+bool decodeTransactionResult(std::string_view body, TransactionResultBody& result, std::string_view& reason);
+
+// Vue sur un champ symbole/identifiant (jusqu'au premier '\0').
+std::string_view fieldView(const char* field, size_t size);
+
+// --- Encodage (ajoute une trame complète à 'out') ---
+void encodeOrder(std::string& out, MessageType side, uint64_t requestId, std::string_view symbol, double percentage);
+void encodeGetPrice(std::string& out, uint64_t requestId, std::string_view symbol);
+void encodeShow(std::string& out, uint64_t requestId, ShowTarget target);
+void encodeQuit(std::string& out, uint64_t requestId);
+// type = PING ou PONG.
+void encodeHeartbeat(std::string& out, MessageType type, uint64_t requestId);
+
+void encodeAck(std::string& out, uint64_t requestId);
+// type = ERROR_TEXT ou TEXT. Le texte est tronqué si la trame dépasse MAX_FRAME_SIZE.
+void encodeText(std::string& out, MessageType type, uint64_t requestId, std::string_view text);
+void encodePrice(std::string& out, uint64_t requestId, std::string_view symbol, double price);
+void encodeWallet(std::string& out, uint64_t requestId, double usd, double srdBtc);
+void encodeTransactionResult(std::string& out, uint64_t requestId, std::string_view transactionId, uint8_t status, std::string_view reason);
+
+// Représentation texte lisible d'une trame reçue (affichage côté client, logs).
+std::string describe(const FrameHeader& header, std::string_view body);
+
+} // namespace BinaryProtocol
+
+#endif
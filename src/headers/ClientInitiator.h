@@ -11,6 +11,7 @@
 #include "OpenSSLDeleters.h"
 #include "Logger.h"
 #include "Utils.h"
+#include "LowLatency.h"
 
 // --- Classe ClientInitiator ---
 // Gère l'initiation des connexions sortantes et le handshake SSL côté client.
@@ -30,8 +31,27 @@ public:
     // Retourne un shared_ptr vers un objet ServerConnection si succès, nullptr sinon.
     std::shared_ptr<ServerConnection> ConnectToServer(const std::string& host, int port, SSL_CTX* ctx_raw);
 
+    // Se connecte en clair au socket Unix local du serveur (ServerOptions::unixSocketPath), sans handshake.
+    // Le serveur identifie le processus par SO_PEERCRED : le mot de passe peut être vide pour le compte lié à
+    // l'UID du processus (ServerOptions::unixPeerAccounts), il est exigé pour tout autre compte.
+    // Retourne un shared_ptr vers un objet ServerConnection si succès, nullptr sinon.
+    std::shared_ptr<ServerConnection> ConnectToUnixSocket(const std::string& path);
+
+    // Négocie le protocole binaire (BinaryProtocol) sur une connexion authentifiée : envoie "BINARY ON"
+    // et attend l'accusé texte du serveur. Ensuite, utiliser BinaryProtocol::encode* + send() et receiveFrame().
+    // Retourne true si le serveur a accepté.
+    bool EnableBinaryProtocol(ServerConnection& connection);
+
+    // Réglages appliqués aux prochains sockets TCP de ConnectToServer (voir LowLatency.h).
+    // Par défaut TCP_NODELAY est actif : un ordre est une petite requête suivie d'une attente de réponse,
+    // exactement le cas où Nagle + ACK retardé ajoutent des dizaines de millisecondes.
+    void SetSocketTuning(bool tcpNoDelay, int busyPollMicros);
+
     // Le destructeur par défaut est suffisant.
 
+private:
+    bool tcpNoDelay = true;
+    int busyPollMicros = 0;
 }; 
 
 #endif 
\ No newline at end of file
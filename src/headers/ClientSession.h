@@ -2,10 +2,15 @@
 #define CLIENTSESSION_H
 
 #include <string>
+#include <string_view>
 #include <memory> 
 #include <atomic> 
 #include <thread> 
 #include <mutex> 
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 
 #include "Global.h"     
 #include "Server.h"     
@@ -13,6 +18,11 @@
 #include "Bot.h"       
 #include "TransactionQueue.h" 
 #include "Transaction.h" 
+#include "BinaryProtocol.h"
+#include "ShmGateway.h"
+#include "PriceFeed.h"
+
+class Server; // Server.h inclut ce fichier
 
 
 // ClientSession gère la session d'un client connecté, son authentification,
@@ -35,8 +45,59 @@ public:
     // La boucle principale d'exécution de la session (dans son propre thread)
     void run(); // Exécute sessionLoop
 
-    // Traite une commande reçue du client (ex: SHOW WALLET, BUY ...)
-    void processClientCommand(const std::string& command);
+    // --- Mode réacteur (SessionReactor) ---
+    // Prépare la session à être pilotée par un thread d'E/S du réacteur au lieu de son propre thread :
+    // passe le socket en non bloquant et marque la session comme active. Appelée par Server.
+    bool startInReactor();
+    // Appelée par le thread d'E/S quand le socket est lisible. Draine la connexion SSL
+    // et traite les commandes complètes. Retourne false si la session doit être fermée.
+    bool onReadable();
+    // Appelée périodiquement (mode thread) : appel du bot si l'intervalle est écoulé.
+    // Retourne false si la session doit être fermée.
+    bool onTick();
+    // Appelée à chaque échéance du timer du bot (mode réacteur, toutes les BOT_CALL_INTERVAL) :
+    // appel du bot s'il est actif. Retourne false si la session doit être fermée.
+    bool onBotTimer();
+
+    // --- Inactivité et heartbeats ---
+    // Délais appliqués à la session (0 = désactivé), fixés par le Server avant le démarrage.
+    // idleTimeout : fermeture si le client n'envoie rien pendant ce délai (pair mort, client inactif).
+    // heartbeatInterval : envoi d'un PING après ce délai sans activité (puis à chaque intervalle) ;
+    // la réponse PONG (comme toute commande) compte comme une activité.
+    void setIdlePolicy(std::chrono::milliseconds idleTimeout, std::chrono::milliseconds heartbeatInterval);
+
+    // Passerelle d'ordres en mémoire partagée du serveur (nullptr = désactivée), pour la commande "SHM ATTACH".
+    // Le canal éventuel est fermé avec la session.
+    void setShmGateway(ShmGateway* gateway);
+
+    // Flux de prix du serveur, pour "SUBSCRIBE PRICE <symbole>" (nullptr = indisponible). Les abonnements
+    // appartiennent à la connexion et sont retirés à l'arrêt de la session.
+    void setPriceFeed(PriceFeed* feed);
+
+    // --- Canaux multiplexés ---
+    // Une connexion authentifiée peut porter les sessions d'autres comptes ("CHANNEL OPEN <n> <id> <mot de passe>") :
+    // leurs commandes s'écrivent "@<n> <commande>" et chaque ligne de leurs réponses (TRANSACTION_RESULT compris)
+    // est préfixée par "@<n> ". La session principale lit la connexion et transmet ces commandes à la session du canal.
+    // Serveur qui authentifie les canaux et nombre maximal de canaux (0 = commande CHANNEL refusée), fixés par le Server.
+    void setChannelHost(Server* server, size_t maxChannels);
+    // Démarre la session comme canal 'channelId' d'une connexion pilotée par une autre session : pas de
+    // thread ni de lecture propres, et stop() ne ferme pas la connexion partagée. Appelée par le Server.
+    void startAsChannel(uint32_t channelId);
+    uint32_t getChannelId() const; // 0 = session principale de sa connexion
+    struct IdleCheck {
+        bool expired = false;                      // true : session inactive (ou terminée) à fermer
+        std::chrono::milliseconds nextCheck{0};    // Délai avant la prochaine vérification (0 = aucune)
+    };
+    // Vérifie l'inactivité à l'instant 'now' et envoie un PING si nécessaire. Appelée par le timer
+    // d'inactivité du réacteur, ou par la boucle de session en mode thread.
+    IdleCheck checkIdle(std::chrono::steady_clock::time_point now);
+
+    // Fréquence d'appel du bot (légèrement > fréquence de prix).
+    static constexpr std::chrono::seconds BOT_CALL_INTERVAL{16};
+
+    // Traite une commande reçue du client (ex: SHOW WALLET, BUY ...).
+    // 'command' est une vue sur le buffer de réception : valide uniquement pendant l'appel.
+    void processClientCommand(std::string_view command);
 
     // Gère la requête de trading manuelle du client. Calcule la quantité réelle et soumet à la TQ.
     // 'value' est soit un pourcentage soit une quantité.
@@ -44,7 +105,13 @@ public:
 
     // Appelée par la TransactionQueue lorsqu'une transaction est appliquée pour ce client.
     // Notifie le bot si présent, et envoie le résultat au client.
-    void applyTransactionRequest(const Transaction& tx);
+    // 'requestId' : identifiant de la commande d'origine en mode pipeline (0 = aucun, ex: ordre du bot).
+    void applyTransactionRequest(const Transaction& tx, uint64_t requestId = 0);
+
+    // Appelée par la TransactionQueue pour les ordres à cours limité : ligne ORDER_STATUS (résultat d'un
+    // LIMIT/IOC/FOK/CANCEL, 'requestId' de la commande d'origine) ou ORDER_FILL (exécution d'un ordre au
+    // repos, requestId 0). 'line' sans '\n' final.
+    void applyOrderStatus(const std::string& line, uint64_t requestId = 0);
 
     // --- Méthodes spécifiques au bot ---
     // Appelée suite à la commande client "START BOT <K>". Crée et démarre l'objet Bot.
@@ -68,6 +135,55 @@ private:
     // La méthode principale exécutée par le thread de la session (contient la boucle de réception réseau)
     void sessionLoop();
 
+    // Extrait et traite chaque commande complète ('\n') déjà présente dans le buffer de réception
+    // de la connexion. Retourne false si le flux est invalide (ligne trop longue).
+    bool drainCommands();
+
+    // Envoie une réponse à la commande en cours (préfixée par "#<id> " en mode pipeline,
+    // dans une trame ERROR_TEXT/TEXT en protocole binaire).
+    void reply(const std::string& message);
+
+    // Traite une trame du protocole binaire (BUY/SELL/GET_PRICE/SHOW/QUIT).
+    // 'body' est une vue sur le buffer de réception : valide uniquement pendant l'appel.
+    void processBinaryFrame(const BinaryProtocol::FrameHeader& header, std::string_view body);
+
+    // --- Commandes texte ---
+    // Verbe résolu par CommandTable::lookup puis traité par commandHandlers[verbe] (voir ClientSession.cpp).
+    struct CommandContext;
+    using CommandHandler = void (ClientSession::*)(CommandContext&);
+    static const CommandHandler commandHandlers[];
+    void handleQuit(CommandContext& ctx);
+    void handleShow(CommandContext& ctx);
+    void handleExport(CommandContext& ctx);
+    void handleShm(CommandContext& ctx);
+    void handleGetPrice(CommandContext& ctx);
+    void handleTrade(CommandContext& ctx); // BUY et SELL
+    void handleStart(CommandContext& ctx);
+    void handleStop(CommandContext& ctx);
+    void handlePipeline(CommandContext& ctx);
+    void handleChannel(CommandContext& ctx);
+    void handleBinary(CommandContext& ctx);
+    void handlePing(CommandContext& ctx);
+    void handlePong(CommandContext& ctx);
+    void handleSubscribe(CommandContext& ctx);
+    void handleUnsubscribe(CommandContext& ctx);
+    void handleLimitOrder(CommandContext& ctx); // LIMIT, IOC et FOK
+    void handleCancel(CommandContext& ctx);
+    void handleUnknown(CommandContext& ctx);
+
+    // Envoie un PING (ligne texte ou trame binaire selon le protocole de la connexion).
+    void sendHeartbeat();
+
+    // Commande "@<n> ..." reçue par la session principale : traitée par la session du canal 'channel'.
+    void dispatchToChannel(uint32_t channel, std::string_view command);
+    // Commande "CHANNEL OPEN|CLOSE <n> ..." (session principale). 'action', 'number', 'userId' et
+    // 'password' sont les mots qui suivent CHANNEL. Envoie elle-même la réponse (préfixée par "@<n> ").
+    void handleChannelCommand(std::string_view action, std::string_view number, std::string_view userId, std::string_view password);
+    // Ferme les canaux ouverts sur la connexion (arrêt de la session principale).
+    void closeAllChannels();
+    // Message tel qu'il part sur la connexion : lignes préfixées par "@<n> " pour une session de canal.
+    std::string onChannel(std::string message) const;
+
     // --- Membres de la session ---
     std::string clientId; // ID du client associé à cette session
     std::shared_ptr<ServerConnection> client; // Connexion réseau (TCP+SSL)
@@ -76,6 +192,39 @@ private:
 
     std::thread sessionThread; // Thread d'exécution de cette session
     std::atomic<bool> running; // Flag atomique pour signaler l'arrêt du thread de la session
+    std::atomic<bool> stopped; // Passe à true au premier appel de stop() (rend stop() idempotent)
+
+    // Mode pipeline (commande "PIPELINE ON") : les commandes portent un identifiant "#<id>" repris dans les réponses.
+    // Lus/écrits uniquement par le thread qui traite les commandes de la session.
+    bool pipelineMode;
+    uint64_t currentRequestId; // Identifiant de la commande en cours (0 = aucun)
+    // Protocole binaire (commande "BINARY ON") : définitif pour la connexion. Lu aussi par le thread de la TQ.
+    std::atomic<bool> binaryMode;
+
+    std::chrono::system_clock::time_point lastBotCallTime; // Dernier appel au bot
+
+    // Inactivité : accédés uniquement par le thread qui lit la connexion (thread de session ou thread d'E/S).
+    std::chrono::milliseconds idleTimeout;
+    std::chrono::milliseconds heartbeatInterval;
+    std::chrono::steady_clock::time_point lastActivity; // Dernière réception d'octets du client
+    std::chrono::steady_clock::time_point lastPingSent; // Dernier PING envoyé
+
+    // Passerelle en mémoire partagée ("SHM ATTACH") : canal ouvert par cette session, s'il existe.
+    ShmGateway* shmGateway = nullptr;
+    std::shared_ptr<ShmChannel> shmChannel;
+
+    // Abonnements aux prix ("SUBSCRIBE PRICE") : symboles suivis par la connexion.
+    PriceFeed* priceFeed = nullptr;
+    std::vector<std::string> priceSubscriptions;
+
+    // Canaux multiplexés. Session de canal : numéro et préfixe "@<n> " de ses réponses (0 / vide sinon).
+    uint32_t channelId = 0;
+    std::string channelPrefix;
+    // Session principale : sessions des canaux ouverts sur sa connexion. Accédés uniquement par le
+    // thread qui lit la connexion (puis par stop(), une fois ce thread arrêté).
+    Server* channelHost = nullptr;
+    size_t maxChannels = 0;
+    std::unordered_map<uint32_t, std::shared_ptr<ClientSession>> channels;
 
     // Le mutex pour la map de sessions est géré dans Server/TransactionQueue, pas ici.
 };
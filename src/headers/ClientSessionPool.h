@@ -0,0 +1,139 @@
+#ifndef CLIENT_SESSION_POOL_H
+#define CLIENT_SESSION_POOL_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+
+#include "ClientInitiator.h"
+#include "ServerConnection.h"
+#include "OpenSSLDeleters.h"
+#include "Logger.h"
+
+// --- Réglages du pool ---
+struct ClientPoolConfig {
+    std::string host = "127.0.0.1";
+    int port = 4433;
+    // Connexions TLS ouvertes au démarrage (un seul SSL_CTX pour toutes).
+    size_t connections = 2;
+    // Canaux par connexion, au plus ServerOptions::maxChannelsPerConnection côté serveur.
+    size_t maxChannelsPerConnection = 64;
+    // Compte de la session principale de chaque connexion : la connexion i s'authentifie comme
+    // "<connectionId>-<i>" (le serveur n'accepte qu'une session par compte). Créé au premier usage.
+    std::string connectionId = "pool";
+    std::string connectionPassword;
+    // Attente maximale de la réponse à CHANNEL OPEN.
+    int openTimeoutMs = 5000;
+};
+
+class ClientSessionPool;
+
+// --- Session d'un compte, portée par un canal d'une connexion du pool ---
+// Obtenue par ClientSessionPool::openSession(). Les commandes et réponses sont les mêmes que sur une
+// connexion dédiée ; le préfixe "@<canal> " est ajouté et retiré par le pool. Thread-safe.
+class PooledSession {
+public:
+    PooledSession(ClientSessionPool* pool, std::shared_ptr<ServerConnection> connection, uint32_t channelId, const std::string& clientId);
+
+    // Envoie une commande (sans '\n', ex: "BUY SRD-BTC 5"). Retourne false si le canal est fermé.
+    bool send(const std::string& command);
+    // Prochaine ligne reçue sur le canal, préfixe retiré. Attend au plus 'timeoutMs' (< 0 : sans limite).
+    // Retourne false sur délai écoulé, ou si le canal est fermé et qu'il ne reste rien à lire.
+    bool receiveLine(std::string& line, int timeoutMs = -1);
+    // Ferme le canal ("CHANNEL CLOSE") : la session du compte se termine, la connexion reste au pool.
+    void close();
+
+    bool isOpen() const;
+    const std::string& getClientId() const;
+    uint32_t getChannelId() const;
+
+private:
+    friend class ClientSessionPool;
+
+    // Appelées par le thread d'E/S du pool.
+    void deliver(std::string line);
+    void markClosed();
+
+    ClientSessionPool* pool;
+    std::shared_ptr<ServerConnection> connection;
+    const uint32_t channelId;
+    const std::string clientId;
+
+    mutable std::mutex inboxMutex;
+    std::condition_variable inboxCv;
+    std::deque<std::string> inbox;
+    bool closed = false;
+};
+
+// --- Classe ClientSessionPool ---
+// Quelques connexions TLS partagées par de nombreux comptes (ferme de comptes, simulateurs) : au lieu
+// d'une connexion (et d'un handshake) par compte, chaque compte ouvre un canal sur la connexion la moins
+// chargée ("CHANNEL OPEN <n> <ID> <mot de passe>", voir ClientSession côté serveur).
+//
+// Un thread d'E/S unique possède toutes les connexions (socket non bloquant) : il lit et démultiplexe les
+// lignes "@<n> ..." vers les sessions, répond aux PING et vide les files d'envoi alimentées par
+// PooledSession::send() depuis n'importe quel thread (même modèle que le SessionReactor du serveur).
+// Une connexion perdue ferme ses canaux ; le pool ne se reconnecte pas.
+class ClientSessionPool {
+public:
+    ClientSessionPool() = default;
+    ~ClientSessionPool();
+
+    ClientSessionPool(const ClientSessionPool&) = delete;
+    ClientSessionPool& operator=(const ClientSessionPool&) = delete;
+
+    // Ouvre et authentifie les connexions puis démarre le thread d'E/S. Retourne false si aucune
+    // connexion n'a pu être établie.
+    bool start(const ClientPoolConfig& config);
+    // Ferme toutes les connexions (et donc tous les canaux) et arrête le thread d'E/S.
+    void stop();
+
+    // Authentifie 'clientId' sur un nouveau canal. Retourne nullptr en cas de refus du serveur
+    // (la raison est journalisée), de délai écoulé ou si toutes les connexions sont pleines.
+    std::shared_ptr<PooledSession> openSession(const std::string& clientId, const std::string& password);
+
+    size_t getConnectionCount() const;
+    size_t getSessionCount() const;
+
+private:
+    friend class PooledSession;
+
+    struct PoolConnection {
+        std::shared_ptr<ServerConnection> connection;
+        std::unordered_map<uint32_t, std::shared_ptr<PooledSession>> sessions; // Canaux ouverts (sous 'mutex')
+        uint32_t nextChannel = 1; // Jamais réutilisé : une réponse tardive ne peut pas toucher un nouveau canal
+        bool alive = true;
+        bool waitingWritable = false; // Accédé uniquement par le thread d'E/S
+    };
+
+    // Connexion TLS + authentification de la session principale "<connectionId>-<index>".
+    std::shared_ptr<ServerConnection> connectOne(size_t index);
+    void ioLoop();
+    // Lit tout ce qui est disponible et distribue les lignes complètes. Retourne false si la connexion est perdue.
+    bool readConnection(PoolConnection& pc);
+    void dispatchLine(PoolConnection& pc, std::string_view line);
+    void connectionLost(PoolConnection& pc);
+    // Retire le canal de sa connexion (fermeture demandée ou ouverture refusée).
+    void forgetSession(const PooledSession& session);
+    void wake();
+
+    ClientPoolConfig config;
+    ClientInitiator initiator;
+    UniqueSSLCTX ctx;
+
+    mutable std::mutex mutex; // Protège connections[*].sessions, nextChannel et alive
+    std::vector<std::unique_ptr<PoolConnection>> connections;
+
+    std::thread ioThread;
+    std::atomic<bool> running{false};
+    int wakeFd = -1; // eventfd : une file d'envoi vient de recevoir un message, ou arrêt
+};
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef COMMAND_TABLE_H
+#define COMMAND_TABLE_H
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// --- Découpage d'une commande texte ---
+// Itère sur les mots (séparés par des espaces/tabulations) d'une vue, sans copie ni allocation.
+class CommandTokens {
+public:
+    explicit CommandTokens(std::string_view text) : rest(text) {}
+
+    // Mot suivant, ou vue vide s'il n'y en a plus.
+    std::string_view next() {
+        size_t start = rest.find_first_not_of(" \t\r");
+        if (start == std::string_view::npos) {
+            rest = std::string_view();
+            return rest;
+        }
+        size_t end = rest.find_first_of(" \t\r", start);
+        std::string_view word = rest.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+        rest.remove_prefix(end == std::string_view::npos ? rest.size() : end);
+        return word;
+    }
+
+    // Mot suivant interprété comme un nombre (std::from_chars : ni copie, ni locale, ni errno).
+    // Retourne false si absent ou si le mot n'est pas entièrement numérique.
+    bool nextDouble(double& value) {
+        std::string_view word = next();
+        if (word.empty()) {
+            return false;
+        }
+        const char* first = word.data();
+        const char* last = word.data() + word.size();
+        if (*first == '+' && word.size() > 1 && first[1] != '-') {
+            ++first; // Accepté par strtod (ancien parsing), pas par from_chars
+        }
+        auto [end, ec] = std::from_chars(first, last, value);
+        return ec == std::errc() && end == last;
+    }
+
+private:
+    std::string_view rest;
+};
+
+// --- Verbes du protocole texte ---
+// UNKNOWN est le dernier : la table des traitements de ClientSession a COMMAND_VERB_COUNT entrées,
+// la dernière traitant les commandes inconnues.
+enum class CommandVerb : uint8_t {
+    QUIT, SHOW, EXPORT, SHM, GET_PRICE, BUY, SELL, START, STOP, PIPELINE, CHANNEL, BINARY, PING, PONG,
+    SUBSCRIBE, UNSUBSCRIBE, LIMIT, IOC, FOK, CANCEL,
+    UNKNOWN
+};
+constexpr size_t COMMAND_VERB_COUNT = static_cast<size_t>(CommandVerb::UNKNOWN) + 1;
+
+// --- Table des verbes à hachage parfait, construite à la compilation ---
+// Le hachage ne lit que la longueur, les deux premiers et le dernier caractère (en majuscules) : un
+// mot reçu coûte une multiplication par caractère lu, un accès à la table et une comparaison avec le
+// seul verbe candidat. La graine est cherchée par le compilateur pour qu'aucun verbe ne partage sa case.
+namespace CommandTable {
+
+struct VerbEntry {
+    std::string_view keyword; // En majuscules
+    CommandVerb verb;
+};
+
+inline constexpr std::array<VerbEntry, COMMAND_VERB_COUNT - 1> VERBS = {{
+    {"QUIT", CommandVerb::QUIT},
+    {"SHOW", CommandVerb::SHOW},
+    {"EXPORT", CommandVerb::EXPORT},
+    {"SHM", CommandVerb::SHM},
+    {"GET_PRICE", CommandVerb::GET_PRICE},
+    {"BUY", CommandVerb::BUY},
+    {"SELL", CommandVerb::SELL},
+    {"START", CommandVerb::START},
+    {"STOP", CommandVerb::STOP},
+    {"PIPELINE", CommandVerb::PIPELINE},
+    {"CHANNEL", CommandVerb::CHANNEL},
+    {"BINARY", CommandVerb::BINARY},
+    {"PING", CommandVerb::PING},
+    {"PONG", CommandVerb::PONG},
+    {"SUBSCRIBE", CommandVerb::SUBSCRIBE},
+    {"UNSUBSCRIBE", CommandVerb::UNSUBSCRIBE},
+    {"LIMIT", CommandVerb::LIMIT},
+    {"IOC", CommandVerb::IOC},
+    {"FOK", CommandVerb::FOK},
+    {"CANCEL", CommandVerb::CANCEL},
+}};
+
+// Puissance de deux, au moins le double du nombre de verbes.
+constexpr size_t TABLE_SIZE = 64;
+static_assert((TABLE_SIZE & (TABLE_SIZE - 1)) == 0 && TABLE_SIZE >= 2 * VERBS.size(), "CommandTable: TABLE_SIZE invalide");
+
+constexpr char upperAscii(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+// Comparaison insensible à la casse (ASCII) d'un mot reçu avec un mot-clé en majuscules.
+constexpr bool equalsIgnoreCase(std::string_view word, std::string_view keyword) {
+    if (word.size() != keyword.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < word.size(); ++i) {
+        if (upperAscii(word[i]) != keyword[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 'word' non vide.
+constexpr size_t hash(std::string_view word, uint32_t seed) {
+    constexpr uint32_t FNV_PRIME = 16777619u;
+    uint32_t h = seed ^ static_cast<uint32_t>(word.size());
+    h = (h ^ static_cast<unsigned char>(upperAscii(word[0]))) * FNV_PRIME;
+    h = (h ^ static_cast<unsigned char>(word.size() > 1 ? upperAscii(word[1]) : 0)) * FNV_PRIME;
+    h = (h ^ static_cast<unsigned char>(upperAscii(word[word.size() - 1]))) * FNV_PRIME;
+    return (h ^ (h >> 16)) & (TABLE_SIZE - 1);
+}
+
+constexpr bool isPerfect(uint32_t seed) {
+    std::array<bool, TABLE_SIZE> used{};
+    for (const VerbEntry& entry : VERBS) {
+        size_t slot = hash(entry.keyword, seed);
+        if (used[slot]) {
+            return false;
+        }
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t findSeed() {
+    for (uint32_t seed = 2166136261u; seed < 2166136261u + 4096; ++seed) {
+        if (isPerfect(seed)) {
+            return seed;
+        }
+    }
+    return 0;
+}
+
+inline constexpr uint32_t SEED = findSeed();
+// Échec : deux verbes de même longueur partagent leurs deux premières et leur dernière lettre.
+// Élargir le hachage (ou TABLE_SIZE) avant d'ajouter le verbe.
+static_assert(SEED != 0, "CommandTable: aucune graine sans collision");
+
+// Case -> indice dans VERBS + 1 (0 = case vide).
+constexpr std::array<uint8_t, TABLE_SIZE> buildSlots() {
+    std::array<uint8_t, TABLE_SIZE> slots{};
+    for (size_t i = 0; i < VERBS.size(); ++i) {
+        slots[hash(VERBS[i].keyword, SEED)] = static_cast<uint8_t>(i + 1);
+    }
+    return slots;
+}
+
+inline constexpr std::array<uint8_t, TABLE_SIZE> SLOTS = buildSlots();
+
+// Verbe correspondant à 'word' (casse ignorée), UNKNOWN sinon.
+constexpr CommandVerb lookup(std::string_view word) {
+    if (word.empty()) {
+        return CommandVerb::UNKNOWN;
+    }
+    uint8_t index = SLOTS[hash(word, SEED)];
+    if (index == 0 || !equalsIgnoreCase(word, VERBS[index - 1].keyword)) {
+        return CommandVerb::UNKNOWN;
+    }
+    return VERBS[index - 1].verb;
+}
+
+constexpr bool allVerbsFound() {
+    for (const VerbEntry& entry : VERBS) {
+        if (lookup(entry.keyword) != entry.verb) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(allVerbsFound(), "CommandTable: table incohérente");
+static_assert(lookup("buy") == CommandVerb::BUY && lookup("BUYS") == CommandVerb::UNKNOWN, "CommandTable: casse ou longueur mal gérée");
+
+} // namespace CommandTable
+
+#endif
@@ -6,6 +6,7 @@
 #include <atomic> 
 #include <thread>
 #include <mutex> 
+#include <functional>
 #include <cstddef> 
 
 
@@ -61,6 +62,11 @@ private:
     // --- Membres statiques pour la gestion du thread de génération de prix ---
     static std::atomic<bool> stopRequested; // Flag atomique pour signaler l'arrêt au thread (thread-safe par nature atomique).
     static std::thread priceGenerationWorker; // L'objet thread qui exécute la boucle de génération de prix.
+    static int priceThreadCpu; // Coeur du thread de génération (-1 = non épinglé), voir LowLatencyConfig.
+
+    // Appelé par le thread de génération à chaque nouveau prix (ex: diffusion aux abonnés, PriceFeed).
+    static std::mutex listenerMutex; // Tenu pendant l'appel : après setPriceListener(nullptr), plus aucun appel.
+    static std::function<void(const std::string& symbol, double price)> priceListener;
 
     // --- Membres statiques pour la dernière valeur de prix SRD-BTC et son mutex ---
     // Le prix est mutable et partagé entre le thread de génération et les threads qui l'appellent (Bot, etc.).
@@ -85,6 +91,9 @@ public:
     // --- Méthodes de gestion du thread de génération de prix ---
     static void startPriceGenerationThread(); // Démarre le thread.
     static void stopPriceGenerationThread(); // Signale l'arrêt et attend la fin du thread.
+    static void setPriceThreadCpu(int cpu); // À appeler avant startPriceGenerationThread().
+    // Reçoit chaque nouveau prix, sur le thread de génération (ne doit pas bloquer). nullptr pour retirer.
+    static void setPriceListener(std::function<void(const std::string& symbol, double price)> listener);
 
     // --- Méthodes d'accès aux prix (Doivent être thread-safe dans .cpp) ---
     // L'implémentation de ces méthodes doit utiliser les mutex (srdMutex et bufferMutex)
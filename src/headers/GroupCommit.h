@@ -0,0 +1,121 @@
+#ifndef GROUP_COMMIT_H
+#define GROUP_COMMIT_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Transaction.h"
+
+class Wallet;
+
+// --- Réglages du group commit (voir ServerOptions) ---
+struct GroupCommitConfig {
+    // Attente maximale, après la première requête d'un lot, avant de l'écrire (0 = écrire dès que possible :
+    // le lot regroupe alors ce qui est arrivé pendant l'écriture du précédent).
+    int intervalMicros = 1000;
+    // Un lot est écrit sans attendre l'intervalle dès qu'il atteint cette taille.
+    int maxBatch = 512;
+    // true : le lot est mis sur disque (syncfs) avant les acquittements. false : écrit dans le cache du
+    // noyau seulement (survit à l'arrêt du processus ; un arrêt de la machine peut perdre le lot, voire
+    // laisser un portefeuille vide ou tronqué).
+    bool sync = true;
+};
+
+// Effets durables d'une requête traitée par la TransactionQueue.
+struct CommitEntry {
+    std::shared_ptr<const Transaction> transaction; // Ligne ajoutée au journal global (CSV)
+    std::shared_ptr<Wallet> wallet;                 // Portefeuille modifié à réécrire (nullptr = inchangé)
+    std::function<void()> acknowledge;              // Appelé une fois le lot durable, dans l'ordre de soumission
+    std::string clientId;                           // Client acquitté (vide : celui du portefeuille, s'il y en a un)
+};
+
+struct GroupCommitStats {
+    uint64_t batches = 0;
+    uint64_t entries = 0;
+    uint64_t walletWrites = 0;         // Réécritures réussies
+    uint64_t walletWriteFailures = 0;  // Réécritures en échec (recommencées aux lots suivants)
+    uint64_t journalWriteFailures = 0; // Écritures du journal en échec (lignes gardées pour le lot suivant)
+    uint64_t syncs = 0;                // Mises sur disque (lots sans écriture : aucune)
+    size_t largestBatch = 0;
+};
+
+// --- Classe GroupCommit ---
+// Étape d'écriture groupée entre le traitement des ordres et leur acquittement. Les shards de la
+// TransactionQueue déposent les effets de chaque requête (submit) ; un thread les écrit par lots :
+//  1. toutes les lignes du lot ajoutées au journal global en un seul write() (descripteur gardé ouvert),
+//  2. chaque portefeuille modifié écrit UNE fois pour le lot dans un fichier temporaire, quel que soit le
+//     nombre de ses ordres dans le lot,
+//  3. une seule mise sur disque (syncfs : journal et fichiers temporaires, même système de fichiers),
+//     seulement si le lot a écrit quelque chose (les refus n'ont ni ligne de journal ni portefeuille),
+//  4. les fichiers temporaires renommés sur les portefeuilles, puis leur répertoire mis sur disque (fsync) :
+//     le contenu est sur disque avant le renommage, un arrêt de la machine ne laisse jamais de fichier tronqué,
+//  5. puis les acquittements (TRANSACTION_RESULT), dans l'ordre de soumission.
+// Un client n'est donc acquitté qu'une fois son ordre durable, et l'ordre des résultats d'un client est
+// conservé (ses requêtes sont soumises par un seul shard, dans l'ordre).
+//
+// Un portefeuille réécrit reflète son état au moment de l'écriture : il peut déjà contenir des ordres du
+// lot suivant, qui ne sont pas encore acquittés.
+//
+// Échec de réécriture d'un portefeuille : son client n'est pas acquitté. L'entrée qui l'a modifié et toutes
+// les suivantes de ce client sont retenues (l'ordre de ses résultats est conservé), et le portefeuille est
+// réécrit aux lots suivants, ou toutes les RETRY_INTERVAL sans nouvelle entrée, jusqu'à réussite. Les autres
+// clients sont acquittés normalement. Une ligne de journal non écrite est gardée pour le lot suivant (pas de ligne perdue ni doublée)
+// sans retenir d'acquittement : l'historique du client est dans son portefeuille.
+class GroupCommit {
+public:
+    GroupCommit() = default;
+    ~GroupCommit();
+
+    GroupCommit(const GroupCommit&) = delete;
+    GroupCommit& operator=(const GroupCommit&) = delete;
+
+    static constexpr std::chrono::milliseconds RETRY_INTERVAL{100};
+
+    // Avant start().
+    void configure(const GroupCommitConfig& config, const std::string& journalPath);
+    bool start();
+    // Écrit et acquitte tout ce qui a été soumis, puis arrête le thread.
+    void stop();
+
+    // Thread-safe. Bloque si le thread d'écriture a plus de 4 lots de retard (contre-pression vers les shards).
+    // Sans thread démarré, l'entrée est écrite et acquittée immédiatement par l'appelant.
+    void submit(CommitEntry entry);
+
+    GroupCommitStats getStats() const;
+
+private:
+    void run();
+    void commit(std::vector<CommitEntry>& batch);
+    bool openJournal();
+
+    GroupCommitConfig config;
+    std::string journalPath = "../src/data/global_transactions.csv";
+    int journalFd = -1;
+
+    // Écritures en échec, reprises au lot suivant (protégées par commitMutex).
+    std::vector<CommitEntry> deferred;                  // Acquittements retenus, dans l'ordre de soumission
+    std::vector<std::shared_ptr<Wallet>> failedWallets; // Portefeuilles à réécrire
+    std::string journalBacklog;                         // Lignes du journal pas encore écrites
+    std::atomic<bool> retryPending{false};              // Une des trois est non vide
+
+    std::vector<CommitEntry> pending;
+    mutable std::mutex mtx;
+    std::condition_variable pendingCv; // Le thread d'écriture attend des entrées
+    std::condition_variable spaceCv;   // Les producteurs attendent de la place
+    bool running = false;
+    std::thread writer;
+    std::mutex commitMutex; // Un seul lot écrit à la fois (thread d'écriture, ou appelant sans thread)
+
+    GroupCommitStats stats; // Protégé par mtx
+};
+
+#endif
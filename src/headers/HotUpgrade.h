@@ -0,0 +1,113 @@
+#ifndef HOT_UPGRADE_H
+#define HOT_UPGRADE_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <functional>
+
+#include "Logger.h"
+
+// --- Classe HotUpgrade ---
+// Mise à jour à chaud du serveur sans interruption de l'acceptation des connexions.
+// L'ancien processus écoute sur un socket Unix (droits 0600, pair vérifié par SO_PEERCRED : même
+// utilisateur uniquement). Un nouveau binaire démarré avec --upgrade s'y connecte et reçoit les
+// descripteurs des sockets d'écoute (SCM_RIGHTS) : ce sont les MÊMES sockets, avec leur file de
+// connexions en attente, aucune connexion n'est perdue et le port n'est jamais fermé.
+//
+// Échange (lignes texte, un seul message porte les descripteurs) :
+//   nouveau -> ancien : "TAKEOVER 2\n"
+//   ancien  -> nouveau : "LISTEN <n> <baux> <compteur>\n" + n descripteurs, puis <baux> lignes "LEASE <client>\n" ;
+//                        l'ancien retire son socket Unix du système de fichiers
+//   nouveau -> ancien : "READY\n" une fois ses threads d'acceptation démarrés
+//   ancien  -> nouveau : "RELEASE <client>\n" à chaque bail rendu, puis fermeture à la fin de l'ancien processus
+// À la réception de READY, l'ancien processus cesse d'accepter et laisse ses sessions se terminer.
+// Sans READY (nouveau processus mort ou en échec), l'ancien processus continue normalement et
+// se remet en écoute pour une nouvelle tentative.
+//
+// Comptes : les deux processus ne doivent jamais écrire le portefeuille d'un même client. Avant LISTEN,
+// l'ancien processus cesse de créer des sessions ; chaque compte dont il garde un Wallet est un bail, que le
+// nouveau processus refuse d'ouvrir jusqu'au RELEASE correspondant (envoyé après la dernière sauvegarde de
+// ce Wallet) ou jusqu'à la fermeture de la connexion (ancien processus terminé : tous les baux sont rendus).
+// Le compteur des IDs de transaction est transmis : le nouveau processus repart au-delà d'une plage laissée
+// à l'ancien pour sa vidange.
+class HotUpgrade {
+public:
+    // État transmis au nouveau processus.
+    struct Handoff {
+        std::vector<int> listenSockets;
+        std::vector<std::string> leasedAccounts; // Comptes encore tenus par l'ancien processus
+        long long transactionCounter = 0;
+    };
+    // Ancien processus (appelées sur le thread de HotUpgrade) :
+    struct Callbacks {
+        // Sockets d'écoute et compteur ; l'ancien processus cesse ici de créer des sessions.
+        std::function<Handoff()> prepare;
+        // Comptes encore tenus, relevés sous le verrou des RELEASE (aucun RELEASE ne précède son LEASE).
+        std::function<std::vector<std::string>()> leasedAccounts;
+        // Reprise non confirmée après prepare : l'ancien processus reprend normalement.
+        std::function<void()> abort;
+        // Appelé une seule fois, quand le nouveau processus a confirmé la reprise.
+        std::function<void()> handoff;
+    };
+    // Nouveau processus : bail rendu (clientId vide : tous, l'ancien processus est terminé).
+    using ReleaseHandler = std::function<void(const std::string& clientId)>;
+
+    explicit HotUpgrade(const std::string& socketPath);
+    ~HotUpgrade();
+
+    HotUpgrade(const HotUpgrade&) = delete;
+    HotUpgrade& operator=(const HotUpgrade&) = delete;
+
+    // --- Ancien processus ---
+    // Crée le socket Unix et lance le thread qui sert les demandes de reprise.
+    bool startListening(Callbacks callbacks);
+    void stop();
+    bool hasHandedOff() const;
+    // Bail rendu (appelé quand ce processus n'écrira plus le portefeuille de 'clientId'). Sans reprise en
+    // cours ou confirmée, ne fait rien.
+    void releaseAccount(const std::string& clientId);
+
+    // --- Nouveau processus ---
+    // Demande les sockets d'écoute, les baux et le compteur à l'ancien processus. Retourne false si aucun
+    // processus ne répond (socket absent, refus, délai dépassé) : l'appelant crée alors ses propres sockets.
+    bool requestHandoff(Handoff& handoff, int timeoutMs);
+    // Confirme à l'ancien processus que les sockets reçus sont en service, puis reçoit ses RELEASE sur un
+    // thread dédié jusqu'à sa fin (arrêté par stop()).
+    bool confirmTakeover(ReleaseHandler onRelease);
+
+private:
+    bool openListener();
+    void closeListener();
+    void listenLoop();
+    // Sert une demande de reprise sur la connexion 'conn'. Retourne true si la reprise est confirmée.
+    bool serveTakeover(int conn);
+
+    static bool sendLine(int fd, const std::string& line, const std::vector<int>& fds = {});
+    // Lit une ligne (et les éventuels descripteurs joints). 'buffer' garde ce qui a été lu au-delà de la ligne
+    // (à repasser à l'appel suivant sur le même fd). Retourne false sur erreur/délai/fermeture.
+    static bool receiveLine(int fd, std::string& buffer, std::string& line, std::vector<int>* fds);
+    void releaseLoop(ReleaseHandler onRelease);
+    static void setTimeout(int fd, int timeoutMs);
+
+    std::string path;
+    int listenFd;
+    int wakeFd;       // eventfd pour réveiller le thread (arrêt)
+    int takeoverConn; // Nouveau processus : connexion vers l'ancien (RELEASE lus jusqu'à sa fin)
+    std::string takeoverBuffer;
+    std::thread releaseThread;
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<bool> handedOff;
+    Callbacks callbacks;
+    // Ancien processus : connexion vers le nouveau, pour les RELEASE. Jamais fermée après READY : le noyau la
+    // ferme à la sortie du processus, après la dernière sauvegarde possible d'un Wallet.
+    std::mutex releaseMutex;
+    int releaseConn;
+
+    static constexpr int TAKEOVER_TIMEOUT_MS = 10000;
+};
+
+#endif
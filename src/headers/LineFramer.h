@@ -0,0 +1,77 @@
+#ifndef LINE_FRAMER_H
+#define LINE_FRAMER_H
+
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// --- Classe LineFramer ---
+// Découpe un flux d'octets en lignes terminées par '\n', sans allocation en régime établi.
+// Les octets sont stockés dans un buffer circulaire de capacité FIXE (puissance de 2) dans lequel
+// on lit directement (SSL_read vers writePtr()/commitWrite()). nextLine() retourne une
+// std::string_view sur la ligne, pointant dans le buffer circulaire ; seule une ligne qui
+// chevauche la fin du buffer est recopiée, dans un tampon de travail alloué une seule fois.
+// Chaque octet n'est examiné qu'une fois (pas de find/substr/erase répétés sur une std::string).
+//
+// Garde-fou : une ligne (ou un début de ligne sans '\n') plus longue que maxLineLength fait
+// retourner LINE_TOO_LONG ; l'appelant décide alors de fermer la connexion.
+//
+// Le même buffer sert aussi au protocole binaire (BinaryProtocol) : peek()/nextBlock() extraient
+// des blocs de taille connue (en-tête puis trame) au lieu de lignes.
+//
+// Durée de vie : la vue retournée par nextLine()/nextBlock() reste valide jusqu'au prochain appel
+// d'une méthode non const du framer.
+class LineFramer {
+public:
+    enum class Status {
+        LINE,          // Une ligne complète est disponible (sans le '\n').
+        NEED_MORE,     // Pas de ligne complète pour l'instant.
+        LINE_TOO_LONG  // Ligne au-delà de maxLineLength : flux considéré invalide.
+    };
+
+    // Param capacity: Capacité du buffer circulaire (arrondie à la puissance de 2 supérieure).
+    // Param maxLineLength: Longueur maximale d'une ligne (doit être < capacité).
+    LineFramer(size_t capacity, size_t maxLineLength);
+
+    // --- Écriture directe (zéro copie) ---
+    // Zone contiguë libre où écrire les prochains octets (peut être de taille 0 si le buffer est plein).
+    char* writePtr();
+    size_t writableSize();
+    // Valide 'count' octets écrits dans writePtr().
+    void commitWrite(size_t count);
+
+    // Copie des octets dans le buffer. Retourne false (rien n'est copié) si la place manque.
+    bool append(const char* data, size_t size);
+
+    // Extrait la prochaine ligne complète.
+    Status nextLine(std::string_view& line);
+
+    // --- Blocs de taille fixe (protocole binaire) ---
+    // Copie les 'size' premiers octets en attente sans les consommer. Retourne false s'ils ne sont pas tous là.
+    bool peek(char* destination, size_t size);
+    // Extrait les 'size' prochains octets (size <= maxLineLength). Retourne false s'ils ne sont pas tous là.
+    bool nextBlock(size_t size, std::string_view& block);
+
+    // Nombre d'octets en attente (lignes non encore extraites + ligne partielle).
+    size_t buffered() const;
+    size_t capacity() const { return ring.size(); }
+    size_t maxLineLength() const { return maxLine; }
+
+private:
+    // Libère la place occupée par la dernière ligne retournée.
+    void releaseConsumed();
+
+    std::vector<char> ring;   // Buffer circulaire (taille puissance de 2)
+    size_t mask;              // ring.size() - 1
+    size_t maxLine;
+    std::vector<char> scratch; // Copie contiguë d'une ligne qui chevauche la fin du buffer
+
+    // Positions absolues (croissantes) ; l'index réel est (position & mask).
+    uint64_t head = 0;    // Début des données non consommées
+    uint64_t tail = 0;    // Fin des données écrites
+    uint64_t scanned = 0; // Octets déjà examinés à la recherche de '\n' (head <= scanned <= tail)
+    uint64_t consumedUpTo = 0; // Fin (après '\n') de la dernière ligne retournée, libérée au prochain appel
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef LOW_LATENCY_H
+#define LOW_LATENCY_H
+
+#include <string>
+#include <vector>
+
+// --- Profil faible latence (voir ServerOptions::lowLatency) ---
+// Échange du CPU contre de la latence. Tout est désactivé par défaut : chaque réglage a un coût.
+//  - tcpNoDelay     : désactive Nagle. Une réponse courte part immédiatement au lieu d'attendre l'ACK du
+//                     segment précédent (jusqu'à 40 ms avec l'ACK retardé du pair). Coût : plus de petits segments.
+//  - busyPollMicros : SO_BUSY_POLL. Une lecture sur un socket vide interroge la file de la carte réseau
+//                     pendant ce délai au lieu de dormir jusqu'à l'interruption. Sans effet sur loopback ;
+//                     au-delà de net.core.busy_read, exige CAP_NET_ADMIN.
+//  - *Cpu           : épingle un thread à un coeur (caches chauds, pas de migration). Sans intérêt si le
+//                     coeur n'est pas réservé à ce thread (isolcpus, ou au moins pas partagé avec un autre
+//                     thread épinglé).
+//  - spinWaitMicros : les files chaudes (TransactionQueue, threads d'E/S du réacteur) attendent activement
+//                     ce délai après le dernier travail avant de dormir. Le producteur n'a alors aucun réveil
+//                     à faire (pas d'appel système), le consommateur aucun délai d'ordonnancement.
+//                     Coût : jusqu'à un coeur entier par thread concerné tant que le trafic continue.
+struct LowLatencyConfig {
+    bool tcpNoDelay = false;
+    int busyPollMicros = 0;
+    int txQueueCpu = -1;           // Premier shard de la TransactionQueue, les suivants sur les coeurs suivants (-1 = non épinglé)
+    int priceThreadCpu = -1;       // Thread de génération des prix (Global)
+    std::vector<int> ioThreadCpus; // Threads d'E/S du réacteur, attribués dans l'ordre (cyclique)
+    int spinWaitMicros = 0;
+};
+
+namespace LowLatency {
+
+// Applique TCP_NODELAY et SO_BUSY_POLL demandés sur un socket TCP connecté. Un échec est loggé (une fois
+// par option pour SO_BUSY_POLL, typiquement EPERM) et n'empêche pas d'utiliser le socket.
+void configureSocket(int fd, bool tcpNoDelay, int busyPollMicros);
+
+// Épingle le thread appelant au coeur 'cpu' (rien si cpu < 0). 'threadName' sert au log.
+bool pinCurrentThread(int cpu, const std::string& threadName);
+
+// Indication au processeur pendant une attente active (libère les ressources du coeur voisin en SMT).
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+} // namespace LowLatency
+
+#endif
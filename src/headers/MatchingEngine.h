@@ -0,0 +1,139 @@
+#ifndef MATCHING_ENGINE_H
+#define MATCHING_ENGINE_H
+
+#include "OrderBook.h"
+#include "MpscRing.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Résultat d'une commande traitée par le moteur.
+struct ExecutionReport {
+    bool accepted = false;
+    const char* reason = "";   // Motif du refus (chaîne statique)
+    uint64_t orderId = 0;      // Ordre laissé au repos (LIMIT), ou annulé (CANCEL)
+    int64_t filledLots = 0;
+    int64_t restingLots = 0;   // Reste au repos (LIMIT) ou retiré du carnet (CANCEL)
+    std::vector<Fill> fills;   // Dans l'ordre d'exécution
+    RestingOrder cancelled;    // CANCEL accepté : l'ordre tel qu'il était au repos
+};
+
+// Case d'achèvement d'une commande attendue (execute) : une par thread appelant, réutilisée d'une commande à
+// l'autre. Le thread d'appariement écrit le rapport directement dans l'objet de l'appelant, puis publie
+// 'state' ; l'appelant attend activement un court instant, puis dort sur le mot lui-même (futex), réveillé
+// seulement s'il dort. Ni allocation ni verrou par commande.
+struct EngineCompletion {
+    static constexpr uint32_t PENDING = 0;
+    static constexpr uint32_t DONE = 1;
+    static constexpr uint32_t SLEEPING = 2; // L'appelant dort : le moteur doit le réveiller
+
+    ExecutionReport* report = nullptr;
+    std::atomic<uint32_t> state{PENDING};
+};
+
+// Commande déposée dans l'anneau du moteur.
+//  MARKET : apparié jusqu'à la limite de protection, le reste est abandonné (exécuté hors carnet par l'appelant).
+//  LIMIT  : apparié jusqu'au prix limite, le reste est posé dans le carnet.
+//  Pas d'auto-exécution : un ordre entrant qui atteint un ordre au repos de son propre 'owner' s'arrête là,
+//  son reste est annulé (ni posé ni apparié plus loin) ; FOK ne compte pas la liquidité au-delà.
+//  IOC    : apparié jusqu'au prix limite, le reste est annulé (immediate-or-cancel).
+//  FOK    : exécuté entièrement jusqu'au prix limite, sinon rien (fill-or-kill).
+//  CANCEL : retire l'ordre 'orderId' s'il appartient à 'owner'.
+struct EngineCommand {
+    enum class Type : uint8_t { MARKET, LIMIT, IOC, FOK, CANCEL };
+
+    Type type = Type::MARKET;
+    OrderSide side = OrderSide::BUY;
+    uint32_t book = 0;        // Indice du carnet (MatchingEngine::findBook)
+    uint32_t owner = 0;       // Propriétaire de l'ordre entrant (0 = aucun, sans prévention des auto-exécutions ; CANCEL : vérifié)
+    int64_t priceTick = 0;    // LIMIT/IOC/FOK : prix limite ; MARKET : pire prix accepté (protection)
+    int64_t quantity = 0;     // En lots
+    uint64_t orderId = 0;     // CANCEL
+    // Reçoit le rapport (execute). nullptr : rapport ignoré, exécutions non collectées (flux synthétiques).
+    EngineCompletion* completion = nullptr;
+};
+
+struct MatchingEngineStats {
+    uint64_t commands = 0;
+    uint64_t fills = 0;
+    uint64_t rejected = 0;
+};
+
+// --- Classe MatchingEngine ---
+// Un carnet d'ordres par symbole (OrderBook) et un thread d'appariement dédié qui est le seul à les
+// modifier : ni verrou ni donnée partagée pendant l'appariement. Les commandes arrivent par un anneau MPSC
+// (les shards de la TransactionQueue déposent, le thread d'appariement retire), dans l'ordre de dépôt de
+// chaque producteur ; attente active brève puis sommeil, comme un shard de la TransactionQueue.
+class MatchingEngine {
+public:
+    struct BookConfig {
+        std::string symbol;
+        double tickSize = 0.1;
+        double lotSize = 1e-8;
+        // Ticks couverts autour du prix de référence : 2^20 niveaux de 0.1 (16 Mo), soit environ ±52000 USD,
+        // pour que des ordres à cours limité loin du marché puissent rester au repos.
+        uint32_t levelCount = 1u << 20;
+        uint32_t orderCapacity = 1u << 18; // Ordres au repos au plus
+    };
+
+    static constexpr size_t RING_CAPACITY = 16384; // Commandes en attente (puissance de 2)
+    static constexpr int SPIN_POLLS = 256;
+
+    MatchingEngine();
+    ~MatchingEngine();
+
+    MatchingEngine(const MatchingEngine&) = delete;
+    MatchingEngine& operator=(const MatchingEngine&) = delete;
+
+    // Avant start(). Retourne l'indice du carnet créé (ou existant pour ce symbole).
+    uint32_t addBook(const BookConfig& config);
+    // Indice du carnet d'un symbole, -1 si inconnu. Thread-safe (carnets fixés avant start()).
+    int findBook(const std::string& symbol) const;
+    // Lecture des conversions prix/quantité d'un carnet (thread-safe : réglages constants). Le contenu du
+    // carnet n'est à lire que depuis le thread d'appariement, ou moteur arrêté.
+    const OrderBook& getBook(uint32_t index) const { return *books[index]; }
+    OrderBook& getBook(uint32_t index) { return *books[index]; }
+
+    // Coeur du thread d'appariement (-1 = non épinglé). Avant start().
+    void setCpu(int cpu) { engineCpu = cpu; }
+    bool start();
+    // Traite les commandes déjà déposées puis arrête le thread.
+    void stop();
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    // Thread-safe. Anneau plein : l'appelant attend une case libre. Moteur arrêté : commande traitée
+    // par l'appelant (qui doit alors être le seul à utiliser le moteur).
+    void submit(EngineCommand command);
+    // Thread-safe. Dépose la commande et attend son rapport (case d'achèvement du thread appelant).
+    ExecutionReport execute(EngineCommand command);
+
+    MatchingEngineStats getStats() const;
+
+private:
+    void run();
+    void apply(EngineCommand& command);
+    static void complete(EngineCompletion& completion);
+    static void waitFor(EngineCompletion& completion);
+
+    std::vector<std::unique_ptr<OrderBook>> books;
+    MpscRing<EngineCommand> ring;
+    std::mutex mtx; // Sommeil du thread seulement
+    std::condition_variable cv;
+    std::atomic<bool> running{false};
+    std::thread matcher;
+    int engineCpu = -1;
+
+    // Écrits par le thread d'appariement seul.
+    std::atomic<uint64_t> commandCount{0};
+    std::atomic<uint64_t> fillCount{0};
+    std::atomic<uint64_t> rejectCount{0};
+};
+
+#endif
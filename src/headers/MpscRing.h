@@ -0,0 +1,145 @@
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+// --- File bornée sans verrou, plusieurs producteurs / un consommateur (MPSC) ---
+// Entrée des shards de la TransactionQueue : les threads des sessions déposent leurs requêtes, le thread
+// du shard les retire.
+//
+// Les cases sont allouées une fois à la construction. Chacune porte un numéro de séquence qui dit à qui
+// elle appartient : 'sequence == position' = libre pour le producteur qui réserve cette position,
+// 'sequence == position + 1' = remplie, à lire par le consommateur. Un producteur réserve sa position par
+// compare_exchange sur 'tail', construit l'élément dans la case par déplacement puis publie la séquence :
+// ni allocation, ni copie, ni verrou. Le consommateur lit dans l'ordre des positions, donc les éléments
+// d'un même producteur restent dans leur ordre d'envoi.
+//
+// Chaque case et chaque position partagée occupe sa propre ligne de cache (pas de faux partage entre
+// producteurs, ni entre producteurs et consommateur).
+//
+// Réveil (même protocole que ShmRing) : le consommateur qui n'a plus rien à lire lève 'consumerWaiting'
+// (prepareToSleep) puis dort ; un producteur ne le réveille que si ce drapeau est levé
+// (consumerNeedsWakeup), donc aucune notification en régime établi.
+template <typename T>
+class MpscRing {
+public:
+    static constexpr size_t CACHE_LINE = 64;
+
+    // 'capacity' : puissance de 2, au moins 2.
+    explicit MpscRing(size_t capacity)
+        : capacity(capacity), mask(capacity - 1), slots(new Slot[capacity])
+    {
+        for (size_t i = 0; i < capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Détruit les éléments jamais retirés (aucun producteur ne doit être en cours).
+    ~MpscRing() {
+        for (uint64_t position = head;; ++position) {
+            Slot& slot = slots[position & mask];
+            if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+                break;
+            }
+            slot.item()->~T();
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    static bool isValidCapacity(size_t capacity) {
+        return capacity >= 2 && (capacity & (capacity - 1)) == 0;
+    }
+
+    // --- Producteurs (thread-safe) ---
+    // Retourne false si la file est pleine : 'value' n'est alors pas déplacé.
+    bool tryPush(T&& value) {
+        uint64_t position = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[position & mask];
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            int64_t lag = static_cast<int64_t>(sequence - position);
+            if (lag == 0) {
+                // Case libre pour cette position : la réserver (un échec recharge 'position').
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    new (slot.storage) T(std::move(value));
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false; // La case contient encore l'élément du tour précédent : pleine.
+            } else {
+                position = tail.load(std::memory_order_relaxed); // Réservée par un autre producteur
+            }
+        }
+    }
+
+    // Après tryPush : true si le consommateur dort et doit être réveillé.
+    // La barrière ordonne la publication de la case avant la lecture du drapeau (voir prepareToSleep).
+    bool consumerNeedsWakeup() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return consumerWaiting.load(std::memory_order_relaxed);
+    }
+
+    // --- Consommateur (un seul thread) ---
+    // Retire l'élément suivant par déplacement, ou rien si la file est vide (ou si le producteur qui a
+    // réservé la position suivante n'a pas encore publié).
+    std::optional<T> tryPop() {
+        Slot& slot = slots[head & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+            return std::nullopt;
+        }
+        std::optional<T> value(std::move(*slot.item()));
+        slot.item()->~T();
+        slot.sequence.store(head + capacity, std::memory_order_release); // Libre pour le tour suivant
+        ++head;
+        return value;
+    }
+
+    bool empty() const {
+        return slots[head & mask].sequence.load(std::memory_order_acquire) != head + 1;
+    }
+
+    // Avant de dormir : lève le drapeau puis revérifie la file. Retourne false (drapeau baissé) si un
+    // élément est arrivé entre-temps ; sinon le producteur suivant verra le drapeau et réveillera.
+    bool prepareToSleep() {
+        consumerWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!empty()) {
+            consumerWaiting.store(false, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    void wokeUp() {
+        consumerWaiting.store(false, std::memory_order_relaxed);
+    }
+
+    size_t getCapacity() const { return capacity; }
+
+private:
+    struct alignas(CACHE_LINE) Slot {
+        std::atomic<uint64_t> sequence{0};
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* item() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    const size_t capacity;
+    const uint64_t mask;
+    std::unique_ptr<Slot[]> slots;
+
+    alignas(CACHE_LINE) std::atomic<uint64_t> tail{0};         // Prochaine position à réserver (producteurs)
+    alignas(CACHE_LINE) uint64_t head = 0;                      // Prochaine position à lire (consommateur seul)
+    alignas(CACHE_LINE) std::atomic<bool> consumerWaiting{false}; // Le consommateur dort (ou s'y prépare)
+};
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef ORDER_BOOK_H
+#define ORDER_BOOK_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Sens d'un ordre dans le carnet.
+enum class OrderSide : uint8_t { BUY, SELL };
+
+// Exécution d'un ordre entrant (preneur) contre un ordre du carnet (teneur).
+struct Fill {
+    uint64_t makerOrderId = 0;
+    uint32_t makerOwner = 0;
+    int64_t priceTick = 0;       // Prix du teneur (en ticks)
+    int64_t quantity = 0;        // En lots
+    int64_t makerRemaining = 0;  // Reste du teneur après l'exécution (0 = retiré du carnet)
+};
+
+// Vue d'un ordre au repos.
+struct RestingOrder {
+    uint64_t id = 0;
+    uint32_t owner = 0;
+    OrderSide side = OrderSide::BUY;
+    int64_t priceTick = 0;
+    int64_t quantity = 0; // Reste, en lots
+};
+
+// --- Classe OrderBook ---
+// Carnet d'ordres à priorité prix-temps d'un symbole. Prix en ticks et quantités en lots (entiers) : pas
+// d'arrondi flottant pendant l'appariement.
+//
+// Niveaux de prix : tableau contigu d'une case de 16 octets par tick (tête, queue et quantité totale du
+// niveau), couvrant 'levelCount' ticks autour d'un prix de référence. Un niveau ne contient jamais que des
+// achats ou que des ventes (un ordre qui croiserait est d'abord apparié) : un seul bitmap d'occupation à deux
+// étages suffit pour trouver le niveau non vide suivant en quelques instructions, et le meilleur prix
+// acheteur/vendeur est gardé à jour (lecture en O(1)).
+//
+// Ordres : pool pré-alloué, listes doublement chaînées intrusives (indices 32 bits) par niveau, dans l'ordre
+// d'arrivée. L'identifiant d'un ordre contient l'indice de sa case : retrouver un ordre (annulation) ne
+// demande ni hachage ni recherche.
+//
+// Non thread-safe : un seul thread (celui du MatchingEngine) utilise un carnet.
+class OrderBook {
+public:
+    OrderBook(const std::string& symbol, double tickSize, double lotSize, uint32_t levelCount, uint32_t orderCapacity);
+
+    const std::string& getSymbol() const { return symbol; }
+    double getTickSize() const { return tickSize; }
+    double getLotSize() const { return lotSize; }
+
+    // Conversions (arrondi au plus proche).
+    int64_t toTicks(double price) const;
+    double toPrice(int64_t tick) const { return static_cast<double>(tick) * tickSize; }
+    int64_t toLots(double quantity) const;
+    double toQuantity(int64_t lots) const { return static_cast<double>(lots) * lotSize; }
+
+    // Prix couverts par les niveaux : [getMinTick(), getMaxTick()].
+    bool inRange(int64_t tick) const { return tick >= baseTick && tick < baseTick + static_cast<int64_t>(levelCount); }
+    int64_t getMinTick() const { return baseTick; }
+    int64_t getMaxTick() const { return baseTick + static_cast<int64_t>(levelCount) - 1; }
+    // Centre les niveaux sur 'tick'. Seulement carnet vide (retourne false sinon).
+    bool recenter(int64_t tick);
+
+    // Meilleurs prix (en ticks). À n'appeler que si hasBid() / hasAsk().
+    bool hasBid() const { return bestBid != NONE; }
+    bool hasAsk() const { return bestAsk != NONE; }
+    int64_t getBestBid() const { return baseTick + bestBid; }
+    int64_t getBestAsk() const { return baseTick + bestAsk; }
+    // Quantité totale (lots) au niveau 'tick'.
+    int64_t getLevelQuantity(int64_t tick) const;
+
+    // Apparie un ordre entrant de sens 'side' contre le côté opposé, aux prix au moins aussi bons que
+    // 'limitTick' (achat : <= limitTick ; vente : >= limitTick), meilleur prix d'abord puis ordre d'arrivée.
+    // 'onFill(const Fill&)' est appelé pour chaque exécution. Retourne la quantité exécutée (lots).
+    // Prévention des auto-exécutions : si 'takerOwner' est non nul, l'appariement s'arrête au premier ordre
+    // au repos du même propriétaire (qui reste dans le carnet) et '*selfTrade' passe à true ; le reste de
+    // l'ordre entrant est à annuler par l'appelant.
+    template <typename OnFill>
+    int64_t match(OrderSide side, int64_t quantity, int64_t limitTick, OnFill&& onFill, uint32_t takerOwner = 0, bool* selfTrade = nullptr);
+
+    // Quantité disponible (lots) pour un ordre entrant jusqu'à 'limitTick', comptée jusqu'à 'wanted' au plus
+    // (fill-or-kill : vérifier avant d'apparier). Parcourt les niveaux touchés ; avec 'takerOwner' non nul,
+    // leurs ordres un par un, jusqu'au premier de ce propriétaire (où match s'arrêterait).
+    int64_t available(OrderSide side, int64_t limitTick, int64_t wanted, uint32_t takerOwner = 0) const;
+
+    // Ajoute un ordre au repos. Retourne son identifiant, ou 0 si refusé : quantité nulle, prix hors des
+    // niveaux, pool plein, ou prix qui croiserait le côté opposé (apparier d'abord).
+    uint64_t add(OrderSide side, int64_t priceTick, int64_t quantity, uint32_t owner);
+
+    // Retire un ordre au repos (O(1)). Retourne false si l'identifiant n'est pas (ou plus) dans le carnet.
+    bool cancel(uint64_t orderId, RestingOrder* removed = nullptr);
+
+    bool find(uint64_t orderId, RestingOrder& out) const;
+
+    size_t getOrderCount() const { return orderCount; }
+    bool empty() const { return orderCount == 0; }
+
+private:
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+    static constexpr int64_t NONE = -1;
+
+    struct Level {
+        uint32_t head = NIL;
+        uint32_t tail = NIL;
+        int64_t quantity = 0;
+    };
+    static_assert(sizeof(Level) == 16, "Un niveau de prix occupe 16 octets.");
+
+    struct Order {
+        uint64_t id = 0;        // 0 = case libre
+        int64_t quantity = 0;
+        uint32_t owner = 0;
+        uint32_t level = 0;     // Indice du niveau
+        uint32_t prev = NIL;
+        uint32_t next = NIL;    // Suivant dans le niveau, ou dans la liste des cases libres
+        OrderSide side = OrderSide::BUY;
+    };
+
+    Order* lookup(uint64_t orderId);
+    const Order* lookup(uint64_t orderId) const;
+    void unlink(uint32_t slot);    // Retire l'ordre de son niveau et libère sa case
+    void levelEmptied(int64_t level);
+
+    // Bitmap d'occupation des niveaux (mots de 64 niveaux + un bit par mot non nul).
+    void setOccupied(int64_t level);
+    void clearOccupied(int64_t level);
+    int64_t nextOccupied(int64_t level) const; // Plus petit niveau occupé > level, ou NONE
+    int64_t prevOccupied(int64_t level) const; // Plus grand niveau occupé < level, ou NONE
+
+    std::string symbol;
+    double tickSize;
+    double lotSize;
+    uint32_t levelCount;
+    int64_t baseTick = 0;
+
+    std::vector<Level> levels;
+    std::vector<uint64_t> occupancy;
+    std::vector<uint64_t> summary;
+    int64_t bestBid = NONE; // Indices de niveau
+    int64_t bestAsk = NONE;
+
+    std::vector<Order> orders;
+    uint32_t freeHead = NIL;
+    size_t orderCount = 0;
+    uint64_t sequence = 0; // Partie haute des identifiants
+};
+
+template <typename OnFill>
+int64_t OrderBook::match(OrderSide side, int64_t quantity, int64_t limitTick, OnFill&& onFill, uint32_t takerOwner, bool* selfTrade) {
+    int64_t filled = 0;
+    // Limite ramenée aux niveaux : un achat sans limite utile balaie tout le carnet.
+    int64_t limit = limitTick - baseTick;
+    while (quantity > 0) {
+        int64_t level = side == OrderSide::BUY ? bestAsk : bestBid;
+        if (level == NONE || (side == OrderSide::BUY ? level > limit : level < limit)) {
+            break;
+        }
+        Level& l = levels[static_cast<size_t>(level)];
+        while (quantity > 0 && l.head != NIL) {
+            uint32_t slot = l.head;
+            Order& maker = orders[slot];
+            if (takerOwner != 0 && maker.owner == takerOwner) {
+                if (selfTrade) *selfTrade = true;
+                return filled;
+            }
+            int64_t traded = maker.quantity < quantity ? maker.quantity : quantity;
+            maker.quantity -= traded;
+            l.quantity -= traded;
+            quantity -= traded;
+            filled += traded;
+
+            Fill fill;
+            fill.makerOrderId = maker.id;
+            fill.makerOwner = maker.owner;
+            fill.priceTick = baseTick + level;
+            fill.quantity = traded;
+            fill.makerRemaining = maker.quantity;
+            if (maker.quantity == 0) {
+                unlink(slot); // Peut vider le niveau (et déplacer bestAsk/bestBid)
+            }
+            onFill(fill);
+        }
+    }
+    return filled;
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef PRICE_FEED_H
+#define PRICE_FEED_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+#include "ServerConnection.h"
+
+// --- Classe PriceFeed ---
+// Diffusion des prix aux connexions abonnées ("SUBSCRIBE PRICE <symbole>") au lieu du GET_PRICE en boucle.
+//
+// À chaque nouveau prix (thread de génération de Global), la ligne "PRICE_UPDATE <symbole> <prix> <séquence>"
+// est formatée UNE fois dans un tampon immuable partagé par tous les abonnés, puis proposée à chaque
+// connexion via ServerConnection::offerConflated() : aucune copie ni formatage par abonné, aucun appel
+// bloquant sur le thread des prix.
+//
+// Conflation : une connexion garde au plus une mise à jour non envoyée par symbole. Un client lent (socket
+// plein) voit donc seulement le dernier prix, avec un saut de séquence, au lieu d'accumuler des prix
+// périmés dans sa file d'envoi (et d'être déconnecté quand elle déborde).
+class PriceFeed {
+public:
+    PriceFeed();
+
+    // Ajoute 'connection' aux abonnés de 'symbol' et lui propose aussitôt le dernier prix connu.
+    // Retourne false si le symbole n'est pas diffusé. Idempotent.
+    bool subscribe(const std::string& symbol, const std::shared_ptr<ServerConnection>& connection);
+    // Retire l'abonnement. Retourne false si la connexion n'était pas abonnée à ce symbole.
+    bool unsubscribe(const std::string& symbol, const ServerConnection* connection);
+    // Retire tous les abonnements de la connexion (fin de session). Retourne le nombre d'abonnements retirés.
+    size_t unsubscribeAll(const ServerConnection* connection);
+
+    // Thread des prix : publie un nouveau prix pour 'symbol' (ignoré si le symbole n'est pas diffusé).
+    void publish(const std::string& symbol, double price);
+
+    bool hasSymbol(const std::string& symbol) const;
+    size_t getSubscriberCount() const;
+
+private:
+    struct Topic {
+        std::string symbol;
+        uint32_t id;                                  // Clé de conflation dans les connexions
+        uint64_t sequence = 0;                        // Numéro du dernier prix publié
+        std::shared_ptr<const std::string> last;      // Dernière ligne publiée (envoyée à l'abonnement)
+        std::vector<std::weak_ptr<ServerConnection>> subscribers;
+    };
+
+    Topic* findTopic(const std::string& symbol);
+
+    // Protège topics. Tenu pendant la diffusion : un abonnement reçoit soit le dernier prix, soit le suivant,
+    // jamais un prix plus ancien après un plus récent. offerConflated() n'écrit pas sur le socket.
+    mutable std::mutex mutex;
+    std::vector<Topic> topics;
+};
+
+#endif
@@ -5,6 +5,8 @@
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <map>
 #include <mutex>
 #include <vector>
 #include <memory>
@@ -27,10 +29,96 @@
 #include "Global.h"          
 #include "Logger.h"           
 #include "Utils.h"             
+#include "SessionReactor.h"
+#include "TlsHandshakePool.h"
+#include "TlsResumption.h"
+#include "TaskExecutor.h"
+#include "HotUpgrade.h"
+#include "ShmGateway.h"
+#include "PriceFeed.h"
+#include "AdmissionController.h"
+#include "LowLatency.h"
 
 // Déclaration de la file de transactions globale (définie ailleurs, typiquement main_serv.cpp)
 extern TransactionQueue txQueue;
 
+// --- Options de configuration du Server ---
+// Regroupe les réglages d'exécution (modèle de threads, etc.). Les valeurs par défaut
+// correspondent au fonctionnement recommandé ; Main_Serv peut les surcharger.
+struct ServerOptions {
+    // true : les sessions sont pilotées par le SessionReactor (epoll, quelques threads d'E/S).
+    // false : modèle historique, un thread dédié par ClientSession (repli).
+    bool useReactor = true;
+    // Nombre de threads d'E/S du réacteur (0 = nombre de coeurs, borné).
+    int reactorIoThreads = 0;
+    // Shards de la TransactionQueue (une file + un thread de traitement chacun, ordres répartis par
+    // clientId). 0 = un shard par coeur ; 1 = un seul thread pour tous les ordres (fonctionnement d'origine).
+    int txQueueShards = 0;
+    // Écriture groupée du journal global et des portefeuilles ; les TRANSACTION_RESULT partent une fois
+    // leur lot sur disque (voir GroupCommit.h).
+    GroupCommitConfig groupCommit;
+    // Nombre de shards d'écoute (un socket SO_REUSEPORT + un thread d'acceptation + des threads
+    // de handshake chacun). 0 = un shard par coeur.
+    int listenerShards = 0;
+    // Threads de handshake TLS non bloquant PAR shard (0 = coeurs répartis entre les shards).
+    int handshakeThreads = 0;
+    // Délai maximal d'un handshake TLS avant fermeture de la connexion (clients lents/malveillants).
+    int handshakeTimeoutMs = 10000;
+    // Reprise de session TLS (tickets à clés tournantes, cache partagé optionnel).
+    TlsResumptionConfig resumption;
+    // Workers de l'exécuteur des tâches de connexion (authentification).
+    // 0 = max(4, nombre de coeurs) : ces tâches bloquent sur les E/S du client.
+    int executorThreads = 0;
+    // Fermeture d'une session dont le client n'a rien envoyé depuis ce délai (0 = jamais).
+    // Libère la session (et l'ID, pour une reconnexion) quand le pair a disparu sans fermer TCP.
+    int idleTimeoutSec = 900;
+    // PING envoyé au client après ce délai sans activité (0 = pas de heartbeat). Un client qui
+    // répond PONG reste actif ; l'écriture sur une connexion morte finit par échouer et la ferme.
+    int heartbeatIntervalSec = 60;
+    // Mise à jour à chaud (voir HotUpgrade) : socket Unix sur lequel ce processus cède ses sockets
+    // d'écoute à un nouveau binaire (vide = désactivé).
+    std::string upgradeSocketPath;
+    // true (option --upgrade) : reprendre les sockets d'écoute du processus en cours au lieu d'en créer.
+    bool takeOverListeners = false;
+    // Après avoir cédé ses sockets, durée maximale laissée aux sessions existantes pour se terminer.
+    int drainTimeoutSec = 300;
+    // Kernel TLS : après le handshake, le chiffrement des enregistrements est confié au noyau (Linux,
+    // module 'tls') et les exports volumineux partent par SSL_sendfile. Si le noyau refuse, la connexion
+    // reste chiffrée en espace utilisateur, sans autre changement.
+    bool kernelTls = false;
+    // Écoute locale en clair sur un socket Unix (vide = désactivée) pour les bots et benchmarks du même
+    // hôte : pas de TLS, le pair est identifié par le noyau (SO_PEERCRED). Mêmes commandes et sessions.
+    std::string unixSocketPath;
+    // Utilisateurs système autorisés sur le socket Unix (vide = uniquement celui du serveur).
+    std::vector<uid_t> unixAllowedUids;
+    // Compte lié à un utilisateur système : un pair local dont l'UID figure ici ouvre CE compte sans mot de
+    // passe (identité fournie par SO_PEERCRED). Tout autre compte, ou un UID absent, exige le mot de passe.
+    std::map<uid_t, std::string> unixPeerAccounts;
+    // Canaux multiplexés : comptes supplémentaires authentifiés sur une même connexion ("CHANNEL OPEN",
+    // voir ClientSession et ClientSessionPool côté client). Nombre maximal par connexion (0 = désactivé).
+    int maxChannelsPerConnection = 64;
+    // Passerelle d'ordres en mémoire partagée (commande "SHM ATTACH" sur le socket Unix, voir ShmGateway.h).
+    bool shmGateway = false;
+    uint32_t shmRingCapacity = 4096; // Enregistrements par anneau (puissance de 2)
+    int shmSpinMicros = 50;          // Attente active du thread de la passerelle avant de dormir
+    // Contrôle d'admission des connexions TLS avant tout travail TLS (voir AdmissionController.h).
+    // Le socket Unix local n'y est pas soumis.
+    AdmissionConfig admission;
+    // Profil faible latence : TCP_NODELAY/SO_BUSY_POLL sur les connexions TLS, épinglage des threads chauds
+    // et attente active des files (voir LowLatency.h). Désactivé par défaut.
+    LowLatencyConfig lowLatency;
+};
+
+// --- Compteurs d'un shard d'écoute (voir Server::getShardStats) ---
+struct ShardStats {
+    int index = 0;
+    uint64_t accepted = 0;            // Connexions TCP acceptées par ce shard
+    uint64_t shed = 0;                // Connexions refusées par le contrôle d'admission (avant TLS)
+    uint64_t handshakesCompleted = 0; // Handshakes TLS réussis
+    uint64_t handshakesFailed = 0;    // Handshakes TLS en erreur
+    uint64_t handshakesTimedOut = 0;  // Handshakes TLS abandonnés (délai dépassé)
+};
+
 // --- Classe Server ---
 // La classe principale du serveur.
 // Gère l'initialisation réseau/SSL, l'acceptation des connexions,
@@ -46,9 +134,10 @@ public:
     // Param transactionCounterFile: Chemin du fichier pour le compteur de transactions.
     // Param transactionHistoryFile: Chemin du fichier pour l'historique global des transactions.
     // Param walletsDir: Chemin du répertoire des portefeuilles clients.
+    // Param opts: Options d'exécution (modèle de threads, ...).
     Server(int p, const std::string& certF, const std::string& keyF, const std::string& usersFile,
            const std::string& transactionCounterFile, const std::string& transactionHistoryFile,
-           const std::string& walletsDir);
+           const std::string& walletsDir, const ServerOptions& opts = ServerOptions());
 
     // Destructeur du serveur.
     // S'assure que le serveur s'arrête proprement (sauvegarde des utilisateurs, arrêt des threads et sessions).
@@ -67,6 +156,31 @@ public:
     // Param clientId: L'ID du client dont la session s'arrête.
     void unregisterSession(const std::string& clientId);
 
+    // Compteurs par shard d'écoute (acceptations, handshakes) pour observer l'équilibrage SO_REUSEPORT.
+    std::vector<ShardStats> getShardStats() const;
+
+    // Compteurs de reprise de session TLS (handshakes repris/complets, hits/misses).
+    TlsResumptionStats getResumptionStats() const;
+
+    // Compteurs de l'exécuteur des tâches de connexion (profondeur des files, vols, ...).
+    ExecutorStats getExecutorStats() const;
+
+    // Contrôle d'admission : compteurs (admises, refusées par motif) et état de charge courant.
+    // Sans limite configurée, l'état est toujours NORMAL.
+    AdmissionStats getAdmissionStats() const;
+    OverloadState getOverloadState() const;
+
+    // --- Canaux multiplexés (commande "CHANNEL OPEN", appelée par la ClientSession principale) ---
+    // Authentifie 'userId' et crée sa session comme canal 'channelId' de la connexion 'conn' (déjà
+    // authentifiée pour un autre compte). Mêmes règles qu'une connexion : une seule session par compte.
+    // Retourne nullptr et remplit 'error' (réponse destinée au client) en cas d'échec. 'outcome' : SUCCESS ou NEW.
+    std::shared_ptr<ClientSession> OpenChannelSession(const std::shared_ptr<ServerConnection>& conn, uint32_t channelId,
+                                                      const std::string& userId, const std::string& password,
+                                                      AuthOutcome& outcome, std::string& error);
+    // Arrête la session d'un canal (la connexion partagée reste ouverte) et la retire de la table des
+    // sessions si elle y figure encore (une nouvelle session du même compte n'est jamais retirée).
+    void CloseChannelSession(const std::shared_ptr<ClientSession>& session);
+
     // Déclare ClientAuthenticator comme une classe amie pour qu'elle puisse accéder aux membres privés/protégés de Server.
     friend class ClientAuthenticator;
 
@@ -81,11 +195,32 @@ private: // Membres et méthodes internes au serveur
     std::string transactionCounterFile_path;
     std::string transactionHistoryFile_path;
     std::string wallets_dir_path;
+    ServerOptions options;
 
     // --- Membres liés à l'état du serveur et réseau principal ---
-    int serverSocket = -1;
+    // Un shard d'écoute : socket SO_REUSEPORT, thread d'acceptation et threads de handshake dédiés.
+    struct ListenerShard {
+        int index = 0;
+        int listenSocket = -1;
+        std::thread acceptThread;
+        int wakeFd = -1; // eventfd réveillant le thread d'acceptation (le socket peut être partagé : pas de shutdown())
+        std::unique_ptr<TlsHandshakePool> handshakePool; // null = repli sur SSL_accept bloquant
+        std::atomic<uint64_t> accepted{0};
+        std::atomic<uint64_t> shed{0};
+    };
+    std::vector<std::unique_ptr<ListenerShard>> listenerShards;
+    // Déclaré avant 'ctx' : doit être détruit APRÈS le contexte SSL qui référence ses callbacks.
+    std::unique_ptr<TlsResumption> resumption;
     UniqueSSLCTX ctx = nullptr;
     std::atomic<bool> acceptingConnections; // Flag pour contrôler la boucle d'acceptation.
+    // Écoute locale AF_UNIX (voir ServerOptions::unixSocketPath).
+    int unixListenSocket = -1;
+    int unixWakeFd = -1;
+    std::thread unixAcceptThread;
+    std::unique_ptr<ShmGateway> shmGateway; // Passerelle en mémoire partagée (si activée)
+    // Abonnements aux prix ("SUBSCRIBE PRICE"). Déclaré avant activeSessions : les sessions s'en désabonnent en se détruisant.
+    PriceFeed priceFeed;
+    std::unique_ptr<AdmissionController> admission; // null si aucune limite n'est configurée
 
     // --- Membres liés à la gestion centrale des utilisateurs et à la persistance ---
     // Map stockant les identifiants clients et leurs mots de passe HASHÉS + sel. Protégée par usersMutex.
@@ -96,9 +231,15 @@ private: // Membres et méthodes internes au serveur
     // --- Membres liés à la gestion des sessions clientes actives ---
     std::unordered_map<std::string, std::shared_ptr<ClientSession>> activeSessions;
     std::mutex sessionsMutex; // Mutex pour protéger l'accès concurrent à 'activeSessions'.
+    // Mise à jour à chaud (voir HotUpgrade) : ancien processus, plus aucune session ni aucun enregistrement
+    // créés (modifié sous sessionsMutex) ; nouveau processus, comptes encore tenus par l'ancien (sous sessionsMutex).
+    std::atomic<bool> sessionsFrozen{false};
+    std::unordered_set<std::string> leasedAccounts;
 
     // --- Membres liés aux threads gérés par le Server ---
-    std::thread acceptThread; // Le thread principal qui exécute la boucle d'acceptation.
+    std::unique_ptr<SessionReactor> reactor; // Boucle epoll des sessions (null en mode un-thread-par-session).
+    std::unique_ptr<WorkStealingExecutor> executor; // Exécute HandleClient (authentification) hors des threads d'acceptation/handshake.
+    std::unique_ptr<HotUpgrade> upgrade; // Mise à jour à chaud (null si désactivée).
 
     // --- Méthodes internes d'aide ---
 
@@ -106,9 +247,15 @@ private: // Membres et méthodes internes au serveur
     UniqueSSLCTX InitServerCTX(const std::string& certFile, const std::string& keyFile);
     UniqueSSL AcceptSSLConnection(SSL_CTX* ctx_raw, int clientSocket);
 
-    // Méthode pour gérer une nouvelle connexion cliente acceptée. Lancée dans un thread séparé.
+    // Méthode pour gérer une nouvelle connexion cliente acceptée (TLS ou socket Unix). Exécutée par l'exécuteur.
     // Elle orchestrera l'authentification (appelant ClientAuthenticator) et le lancement de la ClientSession.
-    void HandleClient(int clientSocket, SSL* ssl_ptr);
+    void HandleClient(std::shared_ptr<ServerConnection> client_conn);
+    // Soumet HandleClient à l'exécuteur pour une connexion TLS établie (ferme la connexion si l'exécuteur est arrêté).
+    void SubmitClient(int clientSocket, SSL* ssl);
+    // Idem pour une connexion déjà encapsulée (ex: socket Unix).
+    void SubmitConnection(std::shared_ptr<ServerConnection> client_conn);
+    // Rend la place réservée par le contrôle d'admission. À appeler AVANT de fermer le socket.
+    void ReleaseAdmission(int clientSocket);
 
     // Méthodes pour la persistance des utilisateurs (chargement/sauvegarde de la map 'users').
     // Appellent LoadUsersInternal/SaveUsersInternal sous le mutex.
@@ -123,8 +270,45 @@ private: // Membres et méthodes internes au serveur
     // Méthode interne pour retirer une session de la map activeSessions. Protégée par sessionsMutex.
     void removeSession(const std::string& clientId);
 
-    // Méthode interne pour la boucle d'acceptation des connexions. Exécutée par acceptThread.
-    void AcceptLoop();
+    // Méthode interne pour la boucle d'acceptation des connexions. Exécutée par le thread d'acceptation de chaque shard.
+    void AcceptLoop(ListenerShard& shard);
+
+    // Crée un socket d'écoute sur 'port' (avec SO_REUSEPORT si demandé). Retourne -1 en cas d'échec.
+    int CreateListenSocket(bool reusePort);
+
+    // Loggue les compteurs de chaque shard.
+    void LogShardStats() const;
+
+    // --- Écoute locale (socket Unix) ---
+    // Crée le socket Unix (droits 0660) sur options.unixSocketPath. Retourne -1 en cas d'échec.
+    int CreateUnixListenSocket();
+    // Boucle d'acceptation du socket Unix : vérifie SO_PEERCRED puis soumet la connexion en clair.
+    void UnixAcceptLoop();
+    bool IsAllowedPeer(uid_t uid) const;
+    // Compte lié au pair local de 'conn' (ServerOptions::unixPeerAccounts), vide pour TLS ou un UID non lié.
+    std::string PeerAccount(const ServerConnection& conn) const;
+
+    // --- Mise à jour à chaud ---
+    // Sockets d'écoute de tous les shards (transmis au nouveau processus).
+    std::vector<int> GetListenSockets() const;
+    // Réveille les threads d'acceptation bloqués dans poll() (arrêt, mise à jour à chaud).
+    void WakeAcceptThreads();
+    // Le nouveau processus accepte : arrêter l'acceptation (appelé depuis le thread de HotUpgrade).
+    void BeginDrain();
+    // Attend la fin des sessions, handshakes et authentifications en cours (borné par drainTimeoutSec).
+    void DrainSessions();
+    // Sessions dont la connexion est encore ouverte.
+    size_t CountLiveSessions();
+    // Ancien processus : gèle la création de sessions puis fournit sockets et compteur (voir HotUpgrade::Callbacks).
+    HotUpgrade::Handoff PrepareHandoff();
+    void AbortHandoff();
+    // Nouveau processus : bail rendu par l'ancien (vide : tous).
+    void ReleaseLease(const std::string& clientId);
+    // Appelant sous sessionsMutex : message de refus si une session ne peut pas être ouverte pour 'clientId'
+    // pendant une mise à jour à chaud, vide sinon.
+    std::string HandoffRefusal(const std::string& clientId) const;
+    // Plage d'IDs de transaction laissée à l'ancien processus pour sa vidange.
+    static constexpr long long HANDOFF_ID_RANGE = 1000000000LL;
 
 
     // --- Méthode privée pour la gestion de l'authentification et des utilisateurs par le Server ---
@@ -135,18 +319,11 @@ private: // Membres et méthodes internes au serveur
     // Param userIdPlainText: L'ID de l'utilisateur potentiel.
     // Param passwordPlain: Le mot de passe en clair reçu.
     // Param authenticatedUserId: Si le retour est SUCCESS ou NEW, cet argument contiendra l'ID de l'utilisateur authentifié/enregistré.
+    // Param peerAccount: Compte lié au pair local authentifié par le noyau (voir PeerAccount, vide sinon) : si c'est
+    //                    le compte demandé et qu'il existe, il est accepté sans vérifier le mot de passe (qui peut être
+    //                    vide). Tout autre compte exige son mot de passe ; l'enregistrement aussi.
     // Retourne le résultat de l'authentification (AuthOutcome::SUCCESS, AuthOutcome::NEW, AuthOutcome::FAIL).
-    AuthOutcome processAuthRequest(const std::string& userIdPlainText, const std::string& passwordPlain, std::string& authenticatedUserId);
-
-    // --- Membres pour le pool de threads ---
-    std::vector<std::thread> threadPool; // Pool de threads pour gérer les connexions
-    std::queue<std::function<void()>> taskQueue; // File de tâches pour les connexions
-    std::mutex taskQueueMutex; // Mutex pour protéger l'accès à la file de tâches
-    std::condition_variable taskQueueCV; // Variable conditionnelle pour notifier les threads
-    std::atomic<bool> stopThreadPool; // Flag pour arrêter le pool de threads
-
-    // Méthode pour les threads du pool
-    void threadPoolWorker();
+    AuthOutcome processAuthRequest(const std::string& userIdPlainText, const std::string& passwordPlain, std::string& authenticatedUserId, const std::string& peerAccount = "");
 
 };
 
@@ -9,16 +9,63 @@
 #include <openssl/err.h>   
 #include <memory>          
 #include <mutex>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <functional>
+#include <sys/types.h>
 
 #include "../headers/OpenSSLDeleters.h" 
 #include "../headers/Logger.h"          
+#include "../headers/LineFramer.h"
+#include "../headers/BinaryProtocol.h"
+#include "../headers/Transport.h"
 
 
 // --- Classe ServerConnection ---
-// Représente une connexion cliente acceptée par le serveur (socket + objet SSL).
+// Représente une connexion cliente acceptée par le serveur (socket + transport).
 // Gère l'envoi/réception de données sur cette connexion et son cycle de vie.
 // Conçue pour être utilisée par ClientSession.
+//
+// Transport : TLS (connexions TCP) ou en clair (socket Unix local, pair authentifié par SO_PEERCRED),
+// voir Transport.h. Tout le reste (file d'envoi, lignes, trames binaires) est commun.
+//
+// Envoi : chaque connexion possède une file d'envoi bornée. Un seul thread "écrivain" (le thread
+// d'E/S du réacteur ou le thread de session) appelle SSL_write, via flushOutbound(), et regroupe
+// plusieurs messages en attente dans un même enregistrement TLS. Les autres threads (ex: worker de
+// la TransactionQueue) se contentent d'enqueueSend() : un client lent ne les bloque jamais.
+//
+// Kernel TLS (option du serveur, SSL_OP_ENABLE_KTLS) : après le handshake, OpenSSL confie les clés au
+// noyau quand celui-ci l'accepte ; SSL_write/SSL_read restent utilisables et le chiffrement se fait
+// dans le noyau. Les gros contenus (exports) passent alors par enqueueFile() et SSL_sendfile() : les
+// données vont du cache de pages au socket sans copie en espace utilisateur. Si le noyau refuse
+// (module 'tls' absent, suite non supportée), le même enqueueFile() est servi par pread() + SSL_write.
+// Le transport en clair envoie toujours les fichiers par sendfile().
+//
+// Socket Unix : enqueueWithDescriptors() transmet aussi des descripteurs (SCM_RIGHTS) avec un message,
+// ex: segment de mémoire partagée et eventfds de la passerelle d'ordres (ShmGateway).
 class ServerConnection {
+public:
+    // Résultat d'une vidange de la file d'envoi.
+    enum class FlushResult {
+        DRAINED,     // Tout a été écrit.
+        WOULD_BLOCK, // Buffer d'émission plein : réessayer quand le socket sera inscriptible.
+        FAILED       // Erreur fatale : la connexion est marquée pour fermeture.
+    };
+
+    // Limites de la file d'envoi. Au-delà, le client est jugé trop lent et la connexion est fermée.
+    static constexpr size_t MAX_OUTBOUND_MESSAGES = 1024;
+    static constexpr size_t MAX_OUTBOUND_BYTES = 1024 * 1024;
+    // Taille maximale d'un lot de messages regroupés (un enregistrement TLS = 16 Ko de données).
+    static constexpr size_t MAX_COALESCED_BYTES = 16 * 1024;
+    // Taille maximale d'un appel SSL_sendfile (le reste du fichier part aux appels suivants).
+    static constexpr size_t SENDFILE_CHUNK_BYTES = 1024 * 1024;
+
+    // Buffer circulaire de réception et longueur maximale d'une ligne (commande ou message d'auth).
+    static constexpr size_t RECEIVE_RING_CAPACITY = 16 * 1024;
+    static constexpr size_t MAX_LINE_LENGTH = 4096;
+    static_assert(BinaryProtocol::MAX_FRAME_SIZE <= MAX_LINE_LENGTH, "Une trame binaire doit tenir dans le tampon de travail du LineFramer.");
+
 private:
     int clientSocket = -1; // Descripteur de fichier du socket
 
@@ -26,19 +73,69 @@ private:
     std::string clientId;
     std::string token;
 
-    bool m_markedForClose = false; // Flag pour marquer la connexion à fermer
-
-    // Objet SSL (la connexion sécurisée). Géré par unique_ptr pour RAII.
-    UniqueSSL ssl = nullptr; // unique_ptr prend possession de SSL*
-
-    // Buffer d'accumulation pour receiveLine
-    std::string receive_buffer;
+    std::atomic<bool> m_markedForClose{false}; // Flag pour marquer la connexion à fermer (peut être levé par un autre thread)
+
+    // Pair local authentifié par le noyau (SO_PEERCRED) : l'authentification n'exige pas de mot de passe
+    // pour le compte lié à son UID (voir Server::PeerAccount).
+    bool peerTrusted = false;
+    pid_t peerPid = 0;
+    uid_t peerUid = 0;
+
+    // Appelée juste avant la fermeture du socket (ex: libération de la place réservée par le contrôle d'admission).
+    std::function<void(int)> closeHandler;
+
+    // Transport (TLS ou en clair). Possède l'objet SSL le cas échéant ; null une fois la connexion fermée.
+    std::unique_ptr<Transport> transport;
+
+    // Buffer circulaire de réception, découpé en lignes. Partagé par receiveLine() (authentification)
+    // et par la session (lignes de commandes) : les octets reçus juste après l'auth n'ont pas à être recopiés.
+    LineFramer inputFramer;
+
+    // Élément de la file d'envoi : un message (éventuellement accompagné de descripteurs à transmettre),
+    // ou une portion de fichier (export volumineux). Possède ses descripteurs, fermés à la destruction.
+    struct OutboundItem {
+        std::string data;
+        int fileFd = -1;
+        off_t fileOffset = 0;
+        size_t fileRemaining = 0;
+        std::vector<int> descriptors;
+
+        OutboundItem() = default;
+        explicit OutboundItem(std::string message) : data(std::move(message)) {}
+        OutboundItem(std::string message, std::vector<int> fds) : data(std::move(message)), descriptors(std::move(fds)) {}
+        OutboundItem(int fd, off_t offset, size_t size) : fileFd(fd), fileOffset(offset), fileRemaining(size) {}
+        OutboundItem(OutboundItem&& other) noexcept;
+        OutboundItem& operator=(OutboundItem&& other) noexcept;
+        OutboundItem(const OutboundItem&) = delete;
+        OutboundItem& operator=(const OutboundItem&) = delete;
+        ~OutboundItem();
+
+        bool isFile() const { return fileFd != -1; }
+    };
+
+    // --- File d'envoi ---
+    std::mutex outboundMutex;               // Protège outboundQueue, outboundBytes, outboundClosed, writerAttached, writeNotifier, conflatedUpdates
+    std::deque<OutboundItem> outboundQueue; // Messages (et fichiers) en attente d'écriture (ordre FIFO)
+    size_t outboundBytes = 0;               // Octets des messages en file (les fichiers restent dans le cache de pages)
+    bool outboundClosed = false;           // Plus aucun message accepté (fermeture ou débordement)
+    bool writerAttached = false;           // Un thread écrivain dédié vide la file (sinon send() écrit lui-même)
+    std::function<void()> writeNotifier;   // Réveille l'écrivain quand la file devient non vide
+    // Mises à jour remplaçables (flux de prix, voir PriceFeed) : au plus une par clé, envoyées après la file.
+    // Tampons immuables partagés entre connexions ; hors des limites de la file (taille bornée par clé).
+    std::vector<std::pair<uint32_t, std::shared_ptr<const std::string>>> conflatedUpdates;
+
+    std::mutex writeMutex;   // Garantit un seul SSL_write à la fois (tenu pendant flushOutbound)
+    std::string writeBuffer; // Lot regroupé en cours d'écriture (inchangé entre deux tentatives SSL_write)
+    OutboundItem pendingFile; // Fichier en cours d'envoi (sorti de la file, protégé par writeMutex)
+    std::vector<int> pendingDescriptors; // À joindre au premier octet de writeBuffer (protégé par writeMutex)
 
 public:
     // --- Constructeur ---
     // Crée un ServerConnection à partir d'un socket FD et d'un objet SSL RAW déjà acceptés/établis.
     // Le ServerConnection prend possession du SSL* (via UniqueSSL).
     ServerConnection(int socket_fd, SSL* ssl_ptr);
+    // Crée un ServerConnection sur un transport quelconque (ex: PlainTransport pour un socket Unix).
+    ServerConnection(int socket_fd, std::unique_ptr<Transport> transport_ptr);
 
     // --- Destructeur ---
     // Ferme la connexion (socket + SSL) et libère les ressources.
@@ -50,19 +147,51 @@ public:
     const std::string& getToken() const;    // Valide après auth
     bool isMarkedForClose() const;
     bool isConnected() const; // Vérifie si la connexion est active/utilisable
+    bool canSendFile() const;          // Fichiers envoyés par le noyau (sendfile, SSL_sendfile avec kTLS)
+    bool canPassDescriptors() const;   // Transmission de descripteurs (socket Unix)
+    std::string getTransportName() const;
+    bool isPeerTrusted() const;        // Pair local authentifié par SO_PEERCRED
+    uid_t getPeerUid() const;
 
     // --- Setters ---
     void setClientId(const std::string& id);
     void setToken(const std::string& tok);
+    // Identité du pair vérifiée par le noyau (socket Unix) : marque la connexion comme de confiance.
+    void setPeerCredentials(pid_t pid, uid_t uid);
+    // 'handler' reçoit le descripteur encore ouvert, une seule fois, au moment de closeConnection().
+    void setCloseHandler(std::function<void(int)> handler);
 
     // --- Méthodes de Communication Réseau ---
-    // Envoyer des données brutes
+    // Envoyer des données brutes. Le message passe par la file d'envoi : si un écrivain est attaché,
+    // send() ne fait que l'y déposer ; sinon (authentification) la file est vidée immédiatement.
     int send(const char* data, int size);
     // Recevoir des données brutes
     int receive(char* buffer, int size);
     // Utilitaire pour envoyer une string
     int send(const std::string& data);
 
+    // Dépose un message dans la file d'envoi sans jamais écrire sur le socket. Thread-safe.
+    // Retourne false si la connexion est fermée ou si la file déborde (la connexion est alors marquée à fermer).
+    bool enqueueSend(std::string message);
+    // Dépose 'size' octets du fichier 'fd' (à partir de 'offset') dans la file d'envoi, à la suite des
+    // messages déjà en file. La connexion devient propriétaire de 'fd' (fermé après envoi ou en cas d'échec).
+    // Envoyé par sendfile si le transport le permet (kTLS, clair), sinon par blocs lus puis écrits.
+    bool enqueueFile(int fd, off_t offset, size_t size);
+    // Dépose un message accompagné de descripteurs (canPassDescriptors() requis). La connexion devient
+    // propriétaire de 'fds' et les ferme une fois transmis (ou en cas d'échec) : passer des copies (dup).
+    bool enqueueWithDescriptors(std::string message, std::vector<int> fds);
+    // Dépose une mise à jour qui remplace celle de même clé encore non envoyée (conflation : un client lent
+    // ne reçoit que la plus récente). Ne copie pas 'update' et n'écrit jamais sur le socket. Thread-safe.
+    // Retourne false si la connexion est fermée.
+    bool offerConflated(uint32_t key, std::shared_ptr<const std::string> update);
+    // Désigne le thread courant (et ses successeurs) comme unique écrivain de la connexion.
+    // 'notifier' (peut être vide) est appelé, file verrouillée, quand un message arrive dans une file vide.
+    void attachWriter(std::function<void()> notifier);
+    // Écrit la file d'envoi en regroupant les messages. Réservé à l'écrivain (ou appelé sans écrivain attaché).
+    FlushResult flushOutbound();
+    // Vrai s'il reste des octets à écrire (file ou lot partiellement envoyé).
+    bool hasPendingOutput();
+
     // --- Méthodes de Gestion de la Connexion ---
     void markForClose();    // Marque la connexion à fermer
     void closeConnection(); // Ferme proprement le socket et SSL
@@ -70,6 +199,33 @@ public:
     // Lire un message complet terminé par newline
     // Peut lancer une exception en cas d'erreur (connexion fermée, erreur SSL/socket).
     std::string receiveLine();
+
+    // Lire une trame complète du protocole binaire (après "BINARY ON"). Bloquant.
+    // 'body' pointe dans le buffer de réception : valide jusqu'à la prochaine lecture.
+    // Peut lancer une exception en cas d'erreur (connexion fermée, erreur SSL/socket, trame invalide).
+    void receiveFrame(BinaryProtocol::FrameHeader& header, std::string_view& body);
+
+    // Passe le socket en mode (non) bloquant (mode réacteur). Retourne false en cas d'échec fcntl.
+    bool setNonBlocking(bool enable);
+    // Lit directement dans le buffer circulaire de réception (mêmes codes retour que receive()).
+    int receiveIntoFramer();
+    // Découpage en lignes des octets reçus (y compris ceux arrivés pendant l'authentification).
+    LineFramer& getInputFramer();
+
+    // Attend (poll) que le socket soit prêt pour 'events' (POLLIN/POLLOUT).
+    // Retourne false sur timeout ou erreur du socket.
+    bool waitForSocket(short events, int timeoutMs);
+
+private:
+    // Vide la file en attendant le socket si nécessaire (chemin sans écrivain attaché).
+    int flushBlocking();
+    // Prépare le prochain bloc de pendingFile : sendfile direct ou lecture dans writeBuffer.
+    // Retourne DRAINED si le bloc a été traité (boucler), sinon le résultat à retourner par flushOutbound.
+    FlushResult sendFileChunk();
+    // Traduit l'échec d'une écriture du transport (WOULD_BLOCK, ou FAILED et connexion marquée à fermer).
+    FlushResult writeFailure(const TransportResult& result);
+    // Lit au moins un octet dans le buffer de réception ou lance une exception (receiveLine/receiveFrame).
+    void fillFramerBlocking(const char* caller);
 };
 
 #endif
\ No newline at end of file
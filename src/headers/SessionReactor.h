@@ -0,0 +1,125 @@
+#ifndef SESSION_REACTOR_H
+#define SESSION_REACTOR_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#include "Logger.h"
+#include "TimingWheel.h"
+
+class ClientSession; // Déclaration anticipée (ClientSession.h inclut Server.h qui inclut ce header)
+
+// --- Classe SessionReactor ---
+// Boucle d'événements epoll partagée par toutes les ClientSession (mode "réacteur").
+// Remplace le modèle un-thread-par-session : un petit nombre FIXE de threads d'E/S
+// surveillent les sockets des sessions. Quand un socket devient lisible, le thread d'E/S
+// draine la connexion SSL (non bloquante) et passe les lignes complètes à
+// ClientSession::processClientCommand().
+// Chaque thread d'E/S possède son propre descripteur epoll et sa propre table de sessions :
+// une session est affectée à un seul thread (round-robin) pour toute sa durée de vie,
+// ce qui sérialise naturellement toutes les lectures sur sa connexion.
+// Ce même thread est l'unique écrivain de la connexion : il vide la file d'envoi après chaque
+// lecture, sur demande des autres threads (réveil eventfd) et sur EPOLLOUT quand le pair est lent.
+// Les échéances (inactivité/heartbeat, appel du bot) sont des timers de la TimingWheel du thread :
+// seules les sessions dont un timer arrive à échéance sont visitées, quel que soit leur nombre.
+class SessionReactor {
+public:
+    // Callback appelée (depuis un thread d'E/S) lorsqu'une session se termine
+    // (déconnexion du pair, QUIT, erreur). Reçoit l'ID du client.
+    using CloseHandler = std::function<void(const std::string&)>;
+
+    // Param ioThreads: Nombre de threads d'E/S (0 = nombre de coeurs, borné à [1, 8]).
+    explicit SessionReactor(int ioThreads);
+    ~SessionReactor();
+
+    SessionReactor(const SessionReactor&) = delete;
+    SessionReactor& operator=(const SessionReactor&) = delete;
+
+    // Démarre les threads d'E/S. Retourne false si la création des epoll/eventfd a échoué.
+    bool start();
+    // Arrête les threads d'E/S, les joint, puis relâche toutes les sessions encore attachées.
+    void stop();
+
+    // Confie une session (déjà authentifiée, socket passé en non bloquant) au réacteur.
+    // L'enregistrement epoll est effectué par le thread d'E/S choisi lui-même,
+    // qui tente aussi une première lecture (des données peuvent déjà être dans le buffer SSL).
+    bool addSession(std::shared_ptr<ClientSession> session);
+
+    // Définit la callback de fin de session (typiquement Server::unregisterSession).
+    void setCloseHandler(CloseHandler handler);
+
+    // Nombre de threads d'E/S effectivement utilisés.
+    size_t getIoThreadCount() const;
+
+    // Profil faible latence (avant start()) : coeurs des threads d'E/S (attribués dans l'ordre, cycliquement ;
+    // vide = non épinglés) et attente active après le dernier événement avant de bloquer dans epoll_wait.
+    void setLatencyProfile(const std::vector<int>& cpus, std::chrono::microseconds spinWait);
+
+private:
+    // Résolution des timers de session (timeout d'epoll_wait tant qu'au moins un timer est armé).
+    static constexpr int TIMER_TICK_MS = 100;
+
+    // Type d'un timer de session (encodé avec le fd dans le userData de la TimingWheel).
+    enum class TimerKind : uint64_t { IDLE = 0, BOT = 1 };
+
+    // Session surveillée par un thread d'E/S et ses timers.
+    struct SessionEntry {
+        std::shared_ptr<ClientSession> session;
+        TimingWheel::TimerId idleTimer = 0; // Inactivité + heartbeat (ClientSession::checkIdle)
+        TimingWheel::TimerId botTimer = 0;  // Appel du bot (ClientSession::onBotTimer)
+    };
+
+    // État propre à un thread d'E/S.
+    struct IoWorker {
+        int epollFd = -1;
+        int wakeFd = -1; // eventfd pour réveiller epoll_wait (nouvelle session, arrêt).
+        std::thread thread;
+        int cpu = -1;    // Coeur du thread (-1 = non épinglé)
+        // Vrai pendant l'attente active : le thread interroge epoll sans bloquer et relit les demandes de
+        // vidange à chaque tour, requestFlush() n'a pas besoin d'écrire dans wakeFd.
+        std::atomic<bool> spinning{false};
+
+        std::mutex pendingMutex; // Protège 'pending' et 'flushRequests' (alimentés depuis d'autres threads).
+        std::vector<std::shared_ptr<ClientSession>> pending;
+        std::vector<int> flushRequests; // Sockets dont la file d'envoi vient de recevoir un message.
+
+        // Sessions surveillées, indexées par descripteur de socket. Accédée uniquement par le thread d'E/S.
+        std::unordered_map<int, SessionEntry> sessions;
+        // Sockets surveillés aussi en écriture (EPOLLOUT) car leur file d'envoi n'a pas pu être vidée.
+        std::unordered_set<int> waitingWritable;
+
+        // Timers des sessions de ce thread. Accédée uniquement par le thread d'E/S.
+        TimingWheel timers{std::chrono::milliseconds(TIMER_TICK_MS)};
+        std::vector<uint64_t> expiredTimers; // Réutilisé à chaque tour (pas d'allocation en régime établi)
+    };
+
+    void ioLoop(IoWorker& worker);
+    void adoptPendingSessions(IoWorker& worker);
+    void closeSession(IoWorker& worker, int fd);
+    // Demande (depuis n'importe quel thread) la vidange de la file d'envoi d'un socket du worker.
+    void requestFlush(IoWorker& worker, int fd);
+    size_t processFlushRequests(IoWorker& worker); // Retourne le nombre de demandes traitées
+    // Vide la file d'envoi de la session et ajuste l'abonnement EPOLLOUT. Retourne false si la session doit être fermée.
+    bool flushSession(IoWorker& worker, int fd, ClientSession& session);
+    // Arme les timers d'une session qui vient d'être adoptée. Retourne false si elle a déjà expiré.
+    bool armSessionTimers(IoWorker& worker, int fd, SessionEntry& entry);
+    // Traite les timers échus du worker (inactivité, heartbeat, bot).
+    void processTimers(IoWorker& worker);
+    void armTimer(IoWorker& worker, int fd, TimerKind kind, std::chrono::milliseconds delay, TimingWheel::TimerId& id);
+
+    std::vector<std::unique_ptr<IoWorker>> workers;
+    std::atomic<bool> running;
+    std::atomic<size_t> nextWorker; // Compteur round-robin pour l'affectation des sessions.
+    std::chrono::microseconds spinWait{0};
+    CloseHandler closeHandler;
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef SHM_GATEWAY_H
+#define SHM_GATEWAY_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+
+#include "ShmRing.h"
+#include "TransactionQueue.h"
+#include "Logger.h"
+
+// --- Canal d'un client de la passerelle en mémoire partagée ---
+// Possède le segment (memfd projeté) et les deux eventfds :
+//   orderDoorbell  : le client réveille le thread de la passerelle (anneau des ordres)
+//   reportDoorbell : le serveur réveille le client (anneau des rapports)
+// Le canal est aussi le TransactionReportSink des ordres qu'il a soumis : le thread de la TQ y dépose
+// directement les rapports d'exécution. Il vit tant qu'un ordre en cours le référence.
+class ShmChannel : public TransactionReportSink {
+public:
+    ShmChannel(const std::string& clientId, int memFd, void* mapping, size_t mappingSize, int orderDoorbell, int reportDoorbell);
+    ~ShmChannel() override;
+
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+
+    // Thread de la TQ : rapport d'exécution vers l'anneau des rapports (jamais bloquant : anneau plein = rapport perdu, compté).
+    void onTransactionResult(const Transaction& tx, uint64_t correlationId) override;
+    // Rapport de refus immédiat (ordre invalide), sans passer par la TQ.
+    void reject(const ShmOrderRecord& order, const char* reason);
+
+    const std::string& getClientId() const { return clientId; }
+    int getMemFd() const { return memFd; }
+    int getOrderDoorbell() const { return orderDoorbell; }
+    int getReportDoorbell() const { return reportDoorbell; }
+    size_t getMappingSize() const { return mappingSize; }
+    uint32_t getOrderCapacity() const;
+    uint32_t getReportCapacity() const;
+
+    bool isClosed() const { return closed.load(std::memory_order_acquire); }
+    void close() { closed.store(true, std::memory_order_release); }
+
+    // Accès réservé au thread de la passerelle (consommateur des ordres).
+    ShmRing<ShmOrderRecord>& getOrderRing() { return orderRing; }
+
+    std::atomic<uint64_t> ordersReceived{0};
+    std::atomic<uint64_t> reportsSent{0};
+    std::atomic<uint64_t> reportsDropped{0};
+
+private:
+    void pushReport(const ShmReportRecord& report);
+
+    std::string clientId;
+    int memFd;
+    void* mapping;
+    size_t mappingSize;
+    int orderDoorbell;
+    int reportDoorbell;
+    ShmRing<ShmOrderRecord> orderRing;
+    ShmRing<ShmReportRecord> reportRing;
+    std::mutex reportMutex; // Un seul producteur à la fois sur l'anneau des rapports (TQ, passerelle pour les refus)
+    std::atomic<bool> closed{false};
+};
+
+// --- Classe ShmGateway ---
+// Soumission d'ordres en mémoire partagée pour les stratégies co-localisées, sans socket ni protocole
+// texte sur le chemin critique. Un client déjà authentifié sur le socket Unix (ServerOptions::unixSocketPath)
+// demande "SHM ATTACH" : sa session crée un canal et lui transmet le memfd et les deux eventfds (SCM_RIGHTS).
+// Les ordres sont ensuite lus par un thread unique qui scrute tous les canaux et les dépose directement
+// dans la TransactionQueue (mêmes contrôles de fonds et même historique que les autres ordres).
+//
+// Le thread attend activement 'spinMicros' après le dernier ordre reçu (latence minimale en rafale),
+// puis dort dans epoll sur les eventfds des canaux (aucun coût CPU à vide).
+class ShmGateway {
+public:
+    // 'ringCapacity' : nombre d'ordres (et de rapports) par anneau, puissance de 2.
+    ShmGateway(uint32_t ringCapacity, int spinMicros);
+    ~ShmGateway();
+
+    ShmGateway(const ShmGateway&) = delete;
+    ShmGateway& operator=(const ShmGateway&) = delete;
+
+    bool start();
+    void stop();
+
+    // Crée le canal d'un client. 'clientFds' reçoit des copies (à transmettre puis fermer) du memfd,
+    // de l'eventfd des ordres et de celui des rapports, dans cet ordre. Retourne nullptr en cas d'échec.
+    std::shared_ptr<ShmChannel> attach(const std::string& clientId, std::vector<int>& clientFds);
+    // Ferme le canal (fin de session) : ses ordres ne sont plus lus, les rapports en cours sont ignorés.
+    void detach(const std::shared_ptr<ShmChannel>& channel);
+
+    uint32_t getRingCapacity() const { return ringCapacity; }
+
+private:
+    void pollLoop();
+    // Lit les ordres d'un canal et les soumet à la TQ. Retourne le nombre d'ordres lus.
+    size_t drainChannel(const std::shared_ptr<ShmChannel>& channel);
+    void submitOrder(const std::shared_ptr<ShmChannel>& channel, const ShmOrderRecord& order);
+    void removeChannel(const std::shared_ptr<ShmChannel>& channel);
+
+    uint32_t ringCapacity;
+    int spinMicros;
+    int epollFd;
+    int wakeFd;
+    std::thread thread;
+    std::atomic<bool> running;
+
+    std::mutex channelsMutex; // Protège channels et channelsVersion
+    std::unordered_map<int, std::shared_ptr<ShmChannel>> channels; // Par eventfd des ordres
+    uint64_t channelsVersion;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef SHM_ORDER_CLIENT_H
+#define SHM_ORDER_CLIENT_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "ShmRing.h"
+
+// --- Classe ShmOrderClient ---
+// Bibliothèque cliente de la passerelle en mémoire partagée (voir ShmGateway.h), pour les stratégies
+// qui tournent sur la même machine que le serveur.
+//
+// connect() ouvre une session sur le socket Unix du serveur, s'authentifie puis demande "SHM ATTACH" :
+// le serveur répond en joignant le memfd du segment et les deux eventfds. Ensuite :
+//   submit()     copie l'ordre dans l'anneau (aucun appel système, sauf si la passerelle dort)
+//   poll()       lit un rapport d'exécution s'il y en a un
+//   waitReport() attend un rapport : attente active 'spinMicros', puis sommeil sur l'eventfd
+// La session texte reste ouverte (sa fermeture ferme le canal) : serviceSocket() répond aux PING du
+// serveur, appelée aussi par waitReport() pendant le sommeil.
+//
+// Un objet ShmOrderClient n'est pas thread-safe : un seul thread soumet et lit les rapports (SPSC).
+class ShmOrderClient {
+public:
+    ShmOrderClient() = default;
+    ~ShmOrderClient();
+
+    ShmOrderClient(const ShmOrderClient&) = delete;
+    ShmOrderClient& operator=(const ShmOrderClient&) = delete;
+
+    // 'password' peut être vide si 'clientId' est le compte lié à l'UID du processus (ServerOptions::unixPeerAccounts).
+    bool connect(const std::string& socketPath, const std::string& clientId, const std::string& password = "");
+    void close();
+    bool isConnected() const { return mapping != nullptr; }
+
+    // false : anneau plein (la passerelle n'a pas encore lu les ordres précédents) ou canal inutilisable.
+    bool submit(uint64_t clientOrderId, ShmLayout::Side side, double quantity, const std::string& symbol = "SRD-BTC");
+    bool poll(ShmReportRecord& report);
+    // false après 'timeoutMs' sans rapport (timeoutMs < 0 : pas de limite).
+    bool waitReport(ShmReportRecord& report, int timeoutMs, int spinMicros = 50);
+
+    // Lit sans bloquer les lignes reçues sur le socket de la session et répond aux PING.
+    // Retourne false si la session a été fermée par le serveur.
+    bool serviceSocket();
+
+    uint32_t getOrderCapacity() const { return orderRing.getCapacity(); }
+    uint32_t getReportCapacity() const { return reportRing.getCapacity(); }
+
+private:
+    bool sendLine(const std::string& line);
+    // Lit une ligne (bloquant) ; les descripteurs joints (SCM_RIGHTS) sont ajoutés à 'receivedFds'.
+    bool receiveLine(std::string& line);
+    bool receiveChunk(int flags);
+    bool mapSegment(uint32_t orderCapacity, uint32_t reportCapacity, size_t size);
+
+    int socketFd = -1;
+    int memFd = -1;
+    int orderDoorbell = -1;
+    int reportDoorbell = -1;
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    ShmRing<ShmOrderRecord> orderRing;   // Côté producteur
+    ShmRing<ShmReportRecord> reportRing; // Côté consommateur
+    std::string inputBuffer;
+    std::vector<int> receivedFds;
+    bool socketClosed = false;
+};
+
+#endif
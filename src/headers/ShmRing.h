@@ -0,0 +1,197 @@
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+
+// --- Passerelle d'ordres en mémoire partagée : disposition commune serveur / client ---
+// Un segment (memfd) par client, projeté par les deux processus :
+//
+//   ShmSegmentHeader (contrôle des deux anneaux, chaque compteur sur sa propre ligne de cache)
+//   orderCapacity  x ShmOrderRecord  (client -> serveur)
+//   reportCapacity x ShmReportRecord (serveur -> client)
+//
+// Chaque anneau a un seul producteur et un seul consommateur (SPSC) : aucune instruction atomique
+// coûteuse, uniquement des load-acquire / store-release sur les positions. Les enregistrements ont une
+// taille fixe (une ou deux lignes de cache) et sont copiés dans l'anneau, jamais sérialisés.
+//
+// Réveil : un consommateur qui n'a plus rien à lire attend d'abord activement, puis lève son drapeau
+// 'consumerWaiting' et dort sur un eventfd. Le producteur n'écrit dans l'eventfd (appel système) que
+// si ce drapeau est levé : en régime établi, la soumission d'un ordre ne fait aucun appel système.
+//
+// Le segment est partagé avec un processus client : le serveur ne fait jamais confiance à son contenu
+// (positions incohérentes = canal fermé, champs des ordres validés comme ceux des commandes texte).
+namespace ShmLayout {
+
+constexpr uint32_t MAGIC = 0x50504E47; // "PPNG"
+constexpr uint32_t VERSION = 1;
+constexpr size_t CACHE_LINE = 64;
+constexpr size_t SYMBOL_SIZE = 16;
+constexpr size_t TRANSACTION_ID_SIZE = 40;
+constexpr size_t REASON_SIZE = 40;
+
+// Sens d'un ordre (valeurs fixes du format, indépendantes de RequestType).
+enum class Side : uint8_t { BUY = 1, SELL = 2 };
+
+} // namespace ShmLayout
+
+// Ordre (64 octets). 'quantity' est une quantité de crypto (pas un pourcentage du solde).
+struct ShmOrderRecord {
+    uint64_t clientOrderId = 0;            // Choisi par le client, repris dans le rapport
+    uint8_t side = 0;                      // ShmLayout::Side
+    uint8_t reserved[7] = {};
+    double quantity = 0.0;
+    char symbol[ShmLayout::SYMBOL_SIZE] = {}; // Complété par des '\0'
+    uint64_t reserved2[3] = {};
+};
+static_assert(sizeof(ShmOrderRecord) == ShmLayout::CACHE_LINE, "Un ordre occupe exactement une ligne de cache.");
+
+// Rapport d'exécution (128 octets).
+struct ShmReportRecord {
+    uint64_t clientOrderId = 0;
+    uint8_t status = 0;                    // TransactionStatus
+    uint8_t side = 0;                      // ShmLayout::Side
+    uint8_t reserved[6] = {};
+    double quantity = 0.0;
+    double unitPrice = 0.0;
+    double totalAmount = 0.0;
+    double fee = 0.0;
+    char transactionId[ShmLayout::TRANSACTION_ID_SIZE] = {};
+    char reason[ShmLayout::REASON_SIZE] = {}; // Raison de l'échec, tronquée, terminée par '\0'
+};
+static_assert(sizeof(ShmReportRecord) == 2 * ShmLayout::CACHE_LINE, "Un rapport occupe exactement deux lignes de cache.");
+
+// Contrôle d'un anneau : positions monotones (jamais remises à zéro), indice = position & (capacité - 1).
+struct ShmRingControl {
+    alignas(ShmLayout::CACHE_LINE) std::atomic<uint64_t> head{0};            // Écrit par le consommateur
+    alignas(ShmLayout::CACHE_LINE) std::atomic<uint64_t> tail{0};            // Écrit par le producteur
+    alignas(ShmLayout::CACHE_LINE) std::atomic<uint32_t> consumerWaiting{0}; // 1 : le consommateur dort sur l'eventfd
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "Les atomiques en mémoire partagée doivent être sans verrou.");
+
+struct ShmSegmentHeader {
+    uint32_t magic = ShmLayout::MAGIC;
+    uint32_t version = ShmLayout::VERSION;
+    uint32_t orderCapacity = 0;
+    uint32_t reportCapacity = 0;
+    ShmRingControl orders;
+    ShmRingControl reports;
+};
+
+namespace ShmLayout {
+
+inline bool isValidCapacity(uint32_t capacity) {
+    return capacity >= 2 && (capacity & (capacity - 1)) == 0;
+}
+
+inline size_t ordersOffset() {
+    return sizeof(ShmSegmentHeader);
+}
+
+inline size_t reportsOffset(uint32_t orderCapacity) {
+    return ordersOffset() + static_cast<size_t>(orderCapacity) * sizeof(ShmOrderRecord);
+}
+
+inline size_t segmentSize(uint32_t orderCapacity, uint32_t reportCapacity) {
+    return reportsOffset(orderCapacity) + static_cast<size_t>(reportCapacity) * sizeof(ShmReportRecord);
+}
+
+} // namespace ShmLayout
+
+// --- Vue sur un anneau SPSC du segment ---
+// Chaque processus crée sa propre vue, côté producteur ou côté consommateur : la position de l'autre
+// côté est mise en cache localement et relue seulement quand l'anneau paraît plein (ou vide).
+template <typename Record>
+class ShmRing {
+public:
+    ShmRing() = default;
+    ShmRing(ShmRingControl* control, Record* slots, uint32_t capacity)
+        : control(control), slots(slots), capacity(capacity), mask(capacity - 1),
+          localHead(control->head.load(std::memory_order_acquire)),
+          localTail(control->tail.load(std::memory_order_acquire))
+    {}
+
+    // --- Producteur ---
+    bool tryPush(const Record& record) {
+        if (localTail - localHead >= capacity) {
+            localHead = control->head.load(std::memory_order_acquire);
+            if (localHead > localTail) {
+                corrupted = true;
+            }
+            if (corrupted || localTail - localHead >= capacity) {
+                return false; // Plein : contre-pression vers l'appelant.
+            }
+        }
+        slots[localTail & mask] = record;
+        ++localTail;
+        control->tail.store(localTail, std::memory_order_release);
+        return true;
+    }
+
+    // Après tryPush : true si le consommateur dort et doit être réveillé (eventfd).
+    // La barrière ordonne la publication de 'tail' avant la lecture du drapeau (voir prepareToSleep).
+    bool consumerNeedsWakeup() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return control->consumerWaiting.load(std::memory_order_relaxed) != 0;
+    }
+
+    // --- Consommateur ---
+    bool tryPop(Record& record) {
+        if (localHead == localTail) {
+            localTail = control->tail.load(std::memory_order_acquire);
+            if (localTail < localHead || localTail - localHead > capacity) {
+                corrupted = true;
+            }
+            if (corrupted || localHead == localTail) {
+                return false;
+            }
+        }
+        record = slots[localHead & mask];
+        ++localHead;
+        control->head.store(localHead, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() {
+        if (localHead != localTail) {
+            return false;
+        }
+        localTail = control->tail.load(std::memory_order_acquire);
+        return localHead == localTail;
+    }
+
+    // Avant de dormir : lève le drapeau puis revérifie l'anneau. Retourne false (drapeau baissé) si un
+    // enregistrement est arrivé entre-temps ; sinon le producteur verra le drapeau et écrira l'eventfd.
+    bool prepareToSleep() {
+        control->consumerWaiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!empty()) {
+            control->consumerWaiting.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    void wokeUp() {
+        control->consumerWaiting.store(0, std::memory_order_relaxed);
+    }
+
+    // Position incohérente lue chez le pair (défaillant ou malveillant) : l'anneau est inutilisable.
+    bool isCorrupted() const { return corrupted; }
+
+    uint32_t getCapacity() const { return capacity; }
+
+private:
+    ShmRingControl* control = nullptr;
+    Record* slots = nullptr;
+    uint32_t capacity = 0;
+    uint64_t mask = 0;
+    uint64_t localHead = 0; // Consommateur : sa position ; producteur : dernière position lue du consommateur
+    uint64_t localTail = 0; // Producteur : sa position ; consommateur : dernière position lue du producteur
+    bool corrupted = false;
+};
+
+#endif
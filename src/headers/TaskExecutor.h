@@ -0,0 +1,197 @@
+#ifndef TASK_EXECUTOR_H
+#define TASK_EXECUTOR_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Logger.h"
+
+// --- Classe InlineTask ---
+// Tâche "type-erased" (appelable sans argument), déplaçable mais non copiable.
+// Contrairement à std::function, une capture de petite taille (jusqu'à INLINE_SIZE octets, ex:
+// [this, fd, ssl]) est stockée DANS l'objet : soumettre une tâche ne fait alors aucune allocation.
+// Les captures plus grosses sont allouées sur le tas (repli comptabilisé par l'exécuteur).
+class InlineTask {
+public:
+    static constexpr size_t INLINE_SIZE = 48;
+
+    InlineTask() noexcept = default;
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InlineTask>>>
+    InlineTask(F&& function) {
+        using Fn = std::decay_t<F>;
+        if constexpr (fitsInline<Fn>()) {
+            ::new (static_cast<void*>(storage)) Fn(std::forward<F>(function));
+            ops = &inlineOps<Fn>;
+        } else {
+            ::new (static_cast<void*>(storage)) Fn*(new Fn(std::forward<F>(function)));
+            ops = &heapOps<Fn>;
+        }
+    }
+
+    InlineTask(InlineTask&& other) noexcept {
+        moveFrom(other);
+    }
+
+    InlineTask& operator=(InlineTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    InlineTask(const InlineTask&) = delete;
+    InlineTask& operator=(const InlineTask&) = delete;
+
+    ~InlineTask() {
+        reset();
+    }
+
+    void operator()() {
+        ops->invoke(storage);
+    }
+
+    explicit operator bool() const noexcept { return ops != nullptr; }
+    // Vrai si la capture est stockée dans l'objet (pas d'allocation).
+    bool isInline() const noexcept { return ops != nullptr && ops->storedInline; }
+
+    void reset() noexcept {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+private:
+    // Table d'opérations propre à chaque type de capture (remplace les fonctions virtuelles).
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*relocate)(void* destination, void* source) noexcept; // Déplace puis détruit la source
+        void (*destroy)(void* storage) noexcept;
+        bool storedInline;
+    };
+
+    template <typename Fn>
+    static constexpr bool fitsInline() {
+        return sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+    template <typename Fn>
+    static inline constexpr Ops inlineOps = {
+        [](void* s) { (*std::launder(static_cast<Fn*>(s)))(); },
+        [](void* d, void* s) noexcept {
+            Fn* source = std::launder(static_cast<Fn*>(s));
+            ::new (d) Fn(std::move(*source));
+            source->~Fn();
+        },
+        [](void* s) noexcept { std::launder(static_cast<Fn*>(s))->~Fn(); },
+        true
+    };
+
+    template <typename Fn>
+    static inline constexpr Ops heapOps = {
+        [](void* s) { (**std::launder(static_cast<Fn**>(s)))(); },
+        [](void* d, void* s) noexcept { ::new (d) Fn*(*std::launder(static_cast<Fn**>(s))); },
+        [](void* s) noexcept { delete *std::launder(static_cast<Fn**>(s)); },
+        false
+    };
+
+    void moveFrom(InlineTask& other) noexcept {
+        ops = other.ops;
+        if (ops) {
+            ops->relocate(storage, other.storage);
+            other.ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+    const Ops* ops = nullptr;
+};
+
+
+// --- Compteurs de l'exécuteur (voir WorkStealingExecutor::getStats) ---
+struct ExecutorStats {
+    size_t threads = 0;
+    std::vector<size_t> queueDepths; // Tâches en attente dans la file de chaque worker
+    size_t queuedTasks = 0;          // Total des tâches en attente
+    size_t peakQueuedTasks = 0;      // Maximum observé du total en attente
+    uint64_t submitted = 0;
+    uint64_t executed = 0;
+    uint64_t stolen = 0;             // Tâches prises dans la file d'un autre worker
+    uint64_t heapAllocatedTasks = 0; // Tâches dont la capture dépassait InlineTask::INLINE_SIZE
+};
+
+// --- Classe WorkStealingExecutor ---
+// Pool de threads à files par worker avec vol de travail (remplace la file unique sous mutex du Server).
+//  - Chaque worker possède sa propre deque protégée par son propre mutex : il y dépose (submit depuis
+//    une tâche) et y reprend ses tâches par la fin (LIFO, données encore chaudes en cache).
+//  - Les soumissions externes (threads d'acceptation/handshake) sont réparties en tourniquet.
+//  - Un worker dont la file est vide vole la tâche la plus ancienne (début de deque) d'un autre worker
+//    avant de s'endormir : la contention se limite aux vols au lieu de porter sur chaque tâche.
+// stop() laisse les workers terminer les tâches déjà soumises avant de les joindre.
+class WorkStealingExecutor {
+public:
+    // Param threads: Nombre de workers (0 = max(DEFAULT_MIN_THREADS, nombre de coeurs), borné à MAX_THREADS).
+    explicit WorkStealingExecutor(int threads);
+    ~WorkStealingExecutor();
+
+    WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+    WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+    bool start();
+    void stop();
+
+    // Soumet une tâche. Retourne false si l'exécuteur n'est pas démarré (la tâche est alors détruite sans être exécutée).
+    bool submit(InlineTask task);
+
+    size_t getThreadCount() const;
+    ExecutorStats getStats() const;
+    void logStats() const;
+
+    // Les tâches de connexion (authentification) bloquent sur les E/S du client : on garde au moins
+    // ce nombre de workers par défaut, même sur une machine à un seul coeur.
+    static constexpr int DEFAULT_MIN_THREADS = 4;
+    static constexpr int MAX_THREADS = 64;
+
+private:
+    struct Worker {
+        mutable std::mutex mutex;
+        std::deque<InlineTask> tasks;
+        std::thread thread;
+    };
+
+    void workerLoop(size_t index);
+    bool popLocal(size_t index, InlineTask& task);
+    bool steal(size_t thief, InlineTask& task);
+    void push(size_t index, InlineTask&& task);
+    void runTask(InlineTask& task);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> running;
+    std::atomic<size_t> nextWorker;
+
+    // Endormissement des workers inactifs.
+    std::mutex sleepMutex;
+    std::condition_variable sleepCv;
+    std::atomic<size_t> pendingTasks; // Tâches soumises et pas encore prises par un worker
+    std::atomic<size_t> idleWorkers;  // Workers endormis (ou sur le point de l'être)
+
+    std::atomic<size_t> peakPending;
+    std::atomic<uint64_t> submitted;
+    std::atomic<uint64_t> executed;
+    std::atomic<uint64_t> stolen;
+    std::atomic<uint64_t> heapAllocated;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// --- Classe TimingWheel ---
+// Roue de temporisation hiérarchique (à la manière des timers historiques du noyau Linux) :
+// LEVELS niveaux de SLOTS cases. Le niveau 0 couvre les SLOTS prochains ticks, le niveau 1 les
+// SLOTS^2 suivants, etc. Un timer est rangé dans la case correspondant à son échéance ; les cases
+// d'un niveau supérieur sont redistribuées ("cascade") vers les niveaux inférieurs quand le niveau
+// inférieur a fait un tour complet.
+//  - arm() et cancel() sont en O(1) : les timers sont des noeuds de listes doublement chaînées
+//    stockés dans un tableau (pas d'allocation par timer une fois le tableau dimensionné).
+//  - advance() ne coûte que le nombre de ticks écoulés plus le nombre de timers échus/redistribués,
+//    quel que soit le nombre de timers armés (100k timers = 100k noeuds, aucun parcours).
+// Les échéances sont arrondies au tick SUPÉRIEUR : un timer n'expire jamais avant son délai.
+// Pas de synchronisation interne : une roue appartient à un seul thread (ex: un thread d'E/S du réacteur).
+class TimingWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    // Identifiant d'un timer armé (0 = aucun). Contient une génération : un identifiant périmé
+    // (timer déjà expiré ou annulé, noeud réutilisé) est ignoré par cancel().
+    using TimerId = uint64_t;
+
+    static constexpr size_t LEVELS = 4;
+    static constexpr size_t SLOT_BITS = 6;
+    static constexpr size_t SLOTS = size_t(1) << SLOT_BITS;
+
+    // Param tick: Résolution de la roue.
+    explicit TimingWheel(std::chrono::milliseconds tick, Clock::time_point now = Clock::now());
+
+    // Arme un timer qui expirera dans 'delay' (borné à la portée de la roue, SLOTS^LEVELS ticks).
+    // 'userData' est restitué tel quel par advance().
+    TimerId arm(std::chrono::milliseconds delay, uint64_t userData);
+    // Désarme un timer. Retourne false s'il avait déjà expiré ou été annulé.
+    bool cancel(TimerId id);
+
+    // Fait avancer la roue jusqu'à 'now' et ajoute à 'expired' le userData de chaque timer échu
+    // (dans l'ordre des échéances, à la résolution du tick près). Retourne le nombre de timers échus.
+    // Les callbacks de l'appelant peuvent ré-armer/annuler des timers après l'appel.
+    size_t advance(Clock::time_point now, std::vector<uint64_t>& expired);
+
+    // Délai jusqu'au prochain tick à traiter (timeout d'epoll_wait), ou -1 si aucun timer n'est armé.
+    int millisecondsUntilNextTick(Clock::time_point now) const;
+
+    size_t size() const { return armedCount; }
+    std::chrono::milliseconds getTick() const { return tickDuration; }
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+
+    struct Node {
+        uint64_t expireTick = 0;
+        uint64_t userData = 0;
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        uint32_t generation = 1;
+        uint32_t bucket = NIL; // Case (niveau * SLOTS + slot) ; NIL = noeud libre
+    };
+
+    void place(uint32_t index);
+    void link(uint32_t index, uint32_t bucket);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void cascade(size_t level);
+    uint64_t tickOf(Clock::time_point time) const;
+
+    std::chrono::milliseconds tickDuration;
+    Clock::time_point origin;
+    uint64_t currentTick = 0; // Prochain tick à traiter
+
+    std::vector<Node> nodes;
+    uint32_t freeHead = NIL; // Noeuds libres, chaînés par 'next'
+    std::array<uint32_t, LEVELS * SLOTS> heads;
+    size_t armedCount = 0;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef TLS_HANDSHAKE_POOL_H
+#define TLS_HANDSHAKE_POOL_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include <openssl/ssl.h>
+
+#include "OpenSSLDeleters.h"
+#include "Logger.h"
+
+// --- Classe TlsHandshakePool ---
+// Exécute les handshakes TLS serveur HORS du thread d'acceptation.
+// Le thread d'acceptation se contente d'accept() puis de submit(fd) : il ne bloque jamais
+// sur un aller-retour TLS. Chaque thread de handshake possède son propre epoll et fait
+// avancer SSL_accept() comme une machine à états reprenable sur socket non bloquant :
+// WANT_READ -> attente EPOLLIN, WANT_WRITE -> attente EPOLLOUT, succès -> callback.
+// Un client lent ou malveillant n'occupe donc qu'une entrée de table, et le coût CPU
+// des handshakes est réparti sur plusieurs coeurs.
+class TlsHandshakePool {
+public:
+    // Callback invoquée (depuis un thread de handshake) quand le handshake a réussi.
+    // Le socket est repassé en mode bloquant ; la callback prend possession du SSL* et du fd.
+    using CompletionHandler = std::function<void(int clientSocket, SSL* ssl)>;
+    // Callback invoquée juste avant que le pool ferme un socket dont le handshake n'a pas abouti
+    // (échec, délai dépassé, arrêt du pool). Le fd est encore ouvert pendant l'appel.
+    using CloseHandler = std::function<void(int clientSocket)>;
+
+    // Param ctx: Contexte SSL serveur (doit survivre au pool).
+    // Param threads: Nombre de threads de handshake (0 = nombre de coeurs, borné à [1, 8]).
+    // Param timeoutMs: Durée maximale d'un handshake avant abandon de la connexion.
+    TlsHandshakePool(SSL_CTX* ctx, int threads, int timeoutMs);
+    ~TlsHandshakePool();
+
+    TlsHandshakePool(const TlsHandshakePool&) = delete;
+    TlsHandshakePool& operator=(const TlsHandshakePool&) = delete;
+
+    bool start();
+    // Arrête les threads et ferme les connexions dont le handshake n'est pas terminé.
+    void stop();
+
+    // Confie un socket fraîchement accepté au pool. Ne bloque pas.
+    bool submit(int clientSocket);
+
+    void setCompletionHandler(CompletionHandler handler);
+    void setCloseHandler(CloseHandler handler);
+
+    size_t getThreadCount() const;
+
+    // --- Compteurs (lecture thread-safe) ---
+    uint64_t getCompletedCount() const { return completed.load(std::memory_order_relaxed); }
+    uint64_t getFailedCount() const { return failed.load(std::memory_order_relaxed); }
+    uint64_t getTimedOutCount() const { return timedOut.load(std::memory_order_relaxed); }
+
+private:
+    // État d'un handshake en cours.
+    struct Handshake {
+        int fd = -1;
+        UniqueSSL ssl;
+        std::chrono::steady_clock::time_point deadline;
+        uint32_t watchedEvents = 0; // Événements epoll actuellement surveillés (0 = pas encore enregistré).
+    };
+
+    struct Worker {
+        int epollFd = -1;
+        int wakeFd = -1;
+        std::thread thread;
+
+        std::mutex pendingMutex;
+        std::vector<int> pending; // Sockets soumis par le thread d'acceptation.
+
+        std::unordered_map<int, Handshake> inProgress; // Accédée uniquement par le thread du worker.
+    };
+
+    void workerLoop(Worker& worker);
+    void adoptPending(Worker& worker);
+    // Fait avancer le handshake. Retourne true s'il est terminé (succès ou échec) et doit quitter la table.
+    bool advance(Worker& worker, Handshake& hs);
+    void abandon(Worker& worker, Handshake& hs);
+    void expireHandshakes(Worker& worker);
+    // Prévient closeHandler puis ferme le socket.
+    void closeSocket(int fd);
+
+    SSL_CTX* ctx;
+    int timeoutMs;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> running;
+    std::atomic<size_t> nextWorker;
+    CompletionHandler completionHandler;
+    CloseHandler closeHandler;
+
+    std::atomic<uint64_t> completed;
+    std::atomic<uint64_t> failed;
+    std::atomic<uint64_t> timedOut;
+
+    static constexpr int POLL_INTERVAL_MS = 250; // Granularité de la vérification des délais.
+};
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef TLS_RESUMPTION_H
+#define TLS_RESUMPTION_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <openssl/ssl.h>
+#include <openssl/evp.h>
+
+#include "Logger.h"
+
+// --- Réglages de la reprise de session TLS (voir ServerOptions) ---
+struct TlsResumptionConfig {
+    // Tickets de session "stateless" (chiffrés par le serveur, conservés par le client).
+    bool sessionTickets = true;
+    // Période de rotation de la clé des tickets. La clé précédente reste acceptée une période de plus.
+    int ticketKeyRotationSec = 3600;
+    // Cache de sessions partagé en mémoire (reprise "stateful" par identifiant). Si activé, il remplace
+    // les tickets stateless : le client reçoit un identifiant, la session reste côté serveur.
+    bool sharedSessionStore = false;
+    // Nombre maximal de sessions conservées (éviction LRU).
+    size_t sessionStoreCapacity = 20000;
+    // Durée de vie d'une session reprenable.
+    int sessionLifetimeSec = 7200;
+};
+
+// --- Compteurs de reprise ---
+struct TlsResumptionStats {
+    uint64_t resumedHandshakes = 0; // Handshakes terminés par reprise (succès)
+    uint64_t fullHandshakes = 0;    // Handshakes complets (pas de reprise)
+    uint64_t ticketKeyHits = 0;     // Tickets présentés dont la clé est connue
+    uint64_t ticketKeyMisses = 0;   // Tickets présentés avec une clé inconnue/expirée
+    uint64_t storeHits = 0;         // Sessions trouvées dans le cache partagé
+    uint64_t storeMisses = 0;       // Sessions demandées mais absentes du cache partagé
+    uint64_t storeEvictions = 0;    // Sessions évincées (capacité atteinte)
+    size_t storeSize = 0;
+};
+
+// --- Classe TlsResumption ---
+// Rend la reprise de session TLS effective sur le contexte serveur :
+//  - clés de tickets tournantes (callback SSL_CTX_set_tlsext_ticket_key_evp_cb),
+//  - cache de sessions borné partagé par tous les threads de handshake (callbacks new/get/remove),
+//  - compteurs de reprise (hit/miss).
+// Une instance est attachée à un SSL_CTX via install() et doit survivre à ce contexte.
+class TlsResumption {
+public:
+    explicit TlsResumption(const TlsResumptionConfig& config);
+    ~TlsResumption();
+
+    TlsResumption(const TlsResumption&) = delete;
+    TlsResumption& operator=(const TlsResumption&) = delete;
+
+    // Configure le cache de sessions et les tickets du contexte. Retourne false en cas d'échec.
+    bool install(SSL_CTX* ctx);
+
+    // À appeler pour chaque handshake serveur terminé avec succès (comptage reprise/complet).
+    void recordHandshake(const SSL* ssl);
+
+    TlsResumptionStats getStats() const;
+    void logStats() const;
+
+private:
+    // --- Clés de tickets ---
+    struct TicketKey {
+        unsigned char name[16] = {};
+        unsigned char aesKey[32] = {};
+        unsigned char hmacKey[32] = {};
+        std::chrono::steady_clock::time_point created;
+    };
+    bool generateKey(TicketKey& key);
+    void rotateKeysIfNeeded(); // Appelée avec keysMutex verrouillé.
+
+    static int ticketKeyCallback(SSL* ssl, unsigned char keyName[16], unsigned char* iv,
+                                 EVP_CIPHER_CTX* cipherCtx, EVP_MAC_CTX* macCtx, int enc);
+
+    // --- Cache de sessions partagé ---
+    static int newSessionCallback(SSL* ssl, SSL_SESSION* session);
+    static void removeSessionCallback(SSL_CTX* ctx, SSL_SESSION* session);
+    static SSL_SESSION* getSessionCallback(SSL* ssl, const unsigned char* id, int idLen, int* copy);
+
+    void storeSession(SSL_SESSION* session);
+    SSL_SESSION* lookupSession(const unsigned char* id, int idLen);
+    void eraseSession(SSL_SESSION* session);
+
+    static TlsResumption* fromSsl(const SSL* ssl);
+
+    TlsResumptionConfig config;
+
+    mutable std::mutex keysMutex;
+    TicketKey currentKey;
+    TicketKey previousKey;
+    bool hasPreviousKey = false;
+
+    // LRU : la liste porte l'ordre d'utilisation (tête = plus récent), la map l'accès par identifiant.
+    mutable std::mutex storeMutex;
+    std::list<std::pair<std::string, SSL_SESSION*>> lru;
+    std::unordered_map<std::string, std::list<std::pair<std::string, SSL_SESSION*>>::iterator> index;
+
+    std::atomic<uint64_t> resumedHandshakes;
+    std::atomic<uint64_t> fullHandshakes;
+    std::atomic<uint64_t> ticketKeyHits;
+    std::atomic<uint64_t> ticketKeyMisses;
+    std::atomic<uint64_t> storeHits;
+    std::atomic<uint64_t> storeMisses;
+    std::atomic<uint64_t> storeEvictions;
+};
+
+#endif
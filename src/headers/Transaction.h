@@ -27,7 +27,7 @@ private:
     std::string failureReason; // Raison de l'échec si applicable
 
     // Membres statiques pour la génération d'ID et la persistance du compteur (définis dans Transaction.cpp).
-    static int counter;
+    static long long counter;
     static std::mutex counterMutex;
     static std::mutex persistenceMutex;
 
@@ -73,10 +73,17 @@ public: // <<< SECTION PUBLIQUE
 
     // Méthode statique pour logguer une transaction dans un fichier CSV global (thread-safe)
     static void logTransactionToCSV(const std::string& filePath, const Transaction& tx);
+    // En-tête et ligne CSV (format du log global, réutilisé par l'export EXPORT TRANSACTIONS)
+    static const char* csvHeader();
+    std::string toCSVLine() const;
 
     // Méthodes statiques pour la persistance du compteur (appelées par le serveur)
     static void loadCounter(const std::string& filename); // <<< DÉCLARATION AJOUTÉE
     static void saveCounter(const std::string& filename); // <<< DÉCLARATION AJOUTÉE
+    // Mise à jour à chaud : valeur courante (transmise au nouveau processus), et saut au-delà d'une valeur
+    // reçue pour que les deux processus ne produisent jamais le même suffixe d'ID.
+    static long long getCounter();
+    static void advanceCounter(long long floor); // counter = max(counter, floor)
 
     // TODO: Ajouter d'autres méthodes si nécessaire (ex: validation interne)
 };
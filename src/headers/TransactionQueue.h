@@ -2,6 +2,9 @@
 #define TRANSACTION_QUEUE_H
 
 #include "Transaction.h"
+#include "MpscRing.h"
+#include "GroupCommit.h"
+#include "MatchingEngine.h"
 
 #include <string>
 #include <queue>
@@ -13,16 +16,37 @@
 #include <unordered_map>
 #include <chrono> 
 #include <ctime>  
+#include <cstdint>
+#include <vector>
 
 // Forward declaration de ClientSession pour éviter une inclusion complète ici
 class ClientSession;
+class Wallet;
 
 // Enums pour les types de requêtes
-enum class RequestType { UNKNOWN_REQUEST, BUY, SELL };
+// CANCEL : retrait d'un ordre au repos (TransactionRequest::orderId).
+enum class RequestType { UNKNOWN_REQUEST, BUY, SELL, CANCEL };
+
+// Exécution d'un BUY/SELL :
+//  MARKET : quantité exécutée en entier, contre le carnet puis au prix de référence (commandes BUY/SELL en %).
+//  LIMIT  : jusqu'au prix limite ; le reste attend dans le carnet, fonds réservés dans le Wallet.
+//  IOC    : jusqu'au prix limite, le reste est annulé (immediate-or-cancel).
+//  FOK    : en entier jusqu'au prix limite, sinon rien (fill-or-kill).
+enum class OrderType { MARKET, LIMIT, IOC, FOK };
 
 // Déclarations des fonctions utilitaires pour convertir les enums en string et vice-versa
 // L'implémentation sera dans TransactionQueue.cpp
 std::string requestTypeToString(RequestType type);
+std::string orderTypeToString(OrderType type);
+
+
+// Destinataire du résultat d'une requête autre que la ClientSession (ex: canal en mémoire partagée,
+// voir ShmGateway.h). Appelé par le thread de la TQ : ne doit jamais bloquer.
+class TransactionReportSink {
+public:
+    virtual ~TransactionReportSink() = default;
+    virtual void onTransactionResult(const Transaction& tx, uint64_t correlationId) = 0;
+};
 
 
 // Structure représentant une requête de transaction entrante (avant traitement par la TQ)
@@ -31,6 +55,15 @@ struct TransactionRequest {
     RequestType type;
     std::string cryptoName;
     double quantity;
+    // Identifiant choisi par le client en mode pipeline (0 = aucun), renvoyé avec le TRANSACTION_RESULT.
+    uint64_t correlationId = 0;
+    // Si défini, reçoit le résultat à la place de ClientSession::applyTransactionRequest.
+    std::shared_ptr<TransactionReportSink> reportSink;
+    // Ordres LIMIT/IOC/FOK : prix limite (USD par unité).
+    OrderType orderType = OrderType::MARKET;
+    double limitPrice = 0.0;
+    // CANCEL : identifiant de l'ordre, donné par ORDER_STATUS ORDER=<id>.
+    uint64_t orderId = 0;
 
     // Constructeur pour créer une requête initiale
     TransactionRequest(const std::string& client_id, RequestType req_type, const std::string& crypto_name, double qty)
@@ -40,6 +73,10 @@ struct TransactionRequest {
 
 
 // Déclaration de la classe TransactionQueue
+// Les requêtes sont réparties entre plusieurs shards (une file + un thread de traitement chacun) selon le
+// hachage du clientId : les ordres d'un même client restent traités un par un, dans leur ordre d'arrivée,
+// par le même thread, tandis que des comptes différents s'exécutent en parallèle (chaque ordre ne verrouille
+// que le Wallet de son client).
 class TransactionQueue {
 public:
     TransactionQueue();
@@ -48,20 +85,95 @@ public:
     void start();
     void stop();
 
-    void addRequest(const TransactionRequest& request); // Thread-safe
+    // Thread-safe. La requête est déplacée dans l'anneau du shard (passer un temporaire ou std::move).
+    // Anneau plein : l'appelant attend qu'une case se libère (contre-pression, aucune requête perdue).
+    void addRequest(TransactionRequest request);
+
+    // Nombre de shards (avant start() ; 0 = nombre de coeurs, borné à MAX_SHARDS). Défaut : 1.
+    void setShardCount(size_t count);
+    size_t getShardCount() const;
+    static constexpr size_t MAX_SHARDS = 64;
+    static constexpr size_t SHARD_CAPACITY = 4096; // Requêtes en attente par shard (puissance de 2)
+    static constexpr double FEE_RATE = 0.0001;     // Frais, en proportion du montant échangé
+
+    // Profil faible latence (avant start()) : coeur du thread du premier shard (-1 = non épinglé), les shards
+    // suivants prenant les coeurs suivants, et attente active prolongée après chaque requête avant de dormir
+    // (0 = seulement la brève attente active par défaut, SPIN_POLLS lectures de l'anneau).
+    void setLatencyProfile(int cpu, std::chrono::microseconds spinWait);
+
+    // Group commit (avant start()) : écriture groupée du journal global et des Wallets, acquittement des
+    // clients après la mise sur disque de leur lot (voir GroupCommit.h).
+    void setGroupCommit(const GroupCommitConfig& config, const std::string& journalPath);
+
+    // Moteur d'appariement (carnet d'ordres par symbole). Démarré avant les shards, arrêté après eux.
+    MatchingEngine& getMatchingEngine() { return matchingEngine; }
 
     void registerSession(const std::shared_ptr<ClientSession>& session); // Thread-safe
-    void unregisterSession(const std::string& clientId); // Thread-safe
+    // Thread-safe. Annule aussi les ordres au repos du client (fonds réservés rendus à son Wallet).
+    void unregisterSession(const std::string& clientId);
 
 private:
-    void process();
+    // Entrée d'un shard : anneau MPSC sans verrou (les sessions y déposent, le worker retire). mtx/cv ne
+    // servent qu'à endormir le worker quand l'anneau reste vide : addRequest ne les touche que si
+    // l'anneau signale que le worker dort.
+    struct Shard {
+        Shard() : ring(SHARD_CAPACITY) {}
+        size_t index = 0;
+        MpscRing<TransactionRequest> ring;
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::thread worker;
+    };
+    static constexpr int SPIN_POLLS = 256; // Brève attente active du worker avant de dormir
+
+    void process(Shard& shard);
     void processRequest(const TransactionRequest& request);
-
-    std::queue<TransactionRequest> queue;
-    std::mutex mtx;
-    std::condition_variable cv;
+    static void notifyResult(const std::shared_ptr<ClientSession>& session, const std::shared_ptr<TransactionReportSink>& reportSink,
+                             uint64_t correlationId, const Transaction& transaction);
+    double executeMarketOrder(const TransactionRequest& request, double referencePrice, std::vector<Fill>& fills);
+
+    // --- Ordres à cours limité (voir OrderType) ---
+    // Propriétaire d'ordres au repos : le Wallet est gardé tant qu'il a des ordres dans le carnet, pour que
+    // les autres shards puissent régler leurs exécutions sans passer par la session. Les ordres ne survivent
+    // pas à une déconnexion : unregisterSession les annule (cancelAllOrders), et jusque-là les exécutions
+    // arrivées entre-temps sont réglées sur ce Wallet.
+    // Un ordre posé peut être exécuté (par un autre shard) avant que son propriétaire n'ait reçu son
+    // ORDER_STATUS : ses ORDER_FILL sont alors retenus et soumis juste après le statut.
+    struct RestingState {
+        uint32_t book = 0;
+        bool announced = false;             // ORDER_STATUS soumis au group commit
+        bool filled = false;                // Exécuté en entier avant d'être annoncé
+        std::vector<CommitEntry> heldFills; // ORDER_FILL en attente de l'annonce
+    };
+    struct OrderOwner {
+        std::string clientId;
+        std::shared_ptr<Wallet> wallet;
+        std::unordered_map<uint64_t, RestingState> restingOrders; // Identifiant -> état
+    };
+    void processLimitOrder(const TransactionRequest& request);
+    void processCancel(const TransactionRequest& request);
+    // Règle, côté teneur, les exécutions d'un ordre entrant (appelant sans aucun verrou de Wallet).
+    void settleMakers(const std::vector<Fill>& fills, OrderSide makerSide, uint32_t bookIndex, const std::string& symbol);
+    // Retire les ordres au repos d'un client et rend leurs fonds réservés.
+    void cancelAllOrders(const std::string& clientId);
+    uint32_t ownerFor(const std::string& clientId, const std::shared_ptr<Wallet>& wallet);
+    uint32_t findOwner(const std::string& clientId); // 0 si aucun ordre posé (ordres au marché)
+    std::shared_ptr<ClientSession> findSession(const std::string& clientId);
+    // Montant réservé (devise, montant) pour 'lots' au prix 'tick' d'un ordre de sens 'side'.
+    static std::pair<Currency, double> reservationFor(const OrderBook& book, OrderSide side, int64_t lots, int64_t tick);
+    static void notifyOrderStatus(const std::shared_ptr<ClientSession>& session, uint64_t correlationId, const std::string& status);
+    Shard& shardFor(const std::string& clientId);
+
+    std::vector<std::unique_ptr<Shard>> shards; // Fixé par start(), inchangé jusqu'à stop()
+    size_t shardCount = 1;
     std::atomic<bool> running;
-    std::thread worker;
+    int workerCpu = -1;
+    std::chrono::microseconds spinWait{0};
+    GroupCommit commitStage; // Démarré avant les shards, arrêté après eux (écrit leurs dernières requêtes)
+    MatchingEngine matchingEngine;
+    std::vector<OrderOwner> owners;                   // Indice = propriétaire dans le carnet (0 : aucun)
+    std::unordered_map<std::string, uint32_t> ownerIndex;
+    std::mutex ownersMtx;                             // Verrou feuille : pris sous celui d'un Wallet, jamais l'inverse
 
     std::unordered_map<std::string, std::weak_ptr<ClientSession>> sessionMap;
     std::mutex sessionMapMtx;
@@ -0,0 +1,95 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <sys/types.h>
+#include <openssl/ssl.h>
+
+#include "../headers/OpenSSLDeleters.h"
+
+// --- Transport d'une connexion ---
+// Couche octets sous ServerConnection : TLS (SSL_read/SSL_write) ou socket en clair (AF_UNIX local).
+// ServerConnection (file d'envoi, découpage en lignes/trames, fermeture) ne connaît que cette interface :
+// les deux transports partagent exactement le même chemin de traitement des commandes.
+// Les appels suivent le mode du socket : en non bloquant, WANT_READ/WANT_WRITE signalent qu'il faut
+// attendre le socket puis réessayer (avec les mêmes données pour write(), exigence d'OpenSSL).
+enum class TransportStatus {
+    OK,         // 'bytes' octets transférés (> 0)
+    WANT_READ,  // Rien à lire pour l'instant / attendre que le socket soit lisible
+    WANT_WRITE, // Buffer d'émission plein : attendre que le socket soit inscriptible
+    CLOSED,     // Fermeture propre par le pair
+    FAILED      // Erreur fatale (déjà loggée par le transport)
+};
+
+struct TransportResult {
+    long bytes = 0;
+    TransportStatus status = TransportStatus::FAILED;
+};
+
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    virtual TransportResult read(char* buffer, size_t size) = 0;
+    // Peut écrire partiellement (socket en clair) : l'appelant renvoie le reste.
+    virtual TransportResult write(const char* data, size_t size) = 0;
+    // Envoi direct d'une portion de fichier par le noyau, si canSendFile().
+    virtual TransportResult sendFile(int fileFd, off_t offset, size_t size) = 0;
+    virtual bool canSendFile() const = 0;
+    // Écriture accompagnée de descripteurs de fichiers (SCM_RIGHTS, socket Unix uniquement, si canPassDescriptors()).
+    // Les descripteurs partent avec le premier octet écrit ; l'appelant garde les siens (le noyau en crée des copies).
+    virtual TransportResult writeWithDescriptors(const char* data, size_t size, const std::vector<int>& fds) = 0;
+    virtual bool canPassDescriptors() const = 0;
+    // Fin de flux côté transport (close_notify en TLS). Ne ferme pas le socket.
+    virtual void shutdown() = 0;
+    virtual const char* name() const = 0;
+};
+
+// --- Transport TLS ---
+// Possède l'objet SSL. Détecte à la construction si le noyau a accepté le chiffrement (kTLS).
+class TlsTransport : public Transport {
+public:
+    explicit TlsTransport(SSL* ssl_ptr);
+
+    TransportResult read(char* buffer, size_t size) override;
+    TransportResult write(const char* data, size_t size) override;
+    TransportResult sendFile(int fileFd, off_t offset, size_t size) override;
+    bool canSendFile() const override { return kernelTlsSend; }
+    TransportResult writeWithDescriptors(const char*, size_t, const std::vector<int>&) override { return {0, TransportStatus::FAILED}; }
+    bool canPassDescriptors() const override { return false; }
+    void shutdown() override;
+    const char* name() const override { return kernelTlsSend ? "TLS (kTLS)" : "TLS"; }
+
+private:
+    // Traduit un échec SSL_read/SSL_write/SSL_sendfile (et le logge s'il est fatal).
+    TransportResult failure(long result, const char* operation);
+
+    UniqueSSL ssl;
+    bool kernelTlsSend = false;
+    bool kernelTlsRecv = false;
+};
+
+// --- Transport en clair ---
+// Socket local (AF_UNIX) dont le pair est authentifié par le noyau (SO_PEERCRED) : aucun chiffrement.
+class PlainTransport : public Transport {
+public:
+    explicit PlainTransport(int socket_fd);
+
+    TransportResult read(char* buffer, size_t size) override;
+    TransportResult write(const char* data, size_t size) override;
+    TransportResult sendFile(int fileFd, off_t offset, size_t size) override;
+    bool canSendFile() const override { return true; }
+    TransportResult writeWithDescriptors(const char* data, size_t size, const std::vector<int>& fds) override;
+    bool canPassDescriptors() const override { return true; }
+    void shutdown() override {}
+    const char* name() const override { return "clair (local)"; }
+
+private:
+    TransportResult failure(const char* operation);
+
+    int fd;
+};
+
+#endif
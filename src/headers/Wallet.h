@@ -7,6 +7,8 @@
 #include <mutex>
 #include <memory>
 #include <filesystem> 
+#include <functional>
+#include <unordered_map>
 
 #include "Transaction.h" 
 #include "Global.h"
@@ -23,8 +25,10 @@ private:
     std::string walletFilePath;
 
     // Données mutables du portefeuille - Protégées par walletMutex
-    std::map<Currency, double> balances; // Soldes par devise
+    std::map<Currency, double> balances; // Soldes par devise (disponibles)
+    std::map<Currency, double> reservedBalances; // Fonds bloqués par les ordres au repos (hors 'balances')
     std::vector<Transaction> transactionHistory; // Historique des transactions
+    std::unordered_map<std::string, size_t> historyIndex; // ID -> position dans transactionHistory (curseur de page)
 
     // Mutex pour protéger l'accès concurrent aux données mutables (balances, transactionHistory)
     // 'mutable' permet de locker/unlocker ce mutex dans les méthodes marquées 'const' (comme getBalance ou saveToFile si implémenté ainsi).
@@ -33,6 +37,12 @@ private:
     // --- Méthodes privées (gestion interne des fichiers/répertoires) ---
     std::string generateWalletFilePath(const std::string& dataDirPath) const; // Génère chemin fichier
     bool ensureWalletsDirectoryExists() const; // Assure répertoire existe
+    bool writeWalletFile(const std::string& path) const; // Écrit soldes + historique dans 'path'
+
+    // Portefeuilles vivants du processus, par client (voir liveClientIds). Protégés par liveMutex.
+    static std::mutex liveMutex;
+    static std::unordered_map<std::string, int> liveWallets;
+    static std::function<void(const std::string&)> releaseHandler;
 
 public:
     // --- Constructeur et destructeur ---
@@ -46,17 +56,58 @@ public:
     // Prend la devise et le montant à mettre à jour
     void updateBalance(Currency currency, double amount);
 
+    // --- Fonds réservés par les ordres à cours limité au repos (appelant sous walletMutex, voir getMutex) ---
+    // Un montant réservé quitte le solde disponible (getBalance) jusqu'à son exécution (consumeReserved) ou
+    // l'annulation de l'ordre (releaseReserved). Les ordres au repos ne survivent pas à un redémarrage : le
+    // fichier du portefeuille enregistre solde disponible + réservé.
+    bool reserveFunds(Currency currency, double amount); // false (rien réservé) si le solde disponible est insuffisant
+    void releaseReserved(Currency currency, double amount);
+    void consumeReserved(Currency currency, double amount);
+    double getReserved(Currency currency) const;
+
     // --- Méthodes de gestion de l'historique (Doivent être thread-safe dans .cpp en utilisant walletMutex) ---
     void addTransaction(const Transaction& tx); // Ajoute transaction (Thread-safe)
     std::vector<Transaction> getTransactionHistory() const; // Retourne historique (Thread-safe, copie pour sécurité)
 
+    // Page d'historique (SHOW TRANSACTIONS [limite] [before=<id>]).
+    struct TransactionPage {
+        size_t total = 0;         // Nombre total de transactions
+        size_t count = 0;         // Transactions visitées
+        bool cursorFound = true;  // false si 'beforeId' n'est pas dans l'historique (rien n'est visité)
+        std::string nextCursor;   // ID de la plus ancienne transaction visitée s'il en reste de plus anciennes, sinon vide
+    };
+    // Visite sur place, sous walletMutex, les 'limit' transactions qui précèdent 'beforeId' (vide = les plus
+    // récentes), de la plus ancienne à la plus récente. Le curseur est retrouvé par historyIndex : une page
+    // coûte O(limit) quelle que soit sa profondeur. Aucune copie de l'historique : 'visit' ne doit ni
+    // rappeler ce Wallet ni bloquer (le verrou retarde les ordres du client).
+    TransactionPage visitTransactionPage(size_t limit, const std::string& beforeId,
+                                         const std::function<void(const Transaction&)>& visit) const;
+
     // --- Méthodes de persistance (Doivent être thread-safe dans .cpp en utilisant walletMutex) ---
     bool loadFromFile(); // Charge données depuis fichier (Thread-safe, modifie l'état)
     bool saveToFile() const; // Sauvegarde données dans fichier (Thread-safe, lecture de l'état)
+    // Sauvegarde durable, appelant sous walletMutex : fichier temporaire mis sur disque (fdatasync), renommé
+    // sur le fichier du portefeuille, puis répertoire mis sur disque. Un arrêt brutal, même de la machine,
+    // laisse l'ancien ou le nouvel état, jamais un fichier tronqué.
+    bool saveToFileAtomic() const;
+    // Les mêmes étapes séparées, pour le group commit (voir GroupCommit.h) qui met sur disque tous les fichiers
+    // temporaires d'un lot en une fois entre les deux. Appelant sous walletMutex pour chacune.
+    bool writeTemporaryFile() const;   // Écrit '<portefeuille>.tmp', sans mise sur disque
+    bool publishTemporaryFile() const; // Le renomme sur le fichier du portefeuille
+    std::string getDirectoryPath() const; // Répertoire du fichier (à mettre sur disque après le renommage)
+    // fsync de 'path' (fichier ou répertoire). false en cas d'échec (loggué).
+    static bool syncPath(const std::string& path, bool directory);
 
     // --- Méthode Cruciale pour verrouiller le Wallet depuis l'extérieur (par la TQ) ---
     std::mutex& getMutex();
 
+    // --- Portefeuilles vivants du processus (mise à jour à chaud, voir HotUpgrade) ---
+    // Comptes dont un Wallet existe encore dans ce processus, qui peut donc encore écrire leur fichier.
+    static std::vector<std::string> liveClientIds();
+    // Appelé à la destruction du dernier Wallet d'un client, APRÈS sa sauvegarde finale : ce processus
+    // n'écrira plus son fichier. Appelé hors de liveMutex.
+    static void setReleaseHandler(std::function<void(const std::string& clientId)> handler);
+
     // --- Getter simple (sur membre constant) ---
     const std::string& getClientId() const; // Retourne l'ID client
 };